@@ -8,35 +8,162 @@
 
 #include "carla/Buffer.h"  // 包含 Buffer 头文件，定义 Buffer 类
 
-#if defined(__clang__)  // 检查是否使用 Clang 编译器
-#  pragma clang diagnostic push   // 保存当前的编译警告状态
-#  pragma clang diagnostic ignored "-Wold-style-cast"  // 忽略旧风格的类型转换警告
-#endif
-#include "moodycamel/ConcurrentQueue.h"  // 包含 moodycamel 的并发队列实现
-#if defined(__clang__)  // 再次检查是否使用 Clang 编译器
-#  pragma clang diagnostic pop  // 恢复之前保存的编译警告状态
-#endif
-
+#include <array>  // 每个大小级别一个空闲列表
+#include <cstdint>
 #include <memory>  // 包含内存管理相关的头文件
+#include <mutex>
+#include <vector>
 
 namespace carla {
 
   /// 一个缓冲区池。 从这个池中弹出的缓冲区在销毁时会自动返回到池中，
   /// 这样分配的内存可以被重用。
+  ///
+  /// 缓冲区按容量以2的幂划分为若干大小级别，第 i 级保存容量在
+  /// [2^i, 2^(i+1)) 之间的缓冲区。指定大小弹出时只会得到容量足够的缓冲区，
+  /// 因此大消息不会拿到一个很小的缓冲区后再重新分配。
+  ///
+  /// 每个级别保留的缓冲区数量以及池中保留的总字节数都有上限，超出上限的
+  /// 缓冲区在归还时直接释放；也可以调用 Trim() 主动释放保留的内存。
   /// @warning 缓冲区仅通过增长来调整其大小，除非明确地清除它们，否则不会缩小。
-  /// 分配的内存在此池被销毁时才会被删除。
 
   class BufferPool : public std::enable_shared_from_this<BufferPool> {  // 定义 BufferPool 类，支持共享指针
   public:
 
+    /// 大小级别的数量，足以覆盖 Buffer 的最大容量。
+    static constexpr size_t NumberOfSizeClasses = 8u * sizeof(Buffer::size_type);
+
+    /// 指定大小弹出时，最多向上查找多少个更大的级别。
+    static constexpr size_t MaxSizeClassDistance = 2u;
+
+    /// 默认每个级别最多保留的缓冲区数量。
+    static constexpr size_t DefaultMaxBuffersPerSizeClass = 32u;
+
+    /// 默认池中最多保留的字节数。
+    static constexpr size_t DefaultMaxRetainedBytes = 512u * 1024u * 1024u;
+
+    /// 池的使用统计。
+    struct Statistics {
+      /// 弹出时复用了池中的缓冲区的次数。
+      uint64_t hits = 0u;
+      /// 弹出时池中没有合适的缓冲区的次数。
+      uint64_t misses = 0u;
+      /// 归还后保留在池中的缓冲区数量（累计）。
+      uint64_t pushes = 0u;
+      /// 归还时因超出上限而释放的缓冲区数量（累计）。
+      uint64_t discarded = 0u;
+      /// 当前保留在池中的缓冲区数量。
+      uint64_t buffers_retained = 0u;
+      /// 当前保留在池中的字节数。
+      uint64_t bytes_retained = 0u;
+    };
+
     BufferPool() = default;  // 默认构造函数
 
-    explicit BufferPool(size_t estimated_size) : _queue(estimated_size) {}  // 带参数的构造函数，初始化队列大小
+    /// @param max_buffers_per_size_class 每个大小级别最多保留的缓冲区数量。
+    /// @param max_retained_bytes 池中最多保留的字节数。
+    explicit BufferPool(
+        size_t max_buffers_per_size_class,
+        size_t max_retained_bytes = DefaultMaxRetainedBytes)
+      : _max_buffers_per_size_class(max_buffers_per_size_class),
+        _max_retained_bytes(max_retained_bytes) {}
 
-  /// 从队列中弹出一个缓冲区，如果队列为空，则创建一个新的缓冲区。
+    /// 弹出池中最小的可用缓冲区，如果池为空，则创建一个新的缓冲区。
     Buffer Pop() {
+      return PopFromSizeClasses(0u, 0u, NumberOfSizeClasses);
+    }
+
+    /// 弹出一个容量至少为 @a size 的缓冲区，如果没有合适的缓冲区，则创建
+    /// 一个新的缓冲区。弹出的缓冲区大小不变，需要调用 reset(size) 调整。
+    Buffer Pop(size_t size) {
+      // 第 floor(log2(size)) 级中也可能有容量足够的缓冲区
+      return PopFromSizeClasses(
+          size,
+          SizeClassForCapacity(size),
+          SizeClassForRequest(size) + MaxSizeClassDistance + 1u);
+    }
+
+    /// 释放池中保留的缓冲区，直到保留的字节数不超过 @a max_retained_bytes。
+    /// 优先释放最大的缓冲区。
+    void Trim(size_t max_retained_bytes = 0u) {
+      std::vector<Buffer> released;
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = NumberOfSizeClasses; i > 0u && _bytes_retained > max_retained_bytes; --i) {
+          auto &size_class = _size_classes[i - 1u];
+          while (!size_class.empty() && _bytes_retained > max_retained_bytes) {
+            _bytes_retained -= size_class.back().capacity();
+            released.emplace_back(std::move(size_class.back()));
+            size_class.pop_back();
+            --_buffers_retained;
+          }
+        }
+      }
+      // 在锁外释放内存，并且不能让缓冲区再回到池中
+      for (auto &buffer : released) {
+        buffer._parent_pool.reset();
+      }
+    }
+
+    Statistics GetStatistics() const {
+      std::lock_guard<std::mutex> lock(_mutex);
+      Statistics statistics;
+      statistics.hits = _hits;
+      statistics.misses = _misses;
+      statistics.pushes = _pushes;
+      statistics.discarded = _discarded;
+      statistics.buffers_retained = _buffers_retained;
+      statistics.bytes_retained = _bytes_retained;
+      return statistics;
+    }
+
+    /// 容量为 @a capacity 的缓冲区所属的大小级别，即 floor(log2(capacity))。
+    static size_t SizeClassForCapacity(size_t capacity) {
+      size_t size_class = 0u;
+      while (capacity > 1u) {
+        capacity >>= 1u;
+        ++size_class;
+      }
+      return size_class;
+    }
+
+    /// 能容纳 @a size 字节的最小大小级别，即 ceil(log2(size))。
+    static size_t SizeClassForRequest(size_t size) {
+      return size <= 1u ? 0u : SizeClassForCapacity(size - 1u) + 1u;
+    }
+
+  private:
+
+    friend class Buffer;  // 允许 Buffer 类访问私有成员
+
+    /// 在 [first, last) 级中查找容量至少为 @a min_capacity 的缓冲区。
+    Buffer PopFromSizeClasses(size_t min_capacity, size_t first, size_t last) {
       Buffer item; // 创建一个 Buffer 实例
-      _queue.try_dequeue(item); // 尝试从队列中弹出，失败则不处理
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        last = last < NumberOfSizeClasses ? last : NumberOfSizeClasses;
+        for (size_t i = first; i < last && item.capacity() == 0u; ++i) {
+          auto &size_class = _size_classes[i];
+          // 后进先出，最近归还的缓冲区更可能还在缓存中
+          for (size_t j = size_class.size(); j > 0u; --j) {
+            if (size_class[j - 1u].capacity() >= min_capacity) {
+              item = std::move(size_class[j - 1u]);
+              if (j != size_class.size()) {
+                size_class[j - 1u] = std::move(size_class.back());
+              }
+              size_class.pop_back();
+              _bytes_retained -= item.capacity();
+              --_buffers_retained;
+              break;
+            }
+          }
+        }
+        if (item.capacity() > 0u) {
+          ++_hits;
+        } else {
+          ++_misses;
+        }
+      }
 #if __cplusplus >= 201703L // 检查是否支持 C++17
       item._parent_pool = weak_from_this();  // 设置父池为弱引用
 #else
@@ -45,15 +172,45 @@ namespace carla {
       return item;  // 返回弹出的 Buffer
     }
 
-  private:
-
-    friend class Buffer;  // 允许 Buffer 类访问私有成员
-
     void Push(Buffer &&buffer) {  // 定义 Push 方法，接受一个右值引用的 Buffer
-      _queue.enqueue(std::move(buffer));  // 将 Buffer 移动到队列中
+      Buffer item = std::move(buffer);
+      const size_t capacity = item.capacity();
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto &size_class = _size_classes[SizeClassForCapacity(capacity)];
+        if ((size_class.size() < _max_buffers_per_size_class) &&
+            (_bytes_retained + capacity <= _max_retained_bytes)) {
+          size_class.emplace_back(std::move(item));
+          _bytes_retained += capacity;
+          ++_buffers_retained;
+          ++_pushes;
+          return;
+        }
+        ++_discarded;
+      }
+      // 超出上限，在锁外释放该缓冲区的内存，不再放回池中
+      item._parent_pool.reset();
     }
 
-    moodycamel::ConcurrentQueue<Buffer> _queue;  // 定义并发队列用于存储 Buffer
+    const size_t _max_buffers_per_size_class = DefaultMaxBuffersPerSizeClass;
+
+    const size_t _max_retained_bytes = DefaultMaxRetainedBytes;
+
+    mutable std::mutex _mutex;
+
+    std::array<std::vector<Buffer>, NumberOfSizeClasses> _size_classes;
+
+    uint64_t _hits = 0u;
+
+    uint64_t _misses = 0u;
+
+    uint64_t _pushes = 0u;
+
+    uint64_t _discarded = 0u;
+
+    uint64_t _buffers_retained = 0u;
+
+    uint64_t _bytes_retained = 0u;
   };
 
 } // namespace carla
@@ -215,6 +215,18 @@ namespace client {
       return responses;  // 返回所有命令的响应列表。
     }
 
+    // 在一次往返中获取多辆车的物理控制参数，不是车辆或不存在的参与者对应空值。
+    std::vector<boost::optional<rpc::VehiclePhysicsControl>> GetVehiclePhysicsControlBatch(
+        const std::vector<ActorId> &vehicles) const {
+      return _simulator->GetVehiclePhysicsControlBatch(vehicles);
+    }
+
+    // 在一次往返中获取多辆车的灯光状态，不是车辆或不存在的参与者对应空值。
+    std::vector<boost::optional<rpc::VehicleLightState>> GetVehicleLightStateBatch(
+        const std::vector<ActorId> &vehicles) const {
+      return _simulator->GetVehicleLightStateBatch(vehicles);
+    }
+
   private:
   
     // 当前仿真器实例的智能指针，用于管理仿真器的生命周期。
@@ -26,7 +26,9 @@ namespace client {
     // 如果路径不以斜杠结尾，自动添加斜杠
     if (path[path.size() - 1] != '/' && path[path.size() - 1] != '\\') {
       _filesBaseFolder = path + "/";
-  }
+    } else {
+      _filesBaseFolder = path;
+    }
 
     return true;
   }
@@ -36,15 +38,21 @@ namespace client {
     return _filesBaseFolder;
   }
 
-  // 检查指定的文件是否存在
-  bool FileTransfer::FileExists(std::string file) {
-    // 构建文件的完整路径
-    struct stat buffer;
+  // 返回缓存中文件的完整路径
+  std::string FileTransfer::GetFullPath(const std::string &file) {
     std::string fullpath = _filesBaseFolder;
     fullpath += "/";
     fullpath += ::carla::version(); // 加入当前的Carla版本号
     fullpath += "/";
     fullpath += file; // 添加目标文件名
+    return fullpath;
+  }
+
+  // 检查指定的文件是否存在
+  bool FileTransfer::FileExists(std::string file) {
+    // 构建文件的完整路径
+    struct stat buffer;
+    const std::string fullpath = GetFullPath(file);
 
     // 使用 stat 函数检查文件是否存在
     return (stat(fullpath.c_str(), &buffer) == 0);
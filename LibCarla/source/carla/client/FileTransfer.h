@@ -28,6 +28,8 @@ namespace client {   // 定义client命名空间
 
     static const std::string& GetFilesBaseFolder();   // 获取文件基础目录的常量引用
 
+    static std::string GetFullPath(const std::string &file);   // 返回缓存中文件的完整路径（基础目录/版本号/文件）
+
     static bool FileExists(std::string file);    // 检查文件是否存在，返回布尔值
 
     static bool WriteFile(std::string path, std::vector<uint8_t> content);    // 写入文件，返回是否成功
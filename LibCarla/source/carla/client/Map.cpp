@@ -10,6 +10,7 @@
 #include "carla/client/Waypoint.h"
 #include "carla/opendrive/OpenDriveParser.h"
 #include "carla/road/Map.h"
+#include "carla/road/MapSnapshot.h"
 #include "carla/road/RoadTypes.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 
@@ -31,6 +32,22 @@ static auto MakeMap(const std::string &opendrive_contents) {
 // 移动 map 的值
     return std::move(*map);
   }
+// 优先从快照恢复地图，快照不可用时解析 opendrive 内容并保存新的快照
+  static road::Map MakeMap(
+      const std::string &opendrive_contents,
+      const std::string &snapshot_file,
+      const uint64_t hash) {
+    if (snapshot_file.empty()) {
+      return MakeMap(opendrive_contents);
+    }
+    auto snapshot = road::MapSnapshot::Load(snapshot_file, hash);
+    if (snapshot.has_value()) {
+      return std::move(*snapshot);
+    }
+    auto map = MakeMap(opendrive_contents);
+    road::MapSnapshot::Save(map, hash, snapshot_file);
+    return map;
+  }
  // Map 类的构造函数，接受 rpc::MapInfo 和 xodr 内容
   Map::Map(rpc::MapInfo description, std::string xodr_content)
     : _description(std::move(description)),
@@ -38,6 +55,16 @@ static auto MakeMap(const std::string &opendrive_contents) {
 // 存储 xodr 内容
     open_drive_file = xodr_content;
   }
+// Map 类的构造函数，额外接受地图快照文件的路径
+  Map::Map(
+      rpc::MapInfo description,
+      std::string xodr_content,
+      const std::string &snapshot_file,
+      const uint64_t opendrive_hash)
+    : _description(std::move(description)),
+      _map(MakeMap(xodr_content, snapshot_file, opendrive_hash)){
+    open_drive_file = xodr_content;
+  }
 // 另一个 Map 类的构造函数，接受名称和 xodr 内容
   Map::Map(std::string name, std::string xodr_content)
     : Map(rpc::MapInfo{
@@ -64,6 +64,23 @@ namespace client {
                * @param xodr_content 包含OpenDRIVE地图数据的字符串。
                */
     explicit Map(rpc::MapInfo description, std::string xodr_content);   
+    /**
+         * @brief 构造函数，优先从磁盘上的地图快照恢复地图。
+         *
+         * 快照与 @a opendrive_hash 不符或不存在时解析OpenDRIVE内容，
+         * 并将结果写入 @a snapshot_file 供之后的客户端使用。
+         *
+         * @param description 描述地图信息的RPC对象。
+         * @param xodr_content 包含OpenDRIVE地图数据的字符串。
+         * @param snapshot_file 地图快照文件的完整路径，为空时不使用快照。
+         * @param opendrive_hash @a xodr_content 的 road::MapSnapshot::ComputeHash，
+         *        调用者通常已经为生成快照文件名计算过。
+         */
+    explicit Map(
+        rpc::MapInfo description,
+        std::string xodr_content,
+        const std::string &snapshot_file,
+        uint64_t opendrive_hash);
     /**
          * @brief 构造函数，从名称和OpenDRIVE内容创建地图。
          *
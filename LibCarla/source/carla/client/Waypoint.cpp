@@ -75,22 +75,24 @@ namespace client {
 
   // 获取Waypoint的下一个Waypoint直到车道结束
   std::vector<SharedPtr<Waypoint>> Waypoint::GetNextUntilLaneEnd(double distance) const {
+    const auto &map = _parent->GetMap();
     std::vector<SharedPtr<Waypoint>> result;  // 结果存储容器
-    std::vector<SharedPtr<Waypoint>> next = GetNext(distance);  // 获取下一个Waypoint列表
+    // 只需判断后继是否唯一，使用栈上的缓冲区避免每一步创建临时对象
+    road::element::Waypoint candidates[2u];
+    road::element::Waypoint current = _waypoint;
+    size_t count = map.GetNext(current, distance, candidates, 2u);  // 获取下一个Waypoint
 
     // 如果下一个Waypoint还在同一条路上，继续获取下一个
-    while (next.size() == 1 && next.front()->GetRoadId() == GetRoadId()) {
-      result.emplace_back(next.front());  // 将下一个Waypoint添加到结果中
-      next = result.back()->GetNext(distance);  // 获取该Waypoint的下一个Waypoint
+    while (count == 1u && candidates[0u].road_id == _waypoint.road_id) {
+      current = candidates[0u];
+      result.emplace_back(SharedPtr<Waypoint>(new Waypoint(_parent, current)));  // 将下一个Waypoint添加到结果中
+      count = map.GetNext(current, distance, candidates, 2u);  // 获取该Waypoint的下一个Waypoint
     }
-    
-    double current_s = GetDistance();  // 获取当前Waypoint的位置
-    if(result.size()) {  // 如果结果中有Waypoint
-      current_s = result.back()->GetDistance();  // 获取最后一个Waypoint的位置
-    }
-    
+
+    double current_s = current.s;  // 当前Waypoint或最后一个Waypoint的位置
+
     double remaining_length;  // 剩余长度
-    double road_length = _parent->GetMap().GetLane(_waypoint).GetRoad()->GetLength();  // 获取道路的总长度
+    double road_length = map.GetLane(_waypoint).GetRoad()->GetLength();  // 获取道路的总长度
     if(_waypoint.lane_id < 0) {  // 如果车道ID为负数
       remaining_length = road_length - current_s;  // 剩余长度为道路总长减去当前距离
     } else {
@@ -98,34 +100,33 @@ namespace client {
     }
     remaining_length -= std::numeric_limits<double>::epsilon();  // 减去一个非常小的数值以避免浮动误差
     
-    // 如果结果中有Waypoint，获取其下一个Waypoint直到车道结束
-    if(result.size()) {
-      result.emplace_back(result.back()->GetNext(remaining_length).front());  // 添加最后一个Waypoint
-    } else {
-      result.emplace_back(GetNext(remaining_length).front());  // 如果没有Waypoint，则获取当前Waypoint的下一个
-    }
+    // 获取下一个Waypoint直到车道结束
+    result.emplace_back(SharedPtr<Waypoint>(
+        new Waypoint(_parent, map.GetNext(current, remaining_length).front())));
 
     return result;  // 返回直到车道结束的Waypoint列表
   }
 
   // 获取Waypoint的前一个Waypoint直到车道开始
   std::vector<SharedPtr<Waypoint>> Waypoint::GetPreviousUntilLaneStart(double distance) const {
+    const auto &map = _parent->GetMap();
     std::vector<SharedPtr<Waypoint>> result;  // 结果存储容器
-    std::vector<SharedPtr<Waypoint>> prev = GetPrevious(distance);  // 获取前一个Waypoint列表
+    // 只需判断前驱是否唯一，使用栈上的缓冲区避免每一步创建临时对象
+    road::element::Waypoint candidates[2u];
+    road::element::Waypoint current = _waypoint;
+    size_t count = map.GetPrevious(current, distance, candidates, 2u);  // 获取前一个Waypoint
 
     // 如果前一个Waypoint还在同一条路上，继续获取前一个
-    while (prev.size() == 1 && prev.front()->GetRoadId() == GetRoadId()) {
-      result.emplace_back(prev.front());  // 将前一个Waypoint添加到结果中
-      prev = result.back()->GetPrevious(distance);  // 获取该Waypoint的前一个Waypoint
+    while (count == 1u && candidates[0u].road_id == _waypoint.road_id) {
+      current = candidates[0u];
+      result.emplace_back(SharedPtr<Waypoint>(new Waypoint(_parent, current)));  // 将前一个Waypoint添加到结果中
+      count = map.GetPrevious(current, distance, candidates, 2u);  // 获取该Waypoint的前一个Waypoint
     }
 
-    double current_s = GetDistance();  // 获取当前Waypoint的位置
-    if(result.size()) {  // 如果结果中有Waypoint
-      current_s = result.back()->GetDistance();  // 获取最后一个Waypoint的位置
-    }
+    double current_s = current.s;  // 当前Waypoint或最后一个Waypoint的位置
 
     double remaining_length;  // 剩余长度
-    double road_length = _parent->GetMap().GetLane(_waypoint).GetRoad()->GetLength();  // 获取道路的总长度
+    double road_length = map.GetLane(_waypoint).GetRoad()->GetLength();  // 获取道路的总长度
     if(_waypoint.lane_id < 0) {  // 如果车道ID为负数
       remaining_length = road_length - current_s;  // 剩余长度为道路总长减去当前距离
     } else {
@@ -133,12 +134,9 @@ namespace client {
     }
     remaining_length -= std::numeric_limits<double>::epsilon();  // 减去一个非常小的数值以避免浮动误差
     
-    // 如果结果中有Waypoint，获取其前一个Waypoint直到车道开始
-    if(result.size()) {
-      result.emplace_back(result.back()->GetPrevious(remaining_length).front());  // 添加最后一个Waypoint
-    } else {
-      result.emplace_back(GetPrevious(remaining_length).front());  // 如果没有Waypoint，则获取当前Waypoint的前一个
-    }
+    // 获取前一个Waypoint直到车道开始
+    result.emplace_back(SharedPtr<Waypoint>(
+        new Waypoint(_parent, map.GetPrevious(current, remaining_length).front())));
 
     return result;  // 返回直到车道开始的Waypoint列表
   }
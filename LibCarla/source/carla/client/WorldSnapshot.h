@@ -61,6 +61,14 @@ namespace client {
       return _state->end();
     }
 
+    // 与 previous 相比新出现和消失的参与者ID（升序），两个快照应属于同一剧集
+    void GetActorIdChanges(
+        const WorldSnapshot &previous,
+        std::vector<ActorId> &spawned,
+        std::vector<ActorId> &destroyed) const {
+      _state->GetActorIdChanges(*previous._state, spawned, destroyed);
+    }
+
     // 重载等于运算符，比较两个 WorldSnapshot 对象是否相等
     // 只有在时间戳相同的情况下，两个快照才视为相等
     bool operator==(const WorldSnapshot &rhs) const {
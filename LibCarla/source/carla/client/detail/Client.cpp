@@ -7,6 +7,7 @@
 #include "carla/client/detail/Client.h"
 
 #include "carla/Exception.h"
+#include "carla/Logging.h"
 #include "carla/Version.h"
 #include "carla/client/FileTransfer.h"
 #include "carla/client/TimeoutException.h"
@@ -26,6 +27,9 @@
 
 #include <rpc/rpc_error.h>
 
+#include <atomic>
+#include <chrono>
+#include <future>
 #include <thread>
 
 namespace carla {
@@ -41,6 +45,32 @@ namespace detail {
     return true;
   }
 
+  // 出错的响应转换为空值
+  template <typename T>
+  static std::vector<boost::optional<T>> GetOptionals(std::vector<carla::rpc::Response<T>> &&responses) {
+    std::vector<boost::optional<T>> result;
+    result.reserve(responses.size());
+    for (auto &response : responses) {
+      if (response.HasError()) {
+        result.emplace_back();
+      } else {
+        result.emplace_back(std::move(response.Get()));
+      }
+    }
+    return result;
+  }
+
+  // 服务器没有绑定被调用的函数时，rpclib 返回的错误信息为
+  // "rpc: server could not find function '<name>' with argument count <n>."
+  static bool IsUnboundFunctionError(::rpc::rpc_error &e) {
+    try {
+      const auto message = e.get_error().get().as<std::string>();
+      return message.find("could not find function") != std::string::npos;
+    } catch (const std::exception &) {
+      return false;
+    }
+  }
+
   // ===========================================================================
   // -- Client::Pimpl ----------------------------------------------------------
   // ===========================================================================
@@ -83,6 +113,63 @@ namespace detail {
       rpc_client.async_call(function, std::forward<Args>(args) ...);
     }
 
+    // 发出一个需要响应的请求但不等待，返回可以稍后等待的future
+    template <typename ... Args>
+    auto AsyncRequest(const std::string &function, Args && ... args) {
+      return rpc_client.async_request(function, std::forward<Args>(args) ...);
+    }
+
+    // 等待一组已经发出的请求的响应，所有请求共享同一个超时时间
+    template <typename T, typename FutureT>
+    auto WaitForResponses(std::vector<FutureT> &futures) {
+      using R = typename carla::rpc::Response<T>;
+      std::vector<R> responses;
+      responses.reserve(futures.size());
+      const auto deadline = std::chrono::steady_clock::now() + GetTimeout().to_chrono();
+      for (auto &future : futures) {
+        if (future.wait_until(deadline) != std::future_status::ready) {
+          throw_exception(TimeoutException(endpoint, GetTimeout()));
+        }
+        responses.emplace_back(future.get().template as<R>());
+      }
+      return responses;
+    }
+
+    // 对每个参数调用一次 function：先连续发出所有请求，再统一等待响应，
+    // 总耗时接近一次往返而不是每个请求一次往返
+    template <typename T, typename ArgT>
+    auto CallPipelined(const std::string &function, const std::vector<ArgT> &args) {
+      using FutureT = decltype(AsyncRequest(function, std::declval<const ArgT &>()));
+      std::vector<FutureT> futures;
+      futures.reserve(args.size());
+      for (auto &&arg : args) {
+        futures.emplace_back(AsyncRequest(function, arg));
+      }
+      return WaitForResponses<T>(futures);
+    }
+
+    // 调用服务器的批量接口 batch_function，服务器不支持时退回到流水线逐个调用 function
+    template <typename T, typename ArgT>
+    auto CallBatch(
+        const std::string &batch_function,
+        const std::string &function,
+        const std::vector<ArgT> &args) {
+      using R = typename carla::rpc::Response<T>;
+      if (batch_supported) {
+        try {
+          return RawCall(batch_function, args).template as<std::vector<R>>();
+        } catch (::rpc::rpc_error &e) {
+          if (!IsUnboundFunctionError(e)) {
+            // 批量接口本身出错，不能说明服务器不支持，交给调用者处理
+            throw;
+          }
+          log_warning("batch function", batch_function, "not found on the server, falling back to pipelined calls");
+          batch_supported = false;
+        }
+      }
+      return CallPipelined<T>(function, args);
+    }
+
     time_duration GetTimeout() const {
       auto timeout = rpc_client.get_timeout();
       DEBUG_ASSERT(timeout.has_value());
@@ -91,6 +178,8 @@ namespace detail {
 
     const std::string endpoint;
 
+    std::atomic_bool batch_supported{true};
+
     rpc::Client rpc_client;
 
     streaming::Client streaming_client;
@@ -291,6 +380,18 @@ namespace detail {
     return _pimpl->CallAndWait<carla::rpc::VehicleLightState>("get_vehicle_light_state", vehicle);
   }
 
+  std::vector<boost::optional<rpc::VehiclePhysicsControl>> Client::GetVehiclePhysicsControlBatch(
+      const std::vector<rpc::ActorId> &vehicles) const {
+    return GetOptionals(_pimpl->CallBatch<carla::rpc::VehiclePhysicsControl>(
+        "get_physics_control_batch", "get_physics_control", vehicles));
+  }
+
+  std::vector<boost::optional<rpc::VehicleLightState>> Client::GetVehicleLightStateBatch(
+      const std::vector<rpc::ActorId> &vehicles) const {
+    return GetOptionals(_pimpl->CallBatch<carla::rpc::VehicleLightState>(
+        "get_vehicle_light_state_batch", "get_vehicle_light_state", vehicles));
+  }
+
   void Client::ApplyPhysicsControlToVehicle(
       rpc::ActorId vehicle,
       const rpc::VehiclePhysicsControl &physics_control) {
@@ -715,6 +816,13 @@ namespace detail {
     return result.as<std::vector<rpc::CommandResponse>>();
   }
 
+  std::vector<rpc::CommandResponse> Client::ApplyBatchSync(
+      rpc::CommandBatchView commands,
+      bool do_tick_cue) {
+    auto result = _pimpl->RawCall("apply_batch", commands, do_tick_cue);
+    return result.as<std::vector<rpc::CommandResponse>>();
+  }
+
   uint64_t Client::SendTickCue() {
     return _pimpl->CallAndWait<uint64_t>("tick_cue");
   }
@@ -15,6 +15,7 @@
 #include "carla/rpc/ActorDefinition.h"
 #include "carla/rpc/AttachmentType.h"
 #include "carla/rpc/Command.h"
+#include "carla/rpc/CommandBatch.h"
 #include "carla/rpc/CommandResponse.h"
 #include "carla/rpc/EnvironmentObject.h"
 #include "carla/rpc/EpisodeInfo.h"
@@ -35,6 +36,8 @@
 #include "carla/rpc/Texture.h"
 #include "carla/rpc/MaterialParameter.h"
 
+#include <boost/optional.hpp>
+
 #include <functional>
 #include <memory>
 #include <string>
@@ -161,6 +164,14 @@ namespace detail {
 
     rpc::VehicleLightState GetVehicleLightState(rpc::ActorId vehicle) const;
 
+    /// 在一次往返中获取多辆车的物理控制参数，出错的车辆对应空值。
+    std::vector<boost::optional<rpc::VehiclePhysicsControl>> GetVehiclePhysicsControlBatch(
+        const std::vector<rpc::ActorId> &vehicles) const;
+
+    /// 在一次往返中获取多辆车的灯光状态，出错的车辆对应空值。
+    std::vector<boost::optional<rpc::VehicleLightState>> GetVehicleLightStateBatch(
+        const std::vector<rpc::ActorId> &vehicles) const;
+
     void ApplyPhysicsControlToVehicle(
         rpc::ActorId vehicle,
         const rpc::VehiclePhysicsControl &physics_control);
@@ -445,6 +456,11 @@ namespace detail {
         std::vector<rpc::Command> commands,
         bool do_tick_cue);
 
+    /// 与上面相同，但直接从调用方的缓冲区打包命令，不复制命令列表。
+    std::vector<rpc::CommandResponse> ApplyBatchSync(
+        rpc::CommandBatchView commands,
+        bool do_tick_cue);
+
     uint64_t SendTickCue();
 
     std::vector<rpc::LightState> QueryLightsStateToServer() const;
@@ -62,8 +62,19 @@ using namespace std::chrono_literals;
       if (self != nullptr) {
         // 反序列化数据
         auto data = sensor::Deserializer::Deserialize(std::move(buffer));
-        auto next = std::make_shared<const EpisodeState>(CastData(*data));
+        const auto &raw_state = CastData(*data);
         auto prev = self->GetState();
+        std::shared_ptr<const EpisodeState> next;
+        if (!raw_state.IsDelta()) {
+          next = std::make_shared<const EpisodeState>(raw_state);
+        } else if (prev->CanApplyDelta(raw_state)) {
+          // 增量帧与上一状态共享关键帧表，只构建变化的参与者
+          next = std::make_shared<const EpisodeState>(raw_state, *prev);
+        } else {
+          // 还没有收到增量所基于的关键帧（刚刚订阅或关键帧丢失），等待下一个关键帧
+          log_debug("episode: missing keyframe", raw_state.GetKeyframe(), "for frame", raw_state.GetFrame());
+          return;
+        }
 
         // TODO: 更新地图变化的检测方式
         bool HasMapChanged = next->HasMapChanged();
@@ -109,7 +120,7 @@ using namespace std::chrono_literals;
 
           // 通知等待的线程并执行回调。
           self->_snapshot.SetValue(next);
-/ 通知等待的线程并执行回调，通过调用_snapshot的SetValue函数，传入下一个状态数据，
+// 通知等待的线程并执行回调，通过调用_snapshot的SetValue函数，传入下一个状态数据，
                     // 这样其他等待该状态数据的部分（可能是其他线程或者模块）就可以获取到最新的状态并进行相应操作。
                     // 同时调用_on_tick_callbacks的Call函数，传入下一个状态数据，执行用户注册的每帧回调函数。
 
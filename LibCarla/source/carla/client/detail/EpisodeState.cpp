@@ -6,10 +6,47 @@
 // 引入必要的头文件
 #include "carla/client/detail/EpisodeState.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace client {
 namespace detail {
 
+  using SimulationState = sensor::s11n::EpisodeStateSerializer::SimulationState;
+
+  static ActorSnapshot MakeActorSnapshot(const sensor::data::ActorDynamicState &actor) {
+    return ActorSnapshot{
+        actor.id,               // Actor的ID
+        actor.actor_state,      // Actor的状态
+        actor.transform,        // Actor的变换（位置和方向）
+        actor.velocity,         // Actor的速度
+        actor.angular_velocity, // Actor的角速度
+        actor.acceleration,     // Actor的加速度
+        actor.state};           // Actor的附加状态信息
+  }
+
+  static bool CompareIds(const ActorSnapshot &lhs, const ActorSnapshot &rhs) {
+    return lhs.id < rhs.id;
+  }
+
+  /// 在按ID排序的快照数组中二分查找。
+  static const ActorSnapshot *FindSorted(const std::vector<ActorSnapshot> &actors, ActorId id) {
+    auto it = std::lower_bound(actors.begin(), actors.end(), id, [](const ActorSnapshot &lhs, ActorId rhs) {
+      return lhs.id < rhs;
+    });
+    return ((it != actors.end()) && (it->id == id)) ? &*it : nullptr;
+  }
+
+  /// 去掉仅用于传输的 Delta 标志。
+  static SimulationState StripDeltaFlag(SimulationState state) {
+    return static_cast<SimulationState>(state & ~SimulationState::Delta);
+  }
+
+  EpisodeState::EpisodeState(uint64_t episode_id)
+    : _episode_id(episode_id),
+      _simulation_state(SimulationState::None),
+      _keyframe(std::make_shared<ActorTable>()) {}
+
 // EpisodeState类的构造函数，用于初始化一个EpisodeState对象
   // 参数：state - 一个const引用，指向sensor::data::RawEpisodeState类型的数据，包含了当前模拟场景的状态信息
   EpisodeState::EpisodeState(const sensor::data::RawEpisodeState &state)
@@ -21,28 +58,114 @@ namespace detail {
           state.GetDeltaSeconds(),
           state.GetPlatformTimeStamp()),
       _map_origin(state.GetMapOrigin()),// 初始化_map_origin，表示地图的原点
-      _simulation_state(state.GetSimulationState()) {// 初始化_simulation_state，表示当前的模拟状态
-    // 预留空间以存储所有的Actor快照
-    _actors.reserve(state.size());
-// 遍历RawEpisodeState中的所有Actor，并为每个Actor创建一个ActorSnapshot对象
+      _simulation_state(StripDeltaFlag(state.GetSimulationState())) {// 初始化_simulation_state，表示当前的模拟状态
+    DEBUG_ASSERT(!state.IsDelta());
+    auto table = std::make_shared<ActorTable>();
+    table->frame = state.GetFrame();
+    table->is_keyframe = true;
+    // 预留空间以存储所有的Actor快照，然后按ID排序以便二分查找和合并增量
+    table->actors.reserve(state.size());
     for (auto &&actor : state) {
- // 使用emplace方法将ActorSnapshot对象插入到_actors映射中
-      // 键是Actor的ID，值是ActorSnapshot对象
-      // DEBUG_ONLY(auto result = ) 这部分代码用于调试，用于检查插入操作是否成功
-      DEBUG_ONLY(auto result = )
-      _actors.emplace(
-          actor.id,
-          ActorSnapshot{// 初始化ActorSnapshot对象
-              actor.id,         // Actor的ID
-              actor.actor_state, // Actor的状态
-              actor.transform,// Actor的变换（位置和方向）
-              actor.velocity,// Actor的速度
-              actor.angular_velocity,// Actor的角速度
-              actor.acceleration,// Actor的加速度
-              actor.state});// Actor的附加状态信息
-      DEBUG_ASSERT(result.second);
- // DEBUG_ASSERT(result.second); 这部分代码用于调试，确保emplace操作成功，即没有重复键
+      table->actors.emplace_back(MakeActorSnapshot(actor));
+    }
+    std::sort(table->actors.begin(), table->actors.end(), CompareIds);
+    DEBUG_ASSERT(std::adjacent_find(table->actors.begin(), table->actors.end(),
+        [](const auto &lhs, const auto &rhs) { return lhs.id == rhs.id; }) == table->actors.end());
+    _size = table->actors.size();
+    _keyframe = std::move(table);
+  }
+
+  EpisodeState::EpisodeState(
+      const sensor::data::RawEpisodeState &delta,
+      const EpisodeState &previous)
+    : _episode_id(delta.GetEpisodeId()),
+      _timestamp(
+          delta.GetFrame(),
+          delta.GetGameTimeStamp(),
+          delta.GetDeltaSeconds(),
+          delta.GetPlatformTimeStamp()),
+      _map_origin(delta.GetMapOrigin()),
+      _simulation_state(StripDeltaFlag(delta.GetSimulationState())),
+      _keyframe(previous._keyframe) {
+    DEBUG_ASSERT(previous.CanApplyDelta(delta));
+    _changed.reserve(delta.size());
+    for (auto &&actor : delta) {
+      _changed.emplace_back(MakeActorSnapshot(actor));
+    }
+    std::sort(_changed.begin(), _changed.end(), CompareIds);
+    auto removed = delta.GetRemovedActorIds();
+    _removed.assign(removed.begin(), removed.end());
+    std::sort(_removed.begin(), _removed.end());
+    // 新增的参与者不在关键帧表中，被删除的参与者一定在关键帧表中
+    for (auto &&actor : _changed) {
+      if (FindSorted(_keyframe->actors, actor.id) == nullptr) {
+        _added.emplace_back(actor.id);
+      }
+    }
+    _size = _keyframe->actors.size() - _removed.size() + _added.size();
+    DEBUG_ASSERT(_size == delta.GetActorCount());
+  }
+
+  bool EpisodeState::CanApplyDelta(const sensor::data::RawEpisodeState &delta) const {
+    return
+        delta.IsDelta() &&
+        (delta.GetEpisodeId() == _episode_id) &&
+        _keyframe->is_keyframe &&
+        (delta.GetKeyframe() == _keyframe->frame);
+  }
+
+  void EpisodeState::GetActorIdChanges(
+      const EpisodeState &previous,
+      std::vector<ActorId> &spawned,
+      std::vector<ActorId> &destroyed) const {
+    if (_keyframe == previous._keyframe) {
+      // 关键帧中的参与者只可能因出现在某一方的删除列表中而不同，
+      // 不在关键帧中的参与者只可能出现在某一方的新增列表中
+      std::vector<ActorId> candidates;
+      candidates.reserve(_added.size() + _removed.size() + previous._added.size() + previous._removed.size());
+      candidates.insert(candidates.end(), _added.begin(), _added.end());
+      candidates.insert(candidates.end(), _removed.begin(), _removed.end());
+      candidates.insert(candidates.end(), previous._added.begin(), previous._added.end());
+      candidates.insert(candidates.end(), previous._removed.begin(), previous._removed.end());
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+      for (ActorId id : candidates) {
+        const bool present = (Find(id) != nullptr);
+        const bool was_present = (previous.Find(id) != nullptr);
+        if (present && !was_present) {
+          spawned.emplace_back(id);
+        } else if (!present && was_present) {
+          destroyed.emplace_back(id);
+        }
+      }
+      return;
+    }
+    // 关键帧不同，两个状态都按ID顺序遍历，合并一次即可
+    auto current = begin();
+    auto old = previous.begin();
+    while ((current != end()) || (old != previous.end())) {
+      if ((old == previous.end()) || ((current != end()) && (current->id < old->id))) {
+        spawned.emplace_back(current->id);
+        ++current;
+      } else if ((current == end()) || (old->id < current->id)) {
+        destroyed.emplace_back(old->id);
+        ++old;
+      } else {
+        ++current;
+        ++old;
+      }
+    }
+  }
+
+  const ActorSnapshot *EpisodeState::Find(ActorId id) const {
+    const ActorSnapshot *changed = FindSorted(_changed, id);
+    if (changed != nullptr) {
+      return changed;
+    }
+    if (std::binary_search(_removed.begin(), _removed.end(), id)) {
+      return nullptr;
     }
+    return FindSorted(_keyframe->actors, id);
   }
 
 } // namespace detail
@@ -6,7 +6,6 @@
 
 #pragma once // 防止头文件被重复包含
 
-#include "carla/Iterator.h" // 引入迭代器头文件
 #include "carla/ListView.h" // 引入列表视图头文件
 #include "carla/NonCopyable.h" // 引入不可复制类的头文件
 #include "carla/client/ActorSnapshot.h" // 引入参与者快照头文件
@@ -14,30 +13,146 @@
 #include "carla/geom/Vector3DInt.h" // 引入三维整数向量头文件
 #include "carla/sensor/data/RawEpisodeState.h" // 引入原始剧集状态数据头文件
 
+#include <boost/iterator/transform_iterator.hpp>
 #include <boost/optional.hpp> // 引入Boost可选类型头文件
 
+#include <iterator>
 #include <memory> // 引入智能指针头文件
-#include <unordered_map> // 引入无序映射头文件
+#include <vector>
 
 namespace carla { // 定义carla命名空间
 namespace client { // 定义client子命名空间
 namespace detail { // 定义detail子命名空间
 
   /// 表示某一帧的所有参与者的状态
+  ///
+  /// 参与者快照保存在按ID排序的连续数组（关键帧表）中。完整帧会构建一张
+  /// 新的表；增量帧与上一状态共享同一张关键帧表，只额外保存自关键帧以来
+  /// 变化的参与者和被删除的参与者ID，因此应用增量的开销只与变化的参与者
+  /// 数量有关，而与世界中参与者的总数无关。
   class EpisodeState
     : public std::enable_shared_from_this<EpisodeState>, // 允许共享自身指针
       private NonCopyable { // 禁止复制
 
       using SimulationState = sensor::s11n::EpisodeStateSerializer::SimulationState; // 定义模拟状态类型
 
+      /// 某个关键帧中所有参与者的快照，按ID排序，构建后不再修改。
+      struct ActorTable {
+        uint64_t frame = 0u;
+        /// 是否由服务器发送的完整帧构建，初始的空状态不能作为增量的基准。
+        bool is_keyframe = false;
+        std::vector<ActorSnapshot> actors;
+      };
+
   public:
 
+    /// 按ID顺序遍历所有参与者快照的迭代器，合并关键帧表与增量。
+    class const_iterator {
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = ActorSnapshot;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const ActorSnapshot *;
+      using reference = const ActorSnapshot &;
+
+      const_iterator() = default;
+
+      reference operator*() const {
+        return *_current;
+      }
+
+      pointer operator->() const {
+        return _current;
+      }
+
+      const_iterator &operator++() {
+        if (_current == _changed) {
+          if ((_keyframe != _keyframe_end) && (_keyframe->id == _changed->id)) {
+            ++_keyframe;
+          }
+          ++_changed;
+        } else {
+          ++_keyframe;
+        }
+        Settle();
+        return *this;
+      }
+
+      const_iterator operator++(int) {
+        const_iterator tmp = *this;
+        ++(*this);
+        return tmp;
+      }
+
+      bool operator==(const const_iterator &rhs) const {
+        return _current == rhs._current;
+      }
+
+      bool operator!=(const const_iterator &rhs) const {
+        return !(*this == rhs);
+      }
+
+    private:
+
+      friend EpisodeState;
+
+      const_iterator(
+          const ActorSnapshot *keyframe, const ActorSnapshot *keyframe_end,
+          const ActorSnapshot *changed, const ActorSnapshot *changed_end,
+          const ActorId *removed, const ActorId *removed_end)
+        : _keyframe(keyframe),
+          _keyframe_end(keyframe_end),
+          _changed(changed),
+          _changed_end(changed_end),
+          _removed(removed),
+          _removed_end(removed_end) {
+        Settle();
+      }
+
+      /// 跳过已删除的参与者，并选出ID较小的一侧作为当前元素。
+      void Settle() {
+        while (_keyframe != _keyframe_end) {
+          while ((_removed != _removed_end) && (*_removed < _keyframe->id)) {
+            ++_removed;
+          }
+          if ((_removed == _removed_end) || (*_removed != _keyframe->id)) {
+            break;
+          }
+          ++_keyframe;
+        }
+        if (_changed == _changed_end) {
+          _current = (_keyframe == _keyframe_end) ? nullptr : _keyframe;
+        } else if ((_keyframe == _keyframe_end) || (_changed->id <= _keyframe->id)) {
+          _current = _changed;
+        } else {
+          _current = _keyframe;
+        }
+      }
+
+      const ActorSnapshot *_keyframe = nullptr;
+      const ActorSnapshot *_keyframe_end = nullptr;
+      const ActorSnapshot *_changed = nullptr;
+      const ActorSnapshot *_changed_end = nullptr;
+      const ActorId *_removed = nullptr;
+      const ActorId *_removed_end = nullptr;
+      const ActorSnapshot *_current = nullptr;
+    };
+
     // 构造函数，接受剧集ID
-    explicit EpisodeState(uint64_t episode_id) : _episode_id(episode_id) {}
+    explicit EpisodeState(uint64_t episode_id);
 
-    // 构造函数，接受原始剧集状态
+    // 构造函数，接受原始剧集状态（必须是完整帧）
     explicit EpisodeState(const sensor::data::RawEpisodeState &state);
 
+    /// 将增量 @a delta 应用到 @a previous 所基于的关键帧上。
+    ///
+    /// @pre previous.CanApplyDelta(delta)
+    EpisodeState(const sensor::data::RawEpisodeState &delta, const EpisodeState &previous);
+
+    /// 检查增量 @a delta 是否基于本状态所持有的关键帧。
+    bool CanApplyDelta(const sensor::data::RawEpisodeState &delta) const;
+
     // 获取剧集ID
     auto GetEpisodeId() const {
       return _episode_id;
@@ -70,7 +185,7 @@ namespace detail { // 定义detail子命名空间
 
     // 检查是否包含指定的参与者快照
     bool ContainsActorSnapshot(ActorId actor_id) const {
-      return _actors.find(actor_id) != _actors.end();
+      return Find(actor_id) != nullptr;
     }
 
     // 获取指定参与者的快照
@@ -90,33 +205,55 @@ namespace detail { // 定义detail子命名空间
     // 获取所有参与者ID
     auto GetActorIds() const {
       return MakeListView( // 创建列表视图
-          iterator::make_map_keys_const_iterator(_actors.begin()), // 获取参与者ID迭代器
-          iterator::make_map_keys_const_iterator(_actors.end())); // 获取参与者ID迭代器
+          boost::make_transform_iterator(begin(), ActorIdOf{}), // 获取参与者ID迭代器
+          boost::make_transform_iterator(end(), ActorIdOf{})); // 获取参与者ID迭代器
     }
 
+    /// 与 @a previous 相比新出现的参与者ID追加到 @a spawned，消失的参与者ID
+    /// 追加到 @a destroyed，两者均按升序排列。
+    ///
+    /// 两个状态基于同一关键帧时，只需检查各自相对关键帧新增与删除的参与者，
+    /// 开销与世界中参与者的总数无关；否则按ID顺序合并两个状态的参与者列表。
+    void GetActorIdChanges(
+        const EpisodeState &previous,
+        std::vector<ActorId> &spawned,
+        std::vector<ActorId> &destroyed) const;
+
     // 获取参与者数量
     size_t size() const {
-      return _actors.size(); // 返回参与者数量
+      return _size; // 返回参与者数量
     }
 
     // 返回参与者快照的开始迭代器
-    auto begin() const {
-      return iterator::make_map_values_const_iterator(_actors.begin()); // 返回参与者快照值的开始迭代器
+    const_iterator begin() const {
+      return const_iterator(
+          _keyframe->actors.data(), _keyframe->actors.data() + _keyframe->actors.size(),
+          _changed.data(), _changed.data() + _changed.size(),
+          _removed.data(), _removed.data() + _removed.size());
     }
 
     // 返回参与者快照的结束迭代器
-    auto end() const {
-      return iterator::make_map_values_const_iterator(_actors.end()); // 返回参与者快照值的结束迭代器
+    const_iterator end() const {
+      return const_iterator();
     }
 
   private:
 
+    struct ActorIdOf {
+      ActorId operator()(const ActorSnapshot &snapshot) const {
+        return snapshot.id;
+      }
+    };
+
+    /// 查找参与者快照，不存在时返回 nullptr。
+    const ActorSnapshot *Find(ActorId id) const;
+
     // 复制指定参与者的快照（如果存在）
     template <typename T>
     void CopyActorSnapshotIfPresent(ActorId id, T &value) const {
-      auto it = _actors.find(id); // 查找参与者
-      if (it != _actors.end()) { // 如果找到了
-        value = it->second; // 复制快照
+      const ActorSnapshot *snapshot = Find(id); // 查找参与者
+      if (snapshot != nullptr) { // 如果找到了
+        value = *snapshot; // 复制快照
       }
     }
 
@@ -128,10 +265,21 @@ namespace detail { // 定义detail子命名空间
 
     SimulationState _simulation_state; // 存储模拟状态
 
-    std::unordered_map<ActorId, ActorSnapshot> _actors; // 存储参与者快照的无序映射
+    /// 关键帧表，可能与其他帧的状态共享。
+    std::shared_ptr<const ActorTable> _keyframe;
+
+    /// 自关键帧以来变化或新增的参与者，按ID排序。
+    std::vector<ActorSnapshot> _changed;
+
+    /// 自关键帧以来被删除的参与者ID，按升序排序。
+    std::vector<ActorId> _removed;
+
+    /// 自关键帧以来新增（不在关键帧表中）的参与者ID，按升序排序。
+    std::vector<ActorId> _added;
+
+    size_t _size = 0u; // 参与者数量
   };
 
 } // namespace detail
 } // namespace client
 } // namespace carla
-
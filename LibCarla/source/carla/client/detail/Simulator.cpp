@@ -18,10 +18,12 @@
 #include "carla/client/WalkerAIController.h"
 #include "carla/client/detail/ActorFactory.h"
 #include "carla/client/detail/WalkerNavigation.h"
+#include "carla/road/MapSnapshot.h"
 #include "carla/trafficmanager/TrafficManager.h"
 #include "carla/sensor/Deserializer.h"
 
 #include <exception>
+#include <sstream>
 #include <thread>
 
 using namespace std::string_literals;
@@ -183,7 +185,17 @@ EpisodeProxy Simulator::GetCurrentEpisode() {
       std::string XODRFolder = map_base_path + "/OpenDrive/" + map_name + ".xodr";
       if (FileTransfer::FileExists(XODRFolder) == false) _client.GetRequiredFiles();
       _open_drive_file = _client.GetMapData();
-      _cached_map = MakeShared<Map>(map_info, _open_drive_file);
+      // 地图快照与交通管理器的缓存放在一起，文件名中带有 OpenDRIVE 内容的哈希，
+      // 同一张地图的其他客户端可以直接加载快照而不必重新解析
+      const uint64_t opendrive_hash = road::MapSnapshot::ComputeHash(_open_drive_file);
+      std::ostringstream snapshot_name;
+      snapshot_name << map_base_path << "/TM/" << map_name << '_' << std::hex
+          << opendrive_hash << ".map.bin";
+      _cached_map = MakeShared<Map>(
+          map_info,
+          _open_drive_file,
+          FileTransfer::GetFullPath(snapshot_name.str()),
+          opendrive_hash);
     }
 
     return _cached_map;
@@ -301,6 +301,18 @@ namespace detail {
       return _client.GetVehicleLightState(vehicle.GetId());
     }
 
+    // 在一次往返中获取多辆车的物理控制状态
+    std::vector<boost::optional<rpc::VehiclePhysicsControl>> GetVehiclePhysicsControlBatch(
+        const std::vector<ActorId> &vehicles) const {
+      return _client.GetVehiclePhysicsControlBatch(vehicles);
+    }
+
+    // 在一次往返中获取多辆车的灯光状态
+    std::vector<boost::optional<rpc::VehicleLightState>> GetVehicleLightStateBatch(
+        const std::vector<ActorId> &vehicles) const {
+      return _client.GetVehicleLightStateBatch(vehicles);
+    }
+
     /// Returns all the BBs of all the elements of the level
     std::vector<geom::BoundingBox> GetLevelBBs(uint8_t queried_tag) const {
       return _client.GetLevelBBs(queried_tag);
@@ -824,6 +836,11 @@ namespace detail {
       return _client.ApplyBatchSync(std::move(commands), do_tick_cue);
     }
 
+    // 批量应用调用方缓冲区中的命令并同步等待结果，不复制命令列表
+    auto ApplyBatchSync(rpc::CommandBatchView commands, bool do_tick_cue) {
+      return _client.ApplyBatchSync(commands, do_tick_cue);
+    }
+
     /// @}
     // =========================================================================
     /// @name 操作灯
@@ -6,6 +6,10 @@
 
 #include <carla/geom/Mesh.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <string>
 #include <sstream>
 #include <ios>
@@ -17,6 +21,142 @@
 namespace carla {
 namespace geom {
 
+namespace {
+
+  /// 把输出先格式化到固定大小的缓冲区中，写满后整块写入目标流，
+  /// 避免逐个浮点数调用 iostream 的格式化和在内存中保留完整的输出。
+  class ChunkedWriter {
+  public:
+
+    static constexpr size_t CHUNK_SIZE = 1u << 16u;
+
+    explicit ChunkedWriter(std::ostream &out) : _out(out) {
+      _buffer.reserve(CHUNK_SIZE + 64u);
+    }
+
+    ~ChunkedWriter() {
+      Flush();
+    }
+
+    void Write(const char *data, size_t size) {
+      _buffer.append(data, size);
+      FlushIfFull();
+    }
+
+    void Write(const std::string &str) {
+      Write(str.data(), str.size());
+    }
+
+    void Write(char c) {
+      _buffer.push_back(c);
+      FlushIfFull();
+    }
+
+    /// 按原始字节写入（用于二进制格式）。
+    template <typename T>
+    void WriteBinary(const T &value) {
+      Write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void WriteUInt(uint64_t value) {
+      char digits[20u];
+      size_t count = 0u;
+      do {
+        digits[count++] = static_cast<char>('0' + value % 10u);
+        value /= 10u;
+      } while (value != 0u);
+      while (count > 0u) {
+        _buffer.push_back(digits[--count]);
+      }
+      FlushIfFull();
+    }
+
+    /// 与 std::fixed 下默认6位小数的输出一致（舍入到最近的偶数）。
+    void WriteFixed(float value) {
+      const double v = value;
+      if (!(std::fabs(v) < 1e12)) { // NaN、无穷大或过大的值
+        char str[64u];
+        const int size = std::snprintf(str, sizeof(str), "%.6f", v);
+        Write(str, static_cast<size_t>(std::max(size, 0)));
+        return;
+      }
+      // 单精度浮点数乘以1e6在双精度下是精确的
+      const double scaled = std::fabs(v) * 1e6;
+      double rounded = std::floor(scaled);
+      const double remainder = scaled - rounded;
+      if (remainder > 0.5 || (remainder == 0.5 && std::fmod(rounded, 2.0) != 0.0)) {
+        rounded += 1.0;
+      }
+      const auto fixed = static_cast<uint64_t>(rounded);
+      if (std::signbit(v)) {
+        _buffer.push_back('-');
+      }
+      WriteUInt(fixed / 1000000u);
+      _buffer.push_back('.');
+      auto fraction = fixed % 1000000u;
+      char digits[6u];
+      for (size_t i = 6u; i > 0u; --i) {
+        digits[i - 1u] = static_cast<char>('0' + fraction % 10u);
+        fraction /= 10u;
+      }
+      Write(digits, 6u);
+    }
+
+    void Flush() {
+      if (!_buffer.empty()) {
+        _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        _buffer.clear();
+      }
+    }
+
+  private:
+
+    void FlushIfFull() {
+      if (_buffer.size() >= CHUNK_SIZE) {
+        Flush();
+      }
+    }
+
+    std::ostream &_out;
+
+    std::string _buffer;
+  };
+
+  /// 写入 OBJ 的面列表，遇到材质的起止位置时写入 usemtl。
+  template <typename FaceWriterT>
+  void WriteOBJFaces(
+      ChunkedWriter &writer,
+      const std::vector<Mesh::index_type> &indexes,
+      const std::vector<Mesh::material_type> &materials,
+      FaceWriterT &&write_face) {
+    writer.Write("\n# Polygonal face element.\n");
+    auto it_m = materials.begin();
+    for (size_t index_counter = 0u; index_counter + 2u < indexes.size(); index_counter += 3u) {
+      // While exist materials
+      if (it_m != materials.end()) {
+        // 如果当前材料在此索引处结束
+        if (it_m->index_end == index_counter) {
+          ++it_m;
+        }
+        // 如果当前材料从该索引开始
+        if (it_m != materials.end() && it_m->index_start == index_counter) {
+          writer.Write("\nusemtl ");
+          writer.Write(it_m->name);
+          writer.Write('\n');
+        }
+      }
+      write_face(indexes[index_counter], indexes[index_counter + 1u], indexes[index_counter + 2u]);
+    }
+  }
+
+  bool IsLittleEndian() {
+    const uint16_t value = 1u;
+    return *reinterpret_cast<const uint8_t *>(&value) == 1u;
+  }
+
+} // namespace
+
+
   bool Mesh::IsValid() const {
     // 至少应为某个顶点
     if (_vertices.empty()) {
@@ -175,110 +315,174 @@ void Mesh::AddTriangleStrip(const std::vector<Mesh::vertex_type> &vertices) {
   }
 
   std::string Mesh::GenerateOBJ() const {
+    std::stringstream out;
+    WriteOBJ(out);
+    return out.str();
+  }
+
+  std::string Mesh::GenerateOBJForRecast() const {
+    std::stringstream out;
+    WriteOBJForRecast(out);
+    return out.str();
+  }
+
+  std::string Mesh::GeneratePLY() const {
     if (!IsValid()) {
-      return "";
+      return "Invalid Mesh";
     }
     std::stringstream out;
-    out << std::fixed; // 避免使用科学计数法
+    WritePLY(out);
+    return out.str();
+  }
 
-    out << "# List of geometric vertices, with (x, y, z) coordinates." << std::endl;
+  bool Mesh::WriteOBJ(std::ostream &out) const {
+    if (!IsValid()) {
+      return false;
+    }
+    ChunkedWriter writer(out);
+
+    writer.Write("# List of geometric vertices, with (x, y, z) coordinates.\n");
     for (auto &v : _vertices) {
-      out << "v " << v.x << " " << v.y << " " << v.z << std::endl;
+      writer.Write("v ");
+      writer.WriteFixed(v.x);
+      writer.Write(' ');
+      writer.WriteFixed(v.y);
+      writer.Write(' ');
+      writer.WriteFixed(v.z);
+      writer.Write('\n');
     }
 
     if (!_uvs.empty()) {
-      out << std::endl << "# List of texture coordinates, in (u, v) coordinates, these will vary between 0 and 1." << std::endl;
+      writer.Write("\n# List of texture coordinates, in (u, v) coordinates, these will vary between 0 and 1.\n");
       for (auto &vt : _uvs) {
-        out << "vt " << vt.x << " " << vt.y << std::endl;
+        writer.Write("vt ");
+        writer.WriteFixed(vt.x);
+        writer.Write(' ');
+        writer.WriteFixed(vt.y);
+        writer.Write('\n');
       }
     }
 
     if (!_normals.empty()) {
-      out << std::endl << "# List of vertex normals in (x, y, z) form; normals might not be unit vectors." << std::endl;
+      writer.Write("\n# List of vertex normals in (x, y, z) form; normals might not be unit vectors.\n");
       for (auto &vn : _normals) {
-        out << "vn " << vn.x << " " << vn.y << " " << vn.z << std::endl;
+        writer.Write("vn ");
+        writer.WriteFixed(vn.x);
+        writer.Write(' ');
+        writer.WriteFixed(vn.y);
+        writer.Write(' ');
+        writer.WriteFixed(vn.z);
+        writer.Write('\n');
       }
     }
 
     if (!_indexes.empty()) {
-      out << std::endl << "# Polygonal face element." << std::endl;
-      auto it_m = _materials.begin();
-      auto it = _indexes.begin();
-      size_t index_counter = 0u;
-      while (it != _indexes.end()) {
-        // While exist materials
-        if (it_m != _materials.end()) {
-          // 如果当前材料在此索引处结束
-          if (it_m->index_end == index_counter) {
-            ++it_m;
-          }
-          // 如果当前材料从该索引开始
-          if (it_m->index_start == index_counter) {
-            out << "\nusemtl " << it_m->name << std::endl;
-          }
-        }
-
-        // 使用 3 个连续的索引添加实际表面
-        out << "f " << *it; ++it;
-        out << " " << *it; ++it;
-        out << " " << *it << std::endl; ++it;
-
-        index_counter += 3;
-      }
+      // 使用 3 个连续的索引添加实际表面
+      WriteOBJFaces(writer, _indexes, _materials, [&](index_type i_1, index_type i_2, index_type i_3) {
+        writer.Write("f ");
+        writer.WriteUInt(i_1);
+        writer.Write(' ');
+        writer.WriteUInt(i_2);
+        writer.Write(' ');
+        writer.WriteUInt(i_3);
+        writer.Write('\n');
+      });
     }
 
-    return out.str();
+    writer.Flush();
+    return out.good();
   }
 
-  std::string Mesh::GenerateOBJForRecast() const {
+  bool Mesh::WriteOBJForRecast(std::ostream &out) const {
     if (!IsValid()) {
-      return "";
+      return false;
     }
-    std::stringstream out;
-    out << std::fixed; // 避免使用科学计数法
+    ChunkedWriter writer(out);
 
-    out << "# List of geometric vertices, with (x, y, z) coordinates." << std::endl;
+    writer.Write("# List of geometric vertices, with (x, y, z) coordinates.\n");
     for (auto &v : _vertices) {
       // 为 Recast 库切换“y”和“z”
-      out << "v " << v.x << " " << v.z << " " << v.y << std::endl;
+      writer.Write("v ");
+      writer.WriteFixed(v.x);
+      writer.Write(' ');
+      writer.WriteFixed(v.z);
+      writer.Write(' ');
+      writer.WriteFixed(v.y);
+      writer.Write('\n');
     }
 
     if (!_indexes.empty()) {
-      out << std::endl << "# Polygonal face element." << std::endl;
-      auto it_m = _materials.begin();
-      auto it = _indexes.begin();
-      size_t index_counter = 0u;
-      while (it != _indexes.end()) {
-        // While exist materials
-        if (it_m != _materials.end()) {
-          // 如果当前材料在此索引处结束
-          if (it_m->index_end == index_counter) {
-            ++it_m;
-          }
-          // 如果当前材料从该索引开始
-          if (it_m->index_start == index_counter) {
-            out << "\nusemtl " << it_m->name << std::endl;
-          }
-        }
-        // 使用 3 个连续的索引添加实际面由于空间已经改变，因此将面构建方向更改为顺时针。
-        out << "f " << *it; ++it;
-        const auto i_2 = *it; ++it;
-        const auto i_3 = *it; ++it;
-        out << " " << i_3 << " " << i_2 << std::endl;
-        index_counter += 3;
-      }
+      // 由于空间已经改变，因此将面构建方向更改为顺时针。
+      WriteOBJFaces(writer, _indexes, _materials, [&](index_type i_1, index_type i_2, index_type i_3) {
+        writer.Write("f ");
+        writer.WriteUInt(i_1);
+        writer.Write(' ');
+        writer.WriteUInt(i_3);
+        writer.Write(' ');
+        writer.WriteUInt(i_2);
+        writer.Write('\n');
+      });
     }
 
-    return out.str();
+    writer.Flush();
+    return out.good();
   }
 
-  std::string Mesh::GeneratePLY() const {
+  bool Mesh::WritePLY(std::ostream &out) const {
     if (!IsValid()) {
-      return "Invalid Mesh";
+      return false;
     }
+    // 法线和 UV 只有在与顶点一一对应时才作为顶点属性写入
+    const bool has_normals = _normals.size() == _vertices.size();
+    const bool has_uvs = _uvs.size() == _vertices.size();
+    ChunkedWriter writer(out);
+
     // 生成头
-    std::stringstream out;
-    return out.str();
+    writer.Write("ply\n");
+    writer.Write(IsLittleEndian() ?
+        "format binary_little_endian 1.0\n" :
+        "format binary_big_endian 1.0\n");
+    writer.Write("comment Generated by CARLA\n");
+    writer.Write("element vertex ");
+    writer.WriteUInt(_vertices.size());
+    writer.Write("\nproperty float x\nproperty float y\nproperty float z\n");
+    if (has_normals) {
+      writer.Write("property float nx\nproperty float ny\nproperty float nz\n");
+    }
+    if (has_uvs) {
+      writer.Write("property float s\nproperty float t\n");
+    }
+    writer.Write("element face ");
+    writer.WriteUInt(_indexes.size() / 3u);
+    writer.Write("\nproperty list uchar uint vertex_indices\nend_header\n");
+
+    // 顶点数据
+    for (size_t i = 0u; i < _vertices.size(); ++i) {
+      writer.WriteBinary(_vertices[i].x);
+      writer.WriteBinary(_vertices[i].y);
+      writer.WriteBinary(_vertices[i].z);
+      if (has_normals) {
+        writer.WriteBinary(_normals[i].x);
+        writer.WriteBinary(_normals[i].y);
+        writer.WriteBinary(_normals[i].z);
+      }
+      if (has_uvs) {
+        writer.WriteBinary(_uvs[i].x);
+        writer.WriteBinary(_uvs[i].y);
+      }
+    }
+
+    // 面数据，PLY 的索引从 0 开始
+    constexpr uint8_t vertices_per_face = 3u;
+    for (size_t i = 0u; i + 2u < _indexes.size(); i += 3u) {
+      writer.WriteBinary(vertices_per_face);
+      for (size_t j = 0u; j < 3u; ++j) {
+        writer.WriteBinary(static_cast<uint32_t>(_indexes[i + j] - 1u));
+      }
+    }
+
+    writer.Flush();
+    return out.good();
   }
 
   const std::vector<Mesh::vertex_type> &Mesh::GetVertices() const {
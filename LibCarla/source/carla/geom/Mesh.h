@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <iosfwd>
+#include <string>
 #include <vector>
 
 #include <carla/geom/Vector3D.h>
@@ -117,6 +119,17 @@ namespace geom {
     /// 返回包含 PLY 中编码的网格的字符串。单位为米。
     std::string GeneratePLY() const;
 
+    /// 与 GenerateOBJ 相同，但分块直接写入 @a out（例如 std::ofstream），
+    /// 不在内存中构建完整的字符串。网格无效时不写入任何内容并返回 false。
+    bool WriteOBJ(std::ostream &out) const;
+
+    /// 与 GenerateOBJForRecast 相同，但分块直接写入 @a out。
+    bool WriteOBJForRecast(std::ostream &out) const;
+
+    /// 将网格以二进制 PLY 格式分块写入 @a out，包含顶点、法线和 UV（数量与
+    /// 顶点一致时）以及三角形面。单位为米。
+    bool WritePLY(std::ostream &out) const;
+
     // =========================================================================
     // -- 其他方法 -------------------------------------------------------------
     // =========================================================================
@@ -148,6 +161,38 @@ namespace geom {
     /// 将两个网格合并为一个网格
     Mesh &operator+=(const Mesh &rhs);
 
+    /// 按顺序将 @a meshes 中的所有网格追加到当前网格，结果与依次调用
+    /// operator+= 相同，但会先统计总大小并一次性预留内存，避免反复重新分配。
+    /// @a meshes 的元素可以是指向 Mesh 的普通指针或智能指针，空指针会被跳过。
+    template <typename MeshPtrRangeT>
+    Mesh &Append(const MeshPtrRangeT &meshes) {
+      size_t vertices = _vertices.size();
+      size_t normals = _normals.size();
+      size_t indexes = _indexes.size();
+      size_t uvs = _uvs.size();
+      size_t materials = _materials.size();
+      for (auto &&mesh : meshes) {
+        if (mesh != nullptr) {
+          vertices += mesh->_vertices.size();
+          normals += mesh->_normals.size();
+          indexes += mesh->_indexes.size();
+          uvs += mesh->_uvs.size();
+          materials += mesh->_materials.size();
+        }
+      }
+      _vertices.reserve(vertices);
+      _normals.reserve(normals);
+      _indexes.reserve(indexes);
+      _uvs.reserve(uvs);
+      _materials.reserve(materials);
+      for (auto &&mesh : meshes) {
+        if (mesh != nullptr) {
+          *this += *mesh;
+        }
+      }
+      return *this;
+    }
+
     friend Mesh operator+(const Mesh &lhs, const Mesh &rhs);
 
     // =========================================================================
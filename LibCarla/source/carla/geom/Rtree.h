@@ -77,6 +77,14 @@ namespace geom {
       return _rtree.size();
     } // 成员函数，返回 R-tree 的大小。
 
+    auto begin() const {
+      return _rtree.begin();
+    } // 成员函数，按 R-tree 内部的存储顺序遍历所有元素的起始迭代器。
+
+    auto end() const {
+      return _rtree.end();
+    } // 成员函数，遍历所有元素的结束迭代器。
+
   private:
 
     boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
@@ -148,6 +156,14 @@ namespace geom {
       return _rtree.size();
     } // 成员函数，返回 R-tree 的大小。
 
+    auto begin() const {
+      return _rtree.begin();
+    } // 成员函数，按 R-tree 内部的存储顺序遍历所有元素的起始迭代器。
+
+    auto end() const {
+      return _rtree.end();
+    } // 成员函数，遍历所有元素的结束迭代器。
+
   private:
 
     boost::geometry::index::rtree<TreeElement, boost::geometry::index::linear<16>> _rtree;
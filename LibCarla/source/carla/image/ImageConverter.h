@@ -7,6 +7,7 @@
 #pragma once // 确保头文件只被包含一次
 
 #include "carla/image/ImageView.h" // 引入ImageView头文件
+#include "carla/image/SimdColorConverter.h" // 引入向量化颜色转换的头文件
 
 namespace carla { // carla命名空间
 namespace image { // image子命名空间
@@ -28,6 +29,38 @@ namespace image { // image子命名空间
           ImageView::MakeColorConvertedView<MutableImageView, DstPixelT>(image_view, converter), // 创建颜色转换后的视图
           image_view); // 目标为原始图像视图
     }
+
+    // 传感器图像（BGRA8）使用向量化的实现，结果与逐像素转换相同
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::Depth) {
+      ForEachRow(image_view, &SimdColorConverter::Depth);
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::LogarithmicDepth) {
+      ForEachRow(image_view, &SimdColorConverter::LogarithmicDepth);
+    }
+
+    static void ConvertInPlace(boost::gil::bgra8_view_t &image_view, ColorConverter::CityScapesPalette) {
+      ForEachRow(image_view, &SimdColorConverter::CityScapesPalette);
+    }
+
+  private:
+
+    // 对连续的像素区间调用 @a func，行与行之间没有间隔时一次处理整幅图像
+    template <typename FuncT>
+    static void ForEachRow(boost::gil::bgra8_view_t &image_view, FuncT func) {
+      static_assert(
+          sizeof(boost::gil::bgra8_pixel_t) == sizeof(sensor::data::Color),
+          "Invalid pixel size");
+      const auto width = static_cast<size_t>(image_view.width());
+      const auto height = static_cast<size_t>(image_view.height());
+      if (image_view.is_1d_traversable()) {
+        func(reinterpret_cast<sensor::data::Color *>(&image_view(0, 0)), width * height);
+        return;
+      }
+      for (size_t y = 0u; y < height; ++y) {
+        func(reinterpret_cast<sensor::data::Color *>(&*image_view.row_begin(static_cast<std::ptrdiff_t>(y))), width);
+      }
+    }
   };
 
 } // namespace image
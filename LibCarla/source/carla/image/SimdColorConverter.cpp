@@ -0,0 +1,699 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/image/SimdColorConverter.h"
+
+#include "carla/geom/Math.h"
+#include "carla/image/CityScapesPalette.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#  define LIBCARLA_SIMD_X86_64
+#  include <immintrin.h>
+#  if defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#endif
+
+// AVX2 的实现使用函数级的目标属性编译，不需要为整个库打开 -mavx2
+#if defined(__GNUC__) || defined(__clang__)
+#  define LIBCARLA_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#  define LIBCARLA_TARGET_AVX2
+#endif
+
+namespace carla {
+namespace image {
+
+  using InstructionSet = SimdColorConverter::InstructionSet;
+  using sensor::data::Color;
+  using sensor::data::OpticalFlowPixel;
+
+namespace {
+
+  // ===========================================================================
+  // -- 标量实现，与 ColorConverter 中逐像素的转换逐位一致 ---------------------
+  // ===========================================================================
+
+  // 与 boost::gil 中浮点通道到 uint8_t 通道的转换相同
+  uint8_t ToChannel(float value) {
+    return static_cast<uint8_t>(value * 255.0f + 0.5f);
+  }
+
+  Color Gray(uint8_t value) {
+    return Color{value, value, value, 255u};
+  }
+
+  float NormalizedDepth(const Color &pixel) {
+    const float depth = pixel.r + (pixel.g * 256) + (pixel.b * 256 * 256);
+    return depth / static_cast<float>(256 * 256 * 256 - 1);
+  }
+
+  float LogarithmicLinear(float normalized) {
+    const float value = 1.0f + std::log(normalized) / 5.70378f;
+    return std::max(std::min(value, 1.0f), 0.005f);
+  }
+
+  Color ScalarDepth(const Color &pixel) {
+    return Gray(ToChannel(NormalizedDepth(pixel)));
+  }
+
+  Color ScalarLogarithmicDepth(const Color &pixel) {
+    return Gray(ToChannel(LogarithmicLinear(NormalizedDepth(pixel))));
+  }
+
+  // CityScapes 调色板按红色通道（标签）索引的查找表
+  const std::array<Color, 256u> &GetCityScapesTable() {
+    static const auto table = [] {
+      std::array<Color, 256u> result;
+      for (auto tag = 0u; tag < result.size(); ++tag) {
+        const auto color = CityScapesPalette::GetColor(static_cast<uint8_t>(tag));
+        result[tag] = Color{color[0u], color[1u], color[2u], 255u};
+      }
+      return result;
+    }();
+    return table;
+  }
+
+  constexpr float FLOW_PI = 3.1415f;
+  constexpr float FLOW_RAD_TO_DEG = 360.0f / (2.0f * FLOW_PI);
+  constexpr float FLOW_SHIFT = 0.999f;
+
+  float GetFlowIntensityScale() {
+    static const float scale = 1.0f / std::log(0.1f + FLOW_SHIFT);
+    return scale;
+  }
+
+  Color ScalarFlow(const OpticalFlowPixel &pixel) {
+    const float vx = pixel.x;
+    const float vy = pixel.y;
+
+    // 方向作为色相，范围为 [0, 360)
+    float angle = 180.0f + std::atan2(vy, vx) * FLOW_RAD_TO_DEG;
+    if (angle < 0) {
+      angle = 360.0f + angle;
+    }
+    angle = std::fmod(angle, 360.0f);
+
+    // 大小经对数缩放后作为亮度
+    const float norm = std::sqrt(vx * vx + vy * vy);
+    const float intensity = geom::Math::Clamp(
+        GetFlowIntensityScale() * std::log(norm + FLOW_SHIFT), 0.0f, 1.0f);
+
+    // HSV 转 RGB，饱和度为1
+    const float H = angle;
+    const float S = 1.0f;
+    const float V = intensity;
+    const float H_60 = H * (1.0f / 60.0f);
+    const float C = V * S;
+    const float X = C * (1.0f - std::abs(std::fmod(H_60, 2.0f) - 1.0f));
+    const float m = V - C;
+
+    float r = 0, g = 0, b = 0;
+    switch (static_cast<unsigned int>(H_60)) {
+      case 0: r = C; g = X; b = 0; break;
+      case 1: r = X; g = C; b = 0; break;
+      case 2: r = 0; g = C; b = X; break;
+      case 3: r = 0; g = X; b = C; break;
+      case 4: r = X; g = 0; b = C; break;
+      case 5: r = C; g = 0; b = X; break;
+      default: r = 1; g = 1; b = 1; break;
+    }
+    return Color{
+        static_cast<uint8_t>((r + m) * 255.0f),
+        static_cast<uint8_t>((g + m) * 255.0f),
+        static_cast<uint8_t>((b + m) * 255.0f),
+        0u};
+  }
+
+  void ScalarDepth(Color *pixels, size_t count) {
+    for (size_t i = 0u; i < count; ++i) {
+      pixels[i] = ScalarDepth(pixels[i]);
+    }
+  }
+
+  void ScalarLogarithmicDepth(Color *pixels, size_t count) {
+    for (size_t i = 0u; i < count; ++i) {
+      pixels[i] = ScalarLogarithmicDepth(pixels[i]);
+    }
+  }
+
+  void ScalarCityScapesPalette(Color *pixels, size_t count) {
+    const auto &table = GetCityScapesTable();
+    for (size_t i = 0u; i < count; ++i) {
+      pixels[i] = table[pixels[i].r];
+    }
+  }
+
+  void ScalarFlow(const OpticalFlowPixel *flow, size_t count, Color *out) {
+    for (size_t i = 0u; i < count; ++i) {
+      out[i] = ScalarFlow(flow[i]);
+    }
+  }
+
+#ifdef LIBCARLA_SIMD_X86_64
+
+  // 近似的对数与反正切误差在 1e-4 个颜色级别以内，结果离取整边界不超过
+  // 该距离时改用标量函数重新计算，保证与标量实现逐位一致。
+  constexpr float ROUNDING_MARGIN = 2e-3f;
+
+  // cephes logf 的多项式系数
+  constexpr float LOG_SQRTHF = 0.707106781186547524f;
+  constexpr float LOG_P0 = 7.0376836292e-2f;
+  constexpr float LOG_P1 = -1.1514610310e-1f;
+  constexpr float LOG_P2 = 1.1676998740e-1f;
+  constexpr float LOG_P3 = -1.2420140846e-1f;
+  constexpr float LOG_P4 = 1.4249322787e-1f;
+  constexpr float LOG_P5 = -1.6668057665e-1f;
+  constexpr float LOG_P6 = 2.0000714765e-1f;
+  constexpr float LOG_P7 = -2.4999993993e-1f;
+  constexpr float LOG_P8 = 3.3333331174e-1f;
+  constexpr float LOG_Q1 = -2.12194440e-4f;
+  constexpr float LOG_Q2 = 0.693359375f;
+
+  // cephes atanf 的多项式系数
+  constexpr float ATAN_TAN_PI_8 = 0.414213562373095f;
+  constexpr float ATAN_P0 = 8.05374449538e-2f;
+  constexpr float ATAN_P1 = -1.38776856032e-1f;
+  constexpr float ATAN_P2 = 1.99777106478e-1f;
+  constexpr float ATAN_P3 = -3.33329491539e-1f;
+  constexpr float PI = 3.14159265358979f;
+
+  // ===========================================================================
+  // -- SSE2（x86-64 的基础指令集） -------------------------------------------
+  // ===========================================================================
+
+  inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+  }
+
+  // 正规正数的自然对数
+  inline __m128 Log(__m128 x) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128i exponent = _mm_srli_epi32(_mm_castps_si128(x), 23);
+    x = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(~0x7f800000)));
+    x = _mm_or_ps(x, _mm_set1_ps(0.5f));
+    exponent = _mm_sub_epi32(exponent, _mm_set1_epi32(0x7f));
+    __m128 e = _mm_add_ps(_mm_cvtepi32_ps(exponent), one);
+    const __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(LOG_SQRTHF));
+    const __m128 tmp = _mm_and_ps(x, mask);
+    x = _mm_sub_ps(x, one);
+    e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+    x = _mm_add_ps(x, tmp);
+    const __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(LOG_P0);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P1));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P2));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P3));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P4));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P5));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P6));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P7));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P8));
+    y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(LOG_Q1)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    x = _mm_add_ps(x, y);
+    return _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(LOG_Q2)));
+  }
+
+  // 两个分量都不为0时的 atan2
+  inline __m128 Atan2(__m128 y, __m128 x) {
+    const __m128 sign_mask = _mm_set1_ps(-0.0f);
+    const __m128 ax = _mm_andnot_ps(sign_mask, x);
+    const __m128 ay = _mm_andnot_ps(sign_mask, y);
+    // 先求 [0, 1] 内比值的反正切，再按象限展开
+    const __m128 swap = _mm_cmpgt_ps(ay, ax);
+    __m128 t = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(ax, ay));
+    const __m128 reduce = _mm_cmpgt_ps(t, _mm_set1_ps(ATAN_TAN_PI_8));
+    const __m128 one = _mm_set1_ps(1.0f);
+    t = Select(reduce, _mm_div_ps(_mm_sub_ps(t, one), _mm_add_ps(t, one)), t);
+    const __m128 z = _mm_mul_ps(t, t);
+    __m128 a = _mm_set1_ps(ATAN_P0);
+    a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(ATAN_P1));
+    a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(ATAN_P2));
+    a = _mm_add_ps(_mm_mul_ps(a, z), _mm_set1_ps(ATAN_P3));
+    a = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(a, z), t), t);
+    a = _mm_add_ps(a, _mm_and_ps(reduce, _mm_set1_ps(PI / 4.0f)));
+    a = Select(swap, _mm_sub_ps(_mm_set1_ps(PI / 2.0f), a), a);
+    a = Select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(PI), a), a);
+    return _mm_or_ps(a, _mm_and_ps(sign_mask, y));
+  }
+
+  // 非负数是否离整数不超过 ROUNDING_MARGIN
+  inline __m128 NearInteger(__m128 value) {
+    const __m128 fraction = _mm_sub_ps(value, _mm_cvtepi32_ps(_mm_cvttps_epi32(value)));
+    return _mm_or_ps(
+        _mm_cmplt_ps(fraction, _mm_set1_ps(ROUNDING_MARGIN)),
+        _mm_cmpgt_ps(fraction, _mm_set1_ps(1.0f - ROUNDING_MARGIN)));
+  }
+
+  inline __m128 NormalizedDepth(__m128i pixels) {
+    const __m128i byte = _mm_set1_epi32(0xff);
+    const __m128i r = _mm_and_si128(_mm_srli_epi32(pixels, 16), byte);
+    const __m128i g = _mm_and_si128(pixels, _mm_set1_epi32(0xff00));
+    const __m128i b = _mm_slli_epi32(_mm_and_si128(pixels, byte), 16);
+    const __m128i depth = _mm_or_si128(_mm_or_si128(r, g), b);
+    return _mm_div_ps(_mm_cvtepi32_ps(depth), _mm_set1_ps(16777215.0f));
+  }
+
+  inline __m128i Gray(__m128i value) {
+    value = _mm_or_si128(value, _mm_slli_epi32(value, 8));
+    value = _mm_or_si128(value, _mm_slli_epi32(value, 16));
+    return _mm_or_si128(_mm_and_si128(value, _mm_set1_epi32(0xffffff)), _mm_set1_epi32(0xff000000));
+  }
+
+  void Sse2Depth(Color *pixels, size_t count) {
+    size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+      auto *ptr = reinterpret_cast<__m128i *>(pixels + i);
+      const __m128 normalized = NormalizedDepth(_mm_loadu_si128(ptr));
+      const __m128 scaled = _mm_add_ps(_mm_mul_ps(normalized, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+      _mm_storeu_si128(ptr, Gray(_mm_cvttps_epi32(scaled)));
+    }
+    ScalarDepth(pixels + i, count - i);
+  }
+
+  void Sse2LogarithmicDepth(Color *pixels, size_t count) {
+    size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+      auto *ptr = reinterpret_cast<__m128i *>(pixels + i);
+      const __m128i input = _mm_loadu_si128(ptr);
+      const __m128 normalized = NormalizedDepth(input);
+      const __m128 value = _mm_add_ps(
+          _mm_set1_ps(1.0f),
+          _mm_div_ps(Log(normalized), _mm_set1_ps(5.70378f)));
+      const __m128 clamped = _mm_max_ps(_mm_min_ps(value, _mm_set1_ps(1.0f)), _mm_set1_ps(0.005f));
+      const __m128 scaled = _mm_add_ps(_mm_mul_ps(clamped, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f));
+      _mm_storeu_si128(ptr, Gray(_mm_cvttps_epi32(scaled)));
+      // 深度为0（对数为负无穷）以及接近取整边界的像素使用标量实现
+      const __m128 fallback = _mm_or_ps(
+          NearInteger(scaled),
+          _mm_cmpeq_ps(normalized, _mm_setzero_ps()));
+      int mask = _mm_movemask_ps(fallback);
+      if (mask != 0) {
+        alignas(16) Color original[4u];
+        _mm_store_si128(reinterpret_cast<__m128i *>(original), input);
+        for (auto lane = 0u; mask != 0; ++lane, mask >>= 1) {
+          if (mask & 1) {
+            pixels[i + lane] = ScalarLogarithmicDepth(original[lane]);
+          }
+        }
+      }
+    }
+    ScalarLogarithmicDepth(pixels + i, count - i);
+  }
+
+  void Sse2Flow(const OpticalFlowPixel *flow, size_t count, Color *out) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 c255 = _mm_set1_ps(255.0f);
+    const __m128 scale = _mm_set1_ps(GetFlowIntensityScale());
+    size_t i = 0u;
+    for (; i + 4u <= count; i += 4u) {
+      const float *src = reinterpret_cast<const float *>(flow + i);
+      const __m128 lo = _mm_loadu_ps(src);
+      const __m128 hi = _mm_loadu_ps(src + 4u);
+      const __m128 vx = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+      const __m128 vy = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+
+      __m128 angle = _mm_add_ps(_mm_set1_ps(180.0f), _mm_mul_ps(Atan2(vy, vx), _mm_set1_ps(FLOW_RAD_TO_DEG)));
+      angle = Select(_mm_cmplt_ps(angle, zero), _mm_add_ps(_mm_set1_ps(360.0f), angle), angle);
+      angle = Select(_mm_cmpge_ps(angle, _mm_set1_ps(360.0f)), _mm_sub_ps(angle, _mm_set1_ps(360.0f)), angle);
+
+      const __m128 norm = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)));
+      const __m128 raw = _mm_mul_ps(scale, Log(_mm_add_ps(norm, _mm_set1_ps(FLOW_SHIFT))));
+      const __m128 C = _mm_min_ps(_mm_max_ps(raw, zero), one);
+
+      const __m128 H_60 = _mm_mul_ps(angle, _mm_set1_ps(1.0f / 60.0f));
+      const __m128i sector = _mm_cvttps_epi32(H_60);
+      const __m128 half = _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(H_60, _mm_set1_ps(0.5f))));
+      const __m128 mod = _mm_sub_ps(H_60, _mm_add_ps(half, half));
+      const __m128 distance = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(mod, one));
+      const __m128 X = _mm_mul_ps(C, _mm_sub_ps(one, distance));
+
+      const auto is = [&](int value) {
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(sector, _mm_set1_epi32(value)));
+      };
+      const __m128 s0 = is(0), s1 = is(1), s2 = is(2), s3 = is(3), s4 = is(4), s5 = is(5);
+      const __m128 other = _mm_andnot_ps(
+          _mm_or_ps(_mm_or_ps(_mm_or_ps(s0, s1), _mm_or_ps(s2, s3)), _mm_or_ps(s4, s5)),
+          _mm_castsi128_ps(_mm_set1_epi32(-1)));
+      const __m128 r = _mm_or_ps(_mm_or_ps(
+          _mm_and_ps(_mm_or_ps(s0, s5), C),
+          _mm_and_ps(_mm_or_ps(s1, s4), X)),
+          _mm_and_ps(other, one));
+      const __m128 g = _mm_or_ps(_mm_or_ps(
+          _mm_and_ps(_mm_or_ps(s1, s2), C),
+          _mm_and_ps(_mm_or_ps(s0, s3), X)),
+          _mm_and_ps(other, one));
+      const __m128 b = _mm_or_ps(_mm_or_ps(
+          _mm_and_ps(_mm_or_ps(s3, s4), C),
+          _mm_and_ps(_mm_or_ps(s2, s5), X)),
+          _mm_and_ps(other, one));
+
+      const __m128i R = _mm_cvttps_epi32(_mm_mul_ps(r, c255));
+      const __m128i G = _mm_cvttps_epi32(_mm_mul_ps(g, c255));
+      const __m128i B = _mm_cvttps_epi32(_mm_mul_ps(b, c255));
+      const __m128i bgra = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(R, 16), _mm_slli_epi32(G, 8)), B);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), bgra);
+
+      // 分量为0或非有限值、亮度或颜色接近取整边界、色相接近360度的像素使用标量实现
+      const __m128 finite = _mm_and_ps(
+          _mm_cmpeq_ps(_mm_sub_ps(vx, vx), zero),
+          _mm_cmpeq_ps(_mm_sub_ps(vy, vy), zero));
+      const __m128 raw_scaled = _mm_mul_ps(raw, c255);
+      const __m128 fallback = _mm_or_ps(_mm_or_ps(_mm_or_ps(
+          _mm_andnot_ps(finite, _mm_castsi128_ps(_mm_set1_epi32(-1))),
+          _mm_or_ps(_mm_cmpeq_ps(vx, zero), _mm_cmpeq_ps(vy, zero))),
+          _mm_and_ps(_mm_and_ps(
+              NearInteger(raw_scaled),
+              _mm_cmpgt_ps(raw_scaled, _mm_set1_ps(-ROUNDING_MARGIN))),
+              _mm_cmplt_ps(raw_scaled, _mm_set1_ps(255.0f + ROUNDING_MARGIN)))),
+          _mm_or_ps(
+              _mm_and_ps(NearInteger(_mm_mul_ps(X, c255)), _mm_cmpgt_ps(C, zero)),
+              _mm_cmpgt_ps(H_60, _mm_set1_ps(6.0f - ROUNDING_MARGIN))));
+      int mask = _mm_movemask_ps(fallback);
+      for (auto lane = 0u; mask != 0; ++lane, mask >>= 1) {
+        if (mask & 1) {
+          out[i + lane] = ScalarFlow(flow[i + lane]);
+        }
+      }
+    }
+    ScalarFlow(flow + i, count - i, out + i);
+  }
+
+  // ===========================================================================
+  // -- AVX2 -------------------------------------------------------------------
+  // ===========================================================================
+
+  LIBCARLA_TARGET_AVX2 inline __m256 Log(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(x), 23);
+    x = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(~0x7f800000)));
+    x = _mm256_or_ps(x, _mm256_set1_ps(0.5f));
+    exponent = _mm256_sub_epi32(exponent, _mm256_set1_epi32(0x7f));
+    __m256 e = _mm256_add_ps(_mm256_cvtepi32_ps(exponent), one);
+    const __m256 mask = _mm256_cmp_ps(x, _mm256_set1_ps(LOG_SQRTHF), _CMP_LT_OQ);
+    const __m256 tmp = _mm256_and_ps(x, mask);
+    x = _mm256_sub_ps(x, one);
+    e = _mm256_sub_ps(e, _mm256_and_ps(one, mask));
+    x = _mm256_add_ps(x, tmp);
+    const __m256 z = _mm256_mul_ps(x, x);
+    __m256 y = _mm256_set1_ps(LOG_P0);
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P1));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P2));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P3));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P4));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P5));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P6));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P7));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(LOG_P8));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+    y = _mm256_add_ps(y, _mm256_mul_ps(e, _mm256_set1_ps(LOG_Q1)));
+    y = _mm256_sub_ps(y, _mm256_mul_ps(z, _mm256_set1_ps(0.5f)));
+    x = _mm256_add_ps(x, y);
+    return _mm256_add_ps(x, _mm256_mul_ps(e, _mm256_set1_ps(LOG_Q2)));
+  }
+
+  LIBCARLA_TARGET_AVX2 inline __m256 Atan2(__m256 y, __m256 x) {
+    const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+    const __m256 ax = _mm256_andnot_ps(sign_mask, x);
+    const __m256 ay = _mm256_andnot_ps(sign_mask, y);
+    const __m256 swap = _mm256_cmp_ps(ay, ax, _CMP_GT_OQ);
+    __m256 t = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_max_ps(ax, ay));
+    const __m256 reduce = _mm256_cmp_ps(t, _mm256_set1_ps(ATAN_TAN_PI_8), _CMP_GT_OQ);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    t = _mm256_blendv_ps(t, _mm256_div_ps(_mm256_sub_ps(t, one), _mm256_add_ps(t, one)), reduce);
+    const __m256 z = _mm256_mul_ps(t, t);
+    __m256 a = _mm256_set1_ps(ATAN_P0);
+    a = _mm256_add_ps(_mm256_mul_ps(a, z), _mm256_set1_ps(ATAN_P1));
+    a = _mm256_add_ps(_mm256_mul_ps(a, z), _mm256_set1_ps(ATAN_P2));
+    a = _mm256_add_ps(_mm256_mul_ps(a, z), _mm256_set1_ps(ATAN_P3));
+    a = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(a, z), t), t);
+    a = _mm256_add_ps(a, _mm256_and_ps(reduce, _mm256_set1_ps(PI / 4.0f)));
+    a = _mm256_blendv_ps(a, _mm256_sub_ps(_mm256_set1_ps(PI / 2.0f), a), swap);
+    a = _mm256_blendv_ps(a, _mm256_sub_ps(_mm256_set1_ps(PI), a), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+    return _mm256_or_ps(a, _mm256_and_ps(sign_mask, y));
+  }
+
+  LIBCARLA_TARGET_AVX2 inline __m256 NearInteger(__m256 value) {
+    const __m256 fraction = _mm256_sub_ps(value, _mm256_round_ps(value, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+    return _mm256_or_ps(
+        _mm256_cmp_ps(fraction, _mm256_set1_ps(ROUNDING_MARGIN), _CMP_LT_OQ),
+        _mm256_cmp_ps(fraction, _mm256_set1_ps(1.0f - ROUNDING_MARGIN), _CMP_GT_OQ));
+  }
+
+  LIBCARLA_TARGET_AVX2 inline __m256 NormalizedDepth(__m256i pixels) {
+    // 将 B、G、R 字节重排为 R + G * 256 + B * 65536
+    const __m256i shuffle = _mm256_setr_epi8(
+        2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1,
+        2, 1, 0, -1, 6, 5, 4, -1, 10, 9, 8, -1, 14, 13, 12, -1);
+    const __m256i depth = _mm256_shuffle_epi8(pixels, shuffle);
+    return _mm256_div_ps(_mm256_cvtepi32_ps(depth), _mm256_set1_ps(16777215.0f));
+  }
+
+  LIBCARLA_TARGET_AVX2 inline __m256i Gray(__m256i value) {
+    return _mm256_or_si256(
+        _mm256_mullo_epi32(value, _mm256_set1_epi32(0x010101)),
+        _mm256_set1_epi32(static_cast<int>(0xff000000)));
+  }
+
+  LIBCARLA_TARGET_AVX2 void Avx2Depth(Color *pixels, size_t count) {
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      auto *ptr = reinterpret_cast<__m256i *>(pixels + i);
+      const __m256 normalized = NormalizedDepth(_mm256_loadu_si256(ptr));
+      const __m256 scaled = _mm256_add_ps(_mm256_mul_ps(normalized, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f));
+      _mm256_storeu_si256(ptr, Gray(_mm256_cvttps_epi32(scaled)));
+    }
+    ScalarDepth(pixels + i, count - i);
+  }
+
+  LIBCARLA_TARGET_AVX2 void Avx2LogarithmicDepth(Color *pixels, size_t count) {
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      auto *ptr = reinterpret_cast<__m256i *>(pixels + i);
+      const __m256i input = _mm256_loadu_si256(ptr);
+      const __m256 normalized = NormalizedDepth(input);
+      const __m256 value = _mm256_add_ps(
+          _mm256_set1_ps(1.0f),
+          _mm256_div_ps(Log(normalized), _mm256_set1_ps(5.70378f)));
+      const __m256 clamped = _mm256_max_ps(_mm256_min_ps(value, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.005f));
+      const __m256 scaled = _mm256_add_ps(_mm256_mul_ps(clamped, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f));
+      _mm256_storeu_si256(ptr, Gray(_mm256_cvttps_epi32(scaled)));
+      const __m256 fallback = _mm256_or_ps(
+          NearInteger(scaled),
+          _mm256_cmp_ps(normalized, _mm256_setzero_ps(), _CMP_EQ_OQ));
+      int mask = _mm256_movemask_ps(fallback);
+      if (mask != 0) {
+        alignas(32) Color original[8u];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(original), input);
+        for (auto lane = 0u; mask != 0; ++lane, mask >>= 1) {
+          if (mask & 1) {
+            pixels[i + lane] = ScalarLogarithmicDepth(original[lane]);
+          }
+        }
+      }
+    }
+    ScalarLogarithmicDepth(pixels + i, count - i);
+  }
+
+  LIBCARLA_TARGET_AVX2 void Avx2CityScapesPalette(Color *pixels, size_t count) {
+    const auto *table = reinterpret_cast<const int *>(GetCityScapesTable().data());
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      auto *ptr = reinterpret_cast<__m256i *>(pixels + i);
+      const __m256i tags = _mm256_and_si256(
+          _mm256_srli_epi32(_mm256_loadu_si256(ptr), 16),
+          _mm256_set1_epi32(0xff));
+      _mm256_storeu_si256(ptr, _mm256_i32gather_epi32(table, tags, 4));
+    }
+    ScalarCityScapesPalette(pixels + i, count - i);
+  }
+
+  // 按扇区查表得到分量的来源：0 为 C，1 为 X，2 为 0，3 为 1
+  LIBCARLA_TARGET_AVX2 inline __m256 Pick(__m256i sectors, __m256i index, __m256 C, __m256 X) {
+    const __m256i which = _mm256_permutevar8x32_epi32(sectors, index);
+    const __m256 is_c = _mm256_castsi256_ps(_mm256_cmpeq_epi32(which, _mm256_setzero_si256()));
+    const __m256 is_x = _mm256_castsi256_ps(_mm256_cmpeq_epi32(which, _mm256_set1_epi32(1)));
+    const __m256 is_one = _mm256_castsi256_ps(_mm256_cmpeq_epi32(which, _mm256_set1_epi32(3)));
+    return _mm256_or_ps(_mm256_or_ps(
+        _mm256_and_ps(is_c, C),
+        _mm256_and_ps(is_x, X)),
+        _mm256_and_ps(is_one, _mm256_set1_ps(1.0f)));
+  }
+
+  LIBCARLA_TARGET_AVX2 void Avx2Flow(const OpticalFlowPixel *flow, size_t count, Color *out) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 c255 = _mm256_set1_ps(255.0f);
+    const __m256 scale = _mm256_set1_ps(GetFlowIntensityScale());
+    const __m256i deinterleave = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    size_t i = 0u;
+    for (; i + 8u <= count; i += 8u) {
+      const float *src = reinterpret_cast<const float *>(flow + i);
+      // 将 x0 y0 x1 y1 ... 分离为 x 与 y 两个向量，保持像素顺序
+      const __m256 lo = _mm256_permutevar8x32_ps(_mm256_loadu_ps(src), deinterleave);
+      const __m256 hi = _mm256_permutevar8x32_ps(_mm256_loadu_ps(src + 8u), deinterleave);
+      const __m256 vx = _mm256_permute2f128_ps(lo, hi, 0x20);
+      const __m256 vy = _mm256_permute2f128_ps(lo, hi, 0x31);
+
+      __m256 angle = _mm256_add_ps(_mm256_set1_ps(180.0f), _mm256_mul_ps(Atan2(vy, vx), _mm256_set1_ps(FLOW_RAD_TO_DEG)));
+      angle = _mm256_blendv_ps(angle, _mm256_add_ps(_mm256_set1_ps(360.0f), angle), _mm256_cmp_ps(angle, zero, _CMP_LT_OQ));
+      angle = _mm256_blendv_ps(angle, _mm256_sub_ps(angle, _mm256_set1_ps(360.0f)), _mm256_cmp_ps(angle, _mm256_set1_ps(360.0f), _CMP_GE_OQ));
+
+      const __m256 norm = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)));
+      const __m256 raw = _mm256_mul_ps(scale, Log(_mm256_add_ps(norm, _mm256_set1_ps(FLOW_SHIFT))));
+      const __m256 C = _mm256_min_ps(_mm256_max_ps(raw, zero), one);
+
+      const __m256 H_60 = _mm256_mul_ps(angle, _mm256_set1_ps(1.0f / 60.0f));
+      const __m256i sector = _mm256_cvttps_epi32(H_60);
+      const __m256 half = _mm256_round_ps(_mm256_mul_ps(H_60, _mm256_set1_ps(0.5f)), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+      const __m256 mod = _mm256_sub_ps(H_60, _mm256_add_ps(half, half));
+      const __m256 distance = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), _mm256_sub_ps(mod, one));
+      const __m256 X = _mm256_mul_ps(C, _mm256_sub_ps(one, distance));
+
+      // 按扇区从 {C, X, 0} 中选取各分量，扇区超出 [0, 5] 时为白色
+      const __m256i sectors_r = _mm256_setr_epi32(0, 1, 2, 2, 1, 0, 3, 3);
+      const __m256i sectors_g = _mm256_setr_epi32(1, 0, 0, 1, 2, 2, 3, 3);
+      const __m256i sectors_b = _mm256_setr_epi32(2, 2, 1, 0, 0, 1, 3, 3);
+      const __m256i index = _mm256_min_epu32(sector, _mm256_set1_epi32(6));
+      const __m256i R = _mm256_cvttps_epi32(_mm256_mul_ps(Pick(sectors_r, index, C, X), c255));
+      const __m256i G = _mm256_cvttps_epi32(_mm256_mul_ps(Pick(sectors_g, index, C, X), c255));
+      const __m256i B = _mm256_cvttps_epi32(_mm256_mul_ps(Pick(sectors_b, index, C, X), c255));
+      const __m256i bgra = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(R, 16), _mm256_slli_epi32(G, 8)), B);
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), bgra);
+
+      const __m256 finite = _mm256_and_ps(
+          _mm256_cmp_ps(_mm256_sub_ps(vx, vx), zero, _CMP_EQ_OQ),
+          _mm256_cmp_ps(_mm256_sub_ps(vy, vy), zero, _CMP_EQ_OQ));
+      const __m256 raw_scaled = _mm256_mul_ps(raw, c255);
+      const __m256 fallback = _mm256_or_ps(_mm256_or_ps(_mm256_or_ps(
+          _mm256_xor_ps(finite, _mm256_castsi256_ps(_mm256_set1_epi32(-1))),
+          _mm256_or_ps(_mm256_cmp_ps(vx, zero, _CMP_EQ_OQ), _mm256_cmp_ps(vy, zero, _CMP_EQ_OQ))),
+          _mm256_and_ps(_mm256_and_ps(
+              NearInteger(raw_scaled),
+              _mm256_cmp_ps(raw_scaled, _mm256_set1_ps(-ROUNDING_MARGIN), _CMP_GT_OQ)),
+              _mm256_cmp_ps(raw_scaled, _mm256_set1_ps(255.0f + ROUNDING_MARGIN), _CMP_LT_OQ))),
+          _mm256_or_ps(
+              _mm256_and_ps(NearInteger(_mm256_mul_ps(X, c255)), _mm256_cmp_ps(C, zero, _CMP_GT_OQ)),
+              _mm256_cmp_ps(H_60, _mm256_set1_ps(6.0f - ROUNDING_MARGIN), _CMP_GT_OQ)));
+      int mask = _mm256_movemask_ps(fallback);
+      for (auto lane = 0u; mask != 0; ++lane, mask >>= 1) {
+        if (mask & 1) {
+          out[i + lane] = ScalarFlow(flow[i + lane]);
+        }
+      }
+    }
+    ScalarFlow(flow + i, count - i, out + i);
+  }
+
+  bool CpuSupportsAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+      return false;
+    }
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    // 操作系统需要保存 YMM 寄存器
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+      return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+  }
+
+#endif // LIBCARLA_SIMD_X86_64
+
+  InstructionSet GetBestSupported() {
+#ifdef LIBCARLA_SIMD_X86_64
+    static const bool avx2 = CpuSupportsAvx2();
+    return avx2 ? InstructionSet::AVX2 : InstructionSet::SSE2;
+#else
+    return InstructionSet::Scalar;
+#endif
+  }
+
+  std::atomic<InstructionSet> &GetSelected() {
+    static std::atomic<InstructionSet> selected{GetBestSupported()};
+    return selected;
+  }
+
+} // namespace
+
+  SimdColorConverter::InstructionSet SimdColorConverter::GetInstructionSet() {
+    return GetSelected().load(std::memory_order_relaxed);
+  }
+
+  SimdColorConverter::InstructionSet SimdColorConverter::SetInstructionSet(
+      const InstructionSet instruction_set) {
+    const auto selected = IsSupported(instruction_set) ? instruction_set : GetBestSupported();
+    GetSelected().store(selected, std::memory_order_relaxed);
+    return selected;
+  }
+
+  bool SimdColorConverter::IsSupported(const InstructionSet instruction_set) {
+    return static_cast<uint8_t>(instruction_set) <= static_cast<uint8_t>(GetBestSupported());
+  }
+
+  void SimdColorConverter::Depth(Color *pixels, const size_t count) {
+    switch (GetInstructionSet()) {
+#ifdef LIBCARLA_SIMD_X86_64
+      case InstructionSet::AVX2: return Avx2Depth(pixels, count);
+      case InstructionSet::SSE2: return Sse2Depth(pixels, count);
+#endif
+      default: return ScalarDepth(pixels, count);
+    }
+  }
+
+  void SimdColorConverter::LogarithmicDepth(Color *pixels, const size_t count) {
+    switch (GetInstructionSet()) {
+#ifdef LIBCARLA_SIMD_X86_64
+      case InstructionSet::AVX2: return Avx2LogarithmicDepth(pixels, count);
+      case InstructionSet::SSE2: return Sse2LogarithmicDepth(pixels, count);
+#endif
+      default: return ScalarLogarithmicDepth(pixels, count);
+    }
+  }
+
+  void SimdColorConverter::CityScapesPalette(Color *pixels, const size_t count) {
+    // SSE2 没有查表（gather）指令，使用与标量实现相同的查找表
+    switch (GetInstructionSet()) {
+#ifdef LIBCARLA_SIMD_X86_64
+      case InstructionSet::AVX2: return Avx2CityScapesPalette(pixels, count);
+#endif
+      default: return ScalarCityScapesPalette(pixels, count);
+    }
+  }
+
+  void SimdColorConverter::ColorCodedFlow(
+      const OpticalFlowPixel *flow,
+      const size_t count,
+      Color *out) {
+    switch (GetInstructionSet()) {
+#ifdef LIBCARLA_SIMD_X86_64
+      case InstructionSet::AVX2: return Avx2Flow(flow, count, out);
+      case InstructionSet::SSE2: return Sse2Flow(flow, count, out);
+#endif
+      default: return ScalarFlow(flow, count, out);
+    }
+  }
+
+} // namespace image
+} // namespace carla
@@ -0,0 +1,58 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/sensor/data/Color.h" // 引入颜色数据的头文件
+
+#include <cstddef>
+#include <cstdint>
+
+namespace carla {
+namespace image {
+
+  /// 对连续存储的传感器图像（BGRA8）进行原地颜色转换的向量化实现。
+  ///
+  /// 首次使用时检测CPU支持的指令集，并按 AVX2、SSE2、标量的顺序选择实现；
+  /// 也可以通过 SetInstructionSet 在运行时切换。所有实现的结果都与
+  /// ColorConverter 中逐像素的转换完全相同：近似计算的对数与反正切在结果
+  /// 接近取整边界时改用标量函数重新计算。
+  class SimdColorConverter {
+  public:
+
+    enum class InstructionSet : uint8_t {
+      Scalar,
+      SSE2,
+      AVX2
+    };
+
+    /// 当前使用的指令集。
+    static InstructionSet GetInstructionSet();
+
+    /// 切换使用的指令集，CPU不支持时使用支持的最高指令集。返回实际使用的指令集。
+    static InstructionSet SetInstructionSet(InstructionSet instruction_set);
+
+    /// 当前CPU是否支持 @a instruction_set。
+    static bool IsSupported(InstructionSet instruction_set);
+
+    /// 与 ColorConverter::Depth 相同，将深度编码转换为灰度。
+    static void Depth(sensor::data::Color *pixels, size_t count);
+
+    /// 与 ColorConverter::LogarithmicDepth 相同，深度与对数转换在一次遍历中完成。
+    static void LogarithmicDepth(sensor::data::Color *pixels, size_t count);
+
+    /// 与 ColorConverter::CityScapesPalette 相同，按红色通道中的标签着色。
+    static void CityScapesPalette(sensor::data::Color *pixels, size_t count);
+
+    /// 将光流转换为HSV编码的颜色（色相为方向，亮度为大小），alpha通道为0。
+    static void ColorCodedFlow(
+        const sensor::data::OpticalFlowPixel *flow,
+        size_t count,
+        sensor::data::Color *out);
+  };
+
+} // namespace image
+} // namespace carla
@@ -24,10 +24,86 @@
 
 // 引入pugixml库的头文件，这是一个用于处理XML的轻量级C++库。
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
+
 namespace carla {
 namespace opendrive {
 // 声明CARLA的命名空间，以便在代码中使用简短的类名而不需要前缀。
 
+  /// 解析各道路中互不依赖的部分：几何、车道和轮廓。
+  static void ParseRoadSections(
+      const std::vector<pugi::xml_node> &roads,
+      carla::road::MapBuilder &map_builder) {
+    parser::GeometryParser::Parse(roads, map_builder);
+    parser::LaneParser::Parse(roads, map_builder);
+    parser::ProfilesParser::Parse(roads, map_builder);
+  }
+
+  /// 在多个线程中解析所有道路的几何、车道和轮廓信息。道路按固定大小分块，
+  /// 各线程动态领取下一块并解析到自己的分区构建器中，最后合并到
+  /// @a map_builder。每条道路只由一个线程解析，因此合并结果与串行解析相同。
+  static void ParseRoadSectionsInParallel(
+      const pugi::xml_document &xml,
+      carla::road::MapBuilder &map_builder) {
+    std::vector<pugi::xml_node> roads;
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      roads.emplace_back(node_road);
+    }
+
+    constexpr size_t roads_per_chunk = 16u;
+    const size_t number_of_chunks = (roads.size() + roads_per_chunk - 1u) / roads_per_chunk;
+    const size_t number_of_threads = std::min<size_t>(
+        std::max(1u, std::thread::hardware_concurrency()), number_of_chunks);
+    if (number_of_threads <= 1u) {
+      ParseRoadSections(roads, map_builder);
+      return;
+    }
+
+    std::vector<carla::road::MapBuilder> section_builders;
+    section_builders.reserve(number_of_threads);
+    for (size_t i = 0u; i < number_of_threads; ++i) {
+      section_builders.emplace_back(map_builder.CreateSectionBuilder());
+    }
+
+    std::atomic_size_t next_chunk{0u};
+    std::vector<std::exception_ptr> errors(number_of_threads);
+    auto work = [&](const size_t thread_index) {
+      try {
+        std::vector<pugi::xml_node> chunk;
+        for (size_t i = next_chunk++; i < number_of_chunks; i = next_chunk++) {
+          const size_t begin = i * roads_per_chunk;
+          const size_t end = std::min(roads.size(), begin + roads_per_chunk);
+          chunk.assign(roads.begin() + begin, roads.begin() + end);
+          ParseRoadSections(chunk, section_builders[thread_index]);
+        }
+      } catch (...) {
+        errors[thread_index] = std::current_exception();
+        next_chunk = number_of_chunks; // 让其他线程尽快结束
+      }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1u; i < number_of_threads; ++i) {
+      workers.emplace_back(work, i);
+    }
+    work(0u); // 当前线程也参与解析
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    for (auto &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+
+    for (auto &section_builder : section_builders) {
+      map_builder.MergeSectionBuilder(std::move(section_builder));
+    }
+  }
+
   boost::optional<road::Map> OpenDriveParser::Load(const std::string &opendrive) {
       // OpenDriveParser类的Load成员函数，用于加载并解析OpenDrive格式的地图数据。
     pugi::xml_document xml;
@@ -55,12 +131,9 @@ namespace opendrive {
     parser::RoadParser::Parse(xml, map_builder);
   // 使用JunctionParser解析器解析XML中的交叉路口信息， 并将这些信息添加到map_builder对象中 
     parser::JunctionParser::Parse(xml, map_builder);
-  // 使用GeometryParser解析器解析XML中的几何信息（如道路曲率、边界等）， 并将这些信息添加到map_builder对象中
-    parser::GeometryParser::Parse(xml, map_builder);
-  // 使用LaneParser解析器解析XML中的车道信息（如车道宽度、方向等）， 并将这些信息添加到map_builder对象中  
-    parser::LaneParser::Parse(xml, map_builder);
-  // 使用ProfilesParser解析器解析XML中的道路属性信息（如速度限制、类型等）， 并将这些信息添加到map_builder对象中  
-    parser::ProfilesParser::Parse(xml, map_builder);
+  // 使用GeometryParser、LaneParser和ProfilesParser解析器解析XML中每条道路的几何信息（如道路曲率、边界等）、
+  // 车道信息（如车道宽度、方向等）和道路属性信息（如高程），各道路互不依赖，在多个线程中并行解析后合并到map_builder对象中
+    ParseRoadSectionsInParallel(xml, map_builder);
   // 使用TrafficGroupParser解析器解析XML中的交通组信息（如公交专用道、自行车道等） ，并将这些信息添加到map_builder对象中  
     parser::TrafficGroupParser::Parse(xml, map_builder);
   // 使用SignalParser解析器解析XML中的交通信号信息（如红绿灯、停车标志等） ，并将这些信息添加到map_builder对象中  
@@ -76,10 +76,20 @@ namespace parser {
   void GeometryParser::Parse(
       const pugi::xml_document &xml,
       carla::road::MapBuilder &map_builder) {
+    std::vector<pugi::xml_node> roads;
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      roads.emplace_back(node_road);
+    }
+    Parse(roads, map_builder);
+  }
+
+  void GeometryParser::Parse(
+      const std::vector<pugi::xml_node> &roads,
+      carla::road::MapBuilder &map_builder) {
 
     std::vector<Geometry> geometry;
 
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+    for (const pugi::xml_node &node_road : roads) {
 
       // 解析规划视图
       pugi::xml_node node_plan_view = node_road.child("planView");
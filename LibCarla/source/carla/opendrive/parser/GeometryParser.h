@@ -5,9 +5,13 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #pragma once
+
+#include <vector>
+
 /// @brief 一个用于处理XML文档的命名空间
 namespace pugi {
   class xml_document;/// @brief 表示一个XML文档的类
+  class xml_node;
 } // namespace pugi
 /// @brief Carla仿真器的相关功能实现的命名空间
 namespace carla {
@@ -28,6 +32,13 @@ namespace parser {
         const pugi::xml_document &xml,
         carla::road::MapBuilder &map_builder);
 
+    /// @brief 只解析 @a roads 中给定的 <road> 节点的几何信息。各道路互不
+    /// 依赖，可以把道路分给多个线程，分别解析到各自的分区构建器中
+    /// （见 MapBuilder::CreateSectionBuilder）。
+    static void Parse(
+        const std::vector<pugi::xml_node> &roads,
+        carla::road::MapBuilder &map_builder);
+
   };
 
 } // namespace parser
@@ -193,11 +193,19 @@ namespace parser {
   void LaneParser::Parse(
       const pugi::xml_document &xml,
       carla::road::MapBuilder &map_builder) {
+    std::vector<pugi::xml_node> roads;
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      roads.emplace_back(node_road);
+    }
+    Parse(roads, map_builder);
+  }
 
-    pugi::xml_node open_drive_node = xml.child("OpenDRIVE"); // 获取OpenDRIVE根节点
+  void LaneParser::Parse(
+      const std::vector<pugi::xml_node> &roads,
+      carla::road::MapBuilder &map_builder) {
 
     // 车道
-    for (pugi::xml_node road_node : open_drive_node.children("road")) { // 遍历每个道路节点
+    for (const pugi::xml_node &road_node : roads) { // 遍历每个道路节点
       road::RoadId road_id = road_node.attribute("id").as_uint(); // 获取道路ID
 
       for (pugi::xml_node lanes_node : road_node.children("lanes")) { // 遍历每个车道节点
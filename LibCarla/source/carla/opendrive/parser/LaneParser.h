@@ -5,10 +5,14 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #pragma once
+
+#include <vector>
+
 /// @brief 提供XML文档解析功能的命名空间
 namespace pugi {
     /// @brief 表示一个XML文档的类，用于存储和解析XML数据
   class xml_document;
+  class xml_node;
 } // namespace pugi
 /// @brief Carla自动驾驶仿真框架的命名空间
 namespace carla {
@@ -32,6 +36,13 @@ namespace parser {
     static void Parse(
         const pugi::xml_document &xml,
         carla::road::MapBuilder &map_builder);
+
+    /// @brief 只解析 @a roads 中给定的 <road> 节点的车道信息。各道路互不
+    /// 依赖，可以把道路分给多个线程，分别解析到各自的分区构建器中
+    /// （见 MapBuilder::CreateSectionBuilder）。
+    static void Parse(
+        const std::vector<pugi::xml_node> &roads,
+        carla::road::MapBuilder &map_builder);
   };
 
 } // namespace parser
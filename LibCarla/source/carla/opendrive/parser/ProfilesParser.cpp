@@ -72,6 +72,16 @@ namespace parser {
   void ProfilesParser::Parse(
       const pugi::xml_document &xml,
       carla::road::MapBuilder &map_builder) {
+    std::vector<pugi::xml_node> roads;
+    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
+      roads.emplace_back(node_road);
+    }
+    Parse(roads, map_builder);
+  }
+
+  void ProfilesParser::Parse(
+      const std::vector<pugi::xml_node> &roads,
+      carla::road::MapBuilder &map_builder) {
     // ProfilesParser类中的Parse函数，用于解析XML中的道路剖面信息并构建地图相关内容
     // 输入为一个pugi::xml_document类型的XML文档对象和一个carla::road::MapBuilder类型的地图构建器对象
 
@@ -82,8 +92,8 @@ namespace parser {
     // 用于存储横向剖面信息的向量
 
 
-    for (pugi::xml_node node_road : xml.child("OpenDRIVE").children("road")) {
-      // 遍历XML文档中<OpenDRIVE>下的所有<road>节点
+    for (const pugi::xml_node &node_road : roads) {
+      // 遍历给定的所有<road>节点
       // 每个<road>节点代表一条道路
 
 
@@ -5,10 +5,14 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #pragma once
+
+#include <vector>
+
 /// @brief 提供XML文档处理功能的命名空间，包含XML文档的加载、解析和遍历等功能
 namespace pugi {
     /// @brief 表示一个XML文档的类，用于存储和解析XML数据
   class xml_document;
+  class xml_node;
 } // namespace pugi
 /// @brief Carla自动驾驶仿真框架的命名空间
 namespace carla {
@@ -33,6 +37,13 @@ namespace parser {
         const pugi::xml_document &xml,
         carla::road::MapBuilder &map_builder);
 
+    /// @brief 只解析 @a roads 中给定的 <road> 节点的轮廓信息。各道路互不
+    /// 依赖，可以把道路分给多个线程，分别解析到各自的分区构建器中
+    /// （见 MapBuilder::CreateSectionBuilder）。
+    static void Parse(
+        const std::vector<pugi::xml_node> &roads,
+        carla::road::MapBuilder &map_builder);
+
   };
 
 } // namespace parser
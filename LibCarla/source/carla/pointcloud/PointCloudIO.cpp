@@ -0,0 +1,312 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/pointcloud/PointCloudIO.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace carla {
+namespace pointcloud {
+
+namespace {
+
+  /// 游程编码中一个控制字节能表示的最大长度。
+  constexpr size_t MAX_RUN = 128u;
+
+  /// 至少这么多个连续的零字节才单独编码为零游程，更短的留在字面量中更省空间。
+  constexpr size_t MIN_ZERO_RUN = 3u;
+
+  /// 控制字节的最高位为1表示零游程，否则表示其后跟着的字面量。
+  constexpr uint8_t ZERO_RUN_FLAG = 0x80u;
+
+  bool IsLittleEndian() {
+    const uint16_t value = 1u;
+    return *reinterpret_cast<const uint8_t *>(&value) == 1u;
+  }
+
+  uint32_t LoadWord(const uint8_t *src) {
+    uint32_t word;
+    std::memcpy(&word, src, sizeof(word));
+    return word;
+  }
+
+  void StoreWord(uint32_t word, uint8_t *dst) {
+    std::memcpy(dst, &word, sizeof(word));
+  }
+
+  void AppendUInt32(std::vector<uint8_t> &out, uint32_t value) {
+    for (size_t b = 0u; b < 4u; ++b) {
+      out.emplace_back(static_cast<uint8_t>(value >> (8u * b)));
+    }
+  }
+
+  uint32_t ReadUInt32(const uint8_t *src) {
+    uint32_t value = 0u;
+    for (size_t b = 0u; b < 4u; ++b) {
+      value |= static_cast<uint32_t>(src[b]) << (8u * b);
+    }
+    return value;
+  }
+
+  [[ noreturn ]] void ThrowCorrupted(const char *reason) {
+    throw_exception(std::runtime_error(
+        std::string("invalid compressed point cloud: ") + reason));
+  }
+
+  /// 按属性分列，与前一个点按位异或后按字节的有效位拆成平面：
+  /// 平面 (w * 4 + b) 保存第 w 个属性异或结果的第 b 个字节。
+  void SplitPlanes(
+      const uint8_t *points,
+      size_t point_count,
+      size_t words_per_point,
+      uint8_t *planes) {
+    const size_t stride = words_per_point * sizeof(uint32_t);
+    for (size_t w = 0u; w < words_per_point; ++w) {
+      uint8_t *plane = planes + w * 4u * point_count;
+      uint32_t previous = 0u;
+      for (size_t i = 0u; i < point_count; ++i) {
+        const uint32_t word = LoadWord(points + i * stride + w * sizeof(uint32_t));
+        const uint32_t delta = word ^ previous;
+        previous = word;
+        plane[i] = static_cast<uint8_t>(delta);
+        plane[point_count + i] = static_cast<uint8_t>(delta >> 8u);
+        plane[2u * point_count + i] = static_cast<uint8_t>(delta >> 16u);
+        plane[3u * point_count + i] = static_cast<uint8_t>(delta >> 24u);
+      }
+    }
+  }
+
+  /// SplitPlanes 的逆过程。
+  void MergePlanes(
+      const uint8_t *planes,
+      size_t point_count,
+      size_t words_per_point,
+      uint8_t *points) {
+    const size_t stride = words_per_point * sizeof(uint32_t);
+    for (size_t w = 0u; w < words_per_point; ++w) {
+      const uint8_t *plane = planes + w * 4u * point_count;
+      uint32_t previous = 0u;
+      for (size_t i = 0u; i < point_count; ++i) {
+        const uint32_t delta =
+            static_cast<uint32_t>(plane[i]) |
+            (static_cast<uint32_t>(plane[point_count + i]) << 8u) |
+            (static_cast<uint32_t>(plane[2u * point_count + i]) << 16u) |
+            (static_cast<uint32_t>(plane[3u * point_count + i]) << 24u);
+        previous ^= delta;
+        StoreWord(previous, points + i * stride + w * sizeof(uint32_t));
+      }
+    }
+  }
+
+  bool StartsZeroRun(const uint8_t *data, size_t size) {
+    if (size < MIN_ZERO_RUN) {
+      // 末尾剩余的零也可以整体编码为零游程
+      return std::all_of(data, data + size, [](uint8_t byte) { return byte == 0u; });
+    }
+    return std::all_of(data, data + MIN_ZERO_RUN, [](uint8_t byte) { return byte == 0u; });
+  }
+
+  void EncodeZeroRuns(const uint8_t *data, size_t size, std::vector<uint8_t> &out) {
+    size_t i = 0u;
+    while (i < size) {
+      if (data[i] == 0u && StartsZeroRun(data + i, size - i)) {
+        size_t length = 1u;
+        while (i + length < size && data[i + length] == 0u && length < MAX_RUN) {
+          ++length;
+        }
+        out.emplace_back(static_cast<uint8_t>(ZERO_RUN_FLAG | (length - 1u)));
+        i += length;
+      } else {
+        const size_t begin = i;
+        do {
+          ++i;
+        } while (i < size && (i - begin) < MAX_RUN &&
+                 !(data[i] == 0u && StartsZeroRun(data + i, size - i)));
+        out.emplace_back(static_cast<uint8_t>(i - begin - 1u));
+        out.insert(out.end(), data + begin, data + i);
+      }
+    }
+  }
+
+  void DecodeZeroRuns(const uint8_t *data, size_t size, uint8_t *out, size_t out_size) {
+    const uint8_t *end = data + size;
+    size_t written = 0u;
+    while (data != end) {
+      const uint8_t control = *data++;
+      const size_t length = (control & ~ZERO_RUN_FLAG) + 1u;
+      if (length > out_size - written) {
+        ThrowCorrupted("run exceeds chunk size");
+      }
+      if ((control & ZERO_RUN_FLAG) != 0u) {
+        std::memset(out + written, 0, length);
+      } else {
+        if (length > static_cast<size_t>(end - data)) {
+          ThrowCorrupted("truncated literal");
+        }
+        std::memcpy(out + written, data, length);
+        data += length;
+      }
+      written += length;
+    }
+    if (written != out_size) {
+      ThrowCorrupted("chunk is shorter than its point count");
+    }
+  }
+
+} // namespace
+
+  constexpr size_t PointCloudIO::COMPRESSED_CHUNK_SIZE;
+  constexpr const char *PointCloudIO::COMPRESSED_MAGIC;
+  constexpr const char *PointCloudIO::COMPRESSED_FORMAT;
+
+  void PointCloudIO::WriteLittleEndian(std::ostream &out, const void *data, size_t word_count) {
+    const auto *bytes = reinterpret_cast<const char *>(data);
+    if (IsLittleEndian()) {
+      out.write(bytes, static_cast<std::streamsize>(word_count * sizeof(uint32_t)));
+      return;
+    }
+    // 大端主机上逐块交换字节序
+    std::array<uint8_t, 16384u * sizeof(uint32_t)> buffer;
+    while (word_count > 0u) {
+      const size_t words = std::min(word_count, buffer.size() / sizeof(uint32_t));
+      for (size_t i = 0u; i < words; ++i) {
+        const uint32_t word = LoadWord(reinterpret_cast<const uint8_t *>(bytes) + i * sizeof(uint32_t));
+        for (size_t b = 0u; b < 4u; ++b) {
+          buffer[i * sizeof(uint32_t) + b] = static_cast<uint8_t>(word >> (8u * b));
+        }
+      }
+      out.write(
+          reinterpret_cast<const char *>(buffer.data()),
+          static_cast<std::streamsize>(words * sizeof(uint32_t)));
+      bytes += words * sizeof(uint32_t);
+      word_count -= words;
+    }
+  }
+
+  void PointCloudIO::WriteCompressedChunks(
+      std::ostream &out,
+      const void *data,
+      size_t point_count,
+      size_t words_per_point) {
+    const auto *points = reinterpret_cast<const uint8_t *>(data);
+    const size_t point_size = words_per_point * sizeof(uint32_t);
+    std::vector<uint8_t> planes;
+    std::vector<uint8_t> chunk;
+    for (size_t first = 0u; first < point_count; first += COMPRESSED_CHUNK_SIZE) {
+      const size_t count = std::min(COMPRESSED_CHUNK_SIZE, point_count - first);
+      planes.resize(count * point_size);
+      SplitPlanes(points + first * point_size, count, words_per_point, planes.data());
+
+      chunk.clear();
+      AppendUInt32(chunk, static_cast<uint32_t>(count));
+      AppendUInt32(chunk, 0u);
+      EncodeZeroRuns(planes.data(), planes.size(), chunk);
+      const auto payload_size = static_cast<uint32_t>(chunk.size() - 8u);
+      for (size_t b = 0u; b < 4u; ++b) {
+        chunk[4u + b] = static_cast<uint8_t>(payload_size >> (8u * b));
+      }
+      out.write(
+          reinterpret_cast<const char *>(chunk.data()),
+          static_cast<std::streamsize>(chunk.size()));
+    }
+  }
+
+  size_t PointCloudIO::ReadCompressedHeader(
+      std::istream &in,
+      const std::string &properties,
+      size_t point_size) {
+    std::string line;
+    if (!std::getline(in, line) || line != COMPRESSED_MAGIC) {
+      ThrowCorrupted("missing header");
+    }
+    if (!std::getline(in, line) || line != std::string("format ") + COMPRESSED_FORMAT) {
+      ThrowCorrupted("unsupported format");
+    }
+    const std::string element = "element vertex ";
+    if (!std::getline(in, line) || line.compare(0u, element.size(), element) != 0u) {
+      ThrowCorrupted("missing vertex count");
+    }
+    size_t count = 0u;
+    try {
+      count = static_cast<size_t>(std::stoull(line.substr(element.size())));
+    } catch (const std::exception &) {
+      ThrowCorrupted("invalid vertex count");
+    }
+    std::string header_properties;
+    while (std::getline(in, line) && line != "end_header") {
+      if (!header_properties.empty()) {
+        header_properties += '\n';
+      }
+      header_properties += line;
+    }
+    if (!in) {
+      ThrowCorrupted("missing end_header");
+    }
+    if (header_properties != properties) {
+      ThrowCorrupted("point properties do not match");
+    }
+    // 分配内存前先用剩余的输入大小检查点数：每块至少有8字节的块头，
+    // 数据最多被压缩到每 MAX_RUN 个字节一个控制字节
+    if (count > std::numeric_limits<size_t>::max() / point_size) {
+      ThrowCorrupted("vertex count too large");
+    }
+    const size_t chunk_count = count / COMPRESSED_CHUNK_SIZE + (count % COMPRESSED_CHUNK_SIZE != 0u ? 1u : 0u);
+    const size_t min_size = chunk_count * 8u + count * point_size / MAX_RUN;
+    const auto position = in.tellg();
+    if (position >= 0) {
+      in.seekg(0, std::ios::end);
+      const auto end = in.tellg();
+      in.seekg(position);
+      if (end >= position && static_cast<uint64_t>(end - position) < min_size) {
+        ThrowCorrupted("vertex count exceeds input size");
+      }
+    }
+    return count;
+  }
+
+  void PointCloudIO::ReadCompressedChunks(
+      std::istream &in,
+      void *data,
+      size_t point_count,
+      size_t words_per_point) {
+    auto *points = reinterpret_cast<uint8_t *>(data);
+    const size_t point_size = words_per_point * sizeof(uint32_t);
+    std::vector<uint8_t> planes;
+    std::vector<uint8_t> payload;
+    size_t first = 0u;
+    while (first < point_count) {
+      std::array<uint8_t, 8u> chunk_header;
+      if (!in.read(reinterpret_cast<char *>(chunk_header.data()), chunk_header.size())) {
+        ThrowCorrupted("truncated chunk header");
+      }
+      const size_t count = ReadUInt32(chunk_header.data());
+      const size_t payload_size = ReadUInt32(chunk_header.data() + 4u);
+      // 写入时每块不超过 COMPRESSED_CHUNK_SIZE 个点，这也保证了下面的乘法不会溢出
+      if (count == 0u || count > COMPRESSED_CHUNK_SIZE || count > point_count - first) {
+        ThrowCorrupted("invalid chunk point count");
+      }
+      // 最坏情况下每 MAX_RUN 个字节多一个控制字节
+      const size_t chunk_size = count * point_size;
+      if (payload_size > chunk_size + chunk_size / MAX_RUN + 1u) {
+        ThrowCorrupted("invalid chunk size");
+      }
+      payload.resize(payload_size);
+      if (!in.read(reinterpret_cast<char *>(payload.data()), static_cast<std::streamsize>(payload_size))) {
+        ThrowCorrupted("truncated chunk");
+      }
+      planes.resize(chunk_size);
+      DecodeZeroRuns(payload.data(), payload.size(), planes.data(), planes.size());
+      MergePlanes(planes.data(), count, words_per_point, points + first * point_size);
+      first += count;
+    }
+  }
+
+} // namespace pointcloud
+} // namespace carla
@@ -7,15 +7,28 @@
 //确保头文件只被包含一次
 #pragma once
 
+//包含Carla调试断言头文件
+#include "carla/Debug.h"
+//包含Carla异常头文件
+#include "carla/Exception.h"
 //包含Carla文件系统头文件
 #include "carla/FileSystem.h"
 
+#include <cstddef>
+#include <cstdint>
 //包含fstream头文件，用于文件流操作
 #include <fstream>
+//包含future头文件，用于异步保存
+#include <future>
 //包含iterator头文件，用于迭代器操作
 #include <iterator>
 //包含iostream头文件，用于输入输出操作
 #include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 namespace carla {// 定义命名空间carla，用于组织相关的代码和数据
 namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于点云处理的代码
@@ -24,6 +37,25 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
 //类的具体实现代码
 
   public:
+
+    /// 点云文件的格式。
+    enum class Format : uint8_t {
+      /// ASCII 编码的 PLY（.ply），每个点一行，保留4位小数。
+      Ascii,
+      /// 小端二进制编码的 PLY（.ply），点的数据直接从内存中写出。
+      BinaryLittleEndian,
+      /// 分块压缩的无损点云（.cpc），见 DumpCompressed。
+      Compressed
+    };
+
+    /// 压缩格式中每个块最多包含的点数。
+    static constexpr size_t COMPRESSED_CHUNK_SIZE = 65536u;
+
+    /// @a format 对应的文件扩展名。
+    static const char *GetExtension(Format format) {
+      return format == Format::Compressed ? ".cpc" : ".ply";
+    }
+
   // 模板函数Dump，用于将点云数据写入到输出流中，PointIt是点迭代器类型，用于遍历点云数据，out是输出流对象，begin和end分别是点云数据的起始和结束迭代器
     template <typename PointIt>
     static void Dump(std::ostream &out, PointIt begin, PointIt end) {
@@ -31,24 +63,151 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
       WriteHeader(out, begin, end);
       // 遍历点云数据，将每个点的信息写入到输出流中
       for (; begin != end; ++begin) {
-        begin->WriteDetection(out);// 假设每个点对象都有WriteDetection方法，用于写入点信息 
+        begin->WriteDetection(out);// 假设每个点对象都有WriteDetection方法，用于写入点信息
         out << '\n';
       }
     }
 
+    /// 以小端二进制 PLY 写出连续存储的点云。
+    ///
+    /// 点的内存布局必须与其 WritePlyHeaderInfo 声明的属性一一对应，且每个
+    /// 属性都是4字节；小端主机上整个缓冲区只需一次写入。
+    template <typename PointT>
+    static void DumpBinary(std::ostream &out, const PointT *begin, const PointT *end) {
+      DEBUG_ASSERT(begin <= end);
+      const size_t count = static_cast<size_t>(end - begin);
+      WriteTypedHeader<PointT>(out, "ply", "binary_little_endian 1.0", count);
+      WriteLittleEndian(out, begin, count * WordsPerPoint<PointT>());
+    }
+
+    /// 以分块压缩的格式写出连续存储的点云，结果是无损的。
+    ///
+    /// 文件以与 PLY 相同结构的文本头开始（首行为 "carla_point_cloud"），之后
+    /// 是若干个块，每块最多 COMPRESSED_CHUNK_SIZE 个点：
+    ///
+    ///   uint32 点数 | uint32 数据字节数 | 数据
+    ///
+    /// 块内按属性分列，每列与前一个点的同一属性按位异或后拆成4个字节平面，
+    /// 再对零字节做游程编码。相邻的激光点大多相近，异或后的高位字节几乎全为零。
+    /// 所有整数均为小端，各块可以独立解码。
+    template <typename PointT>
+    static void DumpCompressed(std::ostream &out, const PointT *begin, const PointT *end) {
+      DEBUG_ASSERT(begin <= end);
+      const size_t count = static_cast<size_t>(end - begin);
+      WriteTypedHeader<PointT>(out, COMPRESSED_MAGIC, COMPRESSED_FORMAT, count);
+      WriteCompressedChunks(out, begin, count, WordsPerPoint<PointT>());
+    }
+
+    /// 读取 DumpCompressed 写出的点云，文件头中的属性必须与 @a PointT 一致。
+    ///
+    /// @throw std::runtime_error 如果文件头不匹配或数据已损坏。
+    template <typename PointT>
+    static std::vector<PointT> LoadCompressed(std::istream &in) {
+      std::ostringstream properties;
+      PointT().WritePlyHeaderInfo(properties);
+      const size_t count = ReadCompressedHeader(
+          in, properties.str(), WordsPerPoint<PointT>() * sizeof(uint32_t));
+      std::vector<PointT> points(count);
+      ReadCompressedChunks(in, points.data(), count, WordsPerPoint<PointT>());
+      return points;
+    }
+
+    /// 按 @a format 将点云写入 @a out。二进制与压缩格式要求 @a begin 和
+    /// @a end 指向连续存储的点。
     template <typename PointIt>
-    static std::string SaveToDisk(std::string path, PointIt begin, PointIt end) {
-      // 验证文件路径是否以".ply"结尾，确保文件类型为PLY 
-      FileSystem::ValidateFilePath(path, ".ply");
-      // 创建输出文件流对象，并打开文件
-      std::ofstream out(path);
-      // 调用Dump函数，将点云数据写入到文件中
-      Dump(out, begin, end);
+    static void Dump(std::ostream &out, PointIt begin, PointIt end, Format format) {
+      if (format == Format::Ascii) {
+        Dump(out, begin, end);
+        return;
+      }
+      const auto *data = ToPointer(begin, end);
+      const auto *data_end = data + std::distance(begin, end);
+      if (format == Format::BinaryLittleEndian) {
+        DumpBinary(out, data, data_end);
+      } else {
+        DumpCompressed(out, data, data_end);
+      }
+    }
+
+    template <typename PointIt>
+    static std::string SaveToDisk(std::string path, PointIt begin, PointIt end, Format format = Format::Ascii) {
+      // 验证文件路径，没有扩展名时按格式补上".ply"或".cpc"
+      FileSystem::ValidateFilePath(path, GetExtension(format));
+      WriteFile(path, begin, end, format);
        // 返回文件路径
       return path;
     }
 
+    /// 与 SaveToDisk 相同，但先复制点云，再在后台线程写入文件。
+    ///
+    /// @a path 在调用时验证，补全扩展名后写回，调用者无需等待写入即可使用；
+    /// 写入时的异常保存在返回的 future 中。
+    template <typename PointIt>
+    static std::future<std::string> SaveToDiskAsync(
+        std::string &path,
+        PointIt begin,
+        PointIt end,
+        Format format = Format::Ascii) {
+      using PointT = typename std::iterator_traits<PointIt>::value_type;
+      FileSystem::ValidateFilePath(path, GetExtension(format));
+      auto points = std::make_shared<std::vector<PointT>>(begin, end);
+      return std::async(std::launch::async, [points, path, format]() {
+        WriteFile(path, points->data(), points->data() + points->size(), format);
+        return path;
+      });
+    }
+
   private:
+
+    static constexpr const char *COMPRESSED_MAGIC = "carla_point_cloud";
+
+    static constexpr const char *COMPRESSED_FORMAT = "chunked_xor_rle_little_endian 1.0";
+
+    template <typename PointIt>
+    static void WriteFile(const std::string &path, PointIt begin, PointIt end, Format format) {
+      // 创建输出文件流对象，并打开文件
+      std::ofstream out(path, format == Format::Ascii ?
+          std::ios::out :
+          std::ios::out | std::ios::binary);
+      // 调用Dump函数，将点云数据写入到文件中
+      Dump(out, begin, end, format);
+      out.close();
+      if (!out) {
+        throw_exception(std::runtime_error(path + ": failed to write point cloud"));
+      }
+    }
+
+    /// 每个点包含的4字节属性个数。
+    template <typename PointT>
+    static constexpr size_t WordsPerPoint() {
+      static_assert(
+          std::is_trivially_copyable<PointT>::value,
+          "point type must be trivially copyable");
+      static_assert(
+          sizeof(PointT) % sizeof(uint32_t) == 0u,
+          "point properties must be 4-byte values");
+      return sizeof(PointT) / sizeof(uint32_t);
+    }
+
+    /// 连续存储的点云的首地址，空范围时为 nullptr。
+    template <typename PointIt>
+    static auto ToPointer(PointIt begin, PointIt end) -> decltype(std::addressof(*begin)) {
+      return begin == end ? nullptr : std::addressof(*begin);
+    }
+
+    template <typename PointT>
+    static void WriteTypedHeader(
+        std::ostream &out,
+        const char *magic,
+        const char *format,
+        size_t count) {
+      out << magic << "\n"
+             "format " << format << "\n"
+             "element vertex " << count << "\n";
+      PointT().WritePlyHeaderInfo(out);
+      out << "\nend_header\n";
+    }
+
     template <typename PointIt> static void WriteHeader(std::ostream &out, PointIt begin, PointIt end) {
       // 断言确保点云数据的数量非负
       DEBUG_ASSERT(std::distance(begin, end) >= 0);
@@ -57,13 +216,35 @@ namespace pointcloud {// 定义命名空间pointcloud，进一步组织特定于
            "format ascii 1.0\n"
            // 写入元素(vertex)的数量，即点云中的点数
            "element vertex " << std::to_string(static_cast<size_t>(std::distance(begin, end))) << "\n";
-      // 假设每个点对象都有WritePlyHeaderInfo方法，用于写入特定的头部信息      
+      // 假设每个点对象都有WritePlyHeaderInfo方法，用于写入特定的头部信息
       begin->WritePlyHeaderInfo(out);
       // 写入PLY文件头部的结束标志
       out << "\nend_header\n";
-      // 设置输出流的格式，固定小数点后4位 
+      // 设置输出流的格式，固定小数点后4位
       out << std::fixed << std::setprecision(4u);
     }
+
+    /// 以小端字节序写出 @a word_count 个4字节值。
+    static void WriteLittleEndian(std::ostream &out, const void *data, size_t word_count);
+
+    static void WriteCompressedChunks(
+        std::ostream &out,
+        const void *data,
+        size_t point_count,
+        size_t words_per_point);
+
+    /// 读取并检查压缩格式的文件头，返回点数。@a in 可以定位时还会检查点数
+    /// 是否超出剩余的输入所能容纳的上限。
+    static size_t ReadCompressedHeader(
+        std::istream &in,
+        const std::string &properties,
+        size_t point_size);
+
+    static void ReadCompressedChunks(
+        std::istream &in,
+        void *data,
+        size_t point_count,
+        size_t words_per_point);
   };
 
 } // namespace pointcloud
@@ -17,6 +17,7 @@ namespace carla {   // carla 命名空间
 namespace road {  // road 命名空间
 
   class MapBuilder;   // 前向声明 MapBuilder 类
+  class MapSnapshot;  // 前向声明 MapSnapshot 类
 
   class Controller : private MovableNonCopyable {  // 定义 Controller 类，继承自不可拷贝类
 
@@ -53,6 +54,7 @@ namespace road {  // road 命名空间
   private:
 
     friend MapBuilder;  // 声明 MapBuilder 为友元类
+    friend MapSnapshot;  // 声明 MapSnapshot 为友元类
 
     ContId _id;   // 控制器 ID
     std::string _name;  // 控制器名称
@@ -0,0 +1,82 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/InformationSet.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace road {
+
+namespace {
+
+  /// 通过访问者得到道路信息在类型索引中的位置。
+  class TypeIndexVisitor final : public element::RoadInfoVisitor {
+  public:
+
+    size_t index = detail::ROAD_INFO_TYPE_COUNT;
+
+    void Visit(element::RoadInfoCrosswalk &) override { Set<element::RoadInfoCrosswalk>(); }
+    void Visit(element::RoadInfoElevation &) override { Set<element::RoadInfoElevation>(); }
+    void Visit(element::RoadInfoGeometry &) override { Set<element::RoadInfoGeometry>(); }
+    void Visit(element::RoadInfoLaneAccess &) override { Set<element::RoadInfoLaneAccess>(); }
+    void Visit(element::RoadInfoLaneBorder &) override { Set<element::RoadInfoLaneBorder>(); }
+    void Visit(element::RoadInfoLaneHeight &) override { Set<element::RoadInfoLaneHeight>(); }
+    void Visit(element::RoadInfoLaneMaterial &) override { Set<element::RoadInfoLaneMaterial>(); }
+    void Visit(element::RoadInfoLaneOffset &) override { Set<element::RoadInfoLaneOffset>(); }
+    void Visit(element::RoadInfoLaneRule &) override { Set<element::RoadInfoLaneRule>(); }
+    void Visit(element::RoadInfoLaneVisibility &) override { Set<element::RoadInfoLaneVisibility>(); }
+    void Visit(element::RoadInfoLaneWidth &) override { Set<element::RoadInfoLaneWidth>(); }
+    void Visit(element::RoadInfoMarkRecord &) override { Set<element::RoadInfoMarkRecord>(); }
+    void Visit(element::RoadInfoMarkTypeLine &) override { Set<element::RoadInfoMarkTypeLine>(); }
+    void Visit(element::RoadInfoSignal &) override { Set<element::RoadInfoSignal>(); }
+    void Visit(element::RoadInfoSpeed &) override { Set<element::RoadInfoSpeed>(); }
+
+  private:
+
+    template <typename T>
+    void Set() {
+      index = detail::RoadInfoTypeIndex<T>::value;
+    }
+  };
+
+} // namespace
+
+  InformationSet::InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec)
+    : _road_set(std::move(vec)) {
+    const auto &infos = _road_set.GetAll();
+
+    // 计数排序：按类型分组，组内保持 _road_set 中按s排序的顺序
+    std::vector<size_t> indices;
+    indices.reserve(infos.size());
+    std::array<uint32_t, detail::ROAD_INFO_TYPE_COUNT + 1u> counts {};
+    for (const auto &info : infos) {
+      DEBUG_ASSERT(info != nullptr);
+      TypeIndexVisitor visitor;
+      info->AcceptVisitor(visitor);
+      indices.emplace_back(visitor.index);
+      ++counts[visitor.index];
+    }
+
+    uint32_t offset = 0u;
+    for (size_t type = 0u; type < detail::ROAD_INFO_TYPE_COUNT; ++type) {
+      _type_offsets[type] = offset;
+      offset += counts[type];
+    }
+    _type_offsets[detail::ROAD_INFO_TYPE_COUNT] = offset;
+
+    // 不在类型索引中的信息只保存在 _road_set 中
+    _by_type.resize(offset);
+    auto cursors = _type_offsets;
+    for (size_t i = 0u; i < infos.size(); ++i) {
+      if (indices[i] < detail::ROAD_INFO_TYPE_COUNT) {
+        _by_type[cursors[indices[i]]++] = infos[i].get();
+      }
+    }
+  }
+
+} // namespace road
+} // namespace carla
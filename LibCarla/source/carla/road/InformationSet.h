@@ -10,54 +10,96 @@
 #include "carla/road/RoadElementSet.h" // 引入道路元素集合的头文件
 #include "carla/road/element/RoadInfo.h" // 引入道路信息元素的头文件
 #include "carla/road/element/RoadInfoIterator.h" // 引入道路信息迭代器的头文件
+#include "carla/road/element/RoadInfoVisitor.h" // 引入道路信息类型的前向声明
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 #include <vector> // 引入向量的头文件
 #include <memory> // 引入智能指针的头文件
 
 namespace carla { // carla命名空间
 namespace road { // road命名空间
+namespace detail {
 
+  /// 各道路信息类型在 InformationSet 类型索引中的位置。未列出的类型不能用于查询。
+  template <typename T>
+  struct RoadInfoTypeIndex;
+
+  template <> struct RoadInfoTypeIndex<element::RoadInfoCrosswalk> : std::integral_constant<size_t, 0u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoElevation> : std::integral_constant<size_t, 1u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoGeometry> : std::integral_constant<size_t, 2u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneAccess> : std::integral_constant<size_t, 3u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneBorder> : std::integral_constant<size_t, 4u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneHeight> : std::integral_constant<size_t, 5u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneMaterial> : std::integral_constant<size_t, 6u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneOffset> : std::integral_constant<size_t, 7u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneRule> : std::integral_constant<size_t, 8u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneVisibility> : std::integral_constant<size_t, 9u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoLaneWidth> : std::integral_constant<size_t, 10u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoMarkRecord> : std::integral_constant<size_t, 11u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoMarkTypeLine> : std::integral_constant<size_t, 12u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoSignal> : std::integral_constant<size_t, 13u> {};
+  template <> struct RoadInfoTypeIndex<element::RoadInfoSpeed> : std::integral_constant<size_t, 14u> {};
+
+  /// 类型索引中的类型数量。
+  constexpr size_t ROAD_INFO_TYPE_COUNT = 15u;
+
+} // namespace detail
+
+  /// 道路或车道上的全部信息。除了按距离s排序的全部信息外，还保存按类型分组、
+  /// 组内按s排序的索引，查询某一类型的信息时只需在该类型中二分查找，
+  /// 不必逐个访问其他类型的信息。
   class InformationSet : private MovableNonCopyable { // 信息集合类，继承自不可拷贝类
   public:
 
     InformationSet() = default; // 默认构造函数
 
-    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec) // 接受右值向量构造函数
-      : _road_set(std::move(vec)) {} // 移动初始化道路元素集合
+    InformationSet(std::vector<std::unique_ptr<element::RoadInfo>> &&vec); // 接受右值向量构造函数，同时建立类型索引
+
+    /// 返回按距离s排序的所有信息
+    const std::vector<std::unique_ptr<element::RoadInfo>> &GetAll() const {
+      return _road_set.GetAll();
+    }
 
     /// 返回从道路起点给定类型的所有信息
     template <typename T>
     std::vector<const T *> GetInfos() const { // 模板函数，获取指定类型的信息
+      const auto range = GetRange<T>();
       std::vector<const T *> vec; // 创建一个存储指针的向量
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetAll()); // 创建道路信息迭代器
-      for (; !it.IsAtEnd(); ++it) { // 遍历迭代器
-        vec.emplace_back(&*it); // 添加迭代器当前指向的元素指针到向量
+      vec.reserve(static_cast<size_t>(range.second - range.first));
+      for (auto it = range.first; it != range.second; ++it) {
+        vec.emplace_back(static_cast<const T *>(*it));
       }
       return vec; // 返回信息向量
     }
 
-    /// 返回给定类型和距离s的单一信息
+    /// 返回给定类型中距离不大于s的最后一个信息
     template <typename T>
     const T *GetInfo(const double s) const { // 模板函数，获取指定距离的信息
-      auto it = element::MakeRoadInfoIterator<T>(_road_set.GetReverseSubset(s)); // 创建反向迭代器
-      return it.IsAtEnd() ? nullptr : &*it; // 如果迭代器到达末尾，返回nullptr，否则返回当前元素的指针
+      const auto range = GetRange<T>();
+      const auto it = std::upper_bound(range.first, range.second, s, LessDistance());
+      return it == range.first ? nullptr : static_cast<const T *>(*(it - 1)); // 没有满足条件的信息时返回nullptr
     }
 
-    /// 返回在指定范围内给定类型的所有信息
+    /// 返回在指定范围内给定类型的所有信息，min_s 大于 max_s 时按s递减的顺序返回
     template <typename T>
     std::vector<const T *> GetInfos(const double min_s, const double max_s) const { // 模板函数，获取指定范围的信息
+      const auto range = GetRange<T>();
       std::vector<const T *> vec; // 创建一个存储指针的向量
       if(min_s < max_s) { // 如果最小值小于最大值
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetSubsetInRange(min_s, max_s)); // 创建范围内迭代器
-        for (; !it.IsAtEnd(); ++it) { // 遍历迭代器
-          vec.emplace_back(&*it); // 添加当前元素指针到向量
+        const auto low = std::lower_bound(range.first, range.second, min_s, LessDistance());
+        const auto up = std::upper_bound(low, range.second, max_s, LessDistance());
+        for (auto it = low; it != up; ++it) {
+          vec.emplace_back(static_cast<const T *>(*it)); // 添加当前元素指针到向量
         }
       } else { // 如果最小值大于等于最大值
-        auto it = element::MakeRoadInfoIterator<T>(
-            _road_set.GetReverseSubsetInRange(max_s, min_s)); // 创建反向范围迭代器
-        for (; !it.IsAtEnd(); ++it) { // 遍历迭代器
-          vec.emplace_back(&*it); // 添加当前元素指针到向量
+        const auto low = std::lower_bound(range.first, range.second, max_s, LessDistance());
+        const auto up = std::upper_bound(low, range.second, min_s, LessDistance());
+        for (auto it = up; it != low; --it) {
+          vec.emplace_back(static_cast<const T *>(*(it - 1))); // 反向添加元素指针到向量
         }
       }
       return vec; // 返回信息向量
@@ -65,8 +107,35 @@ namespace road { // road命名空间
 
   private:
 
+    using IndexIterator = std::vector<const element::RoadInfo *>::const_iterator;
+
+    /// 比较信息的距离s，可与 double 混合比较
+    struct LessDistance {
+      bool operator()(const element::RoadInfo *lhs, double rhs) const {
+        return lhs->GetDistance() < rhs;
+      }
+      bool operator()(double lhs, const element::RoadInfo *rhs) const {
+        return lhs < rhs->GetDistance();
+      }
+    };
+
+    /// 返回类型 T 的信息在 _by_type 中的范围
+    template <typename T>
+    std::pair<IndexIterator, IndexIterator> GetRange() const {
+      constexpr size_t index = detail::RoadInfoTypeIndex<T>::value;
+      return std::make_pair(
+          _by_type.begin() + _type_offsets[index],
+          _by_type.begin() + _type_offsets[index + 1u]);
+    }
+
     RoadElementSet<std::unique_ptr<element::RoadInfo>> _road_set; // 私有成员，存储道路元素集合
+
+    /// 按类型分组、组内按s排序的信息，指向 _road_set 中的元素
+    std::vector<const element::RoadInfo *> _by_type;
+
+    /// 每种类型在 _by_type 中的起始位置，最后一项为索引中的信息总数
+    std::array<uint32_t, detail::ROAD_INFO_TYPE_COUNT + 1u> _type_offsets {};
   };
 
 } // road
-} // carla
\ No newline at end of file
+} // carla
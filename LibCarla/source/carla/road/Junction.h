@@ -19,6 +19,7 @@ namespace carla {  // 定义carla命名空间
 namespace road {  // 定义road命名空间
 
   class MapBuilder;  // 前向声明MapBuilder类
+  class MapSnapshot;  // 前向声明MapSnapshot类
 
   // 定义Junction类，表示交叉口
   class Junction : private MovableNonCopyable {
@@ -103,6 +104,7 @@ namespace road {  // 定义road命名空间
   private:
 
     friend MapBuilder;  // 声明MapBuilder为友元类，可以访问私有成员
+    friend MapSnapshot;  // 声明MapSnapshot为友元类，可以访问私有成员
 
     JuncId _id;  // 交叉口ID
 
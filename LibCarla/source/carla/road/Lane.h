@@ -20,6 +20,7 @@ namespace road { // 定义road命名空间
 
   class LaneSection; // 前向声明LaneSection类
   class MapBuilder; // 前向声明MapBuilder类
+  class MapSnapshot; // 前向声明MapSnapshot类
   class Road; // 前向声明Road类
 
   class Lane : private MovableNonCopyable { // 定义Lane类，继承自MovableNonCopyable
@@ -87,6 +88,10 @@ namespace road { // 定义road命名空间
       return _info.GetInfos<T>(); // 返回所有指定类型的信息
     }
 
+    const std::vector<std::unique_ptr<element::RoadInfo>> &GetAllInfos() const { // 获取按s排序的全部信息，不区分类型
+      return _info.GetAll();
+    }
+
     const std::vector<Lane *> &GetNextLanes() const { // 获取下一车道的引用
       return _next_lanes; // 返回下一车道列表
     }
@@ -122,6 +127,7 @@ namespace road { // 定义road命名空间
   private:
 
     friend MapBuilder; // 友元类：MapBuilder
+    friend MapSnapshot; // 友元类：MapSnapshot
 
     LaneSection *_lane_section = nullptr; // 车道段指针
 
@@ -20,6 +20,7 @@ namespace road {
 
   class Road;            // 前向声明 Road 类
   class MapBuilder;      // 前向声明 MapBuilder 类
+  class MapSnapshot;     // 前向声明 MapSnapshot 类
 
   class LaneSection : private MovableNonCopyable { // LaneSection 类继承非拷贝行为
   public:
@@ -51,6 +52,7 @@ namespace road {
   private:
 
     friend MapBuilder; // 允许 MapBuilder 访问私有成员
+    friend MapSnapshot; // 允许 MapSnapshot 访问私有成员
 
     const SectionId _id = 0u; // 车道节段的唯一标识符
 
@@ -22,13 +22,19 @@
 
 #include "marchingcube/MeshReconstruction.h" // 导入网格重建的头文件
 
+#include <array> // 导入定长数组库
 #include <vector> // 导入向量库
 #include <unordered_map> // 导入无序映射库
 #include <stdexcept> // 导入标准异常库
 #include <chrono> // 导入时间相关库
 #include <thread> // 导入线程相关库
+#include <exception> // 导入异常指针相关库
+#include <atomic> // 导入原子操作库
+#include <algorithm> // 导入算法库
+#include <iterator> // 导入迭代器库
 #include <iomanip> // 导入格式化输入输出库
 #include <cmath> // 导入数学库
+#include <tuple> // 导入元组库
 
 namespace carla {
 namespace road {
@@ -73,6 +79,49 @@ namespace road {
     }
   }
 
+  // 相邻车道能否转换为路点，不能转换的车道在查询时才报错
+  static bool IsValidAdjacentLane(const Lane *lane) {
+    return lane != nullptr &&
+        lane->GetId() != 0 &&
+        lane->GetLaneSection() != nullptr &&
+        lane->GetRoad() != nullptr;
+  }
+
+  // 返回相邻车道入口（@a at_start 为 true）或出口处的路点
+  static std::vector<Waypoint> GetAdjacentWaypoints(
+      const std::vector<Lane *> &lanes,
+      const bool at_start) {
+    std::vector<Waypoint> result; // 存储结果
+    result.reserve(lanes.size()); // 预留空间
+    for (auto *next_lane : lanes) { // 遍历每个相邻车道
+      RELEASE_ASSERT(next_lane != nullptr); // 确保车道不为空
+      const auto lane_id = next_lane->GetId(); // 获取车道ID
+      RELEASE_ASSERT(lane_id != 0); // 确保车道ID有效
+      const auto *section = next_lane->GetLaneSection(); // 获取车道段
+      RELEASE_ASSERT(section != nullptr); // 确保车道段不为空
+      const auto *road = next_lane->GetRoad(); // 获取道路
+      RELEASE_ASSERT(road != nullptr); // 确保道路不为空
+      const auto distance = at_start ?
+          GetDistanceAtStartOfLane(*next_lane) :
+          GetDistanceAtEndOfLane(*next_lane); // 获取车道入口或出口处的距离
+      result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance}); // 添加航点到结果中
+    }
+    return result;
+  }
+
+  // 先写入栈上的小缓冲区，只有结果较多时才按实际数量重新收集
+  template <typename CollectT>
+  static std::vector<Waypoint> CollectToVector(CollectT &&collect) {
+    std::array<Waypoint, 16u> buffer;
+    const size_t count = collect(buffer.data(), buffer.size());
+    if (count <= buffer.size()) {
+      return std::vector<Waypoint>(buffer.begin(), buffer.begin() + count);
+    }
+    std::vector<Waypoint> result(count);
+    collect(result.data(), result.size());
+    return result;
+  }
+
   /// 返回每个可行驶车道的路径点 @a lane_section.
   template <typename FuncT>
   static void ForEachDrivableLaneImpl(
@@ -161,6 +210,68 @@ static bool IsLanePresent(const MapData &data, Waypoint waypoint) {
     return section.ContainsLane(waypoint.lane_id); // 检查车道是否存在
 }
 
+/// 在多个线程中对 [0, count) 的每个索引调用 func。各线程动态领取下一个索引，
+/// 工作量不均匀（例如长短不一的道路）时也能均衡负载。工作线程中抛出的
+/// 第一个异常会在调用线程中重新抛出。@a max_threads 为0时最多使用硬件线程数。
+template <typename FuncT>
+static void ParallelFor(const size_t count, FuncT &&func, size_t max_threads = 0u) {
+    if (max_threads == 0u) {
+        max_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const size_t number_of_threads = std::min(max_threads, count);
+    std::atomic_size_t next{0u};
+    std::vector<std::exception_ptr> errors(number_of_threads);
+    auto work = [&](const size_t thread_index) {
+        try {
+            for (size_t i = next++; i < count; i = next++) {
+                func(i);
+            }
+        } catch (...) {
+            errors[thread_index] = std::current_exception();
+            next = count; // 让其他线程尽快结束
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1u; i < number_of_threads; ++i) {
+        workers.emplace_back(work, i);
+    }
+    if (number_of_threads > 0u) {
+        work(0u); // 当前线程也参与计算
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    for (auto &error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/// 生成交叉口内所有连接道路的车道网格。@a sidewalk_meshes 不为空时，人行道
+/// 车道单独放入其中。
+static void GenerateJunctionLaneMeshes(
+    const geom::MeshFactory &mesh_factory,
+    const MapData &data,
+    const Junction &junction,
+    std::vector<std::unique_ptr<geom::Mesh>> &lane_meshes,
+    std::vector<std::unique_ptr<geom::Mesh>> *sidewalk_meshes = nullptr) {
+    for (const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
+        const auto &connection = connection_pair.second; // 获取连接信息
+        const auto &road = data.GetRoads().at(connection.connecting_road); // 获取连接的道路
+        for (auto &&lane_section : road.GetLaneSections()) { // 遍历道路的车道段
+            for (auto &&lane_pair : lane_section.GetLanes()) { // 遍历车道
+                const auto &lane = lane_pair.second; // 获取当前车道
+                if (sidewalk_meshes != nullptr && lane.GetType() == road::Lane::LaneType::Sidewalk) {
+                    sidewalk_meshes->push_back(mesh_factory.Generate(lane)); // 生成人行道网格并添加
+                } else {
+                    lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成车道网格并添加
+                }
+            }
+        }
+    }
+}
+
 // ===========================================================================
 // -- 地图: 几何 -------------------------------------------------------------
 // ===========================================================================
@@ -233,6 +344,31 @@ boost::optional<Waypoint> Map::GetWaypoint(
     return boost::optional<Waypoint>{}; // 否则返回空
 }
 
+std::vector<boost::optional<Waypoint>> Map::GetWaypointBatch(
+    const geom::Location *locations,
+    const size_t count,
+    const bool project_to_road,
+    const int32_t lane_type,
+    const size_t number_of_threads) const {
+    std::vector<boost::optional<Waypoint>> result(count);
+
+    // 各线程每次领取一批位置，点数较少时避免线程创建的开销超过查询本身
+    constexpr size_t locations_per_block = 1024u;
+    const size_t number_of_blocks = (count + locations_per_block - 1u) / locations_per_block;
+
+    // R树与地图数据在查询时都是只读的，各线程只写入各自领取的结果区间
+    ParallelFor(number_of_blocks, [&](const size_t block) {
+        const size_t begin = block * locations_per_block;
+        const size_t end = std::min(count, begin + locations_per_block);
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = project_to_road ?
+                GetClosestWaypointOnRoad(locations[i], lane_type) :
+                GetWaypoint(locations[i], lane_type);
+        }
+    }, number_of_threads);
+    return result;
+}
+
 boost::optional<Waypoint> Map::GetWaypoint(
     RoadId road_id,
     LaneId lane_id,
@@ -272,6 +408,7 @@ if (!lane_found) { // 如果没有找到车道
 }
 
 return waypoint; // 返回找到的Waypoint
+}
 
 // ===========================================================================
 // -- Map: 地图信息 -----------------------------------------------------------
@@ -519,85 +656,73 @@ std::vector<geom::Location> Map::GetAllCrosswalkZones() const {
 // ===========================================================================
 
 std::vector<Waypoint> Map::GetSuccessors(const Waypoint waypoint) const {
-    const auto &next_lanes = GetLane(waypoint).GetNextLanes(); // 获取下一个车道
-    std::vector<Waypoint> result; // 存储结果
-    result.reserve(next_lanes.size()); // 预留空间
-    for (auto *next_lane : next_lanes) { // 遍历每个下一个车道
-        RELEASE_ASSERT(next_lane != nullptr); // 确保车道不为空
-        const auto lane_id = next_lane->GetId(); // 获取车道ID
-        RELEASE_ASSERT(lane_id != 0); // 确保车道ID有效
-        const auto *section = next_lane->GetLaneSection(); // 获取车道段
-        RELEASE_ASSERT(section != nullptr); // 确保车道段不为空
-        const auto *road = next_lane->GetRoad(); // 获取道路
-        RELEASE_ASSERT(road != nullptr); // 确保道路不为空
-        const auto distance = GetDistanceAtStartOfLane(*next_lane); // 获取下一个车道起始位置的距离
-        result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance}); // 添加航点到结果中
-    }
-    return result; // 返回下一个航点
+    const auto &lane = GetLane(waypoint); // 获取当前车道
+    const Waypoint *begin = nullptr;
+    const Waypoint *end = nullptr;
+    if (GetLaneEnds(lane, false, begin, end)) { // 优先使用预先计算的邻接表
+      return {begin, end};
+    }
+    return GetAdjacentWaypoints(lane.GetNextLanes(), true); // 返回下一个航点
 }
 
 std::vector<Waypoint> Map::GetPredecessors(const Waypoint waypoint) const {
-    const auto &prev_lanes = GetLane(waypoint).GetPreviousLanes(); // 获取前一个车道
-    std::vector<Waypoint> result; // 存储结果
-    result.reserve(prev_lanes.size()); // 预留空间
-    for (auto *next_lane : prev_lanes) { // 遍历每个前一个车道
-        RELEASE_ASSERT(next_lane != nullptr); // 确保车道不为空
-        const auto lane_id = next_lane->GetId(); // 获取车道ID
-        RELEASE_ASSERT(lane_id != 0); // 确保车道ID有效
-        const auto *section = next_lane->GetLaneSection(); // 获取车道段
-        RELEASE_ASSERT(section != nullptr); // 确保车道段不为空
-        const auto *road = next_lane->GetRoad(); // 获取道路
-        RELEASE_ASSERT(road != nullptr); // 确保道路不为空
-        const auto distance = GetDistanceAtEndOfLane(*next_lane); // 获取前一个车道末端位置的距离
-        result.emplace_back(Waypoint{road->GetId(), section->GetId(), lane_id, distance}); // 添加航点到结果中
-    }
-    return result; // 返回前一个航点
+    const auto &lane = GetLane(waypoint); // 获取当前车道
+    const Waypoint *begin = nullptr;
+    const Waypoint *end = nullptr;
+    if (GetLaneEnds(lane, true, begin, end)) { // 优先使用预先计算的邻接表
+      return {begin, end};
+    }
+    return GetAdjacentWaypoints(lane.GetPreviousLanes(), false); // 返回前一个航点
 }
 
 std::vector<Waypoint> Map::GetNext(
       const Waypoint waypoint,
       const double distance) const {
-    RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
-    if (distance <= EPSILON) { // 如果距离很小（近似为0）
-      return {waypoint}; // 返回当前的waypoint
-    }
-    const auto &lane = GetLane(waypoint); // 获取当前waypoint所在的车道
-    const bool forward = (waypoint.lane_id <= 0); // 判断移动方向（正向或反向）
-    const double signed_distance = forward ? distance : -distance; // 根据方向确定带符号的距离
-    const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对位置s
-    const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s; // 剩余车道长度
-    DEBUG_ASSERT(remaining_lane_length >= 0.0); // 确保剩余车道长度非负
-
-    // 如果在同一车道内，返回增加了距离的waypoint
-    if (distance <= remaining_lane_length) {
-      Waypoint result = waypoint; // 创建结果waypoint
-      result.s += signed_distance; // 更新s值
-      result.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
-      RELEASE_ASSERT(result.s > 0.0); // 确保s值大于0
-      return { result }; // 返回结果
-    }
-
-    // 如果没有剩余车道长度，则需要转到后继节点
-    std::vector<Waypoint> result; // 存储结果的vector
-    for (const auto &successor : GetSuccessors(waypoint)) { // 遍历所有后继waypoints
-      DEBUG_ASSERT(
-          successor.road_id != waypoint.road_id || // 确保不在同一路段
-          successor.section_id != waypoint.section_id || // 确保不在同一部分
-          successor.lane_id != waypoint.lane_id); // 确保不在同一车道
-      result = ConcatVectors(result, GetNext(successor, distance - remaining_lane_length)); // 递归获取下一个waypoint
-    }
-    return result; // 返回所有找到的waypoints
+    return CollectToVector([&](Waypoint *buffer, size_t capacity) {
+      return CollectNext(waypoint, distance, false, buffer, capacity);
+    });
   }
 
   std::vector<Waypoint> Map::GetPrevious(
       const Waypoint waypoint,
       const double distance) const {
+    return CollectToVector([&](Waypoint *buffer, size_t capacity) {
+      return CollectNext(waypoint, distance, true, buffer, capacity);
+    });
+  }
+
+  size_t Map::GetNext(
+      const Waypoint waypoint,
+      const double distance,
+      Waypoint *buffer,
+      const size_t capacity) const {
+    return CollectNext(waypoint, distance, false, buffer, capacity);
+  }
+
+  size_t Map::GetPrevious(
+      const Waypoint waypoint,
+      const double distance,
+      Waypoint *buffer,
+      const size_t capacity) const {
+    return CollectNext(waypoint, distance, true, buffer, capacity);
+  }
+
+  size_t Map::CollectNext(
+      const Waypoint waypoint,
+      const double distance,
+      const bool reverse,
+      Waypoint *buffer,
+      const size_t capacity) const {
     RELEASE_ASSERT(distance > 0.0); // 确保距离大于0
     if (distance <= EPSILON) { // 如果距离很小（近似为0）
-      return {waypoint}; // 返回当前的waypoint
+      if (capacity > 0u) {
+        buffer[0] = waypoint; // 返回当前的waypoint
+      }
+      return 1u;
     }
     const auto &lane = GetLane(waypoint); // 获取当前waypoint所在的车道
-    const bool forward = !(waypoint.lane_id <= 0); // 判断移动方向（正向或反向）
+    // 判断移动方向，GetNext 沿车道方向移动，GetPrevious 逆车道方向移动
+    const bool forward = reverse ? (waypoint.lane_id > 0) : (waypoint.lane_id <= 0);
     const double signed_distance = forward ? distance : -distance; // 根据方向确定带符号的距离
     const double relative_s = waypoint.s - lane.GetDistance(); // 计算相对位置s
     const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s; // 剩余车道长度
@@ -609,19 +734,88 @@ std::vector<Waypoint> Map::GetNext(
       result.s += signed_distance; // 更新s值
       result.s += forward ? -EPSILON : EPSILON; // 调整s值以避免浮点数精度问题
       RELEASE_ASSERT(result.s > 0.0); // 确保s值大于0
-      return { result }; // 返回结果
+      if (capacity > 0u) {
+        buffer[0] = result;
+      }
+      return 1u;
     }
 
-    // 如果没有剩余车道长度，则需要转到前驱节点
-    std::vector<Waypoint> result; // 存储结果的vector
-    for (const auto &successor : GetPredecessors(waypoint)) { // 遍历所有前驱waypoints
+    // 如果没有剩余车道长度，则需要转到后继（或前驱）节点
+    const Waypoint *begin = nullptr;
+    const Waypoint *end = nullptr;
+    std::vector<Waypoint> adjacent;
+    if (!GetLaneEnds(lane, reverse, begin, end)) {
+      adjacent = reverse ? GetPredecessors(waypoint) : GetSuccessors(waypoint);
+      begin = adjacent.data();
+      end = begin + adjacent.size();
+    }
+    size_t count = 0u;
+    for (auto it = begin; it != end; ++it) { // 遍历所有相邻的waypoints
       DEBUG_ASSERT(
-          successor.road_id != waypoint.road_id || // 确保不在同一路段
-          successor.section_id != waypoint.section_id || // 确保不在同一部分
-          successor.lane_id != waypoint.lane_id); // 确保不在同一车道
-      result = ConcatVectors(result, GetPrevious(successor, distance - remaining_lane_length)); // 递归获取前一个waypoint
+          it->road_id != waypoint.road_id || // 确保不在同一路段
+          it->section_id != waypoint.section_id || // 确保不在同一部分
+          it->lane_id != waypoint.lane_id); // 确保不在同一车道
+      const size_t offset = std::min(count, capacity);
+      const size_t found = CollectNext(
+          *it,
+          distance - remaining_lane_length,
+          reverse,
+          buffer + offset,
+          capacity - offset); // 递归获取下一个waypoint
+      // 与 ConcatVectors 的合并顺序一致，较长的结果排在前面
+      if (found > count && count + found <= capacity) {
+        std::rotate(buffer, buffer + count, buffer + count + found);
+      }
+      count += found;
+    }
+    return count; // 返回找到的waypoints数量
+  }
+
+  void Map::CreateLaneEnds() {
+    _lane_ends.clear();
+    _lane_end_waypoints.clear();
+    for (const auto &road_pair : _data.GetRoads()) {
+      for (const auto &section : road_pair.second.GetLaneSections()) {
+        for (const auto &lane_pair : section.GetLanes()) {
+          const auto &lane = lane_pair.second;
+          const auto &next_lanes = lane.GetNextLanes();
+          const auto &prev_lanes = lane.GetPreviousLanes();
+          // 含有无效相邻车道的车道不放入邻接表，查询时仍按原方式计算并报错
+          if (!std::all_of(next_lanes.begin(), next_lanes.end(), IsValidAdjacentLane) ||
+              !std::all_of(prev_lanes.begin(), prev_lanes.end(), IsValidAdjacentLane)) {
+            continue;
+          }
+          LaneEnds ends;
+          ends.successors = static_cast<uint32_t>(_lane_end_waypoints.size());
+          for (auto &&waypoint : GetAdjacentWaypoints(next_lanes, true)) {
+            _lane_end_waypoints.emplace_back(waypoint);
+          }
+          ends.predecessors = static_cast<uint32_t>(_lane_end_waypoints.size());
+          for (auto &&waypoint : GetAdjacentWaypoints(prev_lanes, false)) {
+            _lane_end_waypoints.emplace_back(waypoint);
+          }
+          ends.end = static_cast<uint32_t>(_lane_end_waypoints.size());
+          _lane_ends.emplace(&lane, ends);
+        }
+      }
     }
-    return result; // 返回所有找到的waypoints
+    _lane_end_waypoints.shrink_to_fit();
+  }
+
+  bool Map::GetLaneEnds(
+      const Lane &lane,
+      const bool predecessors,
+      const Waypoint *&begin,
+      const Waypoint *&end) const {
+    const auto it = _lane_ends.find(&lane);
+    if (it == _lane_ends.end()) {
+      return false;
+    }
+    const auto *data = _lane_end_waypoints.data();
+    const auto &ends = it->second;
+    begin = data + (predecessors ? ends.predecessors : ends.successors);
+    end = data + (predecessors ? ends.end : ends.predecessors);
+    return true;
   }
 
   boost::optional<Waypoint> Map::GetRight(Waypoint waypoint) const {
@@ -844,7 +1038,7 @@ void Map::AddElementToRtree(
     geom::Transform &current_transform,               // 当前变换
     geom::Transform &next_transform,                  // 下一个变换
     Waypoint &current_waypoint,                       // 当前Waypoint
-    Waypoint &next_waypoint) {                        // 下一个Waypoint
+    Waypoint &next_waypoint) const {                  // 下一个Waypoint
     // 初始化点
     Rtree::BPoint init =
         Rtree::BPoint(
@@ -867,7 +1061,7 @@ void Map::AddElementToRtreeAndUpdateTransforms(
     std::vector<Rtree::TreeElement> &rtree_elements, // R树元素列表
     geom::Transform &current_transform,               // 当前变换
     Waypoint &current_waypoint,                       // 当前Waypoint
-    Waypoint &next_waypoint) {                        // 下一个Waypoint
+    Waypoint &next_waypoint) const {                  // 下一个Waypoint
     // 计算下一个Waypoint的变换
     geom::Transform next_transform = ComputeTransform(next_waypoint);
     // 添加元素到R树
@@ -891,6 +1085,28 @@ double GetRemainingLength(const Lane &lane, double current_s) {
 
 // 创建R树
 void Map::CreateRtree() {
+    // 将段按固定的顺序添加到R树
+    auto elements = ComputeRtreeElements();
+    SortRtreeElements(elements);
+    _rtree.InsertElements(elements);
+}
+
+void Map::SortRtreeElements(std::vector<Rtree::TreeElement> &elements) {
+    auto key = [](const Waypoint &waypoint) {
+        return std::make_tuple(waypoint.road_id, waypoint.section_id, waypoint.lane_id, waypoint.s);
+    };
+    std::sort(elements.begin(), elements.end(),
+        [&](const Rtree::TreeElement &lhs, const Rtree::TreeElement &rhs) {
+            const auto lhs_start = key(lhs.second.first);
+            const auto rhs_start = key(rhs.second.first);
+            if (lhs_start != rhs_start) {
+                return lhs_start < rhs_start;
+            }
+            return key(lhs.second.second) < key(rhs.second.second);
+        });
+}
+
+std::vector<Map::Rtree::TreeElement> Map::ComputeRtreeElements() const {
     const double epsilon = 0.000001; // 设置一个小的增量以防止数值误差
     const double min_delta_s = 1;    // 每个段的最小长度为1米
 
@@ -910,96 +1126,105 @@ void Map::CreateRtree() {
             }
         });
     }
-}
 
-// 段和路点的容器
-std::vector<Rtree::TreeElement> rtree_elements;
+    // 各车道的段互不依赖，在多个线程中分别生成，每条车道写入自己的容器
+    std::vector<std::vector<Rtree::TreeElement>> lane_elements(topology.size());
 
-// 遍历所有车道
-for (auto &waypoint : topology) {
-    auto &lane_start_waypoint = waypoint; // 车道起始路点
+    // 遍历所有车道
+    ParallelFor(topology.size(), [&](const size_t index) {
+        auto &rtree_elements = lane_elements[index]; // 当前车道的段容器
 
-    auto current_waypoint = lane_start_waypoint; // 当前路点
+        auto current_waypoint = topology[index]; // 当前路点，从车道起始路点开始
 
-    const Lane &lane = GetLane(current_waypoint); // 获取当前路点所在的车道
+        const Lane &lane = GetLane(current_waypoint); // 获取当前路点所在的车道
 
-    geom::Transform current_transform = ComputeTransform(current_waypoint); // 计算当前路点的变换
+        geom::Transform current_transform = ComputeTransform(current_waypoint); // 计算当前路点的变换
 
-    // 在直线段中节省计算时间
-    if (lane.IsStraight()) { // 如果车道是直的
-        double delta_s = min_delta_s; // 初始化增量距离
-        double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
-        remaining_length -= epsilon; // 减去一个小值以避免数值问题
-        delta_s = remaining_length; // 更新增量距离
-        if (delta_s < epsilon) { // 如果增量距离小于阈值
-            continue; // 跳过此轮
-        }
-        auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
-
-        RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
-        RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
-        auto next_waypoint = next.front(); // 下一个路点
-
-        AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
-            rtree_elements,
-            current_transform,
-            current_waypoint,
-            next_waypoint);
-        // 到达车道末尾
-    } else {
-        auto next_waypoint = current_waypoint; // 初始化下一个路点
-
-        // 循环直到车道末尾
-        // 按小的s增量前进
-        while (true) {
+        // 在直线段中节省计算时间
+        if (lane.IsStraight()) { // 如果车道是直的
             double delta_s = min_delta_s; // 初始化增量距离
-            double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
+            double remaining_length = GetRemainingLength(lane, current_waypoint.s); // 获取剩余长度
             remaining_length -= epsilon; // 减去一个小值以避免数值问题
-            delta_s = std::min(delta_s, remaining_length); // 更新增量距离
-
+            delta_s = remaining_length; // 更新增量距离
             if (delta_s < epsilon) { // 如果增量距离小于阈值
-                AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
-                    rtree_elements,
-                    current_transform,
-                    current_waypoint,
-                    next_waypoint);
-                break; // 退出循环
+                return; // 跳过此车道
             }
+            auto next = GetNext(current_waypoint, delta_s); // 获取下一个路点
+
+            RELEASE_ASSERT(next.size() == 1); // 确保下一个路点只有一个
+            RELEASE_ASSERT(next.front().road_id == current_waypoint.road_id); // 确保下一个路点在同一路段
+            auto next_waypoint = next.front(); // 下一个路点
+
+            AddElementToRtreeAndUpdateTransforms( // 添加元素到R树并更新变换
+                rtree_elements,
+                current_transform,
+                current_waypoint,
+                next_waypoint);
+            // 到达车道末尾
+        } else {
+            auto next_waypoint = current_waypoint; // 初始化下一个路点
+
+            // 循环直到车道末尾
+            // 按小的s增量前进
+            while (true) {
+                double delta_s = min_delta_s; // 初始化增量距离
+                double remaining_length = GetRemainingLength(lane, next_waypoint.s); // 获取剩余长度
+                remaining_length -= epsilon; // 减去一个小值以避免数值问题
+                delta_s = std::min(delta_s, remaining_length); // 更新增量距离
+
+                if (delta_s < epsilon) { // 如果增量距离小于阈值
+                    AddElementToRtreeAndUpdateTransforms( // 添加当前路点和下一个路点到R树
+                        rtree_elements,
+                        current_transform,
+                        current_waypoint,
+                        next_waypoint);
+                    break; // 退出循环
+                }
 
-            auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
-            if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
-                current_waypoint.section_id != next.front().section_id) {
-                AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
-                    rtree_elements,
-                    current_transform,
-                    current_waypoint,
-                    next_waypoint);
-                break; // 退出循环
-            }
+                auto next = GetNext(next_waypoint, delta_s); // 获取下一个路点
+                if (next.size() != 1 || // 如果下一个路点不止一个或在不同的区段
+                    current_waypoint.section_id != next.front().section_id) {
+                    AddElementToRtreeAndUpdateTransforms( // 添加当前和下一个路点到R树
+                        rtree_elements,
+                        current_transform,
+                        current_waypoint,
+                        next_waypoint);
+                    break; // 退出循环
+                }
 
-            next_waypoint = next.front(); // 更新下一个路点
-            geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
-            double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
-                current_transform.GetForwardVector(), next_transform.GetForwardVector());
-
-            if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
-                std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
-                AddElementToRtree( // 将当前和下一个路点的变换添加到R树
-                    rtree_elements,
-                    current_transform,
-                    next_transform,
-                    current_waypoint,
-                    next_waypoint);
-                current_waypoint = next_waypoint; // 更新当前路点
-                current_transform = next_transform; // 更新当前变换
+                next_waypoint = next.front(); // 更新下一个路点
+                geom::Transform next_transform = ComputeTransform(next_waypoint); // 计算下一个路点的变换
+                double angle = geom::Math::GetVectorAngle( // 获取当前和下一个路点的角度
+                    current_transform.GetForwardVector(), next_transform.GetForwardVector());
+
+                if (std::abs(angle) > angle_threshold || // 如果角度超过阈值
+                    std::abs(current_waypoint.s - next_waypoint.s) > max_segment_length) { // 或者距离超过最大段长度
+                    AddElementToRtree( // 将当前和下一个路点的变换添加到R树
+                        rtree_elements,
+                        current_transform,
+                        next_transform,
+                        current_waypoint,
+                        next_waypoint);
+                    current_waypoint = next_waypoint; // 更新当前路点
+                    current_transform = next_transform; // 更新当前变换
+                }
             }
         }
+    });
+
+    // 按车道顺序合并，保证插入顺序与串行生成时一致
+    size_t total_elements = 0u;
+    for (const auto &elements : lane_elements) {
+        total_elements += elements.size();
+    }
+    std::vector<Rtree::TreeElement> rtree_elements; // 段和路点的容器
+    rtree_elements.reserve(total_elements);
+    for (auto &elements : lane_elements) {
+        std::move(elements.begin(), elements.end(), std::back_inserter(rtree_elements));
     }
+    return rtree_elements;
 }
 
-// 将段添加到R树
-_rtree.InsertElements(rtree_elements);
-
 Junction* Map::GetJunction(JuncId id) { // 获取交叉口
     return _data.GetJunction(id); // 返回指定ID的交叉口
 }
@@ -1021,44 +1246,39 @@ geom::Mesh Map::GenerateMesh(
     mesh_factory.road_param.resolution = static_cast<float>(distance); // 设置分辨率为给定距离
     mesh_factory.road_param.extra_lane_width = extra_width; // 设置额外车道宽度
 
-    // 生成交叉口外的道路
+    // 先收集需要生成的道路和交叉口，按固定顺序生成后再合并，保证顶点顺序
+    // 与串行生成时一致
+    std::vector<const Road *> roads; // 交叉口外的道路
     for (auto &&pair : _data.GetRoads()) { // 遍历所有道路
-      const auto &road = pair.second; // 获取当前道路
-      if (road.IsJunction()) { // 如果是交叉口，跳过
-        continue; // 继续下一个循环
+      if (!pair.second.IsJunction()) { // 交叉口内的道路随交叉口一起生成
+        roads.emplace_back(&pair.second);
       }
-      out_mesh += *mesh_factory.Generate(road); // 生成网格并添加到输出网格中
+    }
+    std::vector<const Junction *> junctions; // 所有交叉口
+    for (const auto &junc_pair : _data.GetJunctions()) {
+      junctions.emplace_back(&junc_pair.second);
     }
 
-    // 生成交叉口内的道路并平滑处理
-    for (const auto &junc_pair : _data.GetJunctions()) { // 遍历所有交叉口
-      const auto &junction = junc_pair.second; // 获取当前交叉口
-      std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格的指针
-
-      // 遍历交叉口的连接
-      for(const auto &connection_pair : junction.GetConnections()) { // 遍历连接
-        const auto &connection = connection_pair.second; // 获取连接信息
-        const auto &road = _data.GetRoads().at(connection.connecting_road); // 获取连接的道路
-
-        // 遍历每个车道段的车道
-        for (auto &&lane_section : road.GetLaneSections()) { // 获取道路上的车道段
-          for (auto &&lane_pair : lane_section.GetLanes()) { // 遍历车道
-            lane_meshes.push_back(mesh_factory.Generate(lane_pair.second)); // 生成车道网格并添加到列表
-          }
-        }
+    // 每条道路、每个交叉口各自生成一个网格，并行执行
+    std::vector<std::unique_ptr<geom::Mesh>> meshes(roads.size() + junctions.size());
+    ParallelFor(meshes.size(), [&](const size_t i) {
+      if (i < roads.size()) {
+        meshes[i] = mesh_factory.Generate(*roads[i]); // 生成交叉口外的道路
+        return;
       }
-
-      // 如果需要平滑交叉口
-      if(smooth_junctions) {
-        out_mesh += *mesh_factory.MergeAndSmooth(lane_meshes); // 合并并平滑车道网格
+      // 生成交叉口内的道路并平滑处理
+      std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格的指针
+      GenerateJunctionLaneMeshes(mesh_factory, _data, *junctions[i - roads.size()], lane_meshes);
+      if (smooth_junctions) { // 如果需要平滑交叉口
+        meshes[i] = mesh_factory.MergeAndSmooth(lane_meshes); // 合并并平滑车道网格
       } else {
-        geom::Mesh junction_mesh; // 创建交叉口网格
-        for(auto& lane : lane_meshes) { // 遍历车道网格
-          junction_mesh += *lane; // 将车道网格添加到交叉口网格中
-        }
-        out_mesh += junction_mesh; // 将交叉口网格添加到输出网格
+        meshes[i] = std::make_unique<geom::Mesh>(); // 创建交叉口网格
+        meshes[i]->Append(lane_meshes); // 将车道网格添加到交叉口网格中
       }
-    }
+    });
+
+    // 一次性预留空间后按顺序合并
+    out_mesh.Append(meshes);
 
     return out_mesh; // 返回生成的网格
   }
@@ -1069,57 +1289,51 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
     geom::MeshFactory mesh_factory(params); // 创建一个网格工厂，用于生成网格
     std::vector<std::unique_ptr<geom::Mesh>> out_mesh_list; // 定义输出网格列表
 
-    std::unordered_map<JuncId, geom::Mesh> junction_map; // 定义用于存储交叉口网格的哈希映射
+    std::vector<const Road *> roads; // 交叉口外的道路
     for (auto &&pair : _data.GetRoads()) { // 遍历所有道路
-      const auto &road = pair.second; // 获取当前道路
-      if (!road.IsJunction()) { // 如果该道路不是交叉口
-        std::vector<std::unique_ptr<geom::Mesh>> road_mesh_list =
-            mesh_factory.GenerateAllWithMaxLen(road); // 生成道路的所有网格
-
-        // 将生成的道路网格添加到输出网格列表中
-        out_mesh_list.insert(
-            out_mesh_list.end(),
-            std::make_move_iterator(road_mesh_list.begin()),
-            std::make_move_iterator(road_mesh_list.end()));
+      if (!pair.second.IsJunction()) { // 如果该道路不是交叉口
+        roads.emplace_back(&pair.second);
       }
     }
+    std::vector<const Junction *> junctions; // 所有交叉口
+    for (const auto &junc_pair : _data.GetJunctions()) {
+      junctions.emplace_back(&junc_pair.second);
+    }
 
-    // 生成交叉口内的道路并进行光滑处理
-    for (const auto &junc_pair : _data.GetJunctions()) { // 遍历所有交叉口
-      const auto &junction = junc_pair.second; // 获取当前交叉口
+    // 并行生成，每条道路、每个交叉口的结果放在各自的位置上
+    std::vector<std::vector<std::unique_ptr<geom::Mesh>>> generated(roads.size() + junctions.size());
+    ParallelFor(generated.size(), [&](const size_t i) {
+      if (i < roads.size()) {
+        generated[i] = mesh_factory.GenerateAllWithMaxLen(*roads[i]); // 生成道路的所有网格
+        return;
+      }
+      // 生成交叉口内的道路并进行光滑处理
       std::vector<std::unique_ptr<geom::Mesh>> lane_meshes; // 存储车道网格
       std::vector<std::unique_ptr<geom::Mesh>> sidewalk_lane_meshes; // 存储人行道网格
-      for(const auto &connection_pair : junction.GetConnections()) { // 遍历交叉口的连接
-        const auto &connection = connection_pair.second; // 获取连接信息
-        const auto &road = _data.GetRoads().at(connection.connecting_road); // 获取连接的道路
-        for (auto &&lane_section : road.GetLaneSections()) { // 遍历道路的车道段
-          for (auto &&lane_pair : lane_section.GetLanes()) { // 遍历车道
-            const auto &lane = lane_pair.second; // 获取当前车道
-            if (lane.GetType() != road::Lane::LaneType::Sidewalk) { // 如果车道不是人行道
-              lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成车道网格并添加
-            } else {
-              sidewalk_lane_meshes.push_back(mesh_factory.Generate(lane)); // 生成人行道网格并添加
-            }
-          }
-        }
-      }
-      if(params.smooth_junctions) { // 如果需要光滑处理交叉口
-        auto merged_mesh = mesh_factory.MergeAndSmooth(lane_meshes); // 合并并光滑车道网格
-        for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
-          *merged_mesh += *lane; // 将人行道网格添加到合并网格中
-        }
-        out_mesh_list.push_back(std::move(merged_mesh)); // 将合并后的网格添加到输出列表
+      GenerateJunctionLaneMeshes(
+          mesh_factory, _data, *junctions[i - roads.size()], lane_meshes, &sidewalk_lane_meshes);
+      std::unique_ptr<geom::Mesh> junction_mesh;
+      if (params.smooth_junctions) { // 如果需要光滑处理交叉口
+        junction_mesh = mesh_factory.MergeAndSmooth(lane_meshes); // 合并并光滑车道网格
       } else {
-        std::unique_ptr<geom::Mesh> junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
-        for(auto& lane : lane_meshes) { // 遍历车道网格
-          *junction_mesh += *lane; // 将车道网格添加到交叉口网格中
-        }
-        for(auto& lane : sidewalk_lane_meshes) { // 遍历人行道网格
-          *junction_mesh += *lane; // 将人行道网格添加到交叉口网格中
+        junction_mesh = std::make_unique<geom::Mesh>(); // 创建新的交叉口网格
+        junction_mesh->Append(lane_meshes); // 将车道网格添加到交叉口网格中
+      }
+      junction_mesh->Append(sidewalk_lane_meshes); // 将人行道网格添加到交叉口网格中
+      generated[i].push_back(std::move(junction_mesh));
+    });
+
+    // 按生成顺序展开为输出网格列表，没有顶点的网格不属于任何块，直接丢弃
+    for (auto &meshes : generated) {
+      for (auto &mesh : meshes) {
+        if (mesh != nullptr && !mesh->GetVertices().empty()) {
+          out_mesh_list.emplace_back(std::move(mesh));
         }
-        out_mesh_list.push_back(std::move(junction_mesh)); // 将交叉口网格添加到输出列表
       }
     }
+    if (out_mesh_list.empty()) {
+      return {};
+    }
 
     // 找到输出网格的最小和最大位置
     auto min_pos = geom::Vector2D(
@@ -1135,17 +1349,19 @@ std::vector<std::unique_ptr<geom::Mesh>> Map::GenerateChunkedMesh(
     }
     size_t mesh_amount_x = static_cast<size_t>((max_pos.x - min_pos.x)/params.max_road_length) + 1; // 计算x方向的网格数量
     size_t mesh_amount_y = static_cast<size_t>((max_pos.y - min_pos.y)/params.max_road_length) + 1; // 计算y方向的网格数量
-    std::vector<std::unique_ptr<geom::Mesh>> result; // 定义结果网格列表
-    result.reserve(mesh_amount_x*mesh_amount_y); // 预留空间以容纳所有网格
-    for (size_t i = 0; i < mesh_amount_x*mesh_amount_y; ++i) { // 根据网格数量逐个初始化网格
-      result.emplace_back(std::make_unique<geom::Mesh>());
-    }
+    // 先把每个网格分配到对应的块，再对每个块一次性预留空间后合并
+    std::vector<std::vector<const geom::Mesh *>> chunks(mesh_amount_x*mesh_amount_y);
     for (auto & mesh : out_mesh_list) { // 遍历所有输出网格
       auto vertex = mesh->GetVertices().front(); // 获取网格的第一个顶点
       size_t x_pos = static_cast<size_t>((vertex.x - min_pos.x) / params.max_road_length); // 计算x坐标在结果网格中的索引
       size_t y_pos = static_cast<size_t>((vertex.y - min_pos.y) / params.max_road_length); // 计算y坐标在结果网格中的索引
-      *(result[x_pos + mesh_amount_x*y_pos]) += *mesh; // 将当前网格添加到对应的结果网格中
+      chunks[x_pos + mesh_amount_x*y_pos].emplace_back(mesh.get()); // 记录当前网格所属的块
     }
+    std::vector<std::unique_ptr<geom::Mesh>> result(chunks.size()); // 定义结果网格列表
+    ParallelFor(chunks.size(), [&](const size_t i) {
+      result[i] = std::make_unique<geom::Mesh>();
+      result[i]->Append(chunks[i]);
+    });
 
     return result; // 返回生成的结果网格列表
   }
@@ -21,11 +21,14 @@
 
 #include <boost/optional.hpp> // 包含可选类型的定义
 
+#include <unordered_map> // 包含无序映射的定义
 #include <vector> // 包含向量类的定义
 
 namespace carla {
 namespace road {
 
+  class MapSnapshot;
+
   class Map : private MovableNonCopyable { // 地图类，禁止复制
   public:
 
@@ -36,6 +39,7 @@ namespace road {
     /// ========================================================================
 
     Map(MapData m) : _data(std::move(m)) { // 构造函数，初始化_map数据
+      CreateLaneEnds(); // 预先计算车道两端的相邻路点
       CreateRtree(); // 创建R树
     }
 
@@ -59,6 +63,16 @@ namespace road {
         const geom::Location &location, // 输入位置
         int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving)) const; // 默认车道类型为驾驶车道
 
+    /// 批量版本的 GetClosestWaypointOnRoad（@a project_to_road 为 false 时对应
+    /// GetWaypoint）：对连续存放的 @a count 个位置分多个线程查询R树，结果按输入顺序返回。
+    /// @a number_of_threads 为0时使用硬件线程数。
+    std::vector<boost::optional<element::Waypoint>> GetWaypointBatch(
+        const geom::Location *locations, // 连续存放的输入位置
+        size_t count, // 位置数量
+        bool project_to_road = true, // 是否投影到最近车道的中心
+        int32_t lane_type = static_cast<int32_t>(Lane::LaneType::Driving),
+        size_t number_of_threads = 0u) const;
+
     boost::optional<element::Waypoint> GetWaypoint( // 根据道路ID和车道ID获取路径点
         RoadId road_id, // 道路ID
         LaneId lane_id, // 车道ID
@@ -122,6 +136,14 @@ namespace road {
     /// 使得车辆可以反向驶向这些路点。
     std::vector<Waypoint> GetPrevious(Waypoint waypoint, double distance) const; // 获取上一个路点
 
+    /// 与 GetNext 相同，但将结果写入调用者提供的 @a buffer，不进行堆分配。
+    /// 返回找到的路点总数；若大于 @a capacity，则 @a buffer 的内容不完整，
+    /// 需要使用足够大的缓冲区重新调用。
+    size_t GetNext(Waypoint waypoint, double distance, Waypoint *buffer, size_t capacity) const;
+
+    /// 与 GetPrevious 相同，但将结果写入调用者提供的 @a buffer，不进行堆分配。
+    size_t GetPrevious(Waypoint waypoint, double distance, Waypoint *buffer, size_t capacity) const;
+
     /// 返回 @a waypoint 右侧车道的路点。
     boost::optional<Waypoint> GetRight(Waypoint waypoint) const; // 获取右侧路点
 
@@ -204,26 +226,73 @@ std::vector<carla::geom::BoundingBox> GetJunctionsBoundingBoxes() const;  // 获
 private:
 
     friend MapBuilder;  // 友元类
+    friend MapSnapshot;  // 从快照恢复地图时直接使用已生成的R树元素
     MapData _data;  // 地图数据
 
     using Rtree = geom::SegmentCloudRtree<Waypoint>;  // 使用R树结构
     Rtree _rtree;  // R树对象
 
+    /// 使用已生成的R树元素构造地图，元素按 SortRtreeElements 的顺序插入，
+    /// 得到的R树与 CreateRtree 构建的完全相同。
+    Map(MapData m, const std::vector<Rtree::TreeElement> &rtree_elements)
+      : _data(std::move(m)) {
+      CreateLaneEnds();
+      _rtree.InsertElements(rtree_elements);
+    }
+
+    /// 车道的后继与前驱路点在 _lane_end_waypoints 中的范围，
+    /// 后继为 [successors, predecessors)，前驱为 [predecessors, end)。
+    struct LaneEnds {
+      uint32_t successors;
+      uint32_t predecessors;
+      uint32_t end;
+    };
+
+    /// 只读的车道邻接表，构造后不再修改。
+    std::unordered_map<const Lane *, LaneEnds> _lane_ends;
+    std::vector<Waypoint> _lane_end_waypoints;
+
+    /// 为每条车道预先计算 GetSuccessors 与 GetPredecessors 的结果。
+    void CreateLaneEnds();
+
+    /// 返回 @a lane 的后继（或 @a predecessors 为 true 时的前驱）路点范围，
+    /// 车道不在邻接表中时返回 false。
+    bool GetLaneEnds(
+        const Lane &lane,
+        bool predecessors,
+        const Waypoint *&begin,
+        const Waypoint *&end) const;
+
+    /// GetNext 与 GetPrevious 的实现，结果的顺序与原先递归合并向量的顺序一致。
+    size_t CollectNext(
+        Waypoint waypoint,
+        double distance,
+        bool reverse,
+        Waypoint *buffer,
+        size_t capacity) const;
+
     void CreateRtree();  // 创建R树
 
+    /// 按车道顺序生成R树的全部元素（段及其两端的路点）。
+    std::vector<Rtree::TreeElement> ComputeRtreeElements() const;
+
+    /// 按两端路点的 road_id、section_id、lane_id 与 s 排序R树元素。最近邻查询
+    /// 在距离相同时的结果取决于R树的结构，以相同的顺序插入才能得到相同的R树。
+    static void SortRtreeElements(std::vector<Rtree::TreeElement> &elements);
+
     // 辅助函数，用于构造R树元素列表
     void AddElementToRtree(  // 将元素添加到R树
         std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
         geom::Transform &current_transform,  // 当前变换
         geom::Transform &next_transform,  // 下一个变换
         Waypoint &current_waypoint,  // 当前路点
-        Waypoint &next_waypoint);  // 下一个路点
+        Waypoint &next_waypoint) const;  // 下一个路点
 
     void AddElementToRtreeAndUpdateTransforms(  // 添加元素到R树并更新变换
         std::vector<Rtree::TreeElement> &rtree_elements,  // R树元素列表
         geom::Transform &current_transform,  // 当前变换
         Waypoint &current_waypoint,  // 当前路点
-        Waypoint &next_waypoint);  // 下一个路点
+        Waypoint &next_waypoint) const;  // 下一个路点
 
 public:
     inline float GetZPosInDeformation(float posx, float posy) const;  // 获取变形中的Z轴位置
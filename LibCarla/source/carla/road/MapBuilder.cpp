@@ -70,6 +70,28 @@ namespace road {
     return map; // 返回构建的地图
   }
 
+  MapBuilder MapBuilder::CreateSectionBuilder() {
+    MapBuilder section;
+    section._parent = this; // 道路和车道仍由本构建器持有
+    return section;
+  }
+
+  void MapBuilder::MergeSectionBuilder(MapBuilder &&section) {
+    DEBUG_ASSERT(section._parent == this);
+    DEBUG_ASSERT(section._temp_signal_container.empty());
+    DEBUG_ASSERT(section._temp_signal_reference_container.empty());
+    for (auto &&info : section._temp_road_info_container) { // 按道路追加道路信息
+      auto &road_info = _temp_road_info_container[info.first];
+      std::move(info.second.begin(), info.second.end(), std::back_inserter(road_info));
+    }
+    for (auto &&info : section._temp_lane_info_container) { // 按车道追加车道信息
+      auto &lane_info = _temp_lane_info_container[info.first];
+      std::move(info.second.begin(), info.second.end(), std::back_inserter(lane_info));
+    }
+    section._temp_road_info_container.clear();
+    section._temp_lane_info_container.clear();
+  }
+
   // called from profiles parser
   void MapBuilder::AddRoadElevationProfile(
       Road *road, // 道路指针
@@ -426,7 +448,8 @@ void MapBuilder::AddSignalPositionRoad(
         location);
 
     // 将新的道路几何信息添加到临时道路信息容器中
-    _temp_road_info_container[road].emplace_back(std::move(elevation));
+    _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
+        std::move(line_geometry))));
   }
 
 // 创建道路速度信息
@@ -502,6 +525,8 @@ void MapBuilder::AddRoadGeometrySpiral(
         location,
         curvStart,
         curvEnd);
+    // 预先计算弧长查找表，之后的 PosFromDist 只需查表插值
+    spiral_geometry->PrecomputeArcLengthTable();
 
     // 将新的道路几何信息（螺旋）添加到临时道路信息容器中
     _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,
@@ -532,8 +557,10 @@ auto poly3_geometry = std::make_unique<GeometryPoly3>(  // 创建一个 Geometry
     b,
     c,
     d);
+poly3_geometry->PrecomputeArcLengthTable();  // 预先计算弧长查找表
 _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,  // 将 RoadInfoGeometry 对象添加到临时道路信息容器中
     std::move(poly3_geometry))));  // 移动 poly3_geometry 智能指针
+}
 
 void MapBuilder::AddRoadGeometryParamPoly3(  // 定义一个函数，用于添加参数化的三次曲线道路几何信息
     Road * road,  // 道路指针
@@ -574,8 +601,10 @@ void MapBuilder::AddRoadGeometryParamPoly3(  // 定义一个函数，用于添
         cV,
         dV,
         arcLength);  // 将 arcLength 作为参数传入
+    parampoly3_geometry->PrecomputeArcLengthTable();  // 预先计算弧长查找表
     _temp_road_info_container[road].emplace_back(std::unique_ptr<RoadInfo>(new RoadInfoGeometry(s,  // 将 RoadInfoGeometry 对象添加到临时道路信息容器中
         std::move(parampoly3_geometry))));  // 移动 parampoly3_geometry 智能指针
+}
 
 void MapBuilder::AddJunction(const int32_t id, const std::string name) {  // 定义一个函数，用于添加交叉口
     _map_data.GetJunctions().emplace(id, Junction(id, name));  // 在地图数据中添加交叉口
@@ -612,12 +641,18 @@ Lane *MapBuilder::GetLane(
       const LaneId lane_id,
       const double s) {
     // 根据给定的道路ID、车道ID和距离s，获取车道的指针
+    if (_parent != nullptr) { // 分区构建器从所属的构建器中查找
+      return _parent->GetLane(road_id, lane_id, s);
+    }
     return &_map_data.GetRoad(road_id).GetLaneByDistance(s, lane_id);
 }
 
 Road *MapBuilder::GetRoad(
       const RoadId road_id) {
     // 根据道路ID获取道路的指针
+    if (_parent != nullptr) { // 分区构建器从所属的构建器中查找
+      return _parent->GetRoad(road_id);
+    }
     return &_map_data.GetRoad(road_id);
 }
 
@@ -22,6 +22,15 @@ namespace road {
 
     boost::optional<Map> Build(); // 构建地图并返回一个可选的地图对象
 
+    /// 创建一个分区构建器，用于在其他线程中并行解析部分道路的几何、车道和
+    /// 轮廓信息。分区构建器通过本构建器查找道路和车道，只能在道路解析完成后
+    /// 创建，且其生命周期不能超过本构建器。
+    MapBuilder CreateSectionBuilder();
+
+    /// 将分区构建器中的道路和车道信息追加到本构建器。每条道路只应由一个分区
+    /// 构建器解析，这样合并结果与串行解析时相同。
+    void MergeSectionBuilder(MapBuilder &&section);
+
     // 从道路解析器调用
     carla::road::Road *AddRoad(
         const RoadId road_id, // 道路ID
@@ -364,6 +373,9 @@ private:
 
     MapData _map_data; // 地图数据
 
+    /// 分区构建器所属的构建器，用于查找道路和车道；普通构建器为空。
+    MapBuilder *_parent { nullptr };
+
     /// Create the pointers between RoadSegments based on the ids. // 根据标识符创建道路段之间的指针
     void CreatePointersBetweenRoadSegments();
 
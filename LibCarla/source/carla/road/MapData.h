@@ -25,6 +25,7 @@ namespace carla { // 定义 carla 命名空间
 namespace road { // 定义 road 命名空间
 
   class Lane; // 前向声明车道类
+  class MapSnapshot; // 前向声明地图快照类
 
   class MapData : private MovableNonCopyable { // 定义 MapData 类，继承不可拷贝类
   public:
@@ -86,6 +87,7 @@ namespace road { // 定义 road 命名空间
   private:
 
     friend class MapBuilder; // 友元类声明
+    friend class MapSnapshot; // 地图快照直接读写私有数据
 
     MapData() = default; // 默认构造函数
 
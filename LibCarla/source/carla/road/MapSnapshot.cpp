@@ -0,0 +1,1102 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/road/MapSnapshot.h"
+
+#include "carla/Exception.h"
+#include "carla/FileSystem.h"
+#include "carla/Logging.h"
+#include "carla/road/element/RoadInfoCrosswalk.h"
+#include "carla/road/element/RoadInfoElevation.h"
+#include "carla/road/element/RoadInfoGeometry.h"
+#include "carla/road/element/RoadInfoLaneAccess.h"
+#include "carla/road/element/RoadInfoLaneBorder.h"
+#include "carla/road/element/RoadInfoLaneHeight.h"
+#include "carla/road/element/RoadInfoLaneMaterial.h"
+#include "carla/road/element/RoadInfoLaneOffset.h"
+#include "carla/road/element/RoadInfoLaneRule.h"
+#include "carla/road/element/RoadInfoLaneVisibility.h"
+#include "carla/road/element/RoadInfoLaneWidth.h"
+#include "carla/road/element/RoadInfoMarkRecord.h"
+#include "carla/road/element/RoadInfoMarkTypeLine.h"
+#include "carla/road/element/RoadInfoSignal.h"
+#include "carla/road/element/RoadInfoSpeed.h"
+#include "carla/road/element/RoadInfoVisitor.h"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <type_traits>
+
+namespace carla {
+namespace road {
+
+  using namespace carla::road::element;
+
+  constexpr char MapSnapshot::MAGIC[8];
+  constexpr uint32_t MapSnapshot::VERSION;
+
+namespace {
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t file_size;
+    uint64_t opendrive_hash;
+    uint64_t data_offset;
+    uint64_t data_size;
+    uint64_t rtree_offset;
+    uint64_t rtree_count;
+  };
+
+  struct WaypointRecord {
+    uint32_t road_id;
+    uint32_t section_id;
+    int32_t lane_id;
+    uint32_t padding;
+    double s;
+  };
+
+  /// R树中的一个段及其两端的路点。
+  struct RtreeRecord {
+    float start[3];
+    float end[3];
+    WaypointRecord waypoints[2];
+  };
+
+  static_assert(std::is_trivially_copyable<Header>::value, "Header must be trivially copyable");
+  static_assert(std::is_trivially_copyable<RtreeRecord>::value, "RtreeRecord must be trivially copyable");
+  static_assert(sizeof(Header) == 64u, "Unexpected Header layout");
+  static_assert(sizeof(RtreeRecord) == 72u, "Unexpected RtreeRecord layout");
+
+  /// 道路信息在快照中的类型标记。
+  enum class RoadInfoType : uint8_t {
+    Crosswalk,
+    Elevation,
+    Geometry,
+    LaneAccess,
+    LaneBorder,
+    LaneHeight,
+    LaneMaterial,
+    LaneOffset,
+    LaneRule,
+    LaneVisibility,
+    LaneWidth,
+    MarkRecord,
+    MarkTypeLine,
+    Signal,
+    Speed
+  };
+
+  /// 将偏移向上对齐到8字节。
+  uint64_t Align(uint64_t offset) {
+    return (offset + 7u) & ~uint64_t(7u);
+  }
+
+  WaypointRecord MakeWaypointRecord(const Waypoint &waypoint) {
+    return WaypointRecord{waypoint.road_id, waypoint.section_id, waypoint.lane_id, 0u, waypoint.s};
+  }
+
+  Waypoint MakeWaypoint(const WaypointRecord &record) {
+    Waypoint waypoint;
+    waypoint.road_id = record.road_id;
+    waypoint.section_id = record.section_id;
+    waypoint.lane_id = record.lane_id;
+    waypoint.s = record.s;
+    return waypoint;
+  }
+
+} // namespace
+
+  // ===========================================================================
+  // -- MapSnapshot::Encoder ---------------------------------------------------
+  // ===========================================================================
+
+  /// 按顺序将 MapData 编码到缓冲区，指针以对应对象的ID保存。
+  class MapSnapshot::Encoder : private RoadInfoVisitor {
+  public:
+
+    explicit Encoder(std::vector<uint8_t> &buffer) : _buffer(buffer) {}
+
+    void Encode(const MapData &data) {
+      Write(data._geo_reference);
+
+      WriteSize(data._signals.size());
+      for (const auto &pair : data._signals) {
+        Encode(*pair.second);
+      }
+
+      WriteSize(data._controllers.size());
+      for (const auto &pair : data._controllers) {
+        Encode(*pair.second);
+      }
+
+      WriteSize(data._roads.size());
+      for (const auto &pair : data._roads) {
+        Encode(pair.second);
+      }
+
+      WriteSize(data._junctions.size());
+      for (const auto &pair : data._junctions) {
+        Encode(pair.second);
+      }
+    }
+
+  private:
+
+    template <typename T>
+    void Write(const T &value) {
+      static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written");
+      const auto *begin = reinterpret_cast<const uint8_t *>(&value);
+      _buffer.insert(_buffer.end(), begin, begin + sizeof(T));
+    }
+
+    void Write(const std::string &value) {
+      WriteSize(value.size());
+      _buffer.insert(_buffer.end(), value.begin(), value.end());
+    }
+
+    void WriteSize(size_t size) {
+      Write(static_cast<uint64_t>(size));
+    }
+
+    template <typename T>
+    void WriteSet(const std::set<T> &values) {
+      WriteSize(values.size());
+      for (const auto &value : values) {
+        Write(value);
+      }
+    }
+
+    void WriteLaneReferences(const std::vector<Lane *> &lanes) {
+      WriteSize(lanes.size());
+      for (const auto *lane : lanes) {
+        DEBUG_ASSERT(lane != nullptr);
+        Write(lane->GetRoad()->GetId());
+        Write(lane->GetLaneSection()->GetId());
+        Write(lane->GetId());
+      }
+    }
+
+    void Encode(const Signal &signal) {
+      Write(signal._road_id);
+      Write(signal._signal_id);
+      Write(signal._s);
+      Write(signal._t);
+      Write(signal._name);
+      Write(signal._dynamic);
+      Write(signal._orientation);
+      Write(signal._zOffset);
+      Write(signal._country);
+      Write(signal._type);
+      Write(signal._subtype);
+      Write(signal._value);
+      Write(signal._unit);
+      Write(signal._height);
+      Write(signal._width);
+      Write(signal._text);
+      Write(signal._hOffset);
+      Write(signal._pitch);
+      Write(signal._roll);
+      WriteSize(signal._dependencies.size());
+      for (const auto &dependency : signal._dependencies) {
+        Write(dependency._dependency_id);
+        Write(dependency._type);
+      }
+      Write(signal._transform);
+      WriteSet(signal._controllers);
+      Write(signal._using_inertial_position);
+    }
+
+    void Encode(const Controller &controller) {
+      Write(controller._id);
+      Write(controller._name);
+      Write(controller._sequence);
+      WriteSet(controller._junctions);
+      WriteSet(controller._signals);
+    }
+
+    void Encode(const Road &road) {
+      Write(road._id);
+      Write(road._name);
+      Write(road._length);
+      Write(road._is_junction);
+      Write(road._junction_id);
+      Write(road._successor);
+      Write(road._predecessor);
+      Encode(road._info);
+      WriteSize(road._nexts.size());
+      for (const auto *next : road._nexts) {
+        Write(next->GetId());
+      }
+      WriteSize(road._prevs.size());
+      for (const auto *prev : road._prevs) {
+        Write(prev->GetId());
+      }
+      const auto sections = road.GetLaneSections();
+      WriteSize(static_cast<size_t>(std::distance(sections.begin(), sections.end())));
+      for (const auto &section : sections) {
+        Encode(section);
+      }
+    }
+
+    void Encode(const LaneSection &section) {
+      Write(section._id);
+      Write(section._s);
+      Write(section._lane_offset);
+      WriteSize(section._lanes.size());
+      for (const auto &pair : section._lanes) {
+        Encode(pair.second);
+      }
+    }
+
+    void Encode(const Lane &lane) {
+      Write(lane._id);
+      Write(lane._type);
+      Write(lane._level);
+      Write(lane._successor);
+      Write(lane._predecessor);
+      Encode(lane._info);
+      WriteLaneReferences(lane._next_lanes);
+      WriteLaneReferences(lane._prev_lanes);
+    }
+
+    void Encode(const Junction &junction) {
+      Write(junction._id);
+      Write(junction._name);
+      WriteSize(junction._connections.size());
+      for (const auto &pair : junction._connections) {
+        const auto &connection = pair.second;
+        Write(connection.id);
+        Write(connection.incoming_road);
+        Write(connection.connecting_road);
+        WriteSize(connection.lane_links.size());
+        for (const auto &link : connection.lane_links) {
+          Write(link.from);
+          Write(link.to);
+        }
+      }
+      WriteSet(junction._controllers);
+      WriteSize(junction._road_conflicts.size());
+      for (const auto &pair : junction._road_conflicts) {
+        Write(pair.first);
+        WriteSize(pair.second.size());
+        for (const auto road_id : pair.second) {
+          Write(road_id);
+        }
+      }
+      Write(junction._bounding_box);
+    }
+
+    void Encode(const InformationSet &info) {
+      WriteSize(info.GetAll().size());
+      for (const auto &road_info : info.GetAll()) {
+        DEBUG_ASSERT(road_info != nullptr);
+        const size_t size = _buffer.size();
+        road_info->AcceptVisitor(*this);
+        if (_buffer.size() == size) {
+          throw_exception(std::runtime_error("map snapshot: unsupported road info type"));
+        }
+      }
+    }
+
+    void WriteTag(RoadInfoType type, const RoadInfo &info) {
+      Write(type);
+      Write(info.GetDistance());
+    }
+
+    void Visit(RoadInfoCrosswalk &info) override {
+      WriteTag(RoadInfoType::Crosswalk, info);
+      Write(info.GetName());
+      Write(info.GetT());
+      Write(info.GetZOffset());
+      Write(info.GetHeading());
+      Write(info.GetPitch());
+      Write(info.GetRoll());
+      Write(info.GetOrientation());
+      Write(info.GetWidth());
+      Write(info.GetLength());
+      WriteSize(info.GetPoints().size());
+      for (const auto &point : info.GetPoints()) {
+        Write(point.u);
+        Write(point.v);
+        Write(point.z);
+      }
+    }
+
+    void Visit(RoadInfoElevation &info) override {
+      WriteTag(RoadInfoType::Elevation, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoGeometry &info) override {
+      WriteTag(RoadInfoType::Geometry, info);
+      const Geometry &geometry = info.GetGeometry();
+      Write(geometry.GetType());
+      Write(geometry.GetStartOffset());
+      Write(geometry.GetLength());
+      Write(geometry.GetHeading());
+      Write(geometry.GetStartPosition());
+      switch (geometry.GetType()) {
+        case GeometryType::LINE:
+          break;
+        case GeometryType::ARC: {
+          const auto &arc = static_cast<const GeometryArc &>(geometry);
+          Write(arc.GetCurvature());
+          break;
+        }
+        case GeometryType::SPIRAL: {
+          const auto &spiral = static_cast<const GeometrySpiral &>(geometry);
+          Write(spiral.GetCurveStart());
+          Write(spiral.GetCurveEnd());
+          break;
+        }
+        case GeometryType::POLY3: {
+          const auto &poly3 = static_cast<const GeometryPoly3 &>(geometry);
+          Write(poly3.Geta());
+          Write(poly3.Getb());
+          Write(poly3.Getc());
+          Write(poly3.Getd());
+          break;
+        }
+        case GeometryType::POLY3PARAM: {
+          const auto &param_poly3 = static_cast<const GeometryParamPoly3 &>(geometry);
+          Write(param_poly3.GetaU());
+          Write(param_poly3.GetbU());
+          Write(param_poly3.GetcU());
+          Write(param_poly3.GetdU());
+          Write(param_poly3.GetaV());
+          Write(param_poly3.GetbV());
+          Write(param_poly3.GetcV());
+          Write(param_poly3.GetdV());
+          Write(param_poly3.IsArcLength());
+          break;
+        }
+        default:
+          throw_exception(std::runtime_error("map snapshot: unsupported geometry type"));
+      }
+    }
+
+    void Visit(RoadInfoLaneAccess &info) override {
+      WriteTag(RoadInfoType::LaneAccess, info);
+      Write(info.GetRestriction());
+    }
+
+    void Visit(RoadInfoLaneBorder &info) override {
+      WriteTag(RoadInfoType::LaneBorder, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoLaneHeight &info) override {
+      WriteTag(RoadInfoType::LaneHeight, info);
+      Write(info.GetInner());
+      Write(info.GetOuter());
+    }
+
+    void Visit(RoadInfoLaneMaterial &info) override {
+      WriteTag(RoadInfoType::LaneMaterial, info);
+      Write(info.GetSurface());
+      Write(info.GetFriction());
+      Write(info.GetRoughness());
+    }
+
+    void Visit(RoadInfoLaneOffset &info) override {
+      WriteTag(RoadInfoType::LaneOffset, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoLaneRule &info) override {
+      WriteTag(RoadInfoType::LaneRule, info);
+      Write(info.GetValue());
+    }
+
+    void Visit(RoadInfoLaneVisibility &info) override {
+      WriteTag(RoadInfoType::LaneVisibility, info);
+      Write(info.GetForward());
+      Write(info.GetBack());
+      Write(info.GetLeft());
+      Write(info.GetRight());
+    }
+
+    void Visit(RoadInfoLaneWidth &info) override {
+      WriteTag(RoadInfoType::LaneWidth, info);
+      Write(info.GetPolynomial());
+    }
+
+    void Visit(RoadInfoMarkRecord &info) override {
+      WriteTag(RoadInfoType::MarkRecord, info);
+      Write(info.GetRoadMarkId());
+      Write(info.GetType());
+      Write(info.GetWeight());
+      Write(info.GetColor());
+      Write(info.GetMaterial());
+      Write(info.GetWidth());
+      Write(info.GetLaneChange());
+      Write(info.GetHeight());
+      Write(info.GetTypeName());
+      Write(info.GetTypeWidth());
+      WriteSize(info.GetLines().size());
+      for (auto &line : info.GetLines()) {
+        Visit(*line);
+      }
+    }
+
+    void Visit(RoadInfoMarkTypeLine &info) override {
+      WriteTag(RoadInfoType::MarkTypeLine, info);
+      Write(info.GetRoadMarkId());
+      Write(info.GetLength());
+      Write(info.GetSpace());
+      Write(info.GetTOffset());
+      Write(info.GetRule());
+      Write(info.GetWidth());
+    }
+
+    void Visit(RoadInfoSignal &info) override {
+      WriteTag(RoadInfoType::Signal, info);
+      Write(info._signal_id);
+      Write(info._road_id);
+      Write(info._s);
+      Write(info._t);
+      Write(info._orientation);
+      WriteSize(info._validities.size());
+      for (const auto &validity : info._validities) {
+        Write(validity._from_lane);
+        Write(validity._to_lane);
+      }
+    }
+
+    void Visit(RoadInfoSpeed &info) override {
+      WriteTag(RoadInfoType::Speed, info);
+      Write(info.GetSpeed());
+      Write(info.GetType());
+    }
+
+    std::vector<uint8_t> &_buffer;
+  };
+
+  // ===========================================================================
+  // -- MapSnapshot::Decoder ---------------------------------------------------
+  // ===========================================================================
+
+  /// 从 Encoder 生成的内容恢复 MapData。内容损坏时抛出异常。
+  class MapSnapshot::Decoder {
+  public:
+
+    Decoder(const uint8_t *data, size_t size) : _data(data), _size(size) {}
+
+    MapData Decode() {
+      MapData data;
+      data._geo_reference = Read<geom::GeoLocation>();
+
+      for (auto count = ReadSize(); count > 0u; --count) {
+        auto signal = DecodeSignal();
+        const auto id = signal->GetSignalId();
+        data._signals.emplace(id, std::move(signal));
+      }
+
+      for (auto count = ReadSize(); count > 0u; --count) {
+        auto controller = DecodeController();
+        const auto id = controller->GetControllerId();
+        data._controllers.emplace(id, std::move(controller));
+      }
+
+      const auto road_count = ReadSize();
+      data._roads.reserve(road_count);
+      for (auto count = road_count; count > 0u; --count) {
+        DecodeRoad(data);
+      }
+
+      for (auto count = ReadSize(); count > 0u; --count) {
+        DecodeJunction(data);
+      }
+
+      if (_position != _size) {
+        throw_exception(std::runtime_error("map snapshot: unexpected trailing data"));
+      }
+
+      ResolveReferences(data);
+      return data;
+    }
+
+  private:
+
+    /// 道路和车道之间的连接在所有道路都恢复后再解析为指针。
+    struct LaneReference {
+      RoadId road_id;
+      SectionId section_id;
+      LaneId lane_id;
+    };
+
+    template <typename T>
+    T Read() {
+      static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read");
+      Require(sizeof(T));
+      T value;
+      std::memcpy(&value, _data + _position, sizeof(T));
+      _position += sizeof(T);
+      return value;
+    }
+
+    std::string ReadString() {
+      const auto size = ReadSize();
+      Require(size);
+      std::string value(reinterpret_cast<const char *>(_data + _position), size);
+      _position += size;
+      return value;
+    }
+
+    /// 读取元素个数。每个元素至少占用一个字节，个数超过剩余内容时说明文件已损坏，
+    /// 这样可以避免按损坏的个数分配巨大的内存。
+    size_t ReadSize() {
+      const auto size = Read<uint64_t>();
+      if (size > _size - _position) {
+        throw_exception(std::runtime_error("map snapshot: invalid element count"));
+      }
+      return static_cast<size_t>(size);
+    }
+
+    template <typename T>
+    std::set<T> ReadSet() {
+      std::set<T> values;
+      for (auto count = ReadSize(); count > 0u; --count) {
+        values.emplace(Read<T>());
+      }
+      return values;
+    }
+
+    std::set<std::string> ReadStringSet() {
+      std::set<std::string> values;
+      for (auto count = ReadSize(); count > 0u; --count) {
+        values.emplace(ReadString());
+      }
+      return values;
+    }
+
+    void Require(size_t size) const {
+      if (size > _size - _position) {
+        throw_exception(std::runtime_error("map snapshot: truncated data"));
+      }
+    }
+
+    std::vector<LaneReference> ReadLaneReferences() {
+      std::vector<LaneReference> references(ReadSize());
+      for (auto &reference : references) {
+        reference.road_id = Read<RoadId>();
+        reference.section_id = Read<SectionId>();
+        reference.lane_id = Read<LaneId>();
+      }
+      return references;
+    }
+
+    std::unique_ptr<Signal> DecodeSignal() {
+      const auto road_id = Read<RoadId>();
+      auto signal_id = ReadString();
+      const auto s = Read<double>();
+      const auto t = Read<double>();
+      auto name = ReadString();
+      auto dynamic = ReadString();
+      auto orientation = ReadString();
+      const auto z_offset = Read<double>();
+      auto country = ReadString();
+      auto type = ReadString();
+      auto subtype = ReadString();
+      const auto value = Read<double>();
+      auto unit = ReadString();
+      const auto height = Read<double>();
+      const auto width = Read<double>();
+      auto text = ReadString();
+      const auto h_offset = Read<double>();
+      const auto pitch = Read<double>();
+      const auto roll = Read<double>();
+      auto signal = std::make_unique<Signal>(
+          road_id, signal_id, s, t, name, dynamic, orientation, z_offset, country,
+          type, subtype, value, unit, height, width, text, h_offset, pitch, roll);
+      for (auto count = ReadSize(); count > 0u; --count) {
+        auto dependency_id = ReadString();
+        auto dependency_type = ReadString();
+        signal->_dependencies.emplace_back(dependency_id, dependency_type);
+      }
+      signal->_transform = Read<geom::Transform>();
+      signal->_controllers = ReadStringSet();
+      signal->_using_inertial_position = Read<bool>();
+      return signal;
+    }
+
+    std::unique_ptr<Controller> DecodeController() {
+      auto id = ReadString();
+      auto name = ReadString();
+      const auto sequence = Read<uint32_t>();
+      auto controller = std::make_unique<Controller>(id, name, sequence);
+      controller->_junctions = ReadSet<JuncId>();
+      controller->_signals = ReadStringSet();
+      return controller;
+    }
+
+    void DecodeRoad(MapData &data) {
+      const auto id = Read<RoadId>();
+      auto result = data._roads.emplace(id, Road());
+      if (!result.second) {
+        throw_exception(std::runtime_error("map snapshot: duplicated road"));
+      }
+      Road &road = result.first->second;
+      road._id = id;
+      road._name = ReadString();
+      road._length = Read<double>();
+      road._is_junction = Read<bool>();
+      road._junction_id = Read<JuncId>();
+      road._successor = Read<RoadId>();
+      road._predecessor = Read<RoadId>();
+      road._info = DecodeInformationSet(data);
+
+      auto &links = _road_links[&road];
+      for (auto count = ReadSize(); count > 0u; --count) {
+        links.first.emplace_back(Read<RoadId>());
+      }
+      for (auto count = ReadSize(); count > 0u; --count) {
+        links.second.emplace_back(Read<RoadId>());
+      }
+
+      for (auto count = ReadSize(); count > 0u; --count) {
+        const auto section_id = Read<SectionId>();
+        const auto s = Read<double>();
+        LaneSection &section = road._lane_sections.Emplace(section_id, s);
+        section._road = &road;
+        section._lane_offset = Read<geom::CubicPolynomial>();
+        for (auto lane_count = ReadSize(); lane_count > 0u; --lane_count) {
+          DecodeLane(data, section);
+        }
+      }
+    }
+
+    void DecodeLane(MapData &data, LaneSection &section) {
+      const auto id = Read<LaneId>();
+      auto result = section._lanes.emplace(id, Lane());
+      if (!result.second) {
+        throw_exception(std::runtime_error("map snapshot: duplicated lane"));
+      }
+      Lane &lane = result.first->second;
+      lane._lane_section = &section;
+      lane._id = id;
+      lane._type = Read<Lane::LaneType>();
+      lane._level = Read<bool>();
+      lane._successor = Read<LaneId>();
+      lane._predecessor = Read<LaneId>();
+      lane._info = DecodeInformationSet(data);
+      auto &links = _lane_links[&lane];
+      links.first = ReadLaneReferences();
+      links.second = ReadLaneReferences();
+    }
+
+    void DecodeJunction(MapData &data) {
+      const auto id = Read<JuncId>();
+      auto name = ReadString();
+      auto result = data._junctions.emplace(id, Junction(id, name));
+      if (!result.second) {
+        throw_exception(std::runtime_error("map snapshot: duplicated junction"));
+      }
+      Junction &junction = result.first->second;
+      for (auto count = ReadSize(); count > 0u; --count) {
+        const auto connection_id = Read<ConId>();
+        const auto incoming_road = Read<RoadId>();
+        const auto connecting_road = Read<RoadId>();
+        auto &connection = junction._connections.emplace(
+            connection_id,
+            Junction::Connection(connection_id, incoming_road, connecting_road)).first->second;
+        for (auto link_count = ReadSize(); link_count > 0u; --link_count) {
+          const auto from = Read<LaneId>();
+          const auto to = Read<LaneId>();
+          connection.AddLaneLink(from, to);
+        }
+      }
+      junction._controllers = ReadStringSet();
+      for (auto count = ReadSize(); count > 0u; --count) {
+        auto &conflicts = junction._road_conflicts[Read<RoadId>()];
+        for (auto road_count = ReadSize(); road_count > 0u; --road_count) {
+          conflicts.emplace(Read<RoadId>());
+        }
+      }
+      junction._bounding_box = Read<geom::BoundingBox>();
+    }
+
+    InformationSet DecodeInformationSet(MapData &data) {
+      std::vector<std::unique_ptr<RoadInfo>> infos(ReadSize());
+      for (auto &info : infos) {
+        info = DecodeRoadInfo(data);
+      }
+      return InformationSet(std::move(infos));
+    }
+
+    std::unique_ptr<RoadInfo> DecodeRoadInfo(MapData &data) {
+      const auto type = Read<RoadInfoType>();
+      const auto s = Read<double>();
+      switch (type) {
+        case RoadInfoType::Crosswalk: {
+          auto name = ReadString();
+          const auto t = Read<double>();
+          const auto z_offset = Read<double>();
+          const auto heading = Read<double>();
+          const auto pitch = Read<double>();
+          const auto roll = Read<double>();
+          auto orientation = ReadString();
+          const auto width = Read<double>();
+          const auto length = Read<double>();
+          std::vector<CrosswalkPoint> points;
+          for (auto count = ReadSize(); count > 0u; --count) {
+            const auto u = Read<double>();
+            const auto v = Read<double>();
+            const auto z = Read<double>();
+            points.emplace_back(u, v, z);
+          }
+          return std::make_unique<RoadInfoCrosswalk>(
+              s, name, t, z_offset, heading, pitch, roll, orientation, width, length, points);
+        }
+        case RoadInfoType::Elevation:
+          return std::make_unique<RoadInfoElevation>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::Geometry:
+          return std::make_unique<RoadInfoGeometry>(s, DecodeGeometry());
+        case RoadInfoType::LaneAccess:
+          return std::make_unique<RoadInfoLaneAccess>(s, ReadString());
+        case RoadInfoType::LaneBorder:
+          return std::make_unique<RoadInfoLaneBorder>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::LaneHeight: {
+          const auto inner = Read<double>();
+          const auto outer = Read<double>();
+          return std::make_unique<RoadInfoLaneHeight>(s, inner, outer);
+        }
+        case RoadInfoType::LaneMaterial: {
+          auto surface = ReadString();
+          const auto friction = Read<double>();
+          const auto roughness = Read<double>();
+          return std::make_unique<RoadInfoLaneMaterial>(s, surface, friction, roughness);
+        }
+        case RoadInfoType::LaneOffset:
+          return std::make_unique<RoadInfoLaneOffset>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::LaneRule:
+          return std::make_unique<RoadInfoLaneRule>(s, ReadString());
+        case RoadInfoType::LaneVisibility: {
+          const auto forward = Read<double>();
+          const auto back = Read<double>();
+          const auto left = Read<double>();
+          const auto right = Read<double>();
+          return std::make_unique<RoadInfoLaneVisibility>(s, forward, back, left, right);
+        }
+        case RoadInfoType::LaneWidth:
+          return std::make_unique<RoadInfoLaneWidth>(s, Read<geom::CubicPolynomial>());
+        case RoadInfoType::MarkRecord: {
+          const auto road_mark_id = Read<int>();
+          auto mark_type = ReadString();
+          auto weight = ReadString();
+          auto color = ReadString();
+          auto material = ReadString();
+          const auto width = Read<double>();
+          const auto lane_change = Read<RoadInfoMarkRecord::LaneChange>();
+          const auto height = Read<double>();
+          auto type_name = ReadString();
+          const auto type_width = Read<double>();
+          auto record = std::make_unique<RoadInfoMarkRecord>(
+              s, road_mark_id, mark_type, weight, color, material, width,
+              lane_change, height, type_name, type_width);
+          for (auto count = ReadSize(); count > 0u; --count) {
+            if (Read<RoadInfoType>() != RoadInfoType::MarkTypeLine) {
+              throw_exception(std::runtime_error("map snapshot: invalid road mark line"));
+            }
+            record->GetLines().emplace_back(DecodeMarkTypeLine(Read<double>()));
+          }
+          return record;
+        }
+        case RoadInfoType::MarkTypeLine:
+          return DecodeMarkTypeLine(s);
+        case RoadInfoType::Signal: {
+          auto signal_id = ReadString();
+          const auto road_id = Read<RoadId>();
+          const auto signal_s = Read<double>();
+          const auto t = Read<double>();
+          auto orientation = ReadString();
+          // 与 MapBuilder 相同，找不到信号时引用中的指针为空
+          const auto signal = data._signals.find(signal_id);
+          auto reference = std::make_unique<RoadInfoSignal>(
+              signal_id,
+              signal != data._signals.end() ? signal->second.get() : nullptr,
+              road_id, signal_s, t, orientation);
+          for (auto count = ReadSize(); count > 0u; --count) {
+            const auto from = Read<LaneId>();
+            const auto to = Read<LaneId>();
+            reference->_validities.emplace_back(from, to);
+          }
+          return reference;
+        }
+        case RoadInfoType::Speed: {
+          const auto speed = Read<double>();
+          auto speed_type = ReadString();
+          return std::make_unique<RoadInfoSpeed>(s, speed, speed_type);
+        }
+        default:
+          throw_exception(std::runtime_error("map snapshot: unknown road info type"));
+      }
+      return nullptr;
+    }
+
+    std::unique_ptr<RoadInfoMarkTypeLine> DecodeMarkTypeLine(double s) {
+      const auto road_mark_id = Read<int>();
+      const auto length = Read<double>();
+      const auto space = Read<double>();
+      const auto t_offset = Read<double>();
+      auto rule = ReadString();
+      const auto width = Read<double>();
+      return std::make_unique<RoadInfoMarkTypeLine>(
+          s, road_mark_id, length, space, t_offset, rule, width);
+    }
+
+    std::unique_ptr<Geometry> DecodeGeometry() {
+      const auto type = Read<GeometryType>();
+      const auto start_offset = Read<double>();
+      const auto length = Read<double>();
+      const auto heading = Read<double>();
+      const auto start_position = Read<geom::Location>();
+      std::unique_ptr<Geometry> geometry;
+      switch (type) {
+        case GeometryType::LINE:
+          geometry = std::make_unique<GeometryLine>(start_offset, length, heading, start_position);
+          break;
+        case GeometryType::ARC: {
+          const auto curvature = Read<double>();
+          geometry = std::make_unique<GeometryArc>(start_offset, length, heading, start_position, curvature);
+          break;
+        }
+        case GeometryType::SPIRAL: {
+          const auto curve_start = Read<double>();
+          const auto curve_end = Read<double>();
+          geometry = std::make_unique<GeometrySpiral>(
+              start_offset, length, heading, start_position, curve_start, curve_end);
+          break;
+        }
+        case GeometryType::POLY3: {
+          const auto a = Read<double>();
+          const auto b = Read<double>();
+          const auto c = Read<double>();
+          const auto d = Read<double>();
+          geometry = std::make_unique<GeometryPoly3>(
+              start_offset, length, heading, start_position, a, b, c, d);
+          break;
+        }
+        case GeometryType::POLY3PARAM: {
+          const auto a_u = Read<double>();
+          const auto b_u = Read<double>();
+          const auto c_u = Read<double>();
+          const auto d_u = Read<double>();
+          const auto a_v = Read<double>();
+          const auto b_v = Read<double>();
+          const auto c_v = Read<double>();
+          const auto d_v = Read<double>();
+          const auto arc_length = Read<bool>();
+          geometry = std::make_unique<GeometryParamPoly3>(
+              start_offset, length, heading, start_position,
+              a_u, b_u, c_u, d_u, a_v, b_v, c_v, d_v, arc_length);
+          break;
+        }
+        default:
+          throw_exception(std::runtime_error("map snapshot: unknown geometry type"));
+      }
+      // 查找表不保存在快照中，和 MapBuilder 一样在加载时重新计算
+      geometry->PrecomputeArcLengthTable();
+      return geometry;
+    }
+
+    void ResolveReferences(MapData &data) {
+      // 引用的道路或车道不存在时 at() 会抛出异常，视为快照已损坏
+      for (auto &pair : _road_links) {
+        Road &road = *pair.first;
+        for (const auto id : pair.second.first) {
+          road._nexts.emplace_back(&data._roads.at(id));
+        }
+        for (const auto id : pair.second.second) {
+          road._prevs.emplace_back(&data._roads.at(id));
+        }
+      }
+      auto resolve = [&data](const LaneReference &reference) {
+        return &data._roads.at(reference.road_id)._lane_sections
+            .GetById(reference.section_id)._lanes.at(reference.lane_id);
+      };
+      for (auto &pair : _lane_links) {
+        Lane &lane = *pair.first;
+        for (const auto &reference : pair.second.first) {
+          lane._next_lanes.emplace_back(resolve(reference));
+        }
+        for (const auto &reference : pair.second.second) {
+          lane._prev_lanes.emplace_back(resolve(reference));
+        }
+      }
+    }
+
+    const uint8_t *_data;
+
+    const size_t _size;
+
+    size_t _position = 0u;
+
+    std::unordered_map<Road *, std::pair<std::vector<RoadId>, std::vector<RoadId>>> _road_links;
+
+    std::unordered_map<Lane *, std::pair<std::vector<LaneReference>, std::vector<LaneReference>>> _lane_links;
+  };
+
+  // ===========================================================================
+  // -- MapSnapshot ------------------------------------------------------------
+  // ===========================================================================
+
+  uint64_t MapSnapshot::ComputeHash(const std::string &opendrive) {
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : opendrive) {
+      hash ^= static_cast<uint8_t>(c);
+      hash *= 1099511628211ull;
+    }
+    return hash;
+  }
+
+  std::vector<uint8_t> MapSnapshot::Serialize(const Map &map, uint64_t opendrive_hash) {
+    std::vector<uint8_t> buffer(sizeof(Header), 0u);
+    Encoder(buffer).Encode(map._data);
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.header_size = sizeof(Header);
+    header.opendrive_hash = opendrive_hash;
+    header.data_offset = sizeof(Header);
+    header.data_size = buffer.size() - sizeof(Header);
+
+    // 直接取出地图中已有的R树元素，不必重新生成。按与 CreateRtree 相同的顺序
+    // 保存，加载时按此顺序插入可以得到相同的R树
+    std::vector<Map::Rtree::TreeElement> elements(map._rtree.begin(), map._rtree.end());
+    Map::SortRtreeElements(elements);
+    header.rtree_offset = Align(buffer.size());
+    header.rtree_count = elements.size();
+    buffer.resize(header.rtree_offset + elements.size() * sizeof(RtreeRecord), 0u);
+    auto *records = buffer.data() + header.rtree_offset;
+    for (const auto &element : elements) {
+      RtreeRecord record;
+      const auto &segment = element.first;
+      record.start[0] = segment.first.get<0>();
+      record.start[1] = segment.first.get<1>();
+      record.start[2] = segment.first.get<2>();
+      record.end[0] = segment.second.get<0>();
+      record.end[1] = segment.second.get<1>();
+      record.end[2] = segment.second.get<2>();
+      record.waypoints[0] = MakeWaypointRecord(element.second.first);
+      record.waypoints[1] = MakeWaypointRecord(element.second.second);
+      std::memcpy(records, &record, sizeof(record));
+      records += sizeof(record);
+    }
+
+    header.file_size = buffer.size();
+    std::memcpy(buffer.data(), &header, sizeof(header));
+    return buffer;
+  }
+
+  bool MapSnapshot::Save(const Map &map, uint64_t opendrive_hash, const std::string &filename) {
+    // 快照只是缓存，编码失败或缓存目录不可写时不能影响地图的加载
+    std::string temporary;
+    try {
+      const auto content = Serialize(map, opendrive_hash);
+
+      std::string path = filename;
+      FileSystem::ValidateFilePath(path);
+
+      // 写入同目录下的临时文件后重命名，其他进程只会看到完整的快照
+      temporary = path + ".tmp" + std::to_string(std::random_device{}());
+      {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+        if (!out.good()) {
+          log_warning("Could not write map snapshot", temporary);
+          out.close();
+          std::remove(temporary.c_str());
+          return false;
+        }
+      }
+      if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        log_warning("Could not move map snapshot to", path);
+        std::remove(temporary.c_str());
+        return false;
+      }
+      return true;
+    } catch (const std::exception &e) {
+      log_warning("Could not save map snapshot", filename, ":", e.what());
+      if (!temporary.empty()) {
+        std::remove(temporary.c_str());
+      }
+      return false;
+    }
+  }
+
+  boost::optional<Map> MapSnapshot::Load(const std::string &filename, uint64_t opendrive_hash) {
+    namespace bip = boost::interprocess;
+    try {
+      // 直接映射快照文件，避免先整体复制到内存中
+      bip::file_mapping mapping(filename.c_str(), bip::read_only);
+      bip::mapped_region region(mapping, bip::read_only);
+      return Load(static_cast<const uint8_t *>(region.get_address()), region.get_size(), opendrive_hash);
+    } catch (const bip::interprocess_exception &e) {
+      // 第一次加载地图时快照还不存在
+      log_debug("Could not map road map snapshot", filename, ":", e.what());
+      return {};
+    }
+  }
+
+  boost::optional<Map> MapSnapshot::Load(const uint8_t *data, size_t size, uint64_t opendrive_hash) {
+    if (data == nullptr || size < sizeof(Header) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+      log_warning("Road map snapshot has an unknown format");
+      return {};
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != VERSION || header.header_size != sizeof(Header)) {
+      log_warning("Road map snapshot version", header.version, "does not match the expected version", VERSION);
+      return {};
+    }
+    if (header.opendrive_hash != opendrive_hash) {
+      log_debug("Road map snapshot was generated from a different OpenDRIVE file");
+      return {};
+    }
+    if (header.file_size > size ||
+        header.data_offset > size ||
+        header.data_size > size - header.data_offset ||
+        header.rtree_offset > size ||
+        header.rtree_count > (size - header.rtree_offset) / sizeof(RtreeRecord)) {
+      log_warning("Road map snapshot is truncated");
+      return {};
+    }
+
+    try {
+      MapData map_data = Decoder(data + header.data_offset, header.data_size).Decode();
+
+      std::vector<Map::Rtree::TreeElement> elements;
+      elements.reserve(header.rtree_count);
+      const auto *records = data + header.rtree_offset;
+      for (uint64_t i = 0u; i < header.rtree_count; ++i) {
+        RtreeRecord record;
+        std::memcpy(&record, records + i * sizeof(RtreeRecord), sizeof(record));
+        const Map::Rtree::BPoint start(record.start[0], record.start[1], record.start[2]);
+        const Map::Rtree::BPoint end(record.end[0], record.end[1], record.end[2]);
+        elements.emplace_back(
+            Map::Rtree::BSegment(start, end),
+            std::make_pair(MakeWaypoint(record.waypoints[0]), MakeWaypoint(record.waypoints[1])));
+      }
+
+      return Map(std::move(map_data), elements);
+    } catch (const std::exception &e) {
+      log_warning("Road map snapshot is corrupted:", e.what());
+      return {};
+    }
+  }
+
+} // namespace road
+} // namespace carla
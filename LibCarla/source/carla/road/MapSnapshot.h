@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/road/Map.h" // 引入地图模块
+
+#include <boost/optional.hpp> // 引入可选类型模块
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace carla {
+namespace road {
+
+  /// road::Map 的二进制快照。
+  ///
+  /// 快照保存了完整的 MapData（道路、车道段、车道、道路信息、交叉口、信号与
+  /// 控制器）以及 Map 中已经构建好的R树元素，加载时无需重新解析 OpenDRIVE
+  /// 的 XML，也无需重新计算R树中的变换。文件布局为：
+  ///
+  ///   Header
+  ///   uint8_t[data_size]                 按顺序编码的 MapData，指针以ID保存
+  ///   RtreeRecord[rtree_count]           R树元素，保持构建时的插入顺序
+  ///
+  /// 文件头中保存了生成快照的 OpenDRIVE 内容的哈希，内容改变后旧的快照会被
+  /// 拒绝。数值按本机字节序写入，格式改变时必须增加 VERSION。
+  class MapSnapshot {
+  public:
+
+    /// 文件开头的魔数。
+    static constexpr char MAGIC[8] = {'C', 'A', 'R', 'O', 'A', 'D', 'M', 'P'};
+
+    /// 当前的快照格式版本。版本2起R树元素按 Map::SortRtreeElements 的顺序保存。
+    static constexpr uint32_t VERSION = 2u;
+
+    /// 计算 OpenDRIVE 内容的64位 FNV-1a 哈希，用于标识快照对应的地图。
+    static uint64_t ComputeHash(const std::string &opendrive);
+
+    /// 将 @a map 编码为快照。
+    static std::vector<uint8_t> Serialize(const Map &map, uint64_t opendrive_hash);
+
+    /// 将 @a map 的快照写入 @a filename。先写入临时文件再重命名，
+    /// 多个客户端同时写入同一个快照时也不会读到不完整的文件。
+    /// 任何失败（包括无法创建目录或无法编码的地图）都只记录警告并返回false，不抛出异常。
+    static bool Save(const Map &map, uint64_t opendrive_hash, const std::string &filename);
+
+    /// 将 @a filename 映射到内存中并从中恢复地图。文件不存在、已损坏、版本或
+    /// 哈希与 @a opendrive_hash 不符时返回空值。
+    static boost::optional<Map> Load(const std::string &filename, uint64_t opendrive_hash);
+
+    /// 从内存中的快照恢复地图。
+    static boost::optional<Map> Load(const uint8_t *data, size_t size, uint64_t opendrive_hash);
+
+  private:
+
+    class Encoder;
+
+    class Decoder;
+  };
+
+} // namespace road
+} // namespace carla
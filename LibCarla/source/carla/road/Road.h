@@ -28,6 +28,7 @@ namespace road {
   class MapData; // 前向声明 MapData 类
   class Elevation; // 前向声明 Elevation 类
   class MapBuilder; // 前向声明 MapBuilder 类
+  class MapSnapshot; // 前向声明 MapSnapshot 类
 
   class Road : private MovableNonCopyable { // 定义 Road 类，继承自 MovableNonCopyable
   public:
@@ -111,6 +112,11 @@ namespace road {
       std::vector<const T*> GetInfos() const { // 模板函数，获取所有信息的常量指针
           return _info.GetInfos<T>();
       }
+
+      const std::vector<std::unique_ptr<element::RoadInfo>> &GetAllInfos() const { // 获取按s排序的全部信息，不区分类型
+          return _info.GetAll();
+      }
+
       template <typename T>
       std::vector<const T*> GetInfosInRange(const double min_s, const double max_s) const {
           // 在指定范围内获取信息，并返回常量指针的向量
@@ -179,6 +185,7 @@ namespace road {
   private:
 
       friend MapBuilder; // 声明 MapBuilder 为友元类
+      friend MapSnapshot; // 声明 MapSnapshot 为友元类
 
       MapData* _map_data{ nullptr }; // 地图数据指针，初始化为 nullptr
 
@@ -33,7 +33,8 @@ namespace road {  // 定义命名空间 road
     RoadElementSet(std::vector<InputTypeT> &&range)
       : _vec([](auto &&input) { // 初始化 _vec，使用 lambda 表达式
           static_assert(!std::is_const<InputTypeT>::value, "Input type cannot be const"); // 检查输入类型不能是常量
-          std::sort(std::begin(input), std::end(input), LessComp()); // 按照 LessComp 排序
+          // 稳定排序：距离相同的元素保持输入顺序，已排序的输入（例如地图快照）不会被打乱
+          std::stable_sort(std::begin(input), std::end(input), LessComp());
           return decltype(_vec){ // 返回 _vec 的移动迭代器
               std::make_move_iterator(std::begin(input)),
               std::make_move_iterator(std::end(input))};
@@ -18,6 +18,8 @@
 namespace carla {
 namespace road {
 
+  class MapSnapshot; // 前向声明地图快照类
+
   enum SignalOrientation { // 定义信号方向枚举
     Positive, // 正向
     Negative, // 负向
@@ -178,6 +180,7 @@ namespace road {
 
   private:
     friend MapBuilder; // 声明MapBuilder为友元类
+    friend MapSnapshot; // 声明MapSnapshot为友元类
 
     RoadId _road_id; // 道路ID
     SignId _signal_id; // 信号ID
@@ -0,0 +1,98 @@
+// Copyright (c) 2019 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace carla {
+namespace road {
+namespace element {
+
+  /// 以弧长 s 为自变量的查找表。每个采样点保存 N 个量的值及其对 s 的导数，
+  /// 查询时二分查找所在区间并做三次 Hermite 插值，避免每次 PosFromDist 都重新
+  /// 积分或求解曲线。
+  template <size_t N>
+  class ArcLengthTable {
+  public:
+
+    using Values = std::array<double, N>;
+
+    bool empty() const {
+      return _s.empty();
+    }
+
+    size_t size() const {
+      return _s.size();
+    }
+
+    void Reserve(size_t size) {
+      _s.reserve(size);
+      _values.reserve(size);
+      _derivatives.reserve(size);
+    }
+
+    /// 添加一个采样点，s 必须严格递增，否则忽略该点。
+    void Add(double s, const Values &values, const Values &derivatives) {
+      if (!_s.empty() && s <= _s.back()) {
+        return;
+      }
+      _s.emplace_back(s);
+      _values.emplace_back(values);
+      _derivatives.emplace_back(derivatives);
+    }
+
+    /// 表中最后一个采样点的弧长。
+    double GetMaxS() const {
+      DEBUG_ASSERT(!empty());
+      return _s.back();
+    }
+
+    /// 计算 @a s 处的插值，超出范围时截断到表的两端。
+    Values Evaluate(double s) const {
+      DEBUG_ASSERT(!empty());
+      if (s <= _s.front()) {
+        return _values.front();
+      }
+      if (s >= _s.back()) {
+        return _values.back();
+      }
+      const auto it = std::upper_bound(_s.begin(), _s.end(), s);
+      const size_t i = static_cast<size_t>(it - _s.begin()) - 1u;
+      const double h = _s[i + 1u] - _s[i];
+      const double t = (s - _s[i]) / h;
+      const double t2 = t * t;
+      const double t3 = t2 * t;
+      // Hermite 基函数
+      const double h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+      const double h10 = (t3 - 2.0 * t2 + t) * h;
+      const double h01 = -2.0 * t3 + 3.0 * t2;
+      const double h11 = (t3 - t2) * h;
+      Values result;
+      for (size_t k = 0u; k < N; ++k) {
+        result[k] =
+            h00 * _values[i][k] + h10 * _derivatives[i][k] +
+            h01 * _values[i + 1u][k] + h11 * _derivatives[i + 1u][k];
+      }
+      return result;
+    }
+
+  private:
+
+    std::vector<double> _s;
+
+    std::vector<Values> _values;
+
+    std::vector<Values> _derivatives;
+  };
+
+} // namespace element
+} // namespace road
+} // namespace carla
@@ -114,6 +114,84 @@ geom::Vector2D RotatebyAngle(double angle, double x, double y) {
     static_cast<float>(y * cos_a + x * sin_a));
 }
 
+namespace {
+
+    // 查找表的采样间隔（米）
+    constexpr double ARC_LENGTH_TABLE_STEP = 0.5;
+    // 精确求解时的积分步长（米）
+    constexpr double EXACT_INTEGRATION_STEP = 0.01;
+
+    // 用 Simpson 公式计算参数区间 [p0, p1] 内的弧长，rate 为 ds/dp
+    template <typename RateT>
+    double IntegrateArcLength(const RateT &rate, double p0, double p1) {
+        return (p1 - p0) / 6.0 * (rate(p0) + 4.0 * rate(0.5 * (p0 + p1)) + rate(p1));
+    }
+
+    // 精确求解：从起点以小步长积分，直到弧长达到 dist，返回对应的参数值
+    template <typename RateT>
+    double ParameterFromArcLength(const RateT &rate, double dist, double max_p, double step) {
+        double p = 0.0;
+        double s = 0.0;
+        while (p < max_p) {
+            const double next_p = std::min(p + step, max_p);
+            const double ds = IntegrateArcLength(rate, p, next_p);
+            if (s + ds >= dist) {
+                return ds > 0.0 ? p + (next_p - p) * (dist - s) / ds : p;
+            }
+            s += ds;
+            p = next_p;
+        }
+        return max_p;
+    }
+
+    // 构建参数 p 关于弧长 s 的查找表，导数 dp/ds 为 ds/dp 的倒数
+    template <typename RateT>
+    void BuildParameterTable(
+            ArcLengthTable<1> &table,
+            const RateT &rate,
+            double length,
+            double max_p,
+            size_t number_intervals) {
+        auto inverse = [&rate](double p) {
+            const double ds = rate(p);
+            return ds > 1e-9 ? 1.0 / ds : 0.0;
+        };
+        const double delta_p = max_p / static_cast<double>(number_intervals);
+        table.Reserve(number_intervals + 1u);
+        table.Add(0.0, {0.0}, {inverse(0.0)});
+        double p = 0.0;
+        double s = 0.0;
+        for (size_t i = 1u; i <= number_intervals && s < length; ++i) {
+            const double next_p = delta_p * static_cast<double>(i);
+            s += IntegrateArcLength(rate, p, next_p);
+            p = next_p;
+            table.Add(s, {p}, {inverse(p)});
+        }
+    }
+
+} // namespace
+
+// 函数：GeometrySpiral类的成员函数，计算起点在标准螺旋线上的参数和位置
+void GeometrySpiral::ComputeStartPoint() {
+    // 计算曲率的变化率
+    _curve_dot = (_curve_end - _curve_start) / (_length);
+    // 计算起始参数s_o
+    _s_o = _curve_start / _curve_dot;
+    // 计算起始参数对应的点坐标和切线方向
+    odrSpiral(_s_o, _curve_dot, &_x_o, &_y_o, &_t_o);
+}
+
+// 函数：GeometrySpiral类的成员函数，直接求解螺旋线上相对起点的偏移量
+geom::Vector2D GeometrySpiral::ExactOffsetFromDist(double dist) const {
+    double x;
+    double y;
+    double t;
+    // 调用odrSpiral函数，根据参数计算螺旋线上的点坐标和切线方向
+    odrSpiral(_s_o + dist, _curve_dot, &x, &y, &t);
+    // 计算相对坐标并旋转到起点的方向
+    return RotatebyAngle(_heading - _t_o, x - _x_o, y - _y_o);
+}
+
 // 函数：GeometrySpiral类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
@@ -124,49 +202,54 @@ DirectedPoint GeometrySpiral::PosFromDist(double dist) const {
     // 创建一个DirectedPoint对象，初始位置为_start_position，方向为_heading
     DirectedPoint p(_start_position, _heading);
 
-    // 获取螺旋线终点的曲率
-    const double curve_end = (_curve_end);
-    // 获取螺旋线起点的曲率
-    const double curve_start = (_curve_start);
-    // 计算曲率的变化率
-    const double curve_dot = (curve_end - curve_start) / (_length);
-    // 计算起始参数s_o
-    const double s_o = curve_start / curve_dot;
-    // 计算当前参数s
-    double s = s_o + dist;
-
-    double x;
-    double y;
-    double t;
-    // 调用odrSpiral函数，可能是根据参数计算螺旋线上的点坐标和切线方向
-    odrSpiral(s, curve_dot, &x, &y, &t);
-
-    double x_o;
-    double y_o;
-    double t_o;
-    // 再次调用odrSpiral函数，计算起始参数对应的点坐标和切线方向
-    odrSpiral(s_o, curve_dot, &x_o, &y_o, &t_o);
-
-    // 计算相对坐标x
-    x = x - x_o;
-    // 计算相对坐标y
-    y = y - y_o;
-    // 计算相对切线方向t
-    t = t - t_o;
+    geom::Vector2D pos;
+    if (_table.empty()) {
+        pos = ExactOffsetFromDist(dist);
+    } else {
+        const auto offset = _table.Evaluate(dist);
+        pos = geom::Vector2D(static_cast<float>(offset[0]), static_cast<float>(offset[1]));
+    }
 
-    // 调用RotatebyAngle函数旋转点坐标
-    geom::Vector2D pos = RotatebyAngle(_heading - t_o, x, y);
     // 更新位置的x坐标
     p.location.x += pos.x;
     // 更新位置的y坐标
     p.location.y += pos.y;
-    // 更新tangent（方向相关的值）
-    p.tangent = _heading + t;
+    // 切线方向有解析解 t = s * s * curve_dot / 2，不需要查表
+    const double s = _s_o + dist;
+    p.tangent = _heading + 0.5 * _curve_dot * (s * s - _s_o * _s_o);
 
     // 返回计算后的DirectedPoint对象
     return p;
 }
 
+// 函数：GeometrySpiral类的成员函数，预计算弧长查找表
+void GeometrySpiral::PrecomputeArcLengthTable() {
+    const size_t number_intervals =
+        std::max(static_cast<size_t>(std::ceil(_length / ARC_LENGTH_TABLE_STEP)), size_t(1));
+    const double delta_s = _length / static_cast<double>(number_intervals);
+    ArcLengthTable<2> table;
+    table.Reserve(number_intervals + 1u);
+    for (size_t i = 0u; i <= number_intervals; ++i) {
+        const double dist = delta_s * static_cast<double>(i);
+        double x;
+        double y;
+        double t;
+        odrSpiral(_s_o + dist, _curve_dot, &x, &y, &t);
+        const double angle = _heading - _t_o;
+        const double cos_a = std::cos(angle);
+        const double sin_a = std::sin(angle);
+        const double dx = x - _x_o;
+        const double dy = y - _y_o;
+        // 位置对弧长的导数就是该点的单位切向量
+        const double tangent = angle + t;
+        table.Add(
+            dist,
+            {dx * cos_a - dy * sin_a, dy * cos_a + dx * sin_a},
+            {std::cos(tangent), std::sin(tangent)});
+    }
+    _table = std::move(table);
+}
+
 // 函数：GeometrySpiral类的成员函数，计算到给定位置的距离（未完全实现）
 // location: 给定的位置
 std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &location) const {
@@ -175,25 +258,28 @@ std::pair<float, float> GeometrySpiral::DistanceTo(const geom::Location &locatio
     return {location.x - _start_position.x, location.y - _start_position.y};
 }
 
+// 函数：GeometryPoly3类的成员函数，弧长对参数u的导数
+double GeometryPoly3::ArcLengthRate(double u) const {
+    const double dv = _poly.Tangent(u);
+    return std::sqrt(1.0 + dv * dv);
+}
+
 // 函数：GeometryPoly3类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometryPoly3::PosFromDist(double dist) const {
-    // 使用rtree获取最近邻元素
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
-
-    // 获取最近邻元素中的两个值的引用
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
-
-    // 计算插值比例
-    double rate = (val2.s - dist) / (val2.s - val1.s);
-    // 根据插值比例计算u值
-    double u = rate * val1.u + (1.0 - rate) * val2.u;
-    // 根据插值比例计算v值
-    double v = rate * val1.v + (1.0 - rate) * val2.v;
-    // 根据插值比例计算tangent（可能是方向相关的值，这里计算方式存疑）
-    double tangent = atan((rate * val1.t + (1.0 - rate) * val2.t)); //?
+    // 将距离限制在0.0到_length之间
+    dist = geom::Math::Clamp(dist, 0.0, _length);
+    // 查表插值得到参数u，没有查找表时直接积分求解（ds/du >= 1，所以 u <= dist）
+    const double u = _table.empty() ?
+        ParameterFromArcLength(
+            [this](double x) { return ArcLengthRate(x); },
+            dist,
+            dist,
+            EXACT_INTEGRATION_STEP) :
+        _table.Evaluate(dist)[0];
+    // 由参数u精确计算v和切线方向
+    const double v = _poly.Evaluate(u);
+    const double tangent = std::atan(_poly.Tangent(u));
 
     // 调用RotatebyAngle函数旋转点坐标
     geom::Vector2D pos = RotatebyAngle(_heading, u, v);
@@ -215,76 +301,46 @@ std::pair<float, float> GeometryPoly3::DistanceTo(const geom::Location & /*p*/)
     return {_start_position.x, _start_position.y};
 }
 
-// 函数：GeometryPoly3类的成员函数，预计算样条曲线
-void GeometryPoly3::PreComputeSpline() {
-    // 定义常量，大概是区间大小（单位：米）
-    constexpr double interval_size = 0.3;
-    // 定义变量，表示u值的区间间隔，初始化为interval_size
-    const double delta_u = interval_size; // interval between values of u
-    double current_s = 0;
-    double current_u = 0;
-    double last_u = 0;
-    // 计算初始的v值
-    double last_v = _poly.Evaluate(current_u);
-    double last_s = 0;
-    // 创建一个RtreeValue对象，存储上次的值
-    RtreeValue last_val{last_u, last_v, last_s, _poly.Tangent(current_u)};
-    // 循环，直到current_s大于_length加上delta_u
-    while (current_s < _length + delta_u) {
-        // 更新u值
-        current_u += delta_u;
-        // 计算当前的v值
-        double current_v = _poly.Evaluate(current_u);
-        // 计算u值的差值
-        double du = current_u - last_u;
-        // 计算v值的差值
-        double dv = current_v - last_v;
-        // 计算s值的变化量
-        double ds = sqrt(du * du + dv * dv);
-        // 更新s值
-        current_s += ds;
-        // 计算当前的切线值
-        double current_t = _poly.Tangent(current_u);
-        // 创建一个当前的RtreeValue对象
-        RtreeValue current_val{current_u, current_v, current_s, current_t};
-
-        // 创建两个Rtree的点对象
-        Rtree::BPoint p1(static_cast<float>(last_s));
-        Rtree::BPoint p2(static_cast<float>(current_s));
-        // 在rtree中插入元素
-        _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
-
-        // 更新上次的值
-        last_u = current_u;
-        last_v = current_v;
-        last_s = current_s;
-        last_val = current_val;
+// 函数：GeometryPoly3类的成员函数，预计算弧长查找表
+void GeometryPoly3::PrecomputeArcLengthTable() {
+    // ds/du >= 1，u 取到 _length 时弧长一定不小于 _length
+    const size_t number_intervals =
+        std::max(static_cast<size_t>(std::ceil(_length / ARC_LENGTH_TABLE_STEP)), size_t(5));
+    ArcLengthTable<1> table;
+    BuildParameterTable(
+        table,
+        [this](double u) { return ArcLengthRate(u); },
+        _length,
+        _length,
+        number_intervals);
+    _table = std::move(table);
+}
 
-    }
+// 函数：GeometryParamPoly3类的成员函数，弧长对参数p的导数
+double GeometryParamPoly3::ArcLengthRate(double p) const {
+    const double du = _polyU.Tangent(p);
+    const double dv = _polyV.Tangent(p);
+    return std::sqrt(du * du + dv * dv);
 }
 
 // 函数：GeometryParamPoly3类的成员函数，根据距离获取位置点
 // dist: 距离
 DirectedPoint GeometryParamPoly3::PosFromDist(double dist) const {
-    // 使用rtree获取最近邻元素
-    auto result = _rtree.GetNearestNeighbours(
-        Rtree::BPoint(static_cast<float>(dist))).front();
-
-    // 获取最近邻元素中的两个值的引用
-    auto &val1 = result.second.first;
-    auto &val2 = result.second.second;
-    // 计算插值比例
-    double rate = (val2.s - dist) / (val2.s - val1.s);
-    // 根据插值比例计算u值
-    double u = rate * val1.u + (1.0 - rate) * val2.u;
-    // 根据插值比例计算v值
-    double v = rate * val1.v + (1.0 - rate) * val2.v;
-    // 根据插值比例计算t_u值
-    double t_u = (rate * val1.t_u + (1.0 - rate) * val2.t_u);
-    // 根据插值比例计算t_v值
-    double t_v = (rate * val1.t_v + (1.0 - rate) * val2.t_v);
-    // 根据t_u和t_v计算tangent（可能是方向相关的值）
-    double tangent = atan2(t_v, t_u); //?
+    // 将距离限制在0.0到_length之间
+    dist = geom::Math::Clamp(dist, 0.0, _length);
+    const double max_p = GetMaxParameter();
+    // 查表插值得到参数p，没有查找表时直接积分求解
+    const double param_p = _table.empty() ?
+        ParameterFromArcLength(
+            [this](double x) { return ArcLengthRate(x); },
+            dist,
+            max_p,
+            EXACT_INTEGRATION_STEP * max_p / _length) :
+        _table.Evaluate(dist)[0];
+    // 由参数p精确计算u、v和切线方向
+    const double u = _polyU.Evaluate(param_p);
+    const double v = _polyV.Evaluate(param_p);
+    const double tangent = std::atan2(_polyV.Tangent(param_p), _polyU.Tangent(param_p));
 
     // 调用RotatebyAngle函数旋转点坐标
     geom::Vector2D pos = RotatebyAngle(_heading, u, v);
@@ -306,84 +362,20 @@ std::pair<float, float> GeometryParamPoly3::DistanceTo(const geom::Location &) c
     return {_start_position.x, _start_position.y};
 }
 
-// 函数：GeometryParamPoly3类的成员函数，预计算样条曲线
-void GeometryParamPoly3::PreComputeSpline() {
-    // 定义常量，大概是区间大小（单位：米）
-    constexpr double interval_size = 0.5;
-    // 根据_length和interval_size计算区间数量，至少为5
-    size_t number_intervals =
-        std::max(static_cast<size_t>(_length / interval_size), size_t(5));
-    double delta_p = 1.0 / number_intervals;
-    if (_arcLength) {
-        // 如果_arcLength为真，根据_length调整delta_p
-        delta_p *= _length;
-    }
-    double param_p = 0;
-    double current_s = 0;
-    double last_u = _polyU.Evaluate(param_p);
-    double last_v = _polyV.Evaluate(param_p);
-    double last_s = 0;
-    // 创建一个RtreeValue对象，存储上次的值
-    RtreeValue last_val{
-        last_u,
-        last_v,
-        last_s,
-        _polyU.Tangent(param_p),
-        _polyV.Tangent(param_p) };
-    // 循环number_intervals次
-    for(size_t i = 0; i < number_intervals; ++i) {
-        // 更新param_p
-        param_p += delta_p;
-        // 计算当前的u值
-        double current_u = _polyU.Evaluate(param_p);
-        // 计算当前的v值
-        double current_v = _polyV.Evaluate(param_p);
-        // 计算u值的差值
-        double du = current_u - last_u;
-        // 计算v值的差值
-        double dv = current_v - last_v;
-        // 计算s值的变化量
-        double ds = sqrt(du * du + dv * dv);
-        // 更新s值
-        current_s += ds;
-        // 计算当前的u方向切线值
-        double current_t_u = _polyU.Tangent(param_p);
-        // 计算当前的v方向切线值
-        double current_t_v = _polyV.Tangent(param_p);
-        // 创建一个当前的RtreeValue对象
-        RtreeValue current_val{
-            current_u,
-            current_v,
-            current_s,
-            current_t_u,
-            current_t_v };
-
-       // 创建一个Rtree中的BPoint类型对象p1，将last_s转换为float类型后作为构造函数的参数
-      // BPoint可能是Rtree中表示点的数据结构，这里是使用last_s的值来初始化这个点
-       Rtree::BPoint p1(static_cast<float>(last_s));
-      // 创建一个Rtree中的BPoint类型对象p2，将current_s转换为float类型后作为构造函数的参数
-      // 同样，这里是使用current_s的值来初始化这个点
-       Rtree::BPoint p2(static_cast<float>(current_s));
-      // 调用_rtree对象的InsertElement函数，将由p1和p2组成的线段（BSegment）以及相关的值last_val和current_val插入到_rtree中
-     // 这里的_rtree可能是某种数据结构（例如空间索引结构），用于存储和管理这些元素
-      _rtree.InsertElement(Rtree::BSegment(p1, p2), last_val, current_val);
-
-     // 将当前的u值赋给last_u，用于记录上一次的u值，可能是为了后续的计算或者数据更新
-      last_u = current_u;
-     // 将当前的v值赋给last_v，用于记录上一次的v值
-      last_v = current_v;
-    // 将当前的s值赋给last_s，用于记录上一次的s值
-      last_s = current_s;
-    // 将当前的val值赋给last_val，用于记录上一次的val值，这里的val可能是包含多个属性值的数据结构
-      last_val = current_val;
-
-   // 如果当前的s值大于_length（这里_length可能是预先定义的某个长度限制或者阈值）
-      if (current_s > _length) {
-    // 则跳出当前的循环
-        break;
-       }
-    }
-  }
+// 函数：GeometryParamPoly3类的成员函数，预计算弧长查找表
+void GeometryParamPoly3::PrecomputeArcLengthTable() {
+    const size_t number_intervals =
+        std::max(static_cast<size_t>(std::ceil(_length / ARC_LENGTH_TABLE_STEP)), size_t(5));
+    ArcLengthTable<1> table;
+    BuildParameterTable(
+        table,
+        [this](double p) { return ArcLengthRate(p); },
+        _length,
+        GetMaxParameter(),
+        number_intervals);
+    _table = std::move(table);
+}
+
 } // namespace element
 } // namespace road
 } // namespace carla
\ No newline at end of file
@@ -10,10 +10,14 @@
 #include "carla/geom/Location.h"
 // 包含carla/geom/Math.h头文件
 #include "carla/geom/Math.h"
+// 包含carla/geom/Vector2D.h头文件
+#include "carla/geom/Vector2D.h"
 // 包含carla/geom/CubicPolynomial.h头文件
 #include "carla/geom/CubicPolynomial.h"
 // 包含carla/geom/Rtree.h头文件
 #include "carla/geom/Rtree.h"
+// 包含弧长查找表的定义
+#include "carla/road/element/ArcLengthTable.h"
 
 // 定义命名空间carla，在这个命名空间下包含road和其他相关的定义
 namespace carla {
@@ -88,7 +92,7 @@ namespace element {
         }
 
         // 获取起始位置的引用
-        const geom::Location &GetStartPosition() {
+        const geom::Location &GetStartPosition() const {
             return _start_position;
         }
 
@@ -101,6 +105,11 @@ namespace element {
         // 纯虚函数，计算到给定点的距离，返回一对浮点数，需要在派生类中实现
         virtual std::pair<float, float> DistanceTo(const geom::Location &p) const = 0;
 
+        /// 预先计算弧长查找表，由 MapBuilder 在创建几何体时调用一次。之后
+        /// PosFromDist 通过查表插值得到结果，未计算时退回到精确求解。
+        /// 直线和圆弧有解析解，不需要查找表。
+        virtual void PrecomputeArcLengthTable() {}
+
     protected:
         // 受保护的构造函数，用于初始化几何形状的基本属性
         Geometry(
@@ -217,15 +226,18 @@ namespace element {
      // 初始化本类中的_curve_start成员变量，将传入的curv_s赋值给它，表示曲线起始曲率
            _curve_start(curv_s),
      // 初始化本类中的_curve_end成员变量，将传入的curv_e赋值给它，表示曲线结束曲率
-           _curve_end(curv_e) {}
+           _curve_end(curv_e) {
+         // 起点在标准螺旋线上的位置只取决于构造参数，只需计算一次
+           ComputeStartPoint();
+       }
 
         // 获取曲线起始曲率的函数
-        double GetCurveStart() {
+        double GetCurveStart() const {
             return _curve_start;
         }
 
         // 获取曲线结束曲率的函数
-        double GetCurveEnd() {
+        double GetCurveEnd() const {
             return _curve_end;
         }
 
@@ -235,11 +247,31 @@ namespace element {
         // 重写DistanceTo函数，计算到给定点的距离（函数体未完整实现）
         std::pair<float, float> DistanceTo(const geom::Location &) const override;
 
+        // 按固定间隔采样 odrSpiral，保存相对起点的位置
+        void PrecomputeArcLengthTable() override;
+
     private:
         // 曲线起始曲率
         double _curve_start;
         // 曲线结束曲率
         double _curve_end;
+
+        // 曲率的变化率
+        double _curve_dot = 0.0;
+        // 起点在标准螺旋线上对应的参数
+        double _s_o = 0.0;
+        // 起点在标准螺旋线上的位置和切线方向
+        double _x_o = 0.0;
+        double _y_o = 0.0;
+        double _t_o = 0.0;
+
+        // 相对起点的 x、y 偏移量查找表（已旋转到世界坐标系）
+        ArcLengthTable<2> _table;
+
+        void ComputeStartPoint();
+
+        // 直接求解 odrSpiral 得到相对起点的偏移量
+        geom::Vector2D ExactOffsetFromDist(double dist) const;
     };
 
     // 定义表示三次多项式曲线的几何形状类，继承自Geometry类
@@ -278,8 +310,6 @@ namespace element {
         // 调用_poly对象（类型为geom::CubicPolynomial）的Set函数
         // 传入三次多项式的系数a、b、c、d来设置多项式
         _poly.Set(a, b, c, d);
-        // 调用PreComputeSpline函数，函数体未实现，可能用于预计算样条相关的操作
-        PreComputeSpline();
     }
         // 获取系数a的函数
         double Geta() const {
@@ -304,6 +334,9 @@ namespace element {
         // 重写DistanceTo函数，计算到给定点的距离（函数体未完整实现）
         std::pair<float, float> DistanceTo(const geom::Location &) const override;
 
+        // 计算参数 u 关于弧长的查找表
+        void PrecomputeArcLengthTable() override;
+
     private:
         // 三次多项式对象
         geom::CubicPolynomial _poly;
@@ -314,21 +347,11 @@ namespace element {
         double _c;
         double _d;
 
-        // 定义用于R - tree的值结构体
-        struct RtreeValue {
-            double u = 0;
-            double v = 0;
-            double s = 0;
-            double t = 0;
-        };
-        // 定义R - tree类型
-        using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-        // 定义R - tree元素类型
-        using TreeElement = Rtree::TreeElement;
-        // R - tree对象
-        Rtree _rtree;
-        // 预计算样条函数，函数体未实现
-        void PreComputeSpline();
+        // 参数 u 关于弧长 s 的查找表
+        ArcLengthTable<1> _table;
+
+        // 弧长对参数 u 的导数 ds/du
+        double ArcLengthRate(double u) const;
     };
 
     // 定义表示带参数的三次多项式曲线的几何形状类，继承自Geometry类
@@ -367,8 +390,6 @@ namespace element {
             _polyU.Set(aU, bU, cU, dU); 
 // 同理，使用传入的系数设置_polyV这个多项式对象，用于V方向的相关几何计算
             _polyV.Set(aV, bV, cV, dV);
-// 调用PreComputeSpline函数（应该是用于预先计算样条相关的数据或者进行一些初始化计算，为后续几何处理做准备，具体功能要看其函数实现）
-            PreComputeSpline();
         }
 
         // 获取系数aU的函数
@@ -404,12 +425,20 @@ namespace element {
             return _dV;
         }
 
+        // 参数 p 是否为弧长（否则取值范围为 [0, 1]）
+        bool IsArcLength() const {
+            return _arcLength;
+        }
+
         // 重写PosFromDist函数，根据距离计算带参数的三次多项式曲线上的位置
         DirectedPoint PosFromDist(double dist) const override;
 
         // 重写DistanceTo函数，计算到给定点的距离（函数体未完整实现）
         std::pair<float, float> DistanceTo(const geom::Location &) const override;
 
+        // 计算参数 p 关于弧长的查找表
+        void PrecomputeArcLengthTable() override;
+
     private:
         // 用于U方向的三次多项式对象
         geom::CubicPolynomial _polyU;
@@ -427,22 +456,16 @@ namespace element {
         // 是否为弧长相关的标志
         bool _arcLength;
 
-        // 定义用于R - tree的值结构体
-        struct RtreeValue {
-            double u = 0;
-            double v = 0;
-            double s = 0;
-            double t_u = 0;
-            double t_v = 0;
-        };
-        // 定义R - tree类型
-        using Rtree = geom::SegmentCloudRtree<RtreeValue, 1>;
-        // 定义R - tree元素类型
-        using TreeElement = Rtree::TreeElement;
-        // R - tree对象
-        Rtree _rtree;
-        // 预计算样条函数，函数体未实现
-        void PreComputeSpline();
+        // 参数 p 关于弧长 s 的查找表
+        ArcLengthTable<1> _table;
+
+        // 参数 p 的取值上限（arcLength 时为曲线长度，否则为1）
+        double GetMaxParameter() const {
+            return _arcLength ? _length : 1.0;
+        }
+
+        // 弧长对参数 p 的导数 ds/dp
+        double ArcLengthRate(double p) const;
     };
 
 } // namespace element
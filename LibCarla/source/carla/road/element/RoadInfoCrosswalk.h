@@ -57,6 +57,8 @@ namespace element { // 开始 element 命名空间
 
     // 获取 s 坐标
     double GetS() const { return GetDistance(); };
+    // 获取人行横道的名称
+    const std::string &GetName() const { return _name; };
     // 获取 t 坐标
     double GetT() const { return _t; };
     // 获取人行横道的宽度
@@ -25,6 +25,11 @@ namespace element {
       : RoadInfo(s), // 调用基类构造函数
         _elevation(a, b, c, d, s) {} // 初始化_elevation成员变量
 
+    /// 使用已经平移到道路起点的多项式构造，用于从地图快照恢复。
+    RoadInfoElevation(double s, const geom::CubicPolynomial &elevation)
+      : RoadInfo(s),
+        _elevation(elevation) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final { // 接受访问者模式的函数，用于访问RoadInfoElevation对象
       v.Visit(*this); // 调用访问者对象的Visit函数
     }
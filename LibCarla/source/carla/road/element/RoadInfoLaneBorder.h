@@ -30,6 +30,11 @@ namespace element {
       : RoadInfo(s), // 初始化基类RoadInfo
         _border(a, b, c, d, s) {} // 初始化边界多项式
 
+    // 使用已经平移到道路起点的多项式构造，用于从地图快照恢复
+    RoadInfoLaneBorder(double s, const geom::CubicPolynomial &border)
+      : RoadInfo(s),
+        _border(border) {}
+
     // 接受访问者模式的实现
     void AcceptVisitor(RoadInfoVisitor &v) final {
       v.Visit(*this); // 调用访问者的Visit方法
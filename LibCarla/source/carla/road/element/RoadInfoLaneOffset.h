@@ -29,6 +29,10 @@ namespace element {
       : RoadInfo(s), // 调用基类RoadInfo的构造函数，传递参数s
         _offset(a, b, c, d, s) {} // 初始化成员变量_offset
 
+    RoadInfoLaneOffset(double s, const geom::CubicPolynomial &offset) // 使用已经平移的多项式构造，用于从地图快照恢复
+      : RoadInfo(s),
+        _offset(offset) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final { // 访问者模式的AcceptVisitor函数，允许访问者对象访问当前对象
       v.Visit(*this); // 访问者访问当前对象
     }
@@ -29,6 +29,10 @@ namespace element { // 定义element命名空间
       : RoadInfo(s),  // 初始化基类
         _width(a, b, c, d, s) {} // 初始化成员变量_width
 
+    RoadInfoLaneWidth(double s, const geom::CubicPolynomial &width) // 使用已经平移的多项式构造，用于从地图快照恢复
+      : RoadInfo(s),
+        _width(width) {}
+
     void AcceptVisitor(RoadInfoVisitor &v) final { // 接受访问者模式的访问
       v.Visit(*this); // 访问当前对象
     }
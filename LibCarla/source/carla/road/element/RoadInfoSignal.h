@@ -99,6 +99,7 @@ namespace element {  // 定义 element 子命名空间
 
   private:
     friend MapBuilder;  // 声明 MapBuilder 为友元类，允许其访问私有成员
+    friend MapSnapshot;  // 声明 MapSnapshot 为友元类，允许其访问私有成员
 
     SignId _signal_id;  // 信号 ID
     Signal* _signal;  // 信号对象指针
@@ -70,6 +70,14 @@ namespace carla {
                 _client.async_call(function, Metadata::MakeAsync(), std::forward<Args>(args)...);
             }
 
+            // 发起一个需要响应的远程过程调用，但不等待结果，而是立即返回一个 std::future。
+            // 与 call 一样使用 Metadata::MakeSync()，服务器会返回结果；与 async_call 不同，
+            // 调用者可以连续发出多个请求后再统一等待（流水线），避免每个请求都等待一次往返。
+            template <typename... Args>
+            auto async_request(const std::string &function, Args &&... args) {
+                return _client.async_call(function, Metadata::MakeSync(), std::forward<Args>(args)...);
+            }
+
         private:
             // 定义了一个私有成员变量 _client，类型为 ::rpc::client，
             // 它是底层实际用于和远程服务进行交互的RPC客户端对象，
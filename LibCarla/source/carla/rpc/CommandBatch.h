@@ -0,0 +1,84 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/Debug.h"
+#include "carla/MsgPack.h"
+#include "carla/rpc/Command.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace carla {
+namespace rpc {
+
+  /// 对一段连续存储的命令的只读引用。
+  ///
+  /// 序列化结果与 std::vector<Command> 完全相同（msgpack 数组），服务器端照常按
+  /// std::vector<Command> 接收。RPC 调用会复制一份参数再打包，传入引用而不是
+  /// 向量可以让调用方复用自己预先分配的命令缓冲区，命令直接写入请求的缓冲区。
+  /// 在调用返回之前，被引用的命令不能被修改或释放。
+  class CommandBatchView {
+  public:
+
+    CommandBatchView(const Command *begin, const Command *end)
+      : _begin(begin),
+        _end(end) {
+      DEBUG_ASSERT(begin <= end);
+    }
+
+    explicit CommandBatchView(const std::vector<Command> &commands)
+      : CommandBatchView(commands.data(), commands.data() + commands.size()) {}
+
+    const Command *begin() const {
+      return _begin;
+    }
+
+    const Command *end() const {
+      return _end;
+    }
+
+    size_t size() const {
+      return static_cast<size_t>(_end - _begin);
+    }
+
+    bool empty() const {
+      return _begin == _end;
+    }
+
+  private:
+
+    const Command *_begin;
+
+    const Command *_end;
+  };
+
+} // namespace rpc
+} // namespace carla
+
+namespace clmdep_msgpack {
+MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
+namespace adaptor {
+
+  // 按 std::vector<carla::rpc::Command> 的格式打包
+  template<>
+  struct pack<carla::rpc::CommandBatchView> {
+    template <typename Stream>
+    packer<Stream> &operator()(
+        clmdep_msgpack::packer<Stream> &o,
+        const carla::rpc::CommandBatchView &v) const {
+      o.pack_array(static_cast<uint32_t>(v.size()));
+      for (const auto &command : v) {
+        o.pack(command);
+      }
+      return o;
+    }
+  };
+
+} // namespace adaptor
+} // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
+} // namespace clmdep_msgpack
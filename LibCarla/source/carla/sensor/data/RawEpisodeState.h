@@ -7,6 +7,7 @@
 #pragma once
 
 #include "carla/Debug.h"
+#include "carla/ListView.h"
 #include "carla/sensor/data/ActorDynamicState.h"
 #include "carla/sensor/data/Array.h"
 #include "carla/sensor/s11n/EpisodeStateSerializer.h"
@@ -27,9 +28,11 @@ namespace data {
 // 将EpisodeStateSerializer声明为友元类，这样它可以访问本类的私有成员，方便进行序列化相关操作
     friend Serializer;
 
-// 显式构造函数，接受一个右值引用的RawData类型参数，用于初始化基类Array，通过调用Serializer的header_offset和移动传入的数据来完成初始化
+// 显式构造函数，接受一个右值引用的RawData类型参数，用于初始化基类Array，参与者数组的偏移量由Serializer根据消息是否为增量计算
     explicit RawEpisodeState(RawData &&data)
-      : Super(Serializer::header_offset, std::move(data)) {}
+      : Super(std::move(data), [](const RawData &raw) {
+          return Serializer::ActorsOffset(raw);
+        }) {}
 
   private:
 
@@ -69,6 +72,35 @@ namespace data {
       return GetHeader().simulation_state;
     }
 
+    /// 消息是否为相对于关键帧的增量。为真时迭代得到的只是自关键帧以来
+    /// 发生了变化的参与者。
+    bool IsDelta() const {
+      return (GetHeader().simulation_state & Serializer::SimulationState::Delta) != 0;
+    }
+
+    /// 增量所基于的关键帧的帧号，仅对增量消息有效。
+    uint64_t GetKeyframe() const {
+      DEBUG_ASSERT(IsDelta());
+      return Serializer::DeserializeDeltaHeader(Super::GetRawData()).keyframe;
+    }
+
+    /// 应用增量后世界中的参与者总数；对完整帧等于 size()。
+    size_t GetActorCount() const {
+      return IsDelta() ?
+          Serializer::DeserializeDeltaHeader(Super::GetRawData()).actor_count :
+          Super::size();
+    }
+
+    /// 自关键帧以来被删除的参与者ID；对完整帧为空。
+    auto GetRemovedActorIds() const {
+      const auto &raw = Super::GetRawData();
+      const bool is_delta = IsDelta();
+      const ActorId *begin = reinterpret_cast<const ActorId *>(
+          raw.begin() + (is_delta ? Serializer::RemovedActorsOffset() : raw.size()));
+      const size_t count = is_delta ? Serializer::DeserializeDeltaHeader(raw).removed_count : 0u;
+      return MakeListView(begin, begin + count);
+    }
+
   };
 
 } // namespace data
@@ -8,9 +8,53 @@
 
 #include "carla/sensor/data/RawEpisodeState.h" // 包含 RawEpisodeState 数据类型的定义
 
+#include <cmath>
+#include <cstring>
+
 namespace carla {
 namespace sensor {
 namespace s11n {
+
+  namespace {
+
+    bool IsWithin(const geom::Vector3D &lhs, const geom::Vector3D &rhs, float tolerance) {
+      return std::abs(lhs.x - rhs.x) <= tolerance &&
+             std::abs(lhs.y - rhs.y) <= tolerance &&
+             std::abs(lhs.z - rhs.z) <= tolerance;
+    }
+
+  } // namespace
+
+  bool EpisodeStateSerializer::IsNearlyEqual(
+      const data::ActorDynamicState &lhs,
+      const data::ActorDynamicState &rhs) {
+    // 结构体是紧凑排列的，先复制成员再比较，避免引用未对齐的字段
+    const geom::Transform lhs_transform = lhs.transform;
+    const geom::Transform rhs_transform = rhs.transform;
+    const geom::Rotation &lhs_rotation = lhs_transform.rotation;
+    const geom::Rotation &rhs_rotation = rhs_transform.rotation;
+    return
+        lhs.id == rhs.id &&
+        lhs.actor_state == rhs.actor_state &&
+        std::memcmp(&lhs.state, &rhs.state, sizeof(lhs.state)) == 0 &&
+        IsWithin(lhs_transform.location, rhs_transform.location, 1e-3f) &&
+        std::abs(lhs_rotation.pitch - rhs_rotation.pitch) <= 1e-2f &&
+        std::abs(lhs_rotation.yaw - rhs_rotation.yaw) <= 1e-2f &&
+        std::abs(lhs_rotation.roll - rhs_rotation.roll) <= 1e-2f &&
+        IsWithin(lhs.velocity, rhs.velocity, 1e-3f) &&
+        IsWithin(lhs.angular_velocity, rhs.angular_velocity, 1e-3f) &&
+        IsWithin(lhs.acceleration, rhs.acceleration, 1e-2f);
+  }
+
+  size_t EpisodeStateSerializer::ActorsOffset(const RawData &message) {
+    const auto &header = DeserializeHeader(message);
+    if ((header.simulation_state & SimulationState::Delta) == 0) {
+      return header_offset;
+    }
+    const auto &delta = DeserializeDeltaHeader(message);
+    return RemovedActorsOffset() + sizeof(ActorId) * delta.removed_count;
+  }
+
   //从原始传感器数据反序列化出场景状态数据
   SharedPtr<SensorData> EpisodeStateSerializer::Deserialize(RawData &&data) {
     // 将输入的原始数据封装到一个新的 RawEpisodeState 对象中
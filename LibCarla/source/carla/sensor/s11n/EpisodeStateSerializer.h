@@ -30,7 +30,8 @@ namespace s11n {
     enum SimulationState {  //枚举类，用于表示模拟状态的类型
       None               = (0x0 << 0),  // 默认状态，无特定更新
       MapChange          = (0x1 << 0),  // 表示地图变更的状态
-      PendingLightUpdate = (0x1 << 1)  // 表示待处理的交通信号灯更新
+      PendingLightUpdate = (0x1 << 1),  // 表示待处理的交通信号灯更新
+      Delta              = (0x1 << 2)   // 表示消息是相对于关键帧的增量
     };
 
 #pragma pack(push, 1)
@@ -41,15 +42,57 @@ namespace s11n {
       geom::Vector3DInt map_origin;  // 地图的原点位置（三维整数坐标）
       SimulationState simulation_state = SimulationState::None;  // 当前的模拟状态
     };
+
+    /// 增量消息在 Header 之后的附加头部。
+    ///
+    /// 增量模式下服务器周期性地发送完整的关键帧，其余帧只发送相对于最近
+    /// 关键帧发生了变化（或新增）的参与者以及自关键帧以来被删除的参与者：
+    ///
+    ///   Header
+    ///   DeltaHeader
+    ///   ActorId[removed_count]
+    ///   ActorDynamicState[...]  变化的参与者，直到消息结束
+    ///
+    /// 增量总是相对于关键帧而不是上一帧，所以丢失任意增量消息都不影响
+    /// 之后的帧，只要客户端收到了对应的关键帧即可。
+    struct DeltaHeader {
+      uint64_t keyframe;       // 基准关键帧的帧号
+      uint32_t actor_count;    // 应用增量后的参与者总数
+      uint32_t removed_count;  // 自关键帧以来被删除的参与者数量
+    };
 #pragma pack(pop)
 
     constexpr static auto header_offset = sizeof(Header);  // 数据头部的偏移量，用于快速定位数据正文
 
+    /// 判断两个参与者状态在增量编码的精度内是否相同。
+    ///
+    /// 位置的容差为1毫米，旋转为0.01度，速度、角速度与加速度各分量为
+    /// 1e-3（加速度为1e-2，它由速度差分得到，噪声更大）；参与者状态以及
+    /// 与类型相关的状态（交通灯、车辆控制等）必须逐字节相同。在容差之内
+    /// 的参与者不会被发送，客户端继续使用关键帧中的值，因此误差不会累积。
+    static bool IsNearlyEqual(
+        const data::ActorDynamicState &lhs,
+        const data::ActorDynamicState &rhs);
+
+    /// 增量消息中被删除的参与者ID列表的偏移量。
+    static size_t RemovedActorsOffset() {
+      return header_offset + sizeof(DeltaHeader);
+    }
+
+    /// 消息中参与者状态数组的偏移量。
+    static size_t ActorsOffset(const RawData &message);
+
     //反序列化数据包头部
     static const Header &DeserializeHeader(const RawData &message) {  // 反序列化数据包头部
       return *reinterpret_cast<const Header *>(message.begin());  // 返回解析后的'Header'结构体的引用
     }
 
+    /// 反序列化增量消息的附加头部，仅在 simulation_state 带有 Delta 标志时有效。
+    static const DeltaHeader &DeserializeDeltaHeader(const RawData &message) {
+      DEBUG_ASSERT(message.size() >= RemovedActorsOffset());
+      return *reinterpret_cast<const DeltaHeader *>(message.begin() + header_offset);
+    }
+
     template <typename SensorT>//序列化传感器数据
     static Buffer Serialize(const SensorT &, Buffer &&buffer) { // Sensor为输入的传感器对像，buffer为输入的缓冲区数据
       return std::move(buffer); // 直接返回传入的缓冲区数据
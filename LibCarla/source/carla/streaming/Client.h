@@ -44,6 +44,11 @@ public:
     }
     // 模板函数，用于订阅一个令牌（Token）对应的流，并传入一个回调函数（Functor），内部调用底层客户端的订阅方法，并传入线程池的输入输出上下文（io_context）、令牌和回调函数。
 
+    /// 与服务器在同一台机器上时，之后订阅的流通过共享内存接收较大的消息。
+    void EnableSharedMemory(size_t capacity = detail::shm::DefaultCapacity) {
+      _client.EnableSharedMemory(capacity);
+    }
+
     void UnSubscribe(const Token &token) {
       _client.UnSubscribe(token);
     }
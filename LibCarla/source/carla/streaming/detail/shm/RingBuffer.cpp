@@ -0,0 +1,166 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/streaming/detail/shm/RingBuffer.h"
+
+#include "carla/Exception.h"
+
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include <atomic>
+#include <exception>
+#include <new>
+#include <random>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  namespace bip = boost::interprocess;
+
+  static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared memory requires lock-free 64-bit atomics");
+
+  /// 共享内存名字的前缀，服务器只打开带有该前缀的共享内存。
+  static constexpr char NAME_PREFIX[] = "carla_stream_";
+
+  static constexpr uint64_t MAGIC = 0x4341524c41524e47ull;
+
+  static constexpr uint32_t VERSION = 1u;
+
+  /// 位于共享内存开头的头部，读写位置放在不同的缓存行中。
+  struct RingBuffer::Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> write_position;
+    alignas(64) std::atomic<uint64_t> read_position;
+  };
+
+  struct RingBuffer::Mapping {
+    bip::shared_memory_object object;
+    bip::mapped_region region;
+  };
+
+  /// 数据区相对共享内存开头的偏移。
+  static constexpr size_t DATA_OFFSET = 256u;
+
+  RingBuffer::RingBuffer(std::string name, bool is_owner)
+    : _name(std::move(name)),
+      _is_owner(is_owner),
+      _mapping(std::make_unique<Mapping>()) {}
+
+  RingBuffer::~RingBuffer() {
+    if (_is_owner) {
+      Unlink();
+    }
+  }
+
+  std::unique_ptr<RingBuffer> RingBuffer::Create(const std::string &name, size_t capacity) {
+    static_assert(sizeof(Header) <= DATA_OFFSET, "Header does not fit");
+    if (name.size() > MaxNameLength || capacity == 0u) {
+      throw_exception(std::invalid_argument("invalid shared memory ring buffer"));
+    }
+    std::unique_ptr<RingBuffer> ring(new RingBuffer(name, true));
+    bip::shared_memory_object::remove(name.c_str());
+    ring->_mapping->object = bip::shared_memory_object(bip::create_only, name.c_str(), bip::read_write);
+    ring->_mapping->object.truncate(static_cast<bip::offset_t>(DATA_OFFSET + capacity));
+    ring->_mapping->region = bip::mapped_region(ring->_mapping->object, bip::read_write);
+
+    auto *address = static_cast<unsigned char *>(ring->_mapping->region.get_address());
+    ring->_header = new (address) Header();
+    ring->_header->magic = MAGIC;
+    ring->_header->version = VERSION;
+    ring->_header->reserved = 0u;
+    ring->_header->capacity = capacity;
+    ring->_header->write_position.store(0u, std::memory_order_relaxed);
+    ring->_header->read_position.store(0u, std::memory_order_release);
+    ring->_data = address + DATA_OFFSET;
+    ring->_capacity = capacity;
+    return ring;
+  }
+
+  std::unique_ptr<RingBuffer> RingBuffer::Open(const std::string &name) {
+    if ((name.size() > MaxNameLength) || (name.compare(0u, sizeof(NAME_PREFIX) - 1u, NAME_PREFIX) != 0)) {
+      throw_exception(std::invalid_argument("invalid shared memory name"));
+    }
+    std::unique_ptr<RingBuffer> ring(new RingBuffer(name, false));
+    ring->_mapping->object = bip::shared_memory_object(bip::open_only, name.c_str(), bip::read_write);
+    ring->_mapping->region = bip::mapped_region(ring->_mapping->object, bip::read_write);
+
+    const size_t region_size = ring->_mapping->region.get_size();
+    auto *address = static_cast<unsigned char *>(ring->_mapping->region.get_address());
+    if (region_size <= DATA_OFFSET) {
+      throw_exception(std::runtime_error("shared memory ring buffer too small"));
+    }
+    ring->_header = reinterpret_cast<Header *>(address);
+    if ((ring->_header->magic != MAGIC) ||
+        (ring->_header->version != VERSION) ||
+        (ring->_header->capacity > region_size - DATA_OFFSET)) {
+      throw_exception(std::runtime_error("invalid shared memory ring buffer header"));
+    }
+    ring->_data = address + DATA_OFFSET;
+    ring->_capacity = static_cast<size_t>(ring->_header->capacity);
+    return ring;
+  }
+
+  std::string RingBuffer::MakeUniqueName(stream_id_type stream_id) {
+    static std::atomic<uint32_t> counter{0u};
+    static const uint64_t seed = []() {
+      std::random_device device;
+      return (static_cast<uint64_t>(device()) << 32u) ^ device();
+    }();
+    return std::string(NAME_PREFIX) +
+        std::to_string(seed) + '_' +
+        std::to_string(counter++) + '_' +
+        std::to_string(stream_id);
+  }
+
+  void RingBuffer::Unlink() {
+    bip::shared_memory_object::remove(_name.c_str());
+  }
+
+  unsigned char *RingBuffer::Reserve(size_t size, uint64_t &position) {
+    if (size == 0u || size > _capacity) {
+      return nullptr;
+    }
+    const uint64_t write_position = _header->write_position.load(std::memory_order_relaxed);
+    const uint64_t read_position = _header->read_position.load(std::memory_order_acquire);
+    const uint64_t offset = write_position % _capacity;
+    // 消息总是连续存放，末尾空间不足时跳到环的开头
+    const uint64_t start = (offset + size > _capacity) ? write_position + (_capacity - offset) : write_position;
+    if (start + size - read_position > _capacity) {
+      return nullptr;
+    }
+    position = start;
+    return _data + (start % _capacity);
+  }
+
+  void RingBuffer::Commit(uint64_t write_position) {
+    _header->write_position.store(write_position, std::memory_order_release);
+  }
+
+  bool RingBuffer::Read(uint64_t position, size_t size, unsigned char *destination) {
+    const uint64_t read_position = _header->read_position.load(std::memory_order_relaxed);
+    const uint64_t write_position = _header->write_position.load(std::memory_order_acquire);
+    const uint64_t offset = position % _capacity;
+    if ((position < read_position) ||
+        (size > _capacity) ||
+        (position + size > write_position) ||
+        (offset + size > _capacity)) {
+      return false;
+    }
+    std::memcpy(destination, _data + offset, size);
+    _header->read_position.store(position + size, std::memory_order_release);
+    return true;
+  }
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
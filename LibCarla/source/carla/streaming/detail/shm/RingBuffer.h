@@ -0,0 +1,139 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/NonCopyable.h"
+#include "carla/streaming/detail/Types.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace carla {
+namespace streaming {
+namespace detail {
+namespace shm {
+
+  /// 同一台机器上的服务器与客户端之间通过共享内存传递消息内容。
+  ///
+  /// 订阅流程与TCP完全相同：客户端通过TCP连接服务器并发送流ID，Dispatcher
+  /// 照常注册会话。启用共享内存的客户端会先创建一个环形缓冲区，在流ID中置
+  /// 上 SharedMemoryFlag，并在其后发送 Handshake 告诉服务器环形缓冲区的名字。
+  /// 之后服务器把较大的消息拷贝到环形缓冲区中，TCP连接上只发送一个
+  /// MessageHeader（大小中置上 SharedMemoryFlag，后跟消息在环中的位置），
+  /// 数据本身不再经过内核的套接字缓冲区。环形缓冲区已满或消息太小时，
+  /// 消息仍按原来的格式直接通过TCP发送。
+
+  /// 握手中的流ID与消息头中的大小使用的标志位。
+  constexpr uint32_t SharedMemoryFlag = 1u << 31;
+
+  /// 共享内存名字的最大长度。
+  constexpr size_t MaxNameLength = 64u;
+
+  /// 客户端默认创建的环形缓冲区大小，可以同时容纳几帧4K图像。
+  constexpr size_t DefaultCapacity = 128u * 1024u * 1024u;
+
+  /// 小于该大小的消息直接通过TCP发送。
+  constexpr size_t MinMessageSize = 64u * 1024u;
+
+#pragma pack(push, 1)
+
+  /// 客户端在流ID之后发送的握手数据。
+  struct Handshake {
+    uint32_t name_length = 0u;
+    char name[MaxNameLength] = {};
+  };
+
+  /// 通过共享内存发送的消息在TCP连接上的消息头。
+  struct MessageHeader {
+    message_size_type size;
+    uint64_t position;
+  };
+
+#pragma pack(pop)
+
+  /// 位于共享内存中的单生产者单消费者环形缓冲区。
+  ///
+  /// 服务器会话是唯一的生产者，客户端是唯一的消费者。消息总是连续存放，
+  /// 末尾剩余空间不足时跳到环的开头；消费者按顺序读取消息，读取后释放该
+  /// 消息及其之前跳过的空间。读写位置是单调递增的字节计数。
+  class RingBuffer : private NonCopyable {
+  public:
+
+    /// 创建一个新的共享内存段（客户端）。失败时抛出异常。
+    static std::unique_ptr<RingBuffer> Create(const std::string &name, size_t capacity);
+
+    /// 打开客户端创建的共享内存段（服务器）。失败时抛出异常。
+    static std::unique_ptr<RingBuffer> Open(const std::string &name);
+
+    /// 为当前进程生成一个不会冲突的共享内存名字。
+    static std::string MakeUniqueName(stream_id_type stream_id);
+
+    ~RingBuffer();
+
+    const std::string &GetName() const {
+      return _name;
+    }
+
+    size_t GetCapacity() const {
+      return _capacity;
+    }
+
+    /// 从系统中删除共享内存的名字，已经建立的映射仍然有效。
+    void Unlink();
+
+    /// 生产者：将缓冲区序列 [begin, end) 共 @a size 字节拷贝到环中，并在
+    /// @a position 中返回其位置。空间不足时返回 false。
+    template <typename ConstBufferIterator>
+    bool TryWrite(ConstBufferIterator begin, ConstBufferIterator end, size_t size, uint64_t &position) {
+      unsigned char *destination = Reserve(size, position);
+      if (destination == nullptr) {
+        return false;
+      }
+      for (; begin != end; ++begin) {
+        std::memcpy(destination, begin->data(), begin->size());
+        destination += begin->size();
+      }
+      Commit(position + size);
+      return true;
+    }
+
+    /// 消费者：将位于 @a position 的 @a size 字节拷贝到 @a destination 并释放
+    /// 这部分空间。位置无效时返回 false。
+    bool Read(uint64_t position, size_t size, unsigned char *destination);
+
+  private:
+
+    struct Header;
+
+    RingBuffer(std::string name, bool is_owner);
+
+    unsigned char *Reserve(size_t size, uint64_t &position);
+
+    void Commit(uint64_t write_position);
+
+    const std::string _name;
+
+    const bool _is_owner;
+
+    struct Mapping;
+
+    std::unique_ptr<Mapping> _mapping;
+
+    Header *_header = nullptr;
+
+    unsigned char *_data = nullptr;
+
+    size_t _capacity = 0u;
+  };
+
+} // namespace shm
+} // namespace detail
+} // namespace streaming
+} // namespace carla
@@ -20,7 +20,9 @@
 // 这会导致客户机和服务器之间的不同步，并最终导致泄漏：https://github.com/carla-simulator/carla/pull/8130
 #include <boost/asio/bind_executor.hpp>
 
+#include <cstring>
 #include <exception>
+#include <vector>
 
 namespace carla {
 namespace streaming {
@@ -32,25 +34,46 @@ namespace tcp {
   // ===========================================================================
 
   /// 读取传入TCP消息的助手。在单个缓冲区中分配整个消息。
+  ///
+  /// 读到消息头之后才从池中弹出缓冲区，这样可以按消息大小选择合适的缓冲区。
   class IncomingMessage {
   public:
 
-    explicit IncomingMessage(Buffer &&buffer) : _message(std::move(buffer)) {}
+    explicit IncomingMessage(std::shared_ptr<BufferPool> pool) : _pool(std::move(pool)) {}
 
     // 获取缓冲区的大小
     boost::asio::mutable_buffer size_as_buffer() {
       return boost::asio::buffer(&_size, sizeof(_size));
     }
 
+    // 获取消息在环形缓冲区中的位置
+    boost::asio::mutable_buffer position_as_buffer() {
+      return boost::asio::buffer(&_position, sizeof(_position));
+    }
+
     // 获取消息的缓冲区
     boost::asio::mutable_buffer buffer() {
-      DEBUG_ASSERT(_size > 0u);
-      _message.reset(_size);
+      DEBUG_ASSERT(size() > 0u);
+      _message = _pool->Pop(size());
+      _message.reset(size());
       return _message.buffer();
     }
 
-    auto size() const {
-      return _size;
+    /// 将消息内容从环形缓冲区拷贝到池中的缓冲区。
+    bool CopyFromSharedMemory(shm::RingBuffer &ring) {
+      DEBUG_ASSERT(is_shared_memory());
+      _message = _pool->Pop(size());
+      _message.reset(size());
+      return ring.Read(_position, size(), _message.data());
+    }
+
+    /// 消息内容是否在共享内存中，此时TCP连接上只有消息头。
+    bool is_shared_memory() const {
+      return (_size & shm::SharedMemoryFlag) != 0u;
+    }
+
+    message_size_type size() const {
+      return _size & ~shm::SharedMemoryFlag;
     }
 
     auto pop() {
@@ -61,8 +84,12 @@ namespace tcp {
 
   private:
 
+    std::shared_ptr<BufferPool> _pool;
+
     message_size_type _size = 0u;
 
+    uint64_t _position = 0u;
+
     Buffer _message;
   };
 
@@ -122,19 +149,29 @@ namespace tcp {
           // 以牺牲带宽效率为代价，换取更低的延迟。
           _socket.set_option(boost::asio::ip::tcp::no_delay(true));
           log_debug("streaming client: connected to", ep);
-          // 发送流id以订阅流。
-          const auto &stream_id = _token.get_stream_id();
-          log_debug("streaming client: sending stream id", stream_id);
+          // 发送流id以订阅流，启用共享内存时随后发送环形缓冲区的名字。
+          CreateSharedMemory();
+          _handshake_stream_id = _token.get_stream_id();
+          std::vector<boost::asio::const_buffer> handshake;
+          if (_shared_memory != nullptr) {
+            _handshake_stream_id |= shm::SharedMemoryFlag;
+            handshake.emplace_back(&_handshake_stream_id, sizeof(_handshake_stream_id));
+            handshake.emplace_back(&_shared_memory_handshake, sizeof(_shared_memory_handshake));
+          } else {
+            handshake.emplace_back(&_handshake_stream_id, sizeof(_handshake_stream_id));
+          }
+          const size_t handshake_size = boost::asio::buffer_size(handshake);
+          log_debug("streaming client: sending stream id", _token.get_stream_id());
           boost::asio::async_write(
               _socket,
-              boost::asio::buffer(&stream_id, sizeof(stream_id)),
+              handshake,
               boost::asio::bind_executor(_strand, [=](error_code ec, size_t DEBUG_ONLY(bytes)) {
                 // 确保在连接停止后停止执行。
                 if (_done) {
                   return;
                 }
                 if (!ec) {
-                  DEBUG_ASSERT_EQ(bytes, sizeof(stream_id));
+                  DEBUG_ASSERT_EQ(bytes, handshake_size);
                   // 如果成功，开始读取数据。
                   ReadData();
                 } else {
@@ -154,6 +191,31 @@ namespace tcp {
   }
 
 
+  void Client::EnableSharedMemory(size_t capacity) {
+    _shared_memory_capacity = capacity;
+  }
+
+  // 为新的连接创建环形缓冲区，失败时只使用TCP
+  void Client::CreateSharedMemory() {
+    _shared_memory = nullptr;
+    if ((_shared_memory_capacity == 0u) || ((_token.get_stream_id() & shm::SharedMemoryFlag) != 0u)) {
+      return;
+    }
+    const std::string name = shm::RingBuffer::MakeUniqueName(_token.get_stream_id());
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+      _shared_memory = shm::RingBuffer::Create(name, _shared_memory_capacity);
+      _shared_memory_handshake.name_length = static_cast<uint32_t>(name.size());
+      std::memcpy(_shared_memory_handshake.name, name.data(), name.size());
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (const std::exception &e) {
+      log_warning("streaming client: failed to create shared memory:", e.what());
+      _shared_memory = nullptr;
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
+
   // 停止连接
   void Client::Stop() {
     _connection_timer.cancel();
@@ -186,7 +248,7 @@ namespace tcp {
 
       // log_debug("streaming client: Client::ReadData");
 
-      auto message = std::make_shared<IncomingMessage>(_buffer_pool->Pop());
+      auto message = std::make_shared<IncomingMessage>(_buffer_pool);
 
       auto handle_read_data = [this, self, message](boost::system::error_code ec, size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_data", bytes, "bytes"));
@@ -204,7 +266,22 @@ namespace tcp {
         }
       };
 
-      auto handle_read_header = [this, self, message, handle_read_data](
+      auto handle_read_position = [this, self, message](boost::system::error_code ec, size_t) {
+        if (!ec) {
+          if (message->CopyFromSharedMemory(*_shared_memory)) {
+            self->_callback(message->pop());
+            ReadData();
+          } else {
+            log_error("streaming client: invalid shared memory message");
+            Connect();
+          }
+        } else {
+          log_debug("streaming client: failed to read shared memory message:", ec.message());
+          Connect();
+        }
+      };
+
+      auto handle_read_header = [this, self, message, handle_read_data, handle_read_position](
           boost::system::error_code ec,
           size_t DEBUG_ONLY(bytes)) {
         DEBUG_ONLY(log_debug("streaming client: Client::ReadData.handle_read_header", bytes, "bytes"));
@@ -213,6 +290,19 @@ namespace tcp {
           if (_done) {
             return;
           }
+          if (message->is_shared_memory()) {
+            if (_shared_memory == nullptr) {
+              log_error("streaming client: unexpected shared memory message");
+              Connect();
+              return;
+            }
+            // 消息内容在环形缓冲区中，只需再读取其位置
+            boost::asio::async_read(
+                _socket,
+                message->position_as_buffer(),
+                boost::asio::bind_executor(_strand, handle_read_position));
+            return;
+          }
           // 现在我们知道了即将到来的缓冲区的大小，我们可以分配缓冲区并开始将数据放入其中。
           boost::asio::async_read(
               _socket,
@@ -12,6 +12,7 @@
 #include "carla/profiler/LifetimeProfiled.h"/// \include 包含用于性能分析的生命周期跟踪类定义。
 #include "carla/streaming/detail/Token.h"/// \include 包含流处理中的令牌类定义。
 #include "carla/streaming/detail/Types.h"/// \include 包含流处理中使用的类型别名和常量定义。
+#include "carla/streaming/detail/shm/RingBuffer.h"/// \include 包含共享内存环形缓冲区的定义。
 
 #include <boost/asio/deadline_timer.hpp>/// \include 包含Boost.Asio的定时器类定义，用于处理超时事件。
 #include <boost/asio/io_context.hpp>/// \include 包含Boost.Asio的I/O上下文类定义，是异步操作的核心。
@@ -70,6 +71,11 @@ namespace tcp {
     /// @brief 停止客户端。
     void Stop();
 
+    /// 在连接之前调用，通过大小为 @a capacity 的共享内存环形缓冲区接收
+    /// 较大的消息。只适用于与服务器在同一台机器上的客户端；服务器无法
+    /// 打开共享内存时会自动回退为只使用TCP。
+    void EnableSharedMemory(size_t capacity = shm::DefaultCapacity);
+
   private:
       /// @brief 重新连接流。
 ///
@@ -79,6 +85,8 @@ namespace tcp {
 ///
 /// 此方法从已连接的流中读取数据，并处理这些数据。
     void ReadData();
+
+    void CreateSharedMemory();
     /// @brief 存储流的唯一标识令牌。
 ///
 /// 这是一个常量，用于在客户端的整个生命周期内唯一标识流。
@@ -107,6 +115,14 @@ namespace tcp {
 ///
 /// 这是一个原子布尔值，用于在线程之间安全地表示客户端是否已完成其工作。初始值为false，表示客户端仍在运行。
     std::atomic_bool _done{false};
+
+    size_t _shared_memory_capacity = 0u;
+
+    std::unique_ptr<shm::RingBuffer> _shared_memory;
+
+    stream_id_type _handshake_stream_id = 0u;
+
+    shm::Handshake _shared_memory_handshake;
   };
 
 } // namespace tcp
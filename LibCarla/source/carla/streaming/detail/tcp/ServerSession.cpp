@@ -15,8 +15,8 @@
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/post.hpp>
 
+#include <algorithm>
 #include <atomic>
-#include <thread>
 
 namespace carla {
 namespace streaming {
@@ -24,6 +24,9 @@ namespace detail {
 namespace tcp {
 // 用于统计服务器会话的数量
   static std::atomic_size_t SESSION_COUNTER{0u};
+
+  constexpr size_t ServerSession::MaxQueuedMessages;
+  constexpr size_t ServerSession::MaxMessagesPerWrite;
 // ServerSession类的构造函数
   // @param io_context boost::asio的I/O上下文对象
   // @param timeout 会话超时时间
@@ -60,16 +63,42 @@ namespace tcp {
     auto self = shared_from_this(); // 为了让自己存活下去。
     boost::asio::post(_strand, [=]() {
  // 定义处理查询的内部函数
-      auto handle_query = [this, self, callback=std::move(on_opened)](
+      auto start_session = [this, self, callback=std::move(on_opened)]() {
+        // 打印调试信息，表示会话已启动
+        log_debug("session", _session_id, "for stream", _stream_id, " started");
+        // 在strand的上下文环境中执行回调函数
+        boost::asio::post(_strand.context(), [=]() { callback(self); });
+      };
+
+      auto handle_handshake = [this, self, start_session](
+          const boost::system::error_code &ec,
+          size_t DEBUG_ONLY(bytes_received)) {
+        if (!ec) {
+          DEBUG_ASSERT_EQ(bytes_received, sizeof(_shared_memory_handshake));
+          OpenSharedMemory();
+          start_session();
+        } else {
+          log_error("session", _session_id, ": error retrieving shared memory handshake :", ec.message());
+          CloseNow(ec);
+        }
+      };
+
+      auto handle_query = [this, self, start_session, handle_handshake](
           const boost::system::error_code &ec,
           size_t DEBUG_ONLY(bytes_received)) {
         if (!ec) {
         	// 断言接收到的字节数等于流ID的大小
           DEBUG_ASSERT_EQ(bytes_received, sizeof(_stream_id));
-          // 打印调试信息，表示会话已启动
-          log_debug("session", _session_id, "for stream", _stream_id, " started");
-          // 在strand的上下文环境中执行回调函数
-          boost::asio::post(_strand.context(), [=]() { callback(self); });
+          if ((_stream_id & shm::SharedMemoryFlag) != 0u) {
+            // 客户端请求使用共享内存，流ID之后是环形缓冲区的名字
+            _stream_id &= ~shm::SharedMemoryFlag;
+            boost::asio::async_read(
+                _socket,
+                boost::asio::buffer(&_shared_memory_handshake, sizeof(_shared_memory_handshake)),
+                boost::asio::bind_executor(_strand, handle_handshake));
+          } else {
+            start_session();
+          }
         } else {
         	// 打印错误信息，表示获取流ID时出错
           log_error("session", _session_id, ": error retrieving stream id :", ec.message());
@@ -87,21 +116,44 @@ namespace tcp {
           boost::asio::bind_executor(_strand, handle_query));
     });
   }
+// 打开客户端创建的环形缓冲区，失败时所有消息仍直接通过TCP发送
+  void ServerSession::OpenSharedMemory() {
+    const size_t length = std::min<size_t>(_shared_memory_handshake.name_length, shm::MaxNameLength);
+    const std::string name(_shared_memory_handshake.name, length);
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    try {
+#endif // LIBCARLA_NO_EXCEPTIONS
+      _shared_memory = shm::RingBuffer::Open(name);
+      // 双方都已映射，删除名字以免进程异常退出后遗留共享内存
+      _shared_memory->Unlink();
+      _shared_memory_headers_in_flight.reserve(MaxMessagesPerWrite);
+      log_debug("session", _session_id, ": using shared memory", name);
+#ifndef LIBCARLA_NO_EXCEPTIONS
+    } catch (const std::exception &e) {
+      log_warning("session", _session_id, ": failed to open shared memory", name, ":", e.what());
+      _shared_memory = nullptr;
+    }
+#endif // LIBCARLA_NO_EXCEPTIONS
+  }
 // 向客户端写入消息的函数
   // @param message 要写入的消息指针
   void ServerSession::Write(std::shared_ptr<const Message> message) {
   	// 断言消息不为空且消息内容不为空
     DEBUG_ASSERT(message != nullptr);
     DEBUG_ASSERT(!message->empty());
-    auto self = shared_from_this();
-      if (!_socket.is_open()) {
+    {
+      std::unique_lock<std::mutex> lock(_queue_mutex);
+      if (_is_closed) {
         return;
       }
-      if (_is_writing) {
+      if (_queue.size() >= MaxQueuedMessages) {
         if (_server.IsSynchronousMode()) {
-          // 等待上一条消息发送完毕
-          while (_is_writing) {
-            std::this_thread::yield();
+          // 同步模式下不能丢弃消息，等待发送队列腾出空间
+          _queue_not_full.wait(lock, [this]() {
+            return _is_closed || _queue.size() < MaxQueuedMessages;
+          });
+          if (_is_closed) {
+            return;
           }
         } else {
           // 忽略该消息
@@ -109,27 +161,81 @@ namespace tcp {
           return;
         }
       }
+      _queue.emplace_back(std::move(message));
+      if (_is_writing) {
+        // 正在进行的写操作完成后会继续发送队列中的消息
+        return;
+      }
       _is_writing = true;
-// 定义消息发送完成后的回调函数
-      auto handle_sent = [this, self, message](const boost::system::error_code &ec, size_t DEBUG_ONLY(bytes)) {
+    }
+    // 与之前一样直接在调用线程中发起写操作，不经过 post，后续的写操作在 strand 中继续
+    WriteQueuedMessages();
+  }
+// 合并发送队列中的消息
+  void ServerSession::WriteQueuedMessages() {
+    _messages_in_flight.clear();
+    _buffers_in_flight.clear();
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      if (_is_closed || _queue.empty()) {
         _is_writing = false;
-        if (ec) {
-        	// 如果发送出错，打印错误信息并立即关闭会话
-          log_info("session", _session_id, ": error sending data :", ec.message());
-          CloseNow(ec);
-        } else {
-        	// 如果发送成功，打印调试信息（可选）并断言发送的字节数正确
-          DEBUG_ONLY(log_debug("session", _session_id, ": successfully sent", bytes, "bytes"));
-          DEBUG_ASSERT_EQ(bytes, sizeof(message_size_type) + message->size());
+        return;
+      }
+      const size_t count = std::min(_queue.size(), MaxMessagesPerWrite);
+      for (size_t i = 0u; i < count; ++i) {
+        _messages_in_flight.emplace_back(std::move(_queue.front()));
+        _queue.pop_front();
+      }
+    }
+    _queue_not_full.notify_all();
+
+    // 每条消息的缓冲区序列都以其大小开头，直接拼接即可
+    size_t total_size = 0u;
+    _shared_memory_headers_in_flight.clear();
+    for (auto &message : _messages_in_flight) {
+      const auto sequence = message->GetBufferSequence();
+      if (_shared_memory != nullptr) {
+        if ((message->size() & shm::SharedMemoryFlag) != 0u) {
+          log_error("session", _session_id, ": message too big for a shared memory session, discarded");
+          continue;
         }
-      };
-// 打印调试信息，表示要发送的消息大小
-      log_debug("session", _session_id, ": sending message of", message->size(), "bytes");
+        // 较大的消息拷贝到环形缓冲区中，TCP连接上只发送消息头
+        uint64_t position = 0u;
+        if ((message->size() >= shm::MinMessageSize) &&
+            _shared_memory->TryWrite(sequence.begin() + 1, sequence.end(), message->size(), position)) {
+          _shared_memory_headers_in_flight.push_back({message->size() | shm::SharedMemoryFlag, position});
+          _buffers_in_flight.emplace_back(
+              &_shared_memory_headers_in_flight.back(),
+              sizeof(shm::MessageHeader));
+          total_size += sizeof(shm::MessageHeader);
+          continue;
+        }
+      }
+      _buffers_in_flight.insert(_buffers_in_flight.end(), sequence.begin(), sequence.end());
+      total_size += sizeof(message_size_type) + message->size();
+    }
+// 定义消息发送完成后的回调函数
+    auto handle_sent = [this, self=shared_from_this(), total_size](
+        const boost::system::error_code &ec,
+        size_t bytes) {
+      if (ec) {
+      	// 如果发送出错，打印错误信息并立即关闭会话
+        log_info("session", _session_id, ": error sending data :", ec.message());
+        CloseNow(ec);
+      } else {
+      	// 如果发送成功，继续发送队列中剩余的消息
+        log_debug("session", _session_id, ": successfully sent", bytes, "of", total_size, "bytes");
+        DEBUG_ASSERT_EQ(bytes, total_size);
+        WriteQueuedMessages();
+      }
+    };
+// 打印调试信息，表示要发送的消息数量与大小
+    log_debug("session", _session_id, ": sending", _messages_in_flight.size(), "messages of", total_size, "bytes");
 // 设置消息发送的截止时间
-      _deadline.expires_from_now(_timeout);
-      // 异步写入消息
-      boost::asio::async_write(_socket, message->GetBufferSequence(), 
-        boost::asio::bind_executor(_strand, handle_sent));
+    _deadline.expires_from_now(_timeout);
+    // 异步写入消息
+    boost::asio::async_write(_socket, _buffers_in_flight,
+      boost::asio::bind_executor(_strand, handle_sent));
   }
 // 关闭会话的函数
   void ServerSession::Close() {
@@ -153,6 +259,14 @@ namespace tcp {
 // 立即关闭会话的函数，取消定时器，关闭套接字并执行关闭回调函数
   void ServerSession::CloseNow(boost::system::error_code ec) {
     _deadline.cancel();
+    {
+      std::lock_guard<std::mutex> lock(_queue_mutex);
+      _is_closed = true;
+      _is_writing = false;
+      _queue.clear();
+    }
+    // 唤醒同步模式下等待发送队列的写入者
+    _queue_not_full.notify_all();
     if (!ec)
     {
       if (_socket.is_open()) {
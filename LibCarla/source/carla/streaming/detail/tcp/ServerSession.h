@@ -43,6 +43,7 @@
       * 此文件定义了流处理模块中使用的底层类型，如流ID和消息大小类型。
       */
 #include "carla/streaming/detail/Types.h"
+#include "carla/streaming/detail/shm/RingBuffer.h"
       /**
        * @brief 引入Carla流处理模块中TCP消息类的定义。
        *
@@ -95,6 +96,8 @@
               *
               * 该头文件提供了函数对象、函数包装器以及标准函数适配器等功能。
               */
+#include <condition_variable>
+#include <deque>
 #include <functional>
               /**
                * @brief 引入C++标准库中的memory头文件。
@@ -102,6 +105,8 @@
                * 该头文件提供了智能指针、动态内存分配和对象生命周期管理等功能。
                */
 #include <memory>
+#include <mutex>
+#include <vector>
                /**
                 * @namespace carla::streaming::detail::tcp
                 * @brief 包含Carla流处理模块中TCP通信的详细实现。
@@ -196,7 +201,9 @@ namespace tcp {
 
     /// @brief 向套接字写入一些数据。
 /// 
-/// 该函数将一个包含数据的消息对象写入到套接字中。
+/// 该函数将消息放入会话的发送队列，没有正在进行的写操作时发起一次写操作。
+/// 队列已满时，异步模式下丢弃该消息，同步模式下等待队列腾出空间。
+/// 可以从任意线程调用。
     void Write(std::shared_ptr<const Message> message);
 
     /// @brief 向套接字写入一些数据（模板函数）。
@@ -216,6 +223,19 @@ namespace tcp {
     void Close();
 
   private:
+    /// @brief 发送队列中最多等待发送的消息数量。
+    static constexpr size_t MaxQueuedMessages = 4u;
+    /// @brief 一次写操作最多合并发送的消息数量，等于队列长度，
+    /// 即写操作开始时队列中的消息全部合并发送。
+    static constexpr size_t MaxMessagesPerWrite = MaxQueuedMessages;
+
+    /// @brief 从发送队列中取出等待的消息，合并为一次异步写操作发送。
+///
+/// 同一时间只有一个写操作，由将 _is_writing 置为 true 的线程发起，
+/// 之后在 strand 中的完成回调里继续处理队列，直到队列为空。
+    void WriteQueuedMessages();
+
+    void OpenSharedMemory();
       /// @brief 启动定时器。
 /// 
 /// 该函数用于启动一个定时器，该定时器在会话空闲时间超过指定时长后触发关闭操作。
@@ -243,8 +263,28 @@ namespace tcp {
     boost::asio::io_context::strand _strand;
     /// @brief 会话关闭时的回调函数。
     callback_function_type _on_closed;
-    /// @brief 表示当前是否正在进行写入操作的标志。
+    /// @brief 保护发送队列以及 _is_writing、_is_closed 标志。
+    std::mutex _queue_mutex;
+    /// @brief 发送队列腾出空间或会话关闭时通知同步模式下等待的写入者。
+    std::condition_variable _queue_not_full;
+    /// @brief 等待发送的消息。
+    std::deque<std::shared_ptr<const Message>> _queue;
+    /// @brief 表示当前是否有写操作正在进行。
     bool _is_writing = false;
+    /// @brief 表示会话是否已关闭，关闭后写入的消息被忽略。
+    bool _is_closed = false;
+    /// @brief 正在发送的消息及其缓冲区序列，只由当前的写操作访问。
+    std::vector<std::shared_ptr<const Message>> _messages_in_flight;
+    std::vector<boost::asio::const_buffer> _buffers_in_flight;
+
+    /// 客户端请求使用共享内存时发送的握手数据。
+    shm::Handshake _shared_memory_handshake;
+
+    /// 客户端创建的环形缓冲区，未启用共享内存时为空。
+    std::unique_ptr<shm::RingBuffer> _shared_memory;
+
+    /// 正在发送的共享内存消息头，预留了 MaxMessagesPerWrite 个元素，不会重新分配。
+    std::vector<shm::MessageHeader> _shared_memory_headers_in_flight;
   };
 
 } // namespace tcp
@@ -61,10 +61,18 @@ namespace low_level {
           io_context,
           token,
           std::forward<Functor>(callback));
+      if (_shared_memory_capacity > 0u) {
+        client->EnableSharedMemory(_shared_memory_capacity);	// 在连接之前启用共享内存
+      }
       client->Connect();	// 让客户端尝试连接到对应的流
       _clients.emplace(token.get_stream_id(), std::move(client));	// 将创建好的客户端智能指针以流ID为键存入到_clients映射容器中，以便后续管理和操作
     }
 
+    /// 之后订阅的流通过大小为 @a capacity 的共享内存接收较大的消息，0 表示禁用。
+    void EnableSharedMemory(size_t capacity) {
+      _shared_memory_capacity = capacity;
+    }
+
     void UnSubscribe(token_type token) {	// 取消订阅流的方法，接受一个令牌作为参数
       log_debug("calling sensor UnSubscribe()");	// 输出一条调试信息，表示正在调用取消订阅操作
       auto it = _clients.find(token.get_stream_id());	// 在已订阅客户端的映射容器中查找与传入令牌的流ID对应的客户端指针
@@ -78,6 +86,8 @@ namespace low_level {
 
     boost::asio::ip::address _fallback_address;	// 存储备用的IP地址，在构造函数中进行初始化，可能在流连接出现问题需要使用备用地址时发挥作用
 
+    size_t _shared_memory_capacity = 0u;	// 共享内存环形缓冲区的大小，0 表示只使用TCP
+
     std::unordered_map<	// 一个无序映射容器，存储底层客户端的智能指针，用于管理和操作订阅的各个流对应的客户端
         detail::stream_id_type,
         std::shared_ptr<underlying_client>> _clients;
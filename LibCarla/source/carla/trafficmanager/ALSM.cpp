@@ -52,19 +52,20 @@ void ALSM::Update() {
   //存储待删除的未注册参与者的 ID 列表
   std::vector<ActorId> unregistered_list_to_be_deleted;
 
-  current_timestamp = world.GetSnapshot().GetTimestamp(); //获取当前时间截
-  ActorList world_actors = world.GetActors();//获取当前世界中的所有参与者列表
+  const cc::WorldSnapshot world_snapshot = world.GetSnapshot(); //获取当前世界快照
+  current_timestamp = world_snapshot.GetTimestamp(); //获取当前时间截
+
+  // 与上一次更新时的快照比较，找到已经销毁的参与者以及需要创建参与者对象的参与者
+  const ActorDeltaTracker::Changes changes =
+      actor_delta_tracker.Update(world_snapshot, registered_vehicles, unregistered_actors);
 
-  // 找到已经销毁的参与者并进行清理
-  const ALSM::DestroyeddActors destroyed_actors = IdentifyDestroyedActors(world_actors);
-  
   //处理已注册的被销毁的参与者
-  const ActorIdSet &destroyed_registered = destroyed_actors.first;
+  const ActorIdSet &destroyed_registered = changes.destroyed_registered;
   for (const auto &deletion_id: destroyed_registered) {
     RemoveActor(deletion_id, true); //删除角色并标记为注册参与者
   }
   //处理未注册的被销毁参与者
-  const ActorIdSet &destroyed_unregistered = destroyed_actors.second;
+  const ActorIdSet &destroyed_unregistered = changes.destroyed_unregistered;
   for (auto deletion_id : destroyed_unregistered) {
     RemoveActor(deletion_id, false);
   }
@@ -90,8 +91,10 @@ void ALSM::Update() {
     }
   }
 
-  // 扫描并识别新的未注册参与者
-  IdentifyNewActors(world_actors);
+  // 只为新生成的参与者创建参与者对象，并识别新的未注册参与者
+  if (!changes.spawned.empty()) {
+    IdentifyNewActors(world.GetActors(changes.spawned));
+  }
 
   // 更新所有已注册的车辆的动态状态和静态属性
   ALSM::IdleInfo max_idle_time = std::make_pair(0u, current_timestamp.elapsed_seconds);
@@ -151,43 +154,6 @@ void ALSM::IdentifyNewActors(const ActorList &actor_list) {
   }
 }
 
-//识别已销毁的参与者
-ALSM::DestroyeddActors ALSM::IdentifyDestroyedActors(const ActorList &actor_list) {
-
-  ALSM::DestroyeddActors destroyed_actors; //用于存储销毁的参与者 ID
-  ActorIdSet &deleted_registered = destroyed_actors.first; //存储已销毁的注册车辆的 ID
-  ActorIdSet &deleted_unregistered = destroyed_actors.second; //存储已销毁的未注册参与者的 ID
-
-  //构建当前帧中存在的参与者的哈希集合
-  ActorIdSet current_actors;
-  for  (auto iter = actor_list->begin(); iter != actor_list->end(); ++iter) {
-    current_actors.insert((*iter)->GetId()); //将当前参与者的 ID 插入集合中
-  }
-
-  // 查找被销毁的已注册车辆
-  std::vector<ActorId> registered_ids = registered_vehicles.GetIDList();
-  for (const ActorId &actor_id : registered_ids) {
-    //如果当前帧中不存在某个已注册车辆
-    if (current_actors.find(actor_id) == current_actors.end()) {
-        //将该车辆的 ID 加入到已销毁的注册车辆列表中
-      deleted_registered.insert(actor_id);
-    }
-  }
-
-  // 查找被销毁的未注册参与者
-  for (const auto &actor_info: unregistered_actors) {
-    const ActorId &actor_id = actor_info.first;
-    //如果当前帧中不存在某个未注册的参与者，或者该参与者已经注册为车辆
-     if (current_actors.find(actor_id) == current_actors.end()
-         || registered_vehicles.Contains(actor_id)) {
-      //将该参与者的 ID 加入到已销毁的未注册参与者列表中
-      deleted_unregistered.insert(actor_id);
-    }
-  }
-  //返回销毁的参与者列表
-  return destroyed_actors;
-}
-
 void ALSM::UpdateRegisteredActorsData(const bool hybrid_physics_mode, ALSM::IdleInfo &max_idle_time) {
 
   //获取所有注册车辆的列表
@@ -455,6 +421,7 @@ void ALSM::Reset() {
   unregistered_actors.clear();
   idle_time.clear();
   hero_actors.clear();
+  actor_delta_tracker.Reset(); // 下一次更新时重新扫描整个世界
   elapsed_last_actor_destruction = 0.0; // 重置上次参与者销毁的时间
   current_timestamp = world.GetSnapshot().GetTimestamp(); // 更新当前时间截
 }
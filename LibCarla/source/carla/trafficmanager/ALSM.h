@@ -8,6 +8,7 @@
 #include "carla/client/World.h"
 #include "carla/Memory.h"
 
+#include "carla/trafficmanager/ActorDeltaTracker.h"
 #include "carla/trafficmanager/AtomicActorSet.h"
 #include "carla/trafficmanager/CollisionStage.h"
 #include "carla/trafficmanager/DataStructures.h"
@@ -60,6 +61,7 @@ private:
   double elapsed_last_participant_destruction {0.0}; // 记录自上次因闲置过久而销毁参与者的时间
   cc::Timestamp current_timestamp; // 当前时间戳
   std::unordered_map<ActorId, bool> has_physics_enabled; // 存储每个参与者是否启用物理的映射
+  ActorDeltaTracker actor_delta_tracker; // 根据世界快照之间的增量求出生成与销毁的参与者
 
   // 更新已注册参与者在某位置上停留的时间
   void UpdateIdleTime(std::pair<ActorId, double>& max_idle_time, const ActorId& actor_id);
@@ -70,11 +72,6 @@ private:
   // 确定自上次更新以来在仿真中新生成的参与者
   void IdentifyNewParticipants(const ParticipantList &participant_list);
 
-  using DestroyeddParticipants = std::pair<ActorIdSet, ActorIdSet>; // 定义删除参与者的数据类型
-  // 确定在上一帧中删除的参与者
-  // 返回已注册和未注册参与者的数组
-  DestroyeddParticipants IdentifyDestroyedParticipants(const ParticipantList &participant_list);
-
   using IdleInfo = std::pair<ActorId, double>; // 定义闲置信息的数据类型
   void UpdateRegisteredParticipantsData(const bool hybrid_physics_mode, IdleInfo &max_idle_time);
 
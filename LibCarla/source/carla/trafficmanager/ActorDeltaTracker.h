@@ -0,0 +1,173 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "carla/client/WorldSnapshot.h"
+#include "carla/rpc/ActorId.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// 根据相邻两次更新的世界快照之间生成与销毁的参与者，求出 ALSM 需要移除的
+/// 参与者以及需要创建参与者对象的参与者。只处理参与者ID，不访问模拟器。
+///
+/// 两个快照基于同一关键帧时，开销只与变化的参与者数量有关。服务器的
+/// EpisodeKeyframeInterval 为0（默认值）时每一帧都是关键帧，这时需要按ID顺序
+/// 合并两个快照的参与者列表，开销与参与者总数成正比，但不再为每个参与者创建
+/// 参与者对象。
+class ActorDeltaTracker {
+
+public:
+
+  struct Changes {
+    /// 已经销毁的已注册车辆。
+    std::unordered_set<ActorId> destroyed_registered;
+    /// 已经销毁，或者已经注册为车辆的未注册参与者。
+    std::unordered_set<ActorId> destroyed_unregistered;
+    /// 需要创建参与者对象并重新识别的参与者，按升序排列且不重复。
+    std::vector<ActorId> spawned;
+  };
+
+  /// 与上一次更新时的快照比较。第一次更新、剧集切换或 Reset() 之后，
+  /// 快照中的所有参与者都视为新生成的。
+  ///
+  /// @a registered 需要提供 Contains、GetState 与 GetIDList，GetState 的值
+  /// 在集合变化时改变；@a unregistered 是以参与者ID为键的关联容器。
+  template <typename RegisteredSet, typename UnregisteredMap>
+  Changes Update(
+      const client::WorldSnapshot &snapshot,
+      RegisteredSet &registered,
+      const UnregisteredMap &unregistered) {
+    Changes changes;
+    const bool full_resync = !last_snapshot || last_snapshot->GetId() != snapshot.GetId();
+    if (full_resync) {
+      FullResync(snapshot, registered, unregistered, changes);
+    } else {
+      std::vector<ActorId> destroyed;
+      snapshot.GetActorIdChanges(*last_snapshot, changes.spawned, destroyed);
+      for (const ActorId actor_id : destroyed) {
+        if (registered.Contains(actor_id)) {
+          changes.destroyed_registered.insert(actor_id);
+        }
+        if (unregistered.find(actor_id) != unregistered.end()) {
+          changes.destroyed_unregistered.insert(actor_id);
+        }
+      }
+      // 已注册车辆的集合变化时（注册、注销或销毁），与上一次检查的结果比较
+      const int registered_state = registered.GetState();
+      if (registered_state != known_registered_state) {
+        CheckRegistration(snapshot, registered, unregistered, registered_state, changes);
+      }
+    }
+    last_snapshot = snapshot;
+
+    std::sort(changes.spawned.begin(), changes.spawned.end());
+    changes.spawned.erase(
+        std::unique(changes.spawned.begin(), changes.spawned.end()),
+        changes.spawned.end());
+    return changes;
+  }
+
+  /// 下一次更新时重新扫描整个快照。
+  void Reset() {
+    last_snapshot.reset();
+    known_registered_ids.clear();
+    known_registered_state = -1;
+  }
+
+private:
+
+  template <typename RegisteredSet, typename UnregisteredMap>
+  void FullResync(
+      const client::WorldSnapshot &snapshot,
+      RegisteredSet &registered,
+      const UnregisteredMap &unregistered,
+      Changes &changes) {
+    changes.spawned.reserve(snapshot.size());
+    for (const auto &actor_snapshot : snapshot) {
+      changes.spawned.emplace_back(actor_snapshot.id);
+    }
+    known_registered_state = registered.GetState();
+    known_registered_ids = registered.GetIDList();
+    std::sort(known_registered_ids.begin(), known_registered_ids.end());
+    for (const ActorId actor_id : known_registered_ids) {
+      if (!snapshot.Contains(actor_id)) {
+        changes.destroyed_registered.insert(actor_id);
+      }
+    }
+    for (const auto &entry : unregistered) {
+      const ActorId actor_id = entry.first;
+      if (!snapshot.Contains(actor_id) || registered.Contains(actor_id)) {
+        changes.destroyed_unregistered.insert(actor_id);
+      }
+    }
+  }
+
+  template <typename RegisteredSet, typename UnregisteredMap>
+  void CheckRegistration(
+      const client::WorldSnapshot &snapshot,
+      RegisteredSet &registered,
+      const UnregisteredMap &unregistered,
+      const int registered_state,
+      Changes &changes) {
+    std::vector<ActorId> registered_ids = registered.GetIDList();
+    std::sort(registered_ids.begin(), registered_ids.end());
+
+    std::vector<ActorId> newly_registered;
+    std::set_difference(registered_ids.begin(), registered_ids.end(),
+                        known_registered_ids.begin(), known_registered_ids.end(),
+                        std::back_inserter(newly_registered));
+    for (const ActorId actor_id : newly_registered) {
+      const bool alive = snapshot.Contains(actor_id);
+      if (!alive) {
+        // 注册时已经被销毁
+        changes.destroyed_registered.insert(actor_id);
+      }
+      if (unregistered.find(actor_id) != unregistered.end()) {
+        // 从未注册参与者中移除，仍然存活时重新检查是否为英雄车辆
+        changes.destroyed_unregistered.insert(actor_id);
+        if (alive) {
+          changes.spawned.emplace_back(actor_id);
+        }
+      }
+    }
+
+    std::vector<ActorId> newly_unregistered;
+    std::set_difference(known_registered_ids.begin(), known_registered_ids.end(),
+                        registered_ids.begin(), registered_ids.end(),
+                        std::back_inserter(newly_unregistered));
+    for (const ActorId actor_id : newly_unregistered) {
+      // 仍然存活的车辆作为未注册参与者继续跟踪
+      if (snapshot.Contains(actor_id)) {
+        changes.spawned.emplace_back(actor_id);
+      }
+    }
+
+    known_registered_state = registered_state;
+    known_registered_ids = std::move(registered_ids);
+  }
+
+  /// 上一次更新时的世界快照。
+  boost::optional<client::WorldSnapshot> last_snapshot;
+
+  /// 上一次检查时已注册车辆的ID，按升序排列。
+  std::vector<ActorId> known_registered_ids;
+
+  /// 上一次检查时已注册车辆集合的状态计数。
+  int known_registered_state {-1};
+};
+
+} // namespace traffic_manager
+} // namespace carla
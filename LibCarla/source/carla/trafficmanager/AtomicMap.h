@@ -8,6 +8,8 @@
 
 #include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 /**
  * @namespace carla::traffic_manager
  *
@@ -83,6 +85,22 @@ namespace traffic_manager {
       std::lock_guard<std::mutex> lock(map_mutex);// 加锁以保护对map的访问
       return map.at(key);// 返回指定键的值
     }
+    /**
+       * @brief 获取指定键的值，只加锁一次。
+       *
+       * @param key 要获取值的键。
+       * @param value 映射包含指定的键时，复制其值。
+       * @return 如果映射包含指定的键，则返回true；否则返回false。
+       */
+    bool TryGetValue(const Key &key, Value &value) const {
+      std::lock_guard<std::mutex> lock(map_mutex);// 加锁以保护对map的访问
+      const auto it = map.find(key);
+      if (it == map.end()) {
+        return false;
+      }
+      value = it->second;
+      return true;
+    }
     /**
        * @brief 从映射中移除指定的键及其对应的值。
        *
@@ -93,6 +111,29 @@ namespace traffic_manager {
       std::lock_guard<std::mutex> lock(map_mutex);// 加锁以保护对map的访问 
       map.erase(key);// 移除指定的键及其对应的值 
     }
+    /**
+       * @brief 添加或更新多个键值对，只加锁一次。
+       *
+       * @param entries 要添加或更新的键值对，同一个键出现多次时以最后一个为准。
+       */
+    void AddEntries(const std::vector<std::pair<Key, Value>> &entries) {
+      std::lock_guard<std::mutex> lock(map_mutex);// 加锁以保护对map的访问
+      for (const auto &entry : entries) {
+        map[entry.first] = entry.second;
+      }
+    }
+    /**
+       * @brief 移除 @a entries 中各条目的键及其对应的值，只加锁一次。
+       *
+       * @param entries 键值对列表，只使用其中的键。
+       */
+    template <typename T>
+    void RemoveEntries(const std::vector<std::pair<Key, T>> &entries) {
+      std::lock_guard<std::mutex> lock(map_mutex);// 加锁以保护对map的访问
+      for (const auto &entry : entries) {
+        map.erase(entry.first);
+      }
+    }
 
   };
 
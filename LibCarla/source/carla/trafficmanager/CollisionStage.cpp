@@ -32,6 +32,40 @@ CollisionStage::CollisionStage(
     output_array(output_array),
     random_device(random_device) {}
 
+void CollisionStage::PrepareCycle() {
+  const unsigned long number_of_vehicles = vehicle_id_list.size();
+  pending_locks.resize(number_of_vehicles);
+
+  // 计算每辆车路径边界的外接圆，更新期间只读
+  broad_phase_x.resize(number_of_vehicles);
+  broad_phase_y.resize(number_of_vehicles);
+  broad_phase_radius.resize(number_of_vehicles);
+  broad_phase_index.clear();
+  broad_phase_index.reserve(number_of_vehicles);
+  for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+    const ActorId actor_id = vehicle_id_list.at(index);
+    const BoundingCircle circle = ComputeBoundingCircle(actor_id);
+    broad_phase_x[index] = circle.x;
+    broad_phase_y[index] = circle.y;
+    broad_phase_radius[index] = circle.radius;
+    broad_phase_index.insert({actor_id, index});
+  }
+}
+
+void CollisionStage::CommitCycle() {
+  // 按车辆列表顺序写回本周期的碰撞锁
+  for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+    const ActorId actor_id = vehicle_id_list.at(index);
+    const PendingCollisionLock &pending = pending_locks.at(index);
+    if (pending.locked) {
+      collision_locks[actor_id] = pending.lock;
+    } else {
+      collision_locks.erase(actor_id);
+    }
+  }
+  ClearCycleCache();
+}
+
 // 更新指定索引的车辆碰撞状态
 void CollisionStage::Update(const unsigned long index) {
   ActorId obstacle_id = 0u; // 障碍物ID ，初始为0
@@ -40,6 +74,15 @@ void CollisionStage::Update(const unsigned long index) {
 
   // 获取当前车辆的ID
   const ActorId ego_actor_id = vehicle_id_list.at(index);
+  const ParametersSnapshot &parameters_snapshot = parameters.GetSnapshot();
+  const VehicleParameters &ego_parameters = parameters_snapshot.GetVehicle(index);
+  // 当前车辆碰撞锁的工作副本，其他车辆只会读取本周期开始时的碰撞锁
+  PendingCollisionLock &ego_lock = pending_locks.at(index);
+  auto committed_lock = collision_locks.find(ego_actor_id);
+  ego_lock.locked = committed_lock != collision_locks.end();
+  if (ego_lock.locked) {
+    ego_lock.lock = committed_lock->second;
+  }
   if (simulation_state.ContainsActor(ego_actor_id)) { // 检查仿真中是否包含此车辆
     const cg::Location ego_location = simulation_state.GetLocation(ego_actor_id); // 获取车辆当前位置
     const Buffer &ego_buffer = buffer_map.at(ego_actor_id); // 获取车辆的路径缓存
@@ -47,10 +90,10 @@ void CollisionStage::Update(const unsigned long index) {
     const float velocity = simulation_state.GetVelocity(ego_actor_id).Length(); // 获取车辆速度
 
     // 获取与当前车辆路径重叠的其他车辆ID
-    ActorIdSet overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
+    const std::vector<ActorId> overlapping_actors = track_traffic.GetOverlappingVehicles(ego_actor_id);
     std::vector<ActorId> collision_candidate_ids; // 碰撞候选车辆ID列表
     // 根据速度和参数计算碰撞检测的最大半径平方
-    const float distance_to_leading = parameters.GetDistanceToLeadingVehicle(ego_actor_id); // 获取前车的安全距离
+    const float distance_to_leading = ego_parameters.distance_to_leading_vehicle; // 获取前车的安全距离
     float collision_radius_square = SQUARE(COLLISION_RADIUS_RATE * velocity + COLLISION_RADIUS_MIN); // 碰撞半径平方
     if (velocity < 2.0f) { // 如果车辆速度较低
       const float length = simulation_state.GetDimensions(ego_actor_id).x; // 获取车辆长度
@@ -89,19 +132,20 @@ void CollisionStage::Update(const unsigned long index) {
       const ActorId other_actor_id = *iter; // 当前检查的对象ID
       const ActorType other_actor_type = simulation_state.GetType(other_actor_id); // 对象的类型（车辆/行人）
       // 检查碰撞检测条件是否满足
-      if (parameters.GetCollisionDetection(ego_actor_id, other_actor_id) // 检查自车与目标车之间的碰撞检测设置
+      if (parameters_snapshot.GetCollisionDetection(ego_parameters, other_actor_id) // 检查自车与目标车之间的碰撞检测设置
           && buffer_map.find(ego_actor_id) != buffer_map.end()           // 检查缓冲区是否存在自车
           && simulation_state.ContainsActor(other_actor_id)) {           // 检查目标对象是否仍在场景中
         // 通过协商函数计算碰撞威胁
         std::pair<bool, float> negotiation_result = NegotiateCollision(ego_actor_id,
                                                                        other_actor_id,
-                                                                       look_ahead_index);
+                                                                       look_ahead_index,
+                                                                       ego_lock);
         if (negotiation_result.first) { // 如果存在碰撞威胁
           // 根据对象类型和随机概率，决定是否忽略此威胁
           if ((other_actor_type == ActorType::Vehicle
-               && parameters.GetPercentageIgnoreVehicles(ego_actor_id) <= random_device.next())
+               && ego_parameters.perc_ignore_vehicles <= random_device.next(ego_actor_id))
               || (other_actor_type == ActorType::Pedestrian
-                  && parameters.GetPercentageIgnoreWalkers(ego_actor_id) <= random_device.next())) {
+                  && ego_parameters.perc_ignore_walkers <= random_device.next(ego_actor_id))) {
             collision_hazard = true;      // 标记碰撞威胁
             obstacle_id = other_actor_id; // 记录威胁对象ID
             available_distance_margin = negotiation_result.second; // 记录距离裕度
@@ -129,6 +173,15 @@ void CollisionStage::Reset() {
 }
 
 float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
+  PendingCollisionLock lock{false, {0.0, 0.0, 0u}};
+  auto committed_lock = collision_locks.find(actor_id);
+  if (committed_lock != collision_locks.end()) {
+    lock = {true, committed_lock->second};
+  }
+  return GetBoundingBoxExtention(actor_id, lock);
+}
+
+float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id, const PendingCollisionLock &pending) {
   // 根据速度计算对象的碰撞边界延伸
   const float velocity = cg::Math::Dot(simulation_state.GetVelocity(actor_id), simulation_state.GetHeading(actor_id)); // 计算对象的速度
   float bbox_extension;
@@ -136,8 +189,8 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   float velocity_extension = VEL_EXT_FACTOR * velocity; // 根据速度计算延伸因子
   bbox_extension = BOUNDARY_EXTENSION_MINIMUM + velocity_extension * velocity_extension; // 基础边界延伸
   // 如果对象有有效的碰撞锁定，调整边界以保持锁定
-  if (collision_locks.find(actor_id) != collision_locks.end()) {
-    const CollisionLock &lock = collision_locks.at(actor_id);
+  if (pending.locked) {
+    const CollisionLock &lock = pending.lock;
     float lock_boundary_length = static_cast<float>(lock.distance_to_lead_vehicle + LOCKING_DISTANCE_PADDING);
     // 仅当前车辆距离未超过速度相关延伸的最大值时，才延伸边界跟踪车辆
     if ((lock_boundary_length - lock.initial_lock_distance) < MAX_LOCKING_EXTENSION) {
@@ -148,6 +201,14 @@ float CollisionStage::GetBoundingBoxExtention(const ActorId actor_id) {
   return bbox_extension; // 返回最终计算的边界长度
 }
 
+float CollisionStage::GetDistanceToLeadingVehicle(const ActorId actor_id) const {
+  // 优先读取本周期的参数快照，不在快照中的车辆读取当前设置
+  const VehicleParameters *vehicle_parameters = parameters.GetSnapshot().FindVehicle(actor_id);
+  return vehicle_parameters != nullptr ?
+      vehicle_parameters->distance_to_leading_vehicle :
+      parameters.GetDistanceToLeadingVehicle(actor_id);
+}
+
 LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
   const ActorType actor_type = simulation_state.GetType(actor_id); // 获取实体类型
   const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id); // 获取实体的朝向向量
@@ -181,76 +242,155 @@ LocationVector CollisionStage::GetBoundary(const ActorId actor_id) {
 
 LocationVector CollisionStage::GetGeodesicBoundary(const ActorId actor_id) {
   LocationVector geodesic_boundary;
+  const LocationVector bbox = GetBoundary(actor_id); //获取边界框
+
+  if (buffer_map.find(actor_id) != buffer_map.end()) {
+    float bbox_extension = GetBoundingBoxExtention(actor_id); // 获取边界框扩展值
+    const float specific_lead_distance = GetDistanceToLeadingVehicle(actor_id); // 获取特定的前车距离
+    bbox_extension = std::max(specific_lead_distance, bbox_extension); // 扩展边界框，使用更大的距离
+    const float bbox_extension_square = SQUARE(bbox_extension); // 计算扩展距离的平方
+
+    LocationVector left_boundary; // 左边界点集合
+    LocationVector right_boundary; // 右边界点集合
+    cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
+    const float width = dimensions.y; // 宽度
+    const float length = dimensions.x; // 长度
+
+    const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 获取路径缓冲区
+    const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length); // 获取目标路径点和起点索引
+    const SimpleWaypointPtr boundary_start = target_wp_info.first; // 边界起始路径点
+    const uint64_t boundary_start_index = target_wp_info.second; // 边界起始索引
+
+    // 在无信号交叉口，我们扩展边界穿过交叉口
+    // 在所有其他情况下，边界长度与速度相关
+    SimpleWaypointPtr boundary_end = nullptr;
+    SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
+    bool reached_distance = false;
+    for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
+      if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
+        reached_distance = true;
+      }
+      if (boundary_end == nullptr
+          || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
+          || reached_distance) {
+
+        const cg::Vector3D heading_vector = current_point->GetForwardVector();
+        const cg::Location location = current_point->GetLocation();
+        cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
+        perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
+        // 方向根据左手坐标系确定
+        const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
+        left_boundary.push_back(location + cg::Location(scaled_perpendicular));
+        right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
+
+        boundary_end = current_point;
+      }
 
-  if (geodesic_boundary_map.find(actor_id) != geodesic_boundary_map.end()) {
-    // 如果地理边界已经缓存，则直接获取
-    geodesic_boundary = geodesic_boundary_map.at(actor_id);
+      current_point = waypoint_buffer.at(j);
+    }
+
+    // 反向右边界以构建顺时针（左手坐标系）
+    // 边界。这是因为左边界和右边界向量都有
+    // 在右边界的起始索引处与车辆的最近点
+    // 边界
+    // 我们希望从最远的点开始，以获得顺时针轨迹
+    std::reverse(right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
+    geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
   } else {
-    const LocationVector bbox = GetBoundary(actor_id); //获取边界框
-
-    if (buffer_map.find(actor_id) != buffer_map.end()) {
-      float bbox_extension = GetBoundingBoxExtention(actor_id); // 获取边界框扩展值
-      const float specific_lead_distance = parameters.GetDistanceToLeadingVehicle(actor_id); // 获取特定的前车距离
-      bbox_extension = std::max(specific_lead_distance, bbox_extension); // 扩展边界框，使用更大的距离
-      const float bbox_extension_square = SQUARE(bbox_extension); // 计算扩展距离的平方
-
-      LocationVector left_boundary; // 左边界点集合
-      LocationVector right_boundary; // 右边界点集合
-      cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
-      const float width = dimensions.y; // 宽度
-      const float length = dimensions.x; // 长度
-
-      const Buffer &waypoint_buffer = buffer_map.at(actor_id); // 获取路径缓冲区
-      const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, length); // 获取目标路径点和起点索引
-      const SimpleWaypointPtr boundary_start = target_wp_info.first; // 边界起始路径点
-      const uint64_t boundary_start_index = target_wp_info.second; // 边界起始索引
-
-      // 在无信号交叉口，我们扩展边界穿过交叉口
-      // 在所有其他情况下，边界长度与速度相关
-      SimpleWaypointPtr boundary_end = nullptr;
-      SimpleWaypointPtr current_point = waypoint_buffer.at(boundary_start_index);
-      bool reached_distance = false;
-      for (uint64_t j = boundary_start_index; !reached_distance && (j < waypoint_buffer.size()); ++j) {
-        if (boundary_start->DistanceSquared(current_point) > bbox_extension_square || j == waypoint_buffer.size() - 1) {
-          reached_distance = true;
-        }
-        if (boundary_end == nullptr
-            || cg::Math::Dot(boundary_end->GetForwardVector(), current_point->GetForwardVector()) < COS_10_DEGREES
-            || reached_distance) {
-
-          const cg::Vector3D heading_vector = current_point->GetForwardVector();
-          const cg::Location location = current_point->GetLocation();
-          cg::Vector3D perpendicular_vector = cg::Vector3D(-heading_vector.y, heading_vector.x, 0.0f);
-          perpendicular_vector = perpendicular_vector.MakeSafeUnitVector(EPSILON);
-          // 方向根据左手坐标系确定
-          const cg::Vector3D scaled_perpendicular = perpendicular_vector * width;
-          left_boundary.push_back(location + cg::Location(scaled_perpendicular));
-          right_boundary.push_back(location + cg::Location(-1.0f * scaled_perpendicular));
-
-          boundary_end = current_point;
-        }
 
-        current_point = waypoint_buffer.at(j);
-      }
+    geodesic_boundary = bbox;
+  }
 
-      // 反向右边界以构建顺时针（左手坐标系）
-      // 边界。这是因为左边界和右边界向量都有
-      // 在右边界的起始索引处与车辆的最近点
-      // 边界
-      // 我们希望从最远的点开始，以获得顺时针轨迹
-      std::reverse(right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), right_boundary.begin(), right_boundary.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), bbox.begin(), bbox.end());
-      geodesic_boundary.insert(geodesic_boundary.end(), left_boundary.begin(), left_boundary.end());
-    } else {
+  return geodesic_boundary;
+}
 
-      geodesic_boundary = bbox;
+const CollisionBoundary &CollisionStage::GetCollisionBoundary(const ActorId actor_id) {
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto cached_boundary = collision_boundary_map.find(actor_id);
+    if (cached_boundary != collision_boundary_map.end()) {
+      // 如果边界已经缓存，则直接使用，无需复制
+      return cached_boundary->second;
     }
+  }
+
+  // 边界只取决于本周期开始时的状态，多个线程同时计算同一边界时结果相同
+  CollisionBoundary boundary{GetPolygon(GetBoundary(actor_id)), GetPolygon(GetGeodesicBoundary(actor_id))};
+
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  // 其他线程先插入时保留已有的结果；unordered_map 插入新元素不会使已有元素的引用失效
+  return collision_boundary_map.emplace(actor_id, std::move(boundary)).first->second;
+}
 
-    geodesic_boundary_map.insert({actor_id, geodesic_boundary});
+BoundingCircle CollisionStage::ComputeBoundingCircle(const ActorId actor_id) {
+  if (!simulation_state.ContainsActor(actor_id)) {
+    return {0.0f, 0.0f, std::numeric_limits<float>::infinity()};
   }
 
-  return geodesic_boundary;
+  const cg::Location location = simulation_state.GetLocation(actor_id); // 获取实体位置
+  const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id); // 获取实体的朝向向量
+  const cg::Vector3D dimensions = simulation_state.GetDimensions(actor_id); // 获取实体的尺寸
+  float forward_extension = 0.0f;
+  if (simulation_state.GetType(actor_id) == ActorType::Pedestrian) {
+    forward_extension = simulation_state.GetVelocity(actor_id).Length() * WALKER_TIME_EXTENSION;
+  }
+  // 与 GetBoundary 相同的边界框，顶点到实体位置的距离不超过两个半轴向量的长度之和
+  const float bbox_radius = heading_vector.Length() * (dimensions.x + forward_extension)
+                            + dimensions.y + forward_extension;
+
+  auto buffer = buffer_map.find(actor_id);
+  if (buffer == buffer_map.end()) {
+    // 没有路径缓存时路径边界就是边界框
+    return {location.x, location.y, bbox_radius};
+  }
+  const Buffer &waypoint_buffer = buffer->second;
+  if (waypoint_buffer.empty()) {
+    return {location.x, location.y, std::numeric_limits<float>::infinity()};
+  }
+
+  float bbox_extension = GetBoundingBoxExtention(actor_id);
+  bbox_extension = std::max(GetDistanceToLeadingVehicle(actor_id), bbox_extension);
+  const float bbox_extension_square = SQUARE(bbox_extension);
+
+  // 以边界起始路径点为圆心，遍历 GetGeodesicBoundary 可能使用的所有路径点，
+  // 路径边界上的点与对应路径点的距离等于车辆宽度
+  const TargetWPInfo target_wp_info = GetTargetWaypoint(waypoint_buffer, dimensions.x);
+  const SimpleWaypointPtr &boundary_start = target_wp_info.first;
+  float max_distance_square = 0.0f;
+  for (uint64_t j = target_wp_info.second; j < waypoint_buffer.size(); ++j) {
+    const float distance_square = boundary_start->DistanceSquared(waypoint_buffer.at(j));
+    max_distance_square = std::max(max_distance_square, distance_square);
+    if (distance_square > bbox_extension_square) {
+      break;
+    }
+  }
+
+  const cg::Location center = boundary_start->GetLocation();
+  const float path_radius = std::sqrt(max_distance_square) + dimensions.y;
+  const float bbox_to_center = cg::Math::Distance2D(center, location) + bbox_radius;
+  return {center.x, center.y, std::max(path_radius, bbox_to_center)};
+}
+
+bool CollisionStage::MayOverlap(const ActorId reference_vehicle_id, const ActorId other_actor_id) {
+  auto get_circle = [this](const ActorId actor_id) -> BoundingCircle {
+    auto index = broad_phase_index.find(actor_id);
+    if (index != broad_phase_index.end()) {
+      const unsigned long i = index->second;
+      return {broad_phase_x[i], broad_phase_y[i], broad_phase_radius[i]};
+    }
+    // 未注册的车辆和行人没有路径缓存，外接圆的计算量很小
+    return ComputeBoundingCircle(actor_id);
+  };
+  const BoundingCircle reference = get_circle(reference_vehicle_id);
+  const BoundingCircle other = get_circle(other_actor_id);
+
+  // 两个外接圆之间的距离是两条路径边界之间距离的下界
+  const float reach = reference.radius + other.radius + OVERLAP_THRESHOLD + BROAD_PHASE_PADDING;
+  const float dx = reference.x - other.x;
+  const float dy = reference.y - other.y;
+  return dx * dx + dy * dy < reach * reach;
 }
 
 Polygon CollisionStage::GetPolygon(const LocationVector &boundary) {
@@ -285,22 +425,31 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
   GeometryComparison comparision_result{-1.0, -1.0, -1.0, -1.0}; // 默认比较结果，初始化为-1.0
 
-  if (geometry_cache.find(actor_id_key) != geometry_cache.end()) {
-    // 如果几何关系已缓存，则直接获取
-    comparision_result = geometry_cache.at(actor_id_key);
+  bool cached = false;
+  {
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    auto cached_result = geometry_cache.find(actor_id_key);
+    if (cached_result != geometry_cache.end()) {
+      comparision_result = cached_result->second;
+      cached = true;
+    }
+  }
+
+  if (cached && reference_vehicle_id != key_parts.first) {
+    // 缓存按较小的 ActorId 作为参考车辆保存，
+    // 交换参考车辆到其他车辆的距离和相反方向的距离
     double mref_veh_other = comparision_result.reference_vehicle_to_other_geodesic;
     // 交换参考车辆到其他车辆的距离和相反方向的距离
     comparision_result.reference_vehicle_to_other_geodesic = comparision_result.other_vehicle_to_reference_geodesic;
     comparision_result.other_vehicle_to_reference_geodesic = mref_veh_other;
-  } else {
-    // 获取参考车辆的边界多边形
-    const Polygon reference_polygon = GetPolygon(GetBoundary(reference_vehicle_id));
-    // 获取其他实体的边界多边形
-    const Polygon other_polygon = GetPolygon(GetBoundary(other_actor_id));
-    // 获取参考车辆的地理边界多边形
-    const Polygon reference_geodesic_polygon = GetPolygon(GetGeodesicBoundary(reference_vehicle_id));
-    //获取其他实体的地理边界多边形
-    const Polygon other_geodesic_polygon = GetPolygon(GetGeodesicBoundary(other_actor_id));
+  } else if (!cached) {
+    // 获取两辆车在本周期缓存的边界多边形
+    const CollisionBoundary &reference_boundary = GetCollisionBoundary(reference_vehicle_id);
+    const CollisionBoundary &other_boundary = GetCollisionBoundary(other_actor_id);
+    const Polygon &reference_polygon = reference_boundary.bbox_polygon;
+    const Polygon &other_polygon = other_boundary.bbox_polygon;
+    const Polygon &reference_geodesic_polygon = reference_boundary.geodesic_polygon;
+    const Polygon &other_geodesic_polygon = other_boundary.geodesic_polygon;
     // 计算参考车辆到其他实体地理边界的距离
     const double reference_vehicle_to_other_geodesic = bg::distance(reference_polygon, other_geodesic_polygon);
     // 计算其他实体到参考车辆地理边界的距离
@@ -314,8 +463,14 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
               other_vehicle_to_reference_geodesic,
               inter_geodesic_distance,
               inter_bbox_distance};
-    // 将结果缓存
-    geometry_cache.insert({actor_id_key, comparision_result});
+    // 将结果以较小的 ActorId 为参考车辆缓存
+    GeometryComparison cached_comparision = comparision_result;
+    if (reference_vehicle_id != key_parts.first) {
+      std::swap(cached_comparision.reference_vehicle_to_other_geodesic,
+                cached_comparision.other_vehicle_to_reference_geodesic);
+    }
+    std::lock_guard<std::mutex> lock(cache_mutex);
+    geometry_cache.insert({actor_id_key, cached_comparision});
   }
 
   return comparision_result; // 返回几何比较结果
@@ -323,7 +478,8 @@ GeometryComparison CollisionStage::GetGeometryBetweenActors(const ActorId refere
 
 std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId reference_vehicle_id,
                                                           const ActorId other_actor_id,
-                                                          const uint64_t reference_junction_look_ahead_index) {
+                                                          const uint64_t reference_junction_look_ahead_index,
+                                                          PendingCollisionLock &ego_lock) {
   // 方法的输出变量
   bool hazard = false;
   float available_distance_margin = std::numeric_limits<float>::infinity();
@@ -347,7 +503,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   float other_vehicle_length = simulation_state.GetDimensions(other_actor_id).x * SQUARE_ROOT_OF_TWO;
 
   float inter_vehicle_distance = cg::Math::DistanceSquared(reference_location, other_location);
-  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id);
+  float ego_bounding_box_extension = GetBoundingBoxExtention(reference_vehicle_id, ego_lock);
   float other_bounding_box_extension = GetBoundingBoxExtention(other_actor_id);
   // 计算车辆之间考虑碰撞协商的最小距离
   float inter_vehicle_length = reference_vehicle_length + other_vehicle_length;
@@ -368,10 +524,11 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
   SimpleWaypointPtr look_ahead_point = reference_vehicle_buffer.at(reference_junction_look_ahead_index);
   bool ego_at_junction_entrance = !closest_point->CheckJunction() && look_ahead_point->CheckJunction();
 
-  // 考虑碰撞谈判的条件
+  // 考虑碰撞谈判的条件，路径边界不可能接触时跳过多边形的构造与距离计算
   if (!(ego_at_junction_entrance && ego_at_traffic_light && ego_stopped_by_light)
       && ((ego_inside_junction && other_vehicles_in_cross_detection_range)
-          || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))) {
+          || (!ego_inside_junction && other_vehicle_in_front && other_vehicle_in_ego_range))
+      && MayOverlap(reference_vehicle_id, other_actor_id)) {
     GeometryComparison geometry_comparison = GetGeometryBetweenActors(reference_vehicle_id, other_actor_id);
 
     // 碰撞谈判的条件
@@ -393,7 +550,7 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
 
       hazard = true;
 
-      const float reference_lead_distance = parameters.GetDistanceToLeadingVehicle(reference_vehicle_id);
+      const float reference_lead_distance = GetDistanceToLeadingVehicle(reference_vehicle_id);
       const float specific_distance_margin = std::max(reference_lead_distance, MIN_REFERENCE_DISTANCE);
       available_distance_margin = static_cast<float>(std::max(geometry_comparison.reference_vehicle_to_other_geodesic
                                                               - static_cast<double>(specific_distance_margin), 0.0));
@@ -404,8 +561,8 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
       // 这使得我们能够平稳地接近前车
 
       // 当发现可能的碰撞时，检查是否存在碰撞锁的条目
-      if (collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-        CollisionLock &lock = collision_locks.at(reference_vehicle_id);
+      if (ego_lock.locked) {
+        CollisionLock &lock = ego_lock.lock;
         // 检查同一车辆是否处于锁定状态
         if (other_actor_id == lock.lead_vehicle_id) {
           // 如果领头车辆的车身与参考车辆的边界框接触
@@ -422,24 +579,23 @@ std::pair<bool, float> CollisionStage::NegotiateCollision(const ActorId referenc
         }
       } else {
         // 如果锁条目不存在，则插入并初始化锁条目
-        collision_locks.insert({reference_vehicle_id,
-                                {geometry_comparison.inter_bbox_distance,
-                                 geometry_comparison.inter_bbox_distance,
-                                 other_actor_id}});
+        ego_lock = {true, {geometry_comparison.inter_bbox_distance,
+                           geometry_comparison.inter_bbox_distance,
+                           other_actor_id}};
       }
     }
   }
 
   // 如果没有检测到碰撞危险，则清除车辆持有的碰撞锁定
-  if (!hazard && collision_locks.find(reference_vehicle_id) != collision_locks.end()) {
-    collision_locks.erase(reference_vehicle_id);
+  if (!hazard) {
+    ego_lock.locked = false;
   }
 
   return {hazard, available_distance_margin};
 }
 
 void CollisionStage::ClearCycleCache() {
-  geodesic_boundary_map.clear();
+  collision_boundary_map.clear();
   geometry_cache.clear();
 }
 
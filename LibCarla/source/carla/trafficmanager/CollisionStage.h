@@ -2,6 +2,7 @@
 #pragma once // 防止头文件重复包含
 
 #include <memory> // 引入智能指针的支持
+#include <mutex> // 引入互斥锁的支持
 
 #if defined(__clang__) // 如果使用 clang 编译器
 #  pragma clang diagnostic push // 保存当前警告状态
@@ -20,6 +21,7 @@
 #include "carla/trafficmanager/RandomGenerator.h" // 引入随机数生成器的定义
 #include "carla/trafficmanager/SimulationState.h" // 引入仿真状态的定义
 #include "carla/trafficmanager/Stage.h" // 引入阶段的定义
+#include "carla/trafficmanager/TrackTraffic.h" // 引入交通跟踪的定义
 
 namespace carla { // 定义 carla 命名空间
 namespace traffic_manager { // 定义 traffic_manager 命名空间
@@ -38,16 +40,34 @@ struct CollisionLock { // 定义碰撞锁结构
 };
 using CollisionLockMap = std::unordered_map<ActorId, CollisionLock>; // 定义碰撞锁映射表
 
+struct PendingCollisionLock { // 并行更新期间某辆车的碰撞锁工作副本
+  bool locked; // 是否持有碰撞锁
+  CollisionLock lock; // 碰撞锁内容
+};
+
 namespace cc = carla::client; // 简化 carla::client 的命名空间
 namespace bg = boost::geometry; // 简化 boost::geometry 的命名空间
 
 using Buffer = std::deque<std::shared_ptr<SimpleWaypoint>>; // 定义 waypoint 缓冲区
 using BufferMap = std::unordered_map<carla::ActorId, Buffer>; // 定义缓冲区映射表
 using LocationVector = std::vector<cg::Location>; // 定义位置向量
-using GeodesicBoundaryMap = std::unordered_map<ActorId, LocationVector>; // 定义测地边界映射表
 using GeometryComparisonMap = std::unordered_map<uint64_t, GeometryComparison>; // 定义几何比较映射表
 using Polygon = bg::model::polygon<bg::model::d2::point_xy<double>>; // 定义多边形类型
 
+/// 车辆在当前更新周期的边界多边形，由同一周期内涉及该车辆的所有车辆对共享
+struct CollisionBoundary {
+  Polygon bbox_polygon; // 车辆边界框的多边形
+  Polygon geodesic_polygon; // 车辆路径边界的多边形
+};
+using CollisionBoundaryMap = std::unordered_map<ActorId, CollisionBoundary>; // 定义碰撞边界映射表
+
+/// 包含车辆路径边界的圆，用于在构造多边形之前剔除不可能相交的车辆对
+struct BoundingCircle {
+  float x; // 圆心的x坐标
+  float y; // 圆心的y坐标
+  float radius; // 半径，无法确定时为无穷大
+};
+
 /// 该类具有检测与附近演员潜在碰撞的功能。
 class CollisionStage : Stage { // 定义 CollisionStage 类，继承自 Stage
 private:
@@ -57,31 +77,50 @@ private:
   const TrackTraffic &track_traffic; // 跟踪交通
   const Parameters &parameters; // 参数
   CollisionFrame &output_array; // 输出数组
-  CollisionLockMap collision_locks; // 存储阻塞的前方车辆信息
+  CollisionLockMap collision_locks; // 存储阻塞的前方车辆信息，并行更新期间只读
+  std::vector<PendingCollisionLock> pending_locks; // 每个 index 在本周期结束时的碰撞锁，CommitCycle 中写回
   GeometryComparisonMap geometry_cache; // 存储车辆边界的几何比较结果
-  GeodesicBoundaryMap geodesic_boundary_map; // 存储车辆的测地边界
+  CollisionBoundaryMap collision_boundary_map; // 存储车辆的边界多边形
+  std::mutex cache_mutex; // 保护 geometry_cache 与 collision_boundary_map
+  // 粗检测阶段：vehicle_id_list 中每辆车路径边界的外接圆，按 index 连续存储，PrepareCycle 中计算
+  std::vector<float> broad_phase_x;
+  std::vector<float> broad_phase_y;
+  std::vector<float> broad_phase_radius;
+  std::unordered_map<ActorId, unsigned long> broad_phase_index; // 车辆 ID 到上述数组下标的映射
   RandomGenerator &random_device; // 随机数生成器
 
   // 方法：确定车辆是否与另一辆车处于碰撞路径
+  // ego_lock 为参考车辆碰撞锁的工作副本，协商结果只写入其中
   std::pair<bool, float> NegotiateCollision(const ActorId reference_vehicle_id,
                                             const ActorId other_actor_id,
-                                            const uint64_t reference_junction_look_ahead_index);
+                                            const uint64_t reference_junction_look_ahead_index,
+                                            PendingCollisionLock &ego_lock);
 
-  // 方法：计算车辆前方的边界框扩展长度
+  // 方法：计算车辆前方的边界框扩展长度，使用本周期开始时的碰撞锁
   float GetBoundingBoxExtention(const ActorId actor_id);
 
+  // 方法：根据给定的碰撞锁计算车辆前方的边界框扩展长度
+  float GetBoundingBoxExtention(const ActorId actor_id, const PendingCollisionLock &lock);
+
+  // 方法：从本周期的参数快照中读取车辆与前车的距离
+  float GetDistanceToLeadingVehicle(const ActorId actor_id) const;
+
   // 方法：计算车辆边界的多边形点
   LocationVector GetBoundary(const ActorId actor_id);
 
   // 方法：构造车辆路径边界的多边形点
   LocationVector GetGeodesicBoundary(const ActorId actor_id);
 
+  // 方法：返回车辆在当前更新周期的边界多边形，第一次访问时构造并缓存
+  const CollisionBoundary &GetCollisionBoundary(const ActorId actor_id);
+
+  // 方法：计算包含车辆路径边界（GetGeodesicBoundary 的所有点）的圆，不分配内存
+  BoundingCircle ComputeBoundingCircle(const ActorId actor_id);
+
+  // 方法：两辆车的路径边界是否可能相距小于 OVERLAP_THRESHOLD，返回 false 时无需构造多边形
   Polygon GetPolygon(const LocationVector &boundary); // 获取多边形对象
 
   // 方法：比较路径边界、车辆的边界框，并缓存当前更新周期的结果
-  GeometryComparison GetGeometryBetweenActors(const ActorId reference_vehicle_id,
-                                              const ActorId other_actor_id);
-
   // 方法：绘制路径边界
   void DrawBoundary(const LocationVector &boundary);
 
@@ -95,7 +134,11 @@ public:
                  CollisionFrame &output_array,
                  RandomGenerator &random_device);
 
-  void Update (const unsigned long index) override; // 更新方法
+  void Update (const unsigned long index) override; // 更新方法，不同 index 可以并行调用
+
+  void PrepareCycle() override; // 为每个 index 准备碰撞锁工作副本并计算粗检测所需的外接圆
+
+  void CommitCycle() override; // 按 index 顺序写回碰撞锁并清除本周期缓存
 
   void RemoveActor(const ActorId actor_id) override; // 移除参与者方法
 
@@ -103,6 +146,14 @@ public:
 
   // 方法：清除当前更新周期的缓存
   void ClearCycleCache();
+
+  // 粗检测：两个外接圆不相交时两条路径边界之间的距离一定超过 OVERLAP_THRESHOLD，
+  // 需要先调用 PrepareCycle
+  bool MayOverlap(const ActorId reference_vehicle_id, const ActorId other_actor_id);
+
+  // 完整检测：两车边界框与路径边界之间的距离，结果在本周期内缓存
+  GeometryComparison GetGeometryBetweenActors(const ActorId reference_vehicle_id,
+                                              const ActorId other_actor_id);
 };
 
 } // namespace traffic_manager
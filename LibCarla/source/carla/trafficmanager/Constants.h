@@ -87,6 +87,7 @@ static const float EPSILON = 2.0f * std::numeric_limits<float>::epsilon(); // 
 static const float MIN_REFERENCE_DISTANCE = 0.5f; // 最小参考距离
 static const float MIN_VELOCITY_COLL_RADIUS = 2.0f; // 最小速度碰撞半径
 static const float VEL_EXT_FACTOR = 0.36f; // 速度扩展因子
+static const float BROAD_PHASE_PADDING = 0.1f; // 粗检测外接圆的额外裕量，抵消浮点误差
 } // namespace Collision
 
 namespace FrameMemory {
@@ -124,6 +125,7 @@ static const float LANDMARK_DETECTION_TIME = 3.5f; // 地标检测时间
 static const float TL_TARGET_VELOCITY = 15.0f / 3.6f; // 交通灯目标速度
 static const float STOP_TARGET_VELOCITY = 10.0f / 3.6f; // 停止目标速度
 static const float YIELD_TARGET_VELOCITY = 10.0f / 3.6f; // 让行目标速度
+static const float LANDMARK_INDEX_HORIZON = 150.0f; // 预计算地标索引的视野长度，也是地标检测距离的上限（超过约154km/h时检测距离被截断）
 static const float FRICTION = 0.6f; // 摩擦系数
 static const float GRAVITY = 9.81f; // 重力加速度
 static const float PI = 3.1415927f; // 圆周率
@@ -0,0 +1,112 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/ControlFrameFilter.h"
+
+#include "carla/Debug.h"
+
+#include <cmath>
+#include <unordered_set>
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace {
+
+    using ApplyVehicleControl = carla::rpc::Command::ApplyVehicleControl;
+    using ApplyTransform = carla::rpc::Command::ApplyTransform;
+
+    /// 支持差分的命令的目标参与者，不支持时返回false。
+    bool GetFilteredActor(const rpc::Command &command, ActorId &actor_id) {
+      if (const auto *control = boost::variant2::get_if<ApplyVehicleControl>(&command.command)) {
+        actor_id = control->actor;
+        return true;
+      }
+      return false;
+    }
+
+    bool IsNear(const float lhs, const float rhs, const float tolerance) {
+      return std::abs(lhs - rhs) <= tolerance;
+    }
+
+  } // namespace
+
+  bool ControlFrameFilter::IsNearlyEqual(const rpc::Command &lhs, const rpc::Command &rhs, const float tolerance) {
+    if (lhs.command.index() != rhs.command.index()) {
+      return false;
+    }
+    if (const auto *a = boost::variant2::get_if<ApplyVehicleControl>(&lhs.command)) {
+      const auto &b = boost::variant2::get<ApplyVehicleControl>(rhs.command);
+      return a->actor == b.actor &&
+             IsNear(a->control.throttle, b.control.throttle, tolerance) &&
+             IsNear(a->control.steer, b.control.steer, tolerance) &&
+             IsNear(a->control.brake, b.control.brake, tolerance) &&
+             a->control.hand_brake == b.control.hand_brake &&
+             a->control.reverse == b.control.reverse &&
+             a->control.manual_gear_shift == b.control.manual_gear_shift &&
+             a->control.gear == b.control.gear;
+    }
+    return false;
+  }
+
+  void ControlFrameFilter::Filter(const ControlFrame &frame,
+                                  const unsigned long number_of_vehicles,
+                                  const float tolerance,
+                                  StageExecutor &executor,
+                                  ControlFrame &batch) {
+    DEBUG_ASSERT(number_of_vehicles <= frame.size());
+
+    // 并行比较，只读取上一次发送的记录
+    changed.assign(number_of_vehicles, 1u);
+    executor.ParallelFor(number_of_vehicles, [this, &frame, tolerance](const unsigned long index) {
+      ActorId actor_id;
+      if (!GetFilteredActor(frame[index], actor_id)) {
+        return;
+      }
+      const rpc::Command *previous = last_sent.Find(actor_id);
+      if (previous != nullptr && IsNearlyEqual(*previous, frame[index], tolerance)) {
+        changed[index] = 0u;
+      }
+    });
+
+    // 按车辆顺序收集需要发送的命令并更新记录
+    for (unsigned long index = 0u; index < number_of_vehicles; ++index) {
+      if (changed[index] == 0u) {
+        continue;
+      }
+      const rpc::Command &command = frame[index];
+      batch.push_back(command);
+      ActorId actor_id;
+      if (GetFilteredActor(command, actor_id)) {
+        last_sent[actor_id] = command;
+      } else if (const auto *teleport = boost::variant2::get_if<ApplyTransform>(&command.command)) {
+        // 传送期间车辆没有物理模拟，恢复控制后的第一条命令总是发送
+        last_sent.Erase(teleport->actor);
+      }
+    }
+    batch.insert(batch.end(), frame.begin() + number_of_vehicles, frame.end());
+  }
+
+  void ControlFrameFilter::Retain(const std::vector<ActorId> &vehicle_ids) {
+    const std::unordered_set<ActorId> current(vehicle_ids.begin(), vehicle_ids.end());
+    std::vector<ActorId> to_remove;
+    last_sent.ForEach([&current, &to_remove](const ActorId actor_id, const rpc::Command &) {
+      if (current.find(actor_id) == current.end()) {
+        to_remove.push_back(actor_id);
+      }
+    });
+    for (const ActorId actor_id : to_remove) {
+      last_sent.Erase(actor_id);
+    }
+  }
+
+  void ControlFrameFilter::Reset() {
+    last_sent.Clear();
+    changed.clear();
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,62 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "carla/rpc/ActorId.h"
+#include "carla/rpc/Command.h"
+
+#include "carla/trafficmanager/DataStructures.h"
+#include "carla/trafficmanager/FlatHashMap.h"
+#include "carla/trafficmanager/StageExecutor.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// 控制帧差分：只保留与上一次发送给模拟器的车辆控制相比变化超过容差的命令。
+///
+/// 服务器端的车辆会一直保持最后一次收到的控制，因此没有变化的 ApplyVehicleControl
+/// 命令可以不发送。比较的基准是上一次实际发送的命令，累计的偏差不会超过容差。
+/// 其他类型的命令总是发送。混合物理模式下的传送目标是车辆当前位置加上一步的位移，
+/// 不发送就不会移动，所以 ApplyTransform 不参与差分。
+class ControlFrameFilter {
+
+public:
+
+  /// 从 @a frame 中选出需要发送的命令追加到 @a batch 并记录下来。
+  ///
+  /// @a frame 的前 @a number_of_vehicles 个命令每辆车一个，由 @a executor 并行比较，
+  /// 之后的命令原样追加。
+  void Filter(const ControlFrame &frame,
+              const unsigned long number_of_vehicles,
+              const float tolerance,
+              StageExecutor &executor,
+              ControlFrame &batch);
+
+  /// 只保留 @a vehicle_ids 中车辆的记录，已注册车辆发生变化时调用。
+  void Retain(const std::vector<ActorId> &vehicle_ids);
+
+  /// 清除所有记录，之后的第一帧会发送全部命令。
+  void Reset();
+
+  /// 两条车辆控制命令的参与者相同，且油门、转向与刹车之差都不超过 @a tolerance
+  /// 时返回true；档位等离散的值必须完全相同。其他命令类型总是返回false。
+  static bool IsNearlyEqual(const rpc::Command &lhs, const rpc::Command &rhs, const float tolerance);
+
+private:
+
+  /// 上一次发送给每辆车的控制命令，车辆被传送后清除。
+  FlatHashMap<ActorId, rpc::Command> last_sent;
+
+  /// 本帧每辆车的命令是否需要发送，由各工作线程分别写入自己的元素。
+  std::vector<uint8_t> changed;
+};
+
+} // namespace traffic_manager
+} // namespace carla
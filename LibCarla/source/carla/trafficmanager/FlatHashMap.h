@@ -0,0 +1,189 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 用于整数键的哈希函数，对连续的ID也能得到均匀分布的结果。
+  template <typename Key>
+  struct FlatHash {
+    size_t operator()(const Key &key) const {
+      uint64_t x = static_cast<uint64_t>(key);
+      x ^= x >> 30;
+      x *= 0xbf58476d1ce4e5b9ull;
+      x ^= x >> 27;
+      x *= 0x94d049bb133111ebull;
+      x ^= x >> 31;
+      return static_cast<size_t>(x);
+    }
+  };
+
+  /// 开放寻址（线性探测）的哈希表，所有条目保存在一块连续内存中。
+  ///
+  /// 删除时将后续条目向前移动（backward shift），因此不需要墓碑标记，
+  /// 频繁插入删除也不会降低查找性能。插入或删除会使指向值的指针失效。
+  template <typename Key, typename Value, typename Hash = FlatHash<Key>>
+  class FlatHashMap {
+  private:
+
+    struct Slot {
+      Key key;
+      Value value;
+      bool used = false;
+    };
+
+    std::vector<Slot> _slots;
+
+    size_t _size = 0u;
+
+    Hash _hash;
+
+    size_t Mask() const {
+      return _slots.size() - 1u;
+    }
+
+    size_t FindSlot(const Key &key) const {
+      if (_slots.empty()) {
+        return npos;
+      }
+      for (size_t i = _hash(key) & Mask(); ; i = (i + 1u) & Mask()) {
+        const Slot &slot = _slots[i];
+        if (!slot.used) {
+          return npos;
+        }
+        if (slot.key == key) {
+          return i;
+        }
+      }
+    }
+
+    void Rehash(size_t capacity) {
+      std::vector<Slot> old_slots(capacity);
+      old_slots.swap(_slots);
+      for (Slot &slot : old_slots) {
+        if (slot.used) {
+          size_t i = _hash(slot.key) & Mask();
+          while (_slots[i].used) {
+            i = (i + 1u) & Mask();
+          }
+          _slots[i].key = slot.key;
+          _slots[i].value = std::move(slot.value);
+          _slots[i].used = true;
+        }
+      }
+    }
+
+  public:
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    size_t Size() const {
+      return _size;
+    }
+
+    bool Empty() const {
+      return _size == 0u;
+    }
+
+    /// 预留至少能容纳 count 个条目的空间。
+    void Reserve(size_t count) {
+      size_t capacity = 16u;
+      while (capacity * 3u < count * 4u) {
+        capacity *= 2u;
+      }
+      if (capacity > _slots.size()) {
+        Rehash(capacity);
+      }
+    }
+
+    /// 返回键对应的值，不存在时返回 nullptr。
+    Value *Find(const Key &key) {
+      const size_t i = FindSlot(key);
+      return i == npos ? nullptr : &_slots[i].value;
+    }
+
+    const Value *Find(const Key &key) const {
+      const size_t i = FindSlot(key);
+      return i == npos ? nullptr : &_slots[i].value;
+    }
+
+    bool Contains(const Key &key) const {
+      return FindSlot(key) != npos;
+    }
+
+    /// 返回键对应的值，不存在时插入一个默认构造的值。
+    Value &operator[](const Key &key) {
+      if ((_size + 1u) * 4u > _slots.size() * 3u) {
+        Rehash(_slots.empty() ? 16u : _slots.size() * 2u);
+      }
+      size_t i = _hash(key) & Mask();
+      while (_slots[i].used) {
+        if (_slots[i].key == key) {
+          return _slots[i].value;
+        }
+        i = (i + 1u) & Mask();
+      }
+      _slots[i].key = key;
+      _slots[i].value = Value();
+      _slots[i].used = true;
+      ++_size;
+      return _slots[i].value;
+    }
+
+    /// 删除键对应的条目，返回是否存在该条目。
+    bool Erase(const Key &key) {
+      size_t hole = FindSlot(key);
+      if (hole == npos) {
+        return false;
+      }
+      // 将同一探测链上的后续条目前移填补空位
+      for (size_t i = (hole + 1u) & Mask(); _slots[i].used; i = (i + 1u) & Mask()) {
+        const size_t home = _hash(_slots[i].key) & Mask();
+        // 条目的理想位置不在 (hole, i] 区间内时才能移动到 hole
+        const bool movable = (hole <= i) ? (home <= hole || home > i) : (home <= hole && home > i);
+        if (movable) {
+          _slots[hole].key = _slots[i].key;
+          _slots[hole].value = std::move(_slots[i].value);
+          hole = i;
+        }
+      }
+      _slots[hole].value = Value();
+      _slots[hole].used = false;
+      --_size;
+      return true;
+    }
+
+    /// 清空所有条目，保留已分配的容量。
+    void Clear() {
+      for (Slot &slot : _slots) {
+        if (slot.used) {
+          slot.value = Value();
+          slot.used = false;
+        }
+      }
+      _size = 0u;
+    }
+
+    /// 对每个条目调用 functor(key, value)。
+    template <typename Functor>
+    void ForEach(Functor &&functor) const {
+      for (const Slot &slot : _slots) {
+        if (slot.used) {
+          functor(slot.key, slot.value);
+        }
+      }
+    }
+  };
+
+} // namespace traffic_manager
+} // namespace carla
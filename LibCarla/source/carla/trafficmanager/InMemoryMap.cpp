@@ -5,10 +5,14 @@
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
 #include "carla/Logging.h"
+#include "carla/client/FileTransfer.h"
 
 #include "carla/trafficmanager/Constants.h"
 #include "carla/trafficmanager/InMemoryMap.h"
+#include "carla/trafficmanager/InMemoryMapCache.h"
 #include <boost/geometry/geometries/box.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 // 定义在carla命名空间下的traffic_manager命名空间
 namespace carla {
 namespace traffic_manager {
@@ -16,6 +20,7 @@ namespace traffic_manager {
   namespace cg = carla::geom;
  // 引入constants::Map命名空间内的元素到当前作用域
   using namespace constants::Map;
+  using constants::MotionPlan::LANDMARK_INDEX_HORIZON;
 // 定义拓扑列表类型
   using TopologyList = std::vector<std::pair<WaypointPtr, WaypointPtr>>;
  // 定义原始节点列表类型
@@ -92,6 +97,15 @@ namespace traffic_manager {
       filename = path;
     }
 
+    // 检查是否存在重复的路径点
+    std::unordered_set<uint64_t> used_ids;
+    for (auto& wp: dense_topology) {
+      if (used_ids.find(wp->GetId()) != used_ids.end()) {
+        log_error("Could not generate the binary file. There are repeated waypoints");
+      }
+      used_ids.insert(wp->GetId());
+    }
+
     std::ofstream out_file;
     out_file.open(filename, std::ios::binary);
     if (!out_file.is_open()) {
@@ -99,27 +113,300 @@ namespace traffic_manager {
       return;
     }
 
-    // 将所有记录的总数写入文件中
-    uint32_t total = static_cast<uint32_t>(dense_topology.size());
-    out_file.write(reinterpret_cast<const char *>(&total), sizeof(uint32_t));
+    const std::vector<uint8_t> content = Serialize();
+    out_file.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+    out_file.close();
+    return;
+  }
 
-    // 创建或记录一些基本的导航点
-    std::unordered_set<uint64_t> used_ids;
-    for (auto& wp: dense_topology) {
-      if (used_ids.find(wp->GetId()) != used_ids.end()) {
-        log_error("Could not generate the binary file. There are repeated waypoints");
+  std::vector<uint8_t> InMemoryMap::Serialize() const {
+    const uint32_t total = static_cast<uint32_t>(dense_topology.size());
+
+    // 计算各个数组在文件中的位置
+    cache::Header header;
+    std::memcpy(header.magic, cache::MAGIC, sizeof(cache::MAGIC));
+    header.version = cache::VERSION;
+    header.header_size = static_cast<uint32_t>(sizeof(cache::Header));
+    header.waypoint_count = total;
+    header.next_link_count = 0u;
+    header.previous_link_count = 0u;
+    for (uint32_t i = 0u; i < total; ++i) {
+      header.next_link_count += static_cast<uint32_t>(waypoint_graph.GetNext(i).size());
+      header.previous_link_count += static_cast<uint32_t>(waypoint_graph.GetPrevious(i).size());
+    }
+    header.spatial_tree_count = static_cast<uint32_t>(rtree.size());
+    header.waypoints_offset = cache::Align(sizeof(cache::Header));
+    header.next_offsets_offset = cache::Align(header.waypoints_offset + total * sizeof(cache::WaypointRecord));
+    header.next_indices_offset = cache::Align(header.next_offsets_offset + (total + 1u) * sizeof(uint32_t));
+    header.previous_offsets_offset = cache::Align(header.next_indices_offset + header.next_link_count * sizeof(uint32_t));
+    header.previous_indices_offset = cache::Align(header.previous_offsets_offset + (total + 1u) * sizeof(uint32_t));
+    header.spatial_tree_offset = cache::Align(header.previous_indices_offset + header.previous_link_count * sizeof(uint32_t));
+    const std::vector<LandmarkObservation> &observations = landmark_index.GetObservations();
+    header.landmark_count = static_cast<uint32_t>(observations.size());
+    header.reserved = 0u;
+    header.landmarks_offset = cache::Align(header.spatial_tree_offset + header.spatial_tree_count * sizeof(cache::SpatialTreeRecord));
+    header.file_size = header.landmarks_offset + header.landmark_count * sizeof(cache::LandmarkRecord);
+
+    std::vector<uint8_t> content(header.file_size, 0u);
+    std::memcpy(content.data(), &header, sizeof(header));
+
+    // 路径点与CSR连接
+    auto *records = reinterpret_cast<cache::WaypointRecord *>(content.data() + header.waypoints_offset);
+    auto *next_offsets = reinterpret_cast<uint32_t *>(content.data() + header.next_offsets_offset);
+    auto *next_indices = reinterpret_cast<uint32_t *>(content.data() + header.next_indices_offset);
+    auto *previous_offsets = reinterpret_cast<uint32_t *>(content.data() + header.previous_offsets_offset);
+    auto *previous_indices = reinterpret_cast<uint32_t *>(content.data() + header.previous_indices_offset);
+    uint32_t next_count = 0u;
+    uint32_t previous_count = 0u;
+    next_offsets[0] = 0u;
+    previous_offsets[0] = 0u;
+    for (uint32_t i = 0u; i < total; ++i) {
+      const SimpleWaypointPtr &swp = dense_topology[i];
+      const ResolvedWaypoint resolved = swp->GetResolvedWaypoint();
+      const cg::Transform &transform = resolved.transform;
+      cache::WaypointRecord &record = records[i];
+      record.waypoint_id = resolved.id;
+      record.location[0] = transform.location.x;
+      record.location[1] = transform.location.y;
+      record.location[2] = transform.location.z;
+      record.rotation[0] = transform.rotation.pitch;
+      record.rotation[1] = transform.rotation.yaw;
+      record.rotation[2] = transform.rotation.roll;
+      record.s = resolved.s;
+      record.road_id = resolved.road_id;
+      record.lane_id = resolved.lane_id;
+      record.junction_id = resolved.junction_id;
+      record.geodesic_grid_id = swp->GetGeodesicGridId();
+      record.left_index = waypoint_graph.GetLeft(i);
+      record.right_index = waypoint_graph.GetRight(i);
+      record.flags = 0u;
+      if (swp->CheckJunction()) {
+        record.flags |= cache::FLAG_JUNCTION;
+      }
+      if (resolved.is_junction) {
+        record.flags |= cache::FLAG_WAYPOINT_JUNCTION;
       }
-      CachedSimpleWaypoint cached_wp(wp);
-      cached_wp.Write(out_file);
+      record.road_option = static_cast<uint8_t>(swp->GetRoadOption());
 
-      used_ids.insert(wp->GetId());
+      for (const WaypointIndex next : waypoint_graph.GetNext(i)) {
+        next_indices[next_count++] = next;
+      }
+      next_offsets[i + 1u] = next_count;
+      for (const WaypointIndex previous : waypoint_graph.GetPrevious(i)) {
+        previous_indices[previous_count++] = previous;
+      }
+      previous_offsets[i + 1u] = previous_count;
     }
 
-    out_file.close();
-    return;
+    // R树条目，按树中的顺序写入
+    auto *tree_records = reinterpret_cast<cache::SpatialTreeRecord *>(content.data() + header.spatial_tree_offset);
+    for (const SpatialTreeEntry &entry : rtree) {
+      tree_records->location[0] = bg::get<0>(entry.first);
+      tree_records->location[1] = bg::get<1>(entry.first);
+      tree_records->location[2] = bg::get<2>(entry.first);
+      tree_records->index = entry.second;
+      ++tree_records;
+    }
+
+    // 地标的观察结果，加载时据此重新传播，不必再查询OpenDrive地图
+    auto *landmark_records = reinterpret_cast<cache::LandmarkRecord *>(content.data() + header.landmarks_offset);
+    for (const LandmarkObservation &observation : observations) {
+      landmark_records->location[0] = observation.location.x;
+      landmark_records->location[1] = observation.location.y;
+      landmark_records->location[2] = observation.location.z;
+      landmark_records->waypoint_index = observation.waypoint;
+      landmark_records->distance = observation.distance;
+      landmark_records->value = observation.value;
+      landmark_records->type = static_cast<uint8_t>(observation.type);
+      ++landmark_records;
+    }
+
+    return content;
+  }
+
+  bool InMemoryMap::Load(const std::string& filename) {
+    namespace bip = boost::interprocess;
+    try {
+      // 直接映射缓存文件，避免先整体复制到内存中
+      bip::file_mapping mapping(filename.c_str(), bip::read_only);
+      bip::mapped_region region(mapping, bip::read_only);
+      const auto *data = static_cast<const uint8_t *>(region.get_address());
+      const size_t size = region.get_size();
+      if (!cache::HasMagic(data, size)) {
+        return LoadLegacy(std::vector<uint8_t>(data, data + size));
+      }
+      return LoadCache(data, size);
+    } catch (const bip::interprocess_exception &e) {
+      log_warning("Could not map InMemoryMap cache", filename, ":", e.what());
+      return false;
+    }
+  }
+
+  bool InMemoryMap::LoadFromFileCache(const std::string& file) {
+    // FileExists 检查的是带版本号的完整路径，加载时必须使用同一路径
+    if (!cc::FileTransfer::FileExists(file)) {
+      return false;
+    }
+    return Load(cc::FileTransfer::GetFullPath(file));
   }
 
   bool InMemoryMap::Load(const std::vector<uint8_t>& content) {
+    if (cache::HasMagic(content.data(), content.size())) {
+      return LoadCache(content.data(), content.size());
+    }
+    return LoadLegacy(content);
+  }
+
+  bool InMemoryMap::LoadCache(const uint8_t *data, size_t size) {
+    if (size < sizeof(cache::Header) || !cache::HasMagic(data, size)) {
+      log_warning("InMemoryMap cache has an unknown format");
+      return false;
+    }
+    cache::Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.version != cache::VERSION || header.header_size != sizeof(cache::Header)) {
+      log_warning("InMemoryMap cache version", header.version, "does not match the expected version", cache::VERSION);
+      return false;
+    }
+
+    const uint64_t total = header.waypoint_count;
+    if (header.file_size > size ||
+        !cache::IsInBounds<cache::WaypointRecord>(header.waypoints_offset, total, size) ||
+        !cache::IsInBounds<uint32_t>(header.next_offsets_offset, total + 1u, size) ||
+        !cache::IsInBounds<uint32_t>(header.next_indices_offset, header.next_link_count, size) ||
+        !cache::IsInBounds<uint32_t>(header.previous_offsets_offset, total + 1u, size) ||
+        !cache::IsInBounds<uint32_t>(header.previous_indices_offset, header.previous_link_count, size) ||
+        !cache::IsInBounds<cache::SpatialTreeRecord>(header.spatial_tree_offset, header.spatial_tree_count, size) ||
+        !cache::IsInBounds<cache::LandmarkRecord>(header.landmarks_offset, header.landmark_count, size)) {
+      log_warning("InMemoryMap cache is truncated");
+      return false;
+    }
+
+    const auto *records = reinterpret_cast<const cache::WaypointRecord *>(data + header.waypoints_offset);
+    const auto *next_offsets = reinterpret_cast<const uint32_t *>(data + header.next_offsets_offset);
+    const auto *next_indices = reinterpret_cast<const uint32_t *>(data + header.next_indices_offset);
+    const auto *previous_offsets = reinterpret_cast<const uint32_t *>(data + header.previous_offsets_offset);
+    const auto *previous_indices = reinterpret_cast<const uint32_t *>(data + header.previous_indices_offset);
+    const auto *tree_records = reinterpret_cast<const cache::SpatialTreeRecord *>(data + header.spatial_tree_offset);
+    const auto *landmark_records = reinterpret_cast<const cache::LandmarkRecord *>(data + header.landmarks_offset);
+
+    // 在修改本地地图之前校验所有索引
+    auto is_valid_index = [total](uint32_t index) {
+      return index == cache::INVALID_INDEX || index < total;
+    };
+    if (next_offsets[0] != 0u || previous_offsets[0] != 0u ||
+        next_offsets[total] != header.next_link_count ||
+        previous_offsets[total] != header.previous_link_count) {
+      log_warning("InMemoryMap cache has corrupted links");
+      return false;
+    }
+    for (uint64_t i = 0u; i < total; ++i) {
+      if (next_offsets[i] > next_offsets[i + 1u] || previous_offsets[i] > previous_offsets[i + 1u] ||
+          !is_valid_index(records[i].left_index) || !is_valid_index(records[i].right_index)) {
+        log_warning("InMemoryMap cache has corrupted links");
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < header.next_link_count; ++i) {
+      if (next_indices[i] >= total) {
+        log_warning("InMemoryMap cache has corrupted links");
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < header.previous_link_count; ++i) {
+      if (previous_indices[i] >= total) {
+        log_warning("InMemoryMap cache has corrupted links");
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < header.spatial_tree_count; ++i) {
+      if (tree_records[i].index >= total) {
+        log_warning("InMemoryMap cache has a corrupted spatial tree");
+        return false;
+      }
+    }
+    for (uint32_t i = 0u; i < header.landmark_count; ++i) {
+      if (landmark_records[i].waypoint_index >= total ||
+          landmark_records[i].type >= NUMBER_OF_LANDMARK_TYPES) {
+        log_warning("InMemoryMap cache has corrupted landmarks");
+        return false;
+      }
+    }
+
+    // 创建路径点，Carla的Waypoint对象在第一次使用时才解析
+    dense_topology.clear();
+    dense_topology.reserve(total);
+    for (uint64_t i = 0u; i < total; ++i) {
+      const cache::WaypointRecord &record = records[i];
+      ResolvedWaypoint resolved;
+      resolved.transform = cg::Transform(
+          cg::Location(record.location[0], record.location[1], record.location[2]),
+          cg::Rotation(record.rotation[0], record.rotation[1], record.rotation[2]));
+      resolved.id = record.waypoint_id;
+      resolved.road_id = record.road_id;
+      resolved.lane_id = record.lane_id;
+      resolved.s = record.s;
+      resolved.junction_id = record.junction_id;
+      resolved.is_junction = (record.flags & cache::FLAG_WAYPOINT_JUNCTION) != 0u;
+      SimpleWaypointPtr wp = std::make_shared<SimpleWaypoint>(_world_map, resolved);
+      wp->SetGeodesicGridId(record.geodesic_grid_id);
+      wp->SetIsJunction((record.flags & cache::FLAG_JUNCTION) != 0u);
+      wp->SetRoadOption(static_cast<RoadOption>(record.road_option));
+      dense_topology.push_back(std::move(wp));
+    }
+
+    // 按索引连接路径点
+    NodeList links;
+    for (uint64_t i = 0u; i < total; ++i) {
+      const SimpleWaypointPtr &wp = dense_topology[i];
+      links.clear();
+      for (uint32_t j = next_offsets[i]; j < next_offsets[i + 1u]; ++j) {
+        links.push_back(dense_topology[next_indices[j]]);
+      }
+      wp->SetNextWaypoint(links);
+      links.clear();
+      for (uint32_t j = previous_offsets[i]; j < previous_offsets[i + 1u]; ++j) {
+        links.push_back(dense_topology[previous_indices[j]]);
+      }
+      wp->SetPreviousWaypoint(links);
+      if (records[i].left_index != cache::INVALID_INDEX) {
+        wp->SetLeftWaypoint(dense_topology[records[i].left_index]);
+      }
+      if (records[i].right_index != cache::INVALID_INDEX) {
+        wp->SetRightWaypoint(dense_topology[records[i].right_index]);
+      }
+    }
+
+    // 从缓存的条目批量构建空间树
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(header.spatial_tree_count);
+    for (uint32_t i = 0u; i < header.spatial_tree_count; ++i) {
+      const cache::SpatialTreeRecord &record = tree_records[i];
+      entries.emplace_back(Point3D(record.location[0], record.location[1], record.location[2]), record.index);
+    }
+    rtree = Rtree(entries.begin(), entries.end());
+
+    // 创建紧凑路径点图
+    SetUpWaypointGraph();
+
+    // 由缓存的观察结果创建地标索引
+    std::vector<LandmarkObservation> observations;
+    observations.reserve(header.landmark_count);
+    for (uint32_t i = 0u; i < header.landmark_count; ++i) {
+      const cache::LandmarkRecord &record = landmark_records[i];
+      observations.push_back(LandmarkObservation{
+          record.waypoint_index,
+          static_cast<LandmarkType>(record.type),
+          record.distance,
+          record.value,
+          cg::Location(record.location[0], record.location[1], record.location[2])});
+    }
+    landmark_index.Build(waypoint_graph, std::move(observations), LANDMARK_INDEX_HORIZON);
+
+    return true;
+  }
+
+  bool InMemoryMap::LoadLegacy(const std::vector<uint8_t>& content) {
     unsigned long pos = 0;
     std::vector<CachedSimpleWaypoint> cached_waypoints;
     std::unordered_map<uint64_t, uint32_t> id2index;
@@ -170,6 +457,12 @@ namespace traffic_manager {
     // 创建空间树
     SetUpSpatialTree();
 
+    // 创建紧凑路径点图
+    SetUpWaypointGraph();
+
+    // 旧版缓存不包含地标，从地图中查询
+    SetUpLandmarkIndex();
+
     return true;
   }
 
@@ -373,16 +666,27 @@ namespace traffic_manager {
 
     // 为每个 SimpleWaypoint 指定一个 RoadOption
     SetUpRoadOption();
+
+    // 所有连接与道路选项确定后，创建紧凑路径点图
+    SetUpWaypointGraph();
+
+    // 沿路径点图预先计算到各类地标的距离
+    SetUpLandmarkIndex();
   }
 
   void InMemoryMap::SetUpSpatialTree() {
-    for (auto &simple_waypoint: dense_topology) {
+    std::vector<SpatialTreeEntry> entries;
+    entries.reserve(dense_topology.size());
+    for (size_t i = 0u; i < dense_topology.size(); ++i) {
+      const SimpleWaypointPtr &simple_waypoint = dense_topology[i];
       if (simple_waypoint != nullptr) {
         const cg::Location loc = simple_waypoint->GetLocation();
         Point3D point(loc.x, loc.y, loc.z);
-        rtree.insert(std::make_pair(point, simple_waypoint));
+        entries.emplace_back(point, static_cast<WaypointIndex>(i));
       }
     }
+    // 使用打包算法批量构建，比逐个插入更快且树的结构更紧凑
+    rtree = Rtree(entries.begin(), entries.end());
   }
 
   void InMemoryMap::SetUpRoadOption() {
@@ -481,9 +785,7 @@ namespace traffic_manager {
     rtree.query(bgi::nearest(query_point, 1), std::back_inserter(result_1));
 
     SpatialTreeEntry &closest_entry = result_1.front();
-    SimpleWaypointPtr &closest_point = closest_entry.second;
-
-    return closest_point;
+    return dense_topology[closest_entry.second];
   }
 
   NodeList InMemoryMap::GetWaypointsInDelta(const cg::Location loc, const uint16_t n_points, const float random_sample) const {
@@ -502,11 +804,11 @@ namespace traffic_manager {
     for (Rtree::const_query_iterator
         it = rtree.qbegin(bgi::within(upper_query_box)
         && !bgi::within(lower_query_box)
-        && bgi::satisfies([&](SpatialTreeEntry const& v) { return !v.second->CheckJunction();}));
+        && bgi::satisfies([&](SpatialTreeEntry const& v) { return !dense_topology[v.second]->CheckJunction();}));
         it != rtree.qend();
         ++it) {
     x++;
-    result.push_back(it->second);
+    result.push_back(dense_topology[it->second]);
     if (x >= n_points)
         break;
     }
@@ -518,6 +820,53 @@ namespace traffic_manager {
     return dense_topology;
   }
 
+  const WaypointGraph &InMemoryMap::GetWaypointGraph() const {
+    return waypoint_graph;
+  }
+
+  const SimpleWaypointPtr &InMemoryMap::GetWaypointByIndex(const WaypointIndex index) const {
+    return dense_topology[index];
+  }
+
+  const LandmarkIndex &InMemoryMap::GetLandmarkIndex() const {
+    return landmark_index;
+  }
+
+  void InMemoryMap::SetUpWaypointGraph() {
+    waypoint_graph.Build(dense_topology);
+  }
+
+  void InMemoryMap::SetUpLandmarkIndex() {
+    std::vector<LandmarkObservation> observations;
+    for (WaypointIndex i = 0u; i < dense_topology.size(); ++i) {
+      const SimpleWaypointPtr &swp = dense_topology[i];
+      if (swp == nullptr) {
+        continue;
+      }
+      // 每个路径点只需查询到后继路径点为止，更远的地标由后继观察到后反向传播。
+      // 弯道上沿车道的距离比直线距离长，因此多查询一段。没有后继的路径点
+      // 不一定位于车道末端，至少查询一个采样间隔
+      float step = 0.0f;
+      for (const WaypointIndex next : waypoint_graph.GetNext(i)) {
+        step = std::max(step, std::sqrt(waypoint_graph.DistanceSquared(i, next)));
+      }
+      const double query_distance = std::max(2.0f * step, MAP_RESOLUTION);
+      for (auto &landmark : swp->GetWaypoint()->GetAllLandmarksInDistance(query_distance, false)) {
+        LandmarkType type;
+        if (!ToLandmarkType(landmark->GetType(), type)) {
+          continue;
+        }
+        observations.push_back(LandmarkObservation{
+            i,
+            type,
+            static_cast<float>(landmark->GetDistance()),
+            static_cast<float>(landmark->GetValue()),
+            landmark->GetWaypoint()->GetTransform().location});
+      }
+    }
+    landmark_index.Build(waypoint_graph, std::move(observations), LANDMARK_INDEX_HORIZON);
+  }
+
   void InMemoryMap::FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint) {
 
     const WaypointPtr raw_waypoint = reference_waypoint->GetWaypoint();
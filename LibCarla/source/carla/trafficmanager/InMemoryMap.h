@@ -32,6 +32,8 @@
 #include "carla/trafficmanager/RandomGenerator.h"  // 引入随机生成器定义
 #include "carla/trafficmanager/SimpleWaypoint.h"  // 引入简单路径点定义
 #include "carla/trafficmanager/CachedSimpleWaypoint.h"  // 引入缓存的简单路径点定义
+#include "carla/trafficmanager/LandmarkIndex.h"  // 引入预计算的地标索引定义
+#include "carla/trafficmanager/WaypointGraph.h"  // 引入索引寻址的路径点图定义
 
 namespace carla {
 namespace traffic_manager {
@@ -50,7 +52,7 @@ using WorldMap = carla::SharedPtr<const cc::Map>;  // 定义世界地图类型
 
 using Point3D = bg::model::point<float, 3, bg::cs::cartesian>;  // 定义三维点类型
 using Box = bg::model::box<Point3D>;  // 定义三维盒子类型
-using SpatialTreeEntry = std::pair<Point3D, SimpleWaypointPtr>;  // 定义空间树条目类型
+using SpatialTreeEntry = std::pair<Point3D, WaypointIndex>;  // 定义空间树条目类型，值为路径点在稠密拓扑中的索引
 
 using SegmentId = std::tuple<crd::RoadId, crd::LaneId, crd::SectionId>;  // 定义段ID类型
 using SegmentTopology = std::map<SegmentId, std::pair<std::vector<SegmentId>, std::vector<SegmentId>>>;  // 定义段拓扑图类型
@@ -69,6 +71,10 @@ private:
     NodeList dense_topology;
     /// 用于索引和查询路径点的空间二维R树。
     Rtree rtree;
+    /// 与稠密拓扑按索引对应的紧凑路径点图，供交通管理器各阶段遍历路径使用。
+    WaypointGraph waypoint_graph;
+    /// 每个路径点之后最近的各类地标，与路径点图按索引对应。
+    LandmarkIndex landmark_index;
 
 public:
 
@@ -77,9 +83,17 @@ public:
 
     static void Cook(WorldMap world_map, const std::string& path);  // 静态方法，用于处理地图并保存到指定路径
 
-    //bool Load(const std::string& filename);  // 加载地图的方法（未实现）
+    /// 将缓存文件映射到内存并加载地图，文件不存在或格式不符时返回false。
+    bool Load(const std::string& filename);
     bool Load(const std::vector<uint8_t>& content);  // 从字节内容加载地图的方法
 
+    /// 从客户端的文件缓存（FileTransfer 的基础目录/版本号/@a file）映射并加载地图，
+    /// 缓存中没有该文件或加载失败时返回false。
+    bool LoadFromFileCache(const std::string& file);
+
+    /// 将本地地图序列化为当前版本的缓存格式。
+    std::vector<uint8_t> Serialize() const;
+
     /// 此方法以采样分辨率构建本地地图。
     void SetUp();
 
@@ -92,6 +106,15 @@ public:
     /// 此方法返回本地缓存中离散样本的完整列表。
     NodeList GetDenseTopology() const;
 
+    /// 此方法返回与稠密拓扑按索引对应的紧凑路径点图。
+    const WaypointGraph &GetWaypointGraph() const;
+
+    /// 此方法返回稠密拓扑中给定索引处的路径点。
+    const SimpleWaypointPtr &GetWaypointByIndex(const WaypointIndex index) const;
+
+    /// 此方法返回每个路径点之后最近的交通灯、停车、让行与限速标志的索引。
+    const LandmarkIndex &GetLandmarkIndex() const;
+
     std::string GetMapName();  // 获取地图名称
 
     const cc::Map& GetMap() const;  // 获取地图引用
@@ -99,9 +122,16 @@ public:
 private:
     void Save(const std::string& path);  // 保存地图到指定路径
 
+    /// 从当前版本的缓存内容加载地图，内容可以来自文件映射。
+    bool LoadCache(const uint8_t *data, size_t size);
+    /// 从不带文件头的旧版缓存内容加载地图。
+    bool LoadLegacy(const std::vector<uint8_t>& content);
+
     void SetUpDenseTopology();  // 设置稠密拓扑
     void SetUpSpatialTree();  // 设置空间树
     void SetUpRoadOption();  // 设置道路选项
+    void SetUpWaypointGraph();  // 设置紧凑路径点图
+    void SetUpLandmarkIndex();  // 查询地图中的地标并设置地标索引
 
     /// 此方法用于查找和链接车道变更连接。
     void FindAndLinkLaneChange(SimpleWaypointPtr reference_waypoint);
@@ -0,0 +1,134 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace carla {
+namespace traffic_manager {
+namespace cache {
+
+  /// InMemoryMap缓存文件的二进制格式。
+  ///
+  /// 文件由一个固定大小的文件头和若干按8字节对齐的连续数组组成，
+  /// 所有数据都已按稠密拓扑的索引解析完毕，可以直接映射到内存中读取：
+  ///
+  ///   Header
+  ///   WaypointRecord[waypoint_count]         路径点的位置、朝向、OpenDrive坐标与标志位
+  ///   uint32_t[waypoint_count + 1]           后继路径点的CSR偏移
+  ///   uint32_t[next_link_count]              后继路径点的索引
+  ///   uint32_t[waypoint_count + 1]           前驱路径点的CSR偏移
+  ///   uint32_t[previous_link_count]          前驱路径点的索引
+  ///   SpatialTreeRecord[spatial_tree_count]  R树的条目，按打包顺序排列
+  ///   LandmarkRecord[landmark_count]         路径点沿车道直接观察到的地标
+  ///
+  /// 与旧格式一样，数值按本机字节序写入。格式改变时必须增加 VERSION，
+  /// 读取时版本不符的缓存会被拒绝并回退为重新构建本地地图。
+
+  /// 文件开头的魔数，用于和不带文件头的旧格式区分。
+  constexpr char MAGIC[8] = {'C', 'A', 'T', 'M', 'C', 'A', 'C', 'H'};
+
+  /// 当前的缓存格式版本。
+  constexpr uint32_t VERSION = 3u;
+
+  /// 表示不存在的路径点索引。
+  constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t file_size;
+    uint32_t waypoint_count;
+    uint32_t next_link_count;
+    uint32_t previous_link_count;
+    uint32_t spatial_tree_count;
+    uint64_t waypoints_offset;
+    uint64_t next_offsets_offset;
+    uint64_t next_indices_offset;
+    uint64_t previous_offsets_offset;
+    uint64_t previous_indices_offset;
+    uint64_t spatial_tree_offset;
+    uint32_t landmark_count;
+    uint32_t reserved;
+    uint64_t landmarks_offset;
+  };
+
+  enum WaypointFlags : uint8_t {
+    /// 交通管理器认为该路径点属于交叉口。
+    FLAG_JUNCTION = 1u << 0,
+    /// OpenDrive中该路径点位于交叉口内。
+    FLAG_WAYPOINT_JUNCTION = 1u << 1
+  };
+
+  struct WaypointRecord {
+    uint64_t waypoint_id;
+    float location[3];
+    /// 俯仰角、偏航角与翻滚角。
+    float rotation[3];
+    float s;
+    uint32_t road_id;
+    int32_t lane_id;
+    int32_t junction_id;
+    int32_t geodesic_grid_id;
+    uint32_t left_index;
+    uint32_t right_index;
+    uint8_t flags;
+    uint8_t road_option;
+    uint8_t padding[2];
+  };
+
+  struct SpatialTreeRecord {
+    float location[3];
+    uint32_t index;
+  };
+
+  struct LandmarkRecord {
+    float location[3];
+    /// 观察到地标的路径点的索引。
+    uint32_t waypoint_index;
+    /// 沿车道从该路径点到地标的距离。
+    float distance;
+    float value;
+    /// 见 LandmarkType。
+    uint8_t type;
+    uint8_t padding[7];
+  };
+
+  static_assert(std::is_trivially_copyable<Header>::value, "Header must be trivially copyable");
+  static_assert(std::is_trivially_copyable<WaypointRecord>::value, "WaypointRecord must be trivially copyable");
+  static_assert(std::is_trivially_copyable<SpatialTreeRecord>::value, "SpatialTreeRecord must be trivially copyable");
+  static_assert(sizeof(WaypointRecord) == 64u, "Unexpected WaypointRecord layout");
+  static_assert(std::is_trivially_copyable<LandmarkRecord>::value, "LandmarkRecord must be trivially copyable");
+  static_assert(sizeof(SpatialTreeRecord) == 16u, "Unexpected SpatialTreeRecord layout");
+  static_assert(sizeof(LandmarkRecord) == 32u, "Unexpected LandmarkRecord layout");
+
+  /// 将偏移向上对齐到8字节。
+  inline uint64_t Align(uint64_t offset) {
+    return (offset + 7u) & ~uint64_t(7u);
+  }
+
+  /// 判断内容是否以缓存魔数开头。
+  inline bool HasMagic(const uint8_t *data, size_t size) {
+    return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+  }
+
+  /// 检查[offset, offset + count * sizeof(T))是否完全位于大小为size的内容中。
+  template <typename T>
+  bool IsInBounds(uint64_t offset, uint64_t count, size_t size) {
+    if (offset > size || offset % alignof(T) != 0u) {
+      return false;
+    }
+    return count <= (static_cast<uint64_t>(size) - offset) / sizeof(T);
+  }
+
+} // namespace cache
+} // namespace traffic_manager
+} // namespace carla
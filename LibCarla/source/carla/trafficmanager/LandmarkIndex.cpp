@@ -0,0 +1,182 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/LandmarkIndex.h"
+
+#include "carla/trafficmanager/Constants.h"
+#include "carla/trafficmanager/Parameters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+
+namespace carla {
+namespace traffic_manager {
+
+  using constants::Map::INFINITE_DISTANCE;
+  using namespace constants::MotionPlan;
+
+  namespace {
+
+    /// 表示没有对应的地标。
+    constexpr uint32_t NO_LANDMARK = 0xFFFFFFFFu;
+
+    size_t Slot(WaypointIndex index, LandmarkType type) {
+      return static_cast<size_t>(index) * NUMBER_OF_LANDMARK_TYPES + static_cast<size_t>(type);
+    }
+
+  } // namespace
+
+  bool ToLandmarkType(const std::string &opendrive_type, LandmarkType &type) {
+    if (opendrive_type == "1000001") {
+      type = LandmarkType::TrafficLight;
+    } else if (opendrive_type == "206") {
+      type = LandmarkType::Stop;
+    } else if (opendrive_type == "205") {
+      type = LandmarkType::Yield;
+    } else if (opendrive_type == "274") {
+      type = LandmarkType::SpeedLimit;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  void LandmarkIndex::Build(const WaypointGraph &graph,
+                            std::vector<LandmarkObservation> observations,
+                            const float horizon) {
+    Clear();
+    const size_t size = graph.Size();
+    _observations = std::move(observations);
+    _distances.assign(size * NUMBER_OF_LANDMARK_TYPES, INFINITE_DISTANCE);
+    _landmarks.assign(size * NUMBER_OF_LANDMARK_TYPES, NO_LANDMARK);
+
+    // 由后继关系构建反向的CSR，保证传播的方向与各阶段沿路径扩展的方向一致
+    std::vector<uint32_t> offsets(size + 1u, 0u);
+    for (WaypointIndex i = 0u; i < size; ++i) {
+      for (const WaypointIndex next : graph.GetNext(i)) {
+        ++offsets[next + 1u];
+      }
+    }
+    for (size_t i = 0u; i < size; ++i) {
+      offsets[i + 1u] += offsets[i];
+    }
+    std::vector<WaypointIndex> predecessors(offsets[size]);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (WaypointIndex i = 0u; i < size; ++i) {
+      for (const WaypointIndex next : graph.GetNext(i)) {
+        predecessors[fill[next]++] = i;
+      }
+    }
+
+    // 每类地标做一次多源Dijkstra，源点为直接观察到地标的路径点
+    using QueueEntry = std::pair<float, WaypointIndex>;
+    for (size_t t = 0u; t < NUMBER_OF_LANDMARK_TYPES; ++t) {
+      const auto type = static_cast<LandmarkType>(t);
+      std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+      for (uint32_t o = 0u; o < _observations.size(); ++o) {
+        const LandmarkObservation &observation = _observations[o];
+        if (observation.type != type || observation.waypoint >= size || observation.distance > horizon) {
+          continue;
+        }
+        const size_t slot = Slot(observation.waypoint, type);
+        if (observation.distance < _distances[slot]) {
+          _distances[slot] = observation.distance;
+          _landmarks[slot] = o;
+          queue.emplace(observation.distance, observation.waypoint);
+        }
+      }
+
+      while (!queue.empty()) {
+        const QueueEntry entry = queue.top();
+        queue.pop();
+        const WaypointIndex current = entry.second;
+        const size_t current_slot = Slot(current, type);
+        if (entry.first > _distances[current_slot]) {
+          continue;
+        }
+        for (uint32_t p = offsets[current]; p < offsets[current + 1u]; ++p) {
+          const WaypointIndex previous = predecessors[p];
+          const float distance = entry.first + std::sqrt(graph.DistanceSquared(previous, current));
+          const size_t slot = Slot(previous, type);
+          if (distance <= horizon && distance < _distances[slot]) {
+            _distances[slot] = distance;
+            _landmarks[slot] = _landmarks[current_slot];
+            queue.emplace(distance, previous);
+          }
+        }
+      }
+    }
+  }
+
+  void LandmarkIndex::Clear() {
+    _observations.clear();
+    _distances.clear();
+    _landmarks.clear();
+  }
+
+  UpcomingLandmark LandmarkIndex::GetUpcoming(const WaypointIndex index, const LandmarkType type) const {
+    const size_t slot = Slot(index, type);
+    if (index == INVALID_WAYPOINT_INDEX || slot >= _landmarks.size() || _landmarks[slot] == NO_LANDMARK) {
+      return {INFINITE_DISTANCE, nullptr};
+    }
+    return {_distances[slot], &_observations[_landmarks[slot]]};
+  }
+
+  float LandmarkIndex::GetTargetVelocity(const WaypointIndex index,
+                                         const cg::Location &vehicle_location,
+                                         const VehicleParameters &vehicle_parameters,
+                                         const float max_target_velocity) const {
+    // 视野之外的地标没有被索引，检测距离不能超过视野长度
+    const float max_distance = std::min(LANDMARK_DETECTION_TIME * max_target_velocity, LANDMARK_INDEX_HORIZON);
+    float landmark_target_velocity = std::numeric_limits<float>::max();
+    for (size_t t = 0u; t < NUMBER_OF_LANDMARK_TYPES; ++t) {
+      const auto type = static_cast<LandmarkType>(t);
+      const UpcomingLandmark upcoming = GetUpcoming(index, type);
+      if (upcoming.landmark == nullptr || upcoming.distance > max_distance) {
+        continue;
+      }
+      const float distance = upcoming.landmark->location.Distance(vehicle_location);
+      if (distance > max_distance) {
+        continue;
+      }
+
+      float minimum_velocity = max_target_velocity;
+      switch (type) {
+        case LandmarkType::TrafficLight:
+          minimum_velocity = TL_TARGET_VELOCITY;
+          break;
+        case LandmarkType::Stop:
+          minimum_velocity = STOP_TARGET_VELOCITY;
+          break;
+        case LandmarkType::Yield:
+          minimum_velocity = YIELD_TARGET_VELOCITY;
+          break;
+        case LandmarkType::SpeedLimit: {
+          const float value = vehicle_parameters.GetVehicleTargetVelocity(upcoming.landmark->value / 3.6f);
+          minimum_velocity = std::min(value, max_target_velocity);
+          break;
+        }
+      }
+
+      // 在检测距离内从最大目标速度线性降低到地标要求的速度
+      const float v = std::max(((max_target_velocity - minimum_velocity) / max_distance) * distance + minimum_velocity, minimum_velocity);
+      landmark_target_velocity = std::min(landmark_target_velocity, v);
+    }
+    return landmark_target_velocity;
+  }
+
+  size_t LandmarkIndex::GetMemoryUsage() const {
+    return _observations.capacity() * sizeof(LandmarkObservation) +
+           _distances.capacity() * sizeof(float) +
+           _landmarks.capacity() * sizeof(uint32_t);
+  }
+
+} // namespace traffic_manager
+} // namespace carla
@@ -0,0 +1,103 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/trafficmanager/WaypointGraph.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  struct VehicleParameters;
+
+  /// 交通管理器关心的地标类型，按整数编码以避免逐帧比较OpenDrive的类型字符串。
+  enum class LandmarkType : uint8_t {
+    TrafficLight = 0u,  // "1000001"
+    Stop = 1u,          // "206"
+    Yield = 2u,         // "205"
+    SpeedLimit = 3u     // "274"
+  };
+
+  /// 地标类型的数量。
+  constexpr size_t NUMBER_OF_LANDMARK_TYPES = 4u;
+
+  /// 将OpenDrive的信号类型转换为地标类型，不是交通管理器关心的类型时返回false。
+  bool ToLandmarkType(const std::string &opendrive_type, LandmarkType &type);
+
+  /// 从某个路径点沿车道向前能直接看到的地标。
+  struct LandmarkObservation {
+    /// 观察到地标的路径点在稠密拓扑中的索引。
+    WaypointIndex waypoint;
+    LandmarkType type;
+    /// 沿车道从该路径点到地标的距离。
+    float distance;
+    /// 地标的数值，对限速标志为km/h。
+    float value;
+    /// 地标在道路上对应的位置。
+    cg::Location location;
+  };
+
+  /// 某个路径点之后最近的一个某类地标。
+  struct UpcomingLandmark {
+    /// 沿路径点图到地标的距离。
+    float distance;
+    /// 地标，在视野范围内没有该类地标时为nullptr。
+    const LandmarkObservation *landmark;
+  };
+
+  /// 为路径点图中的每个路径点预先计算沿路径到每类地标中最近一个的距离。
+  ///
+  /// 观察结果只记录地标与其前方相邻的路径点之间的关系，构建时沿后继关系
+  /// 反向传播（多源最短路径），超过视野长度的地标被忽略。查询只需要一次
+  /// 数组访问。对交通灯、停车与让行标志，越近的地标限制越严，因此只需保留
+  /// 最近的一个；对限速标志同样只保留最近的一个。
+  class LandmarkIndex {
+
+  private:
+
+    std::vector<LandmarkObservation> _observations;
+    /// 按 [路径点 * NUMBER_OF_LANDMARK_TYPES + 类型] 存储的距离与观察结果索引。
+    std::vector<float> _distances;
+    std::vector<uint32_t> _landmarks;
+
+  public:
+
+    /// 根据观察结果为 @a graph 中的所有路径点构建索引。
+    void Build(const WaypointGraph &graph,
+               std::vector<LandmarkObservation> observations,
+               float horizon);
+
+    void Clear();
+
+    const std::vector<LandmarkObservation> &GetObservations() const {
+      return _observations;
+    }
+
+    /// 返回路径点之后最近的 @a type 类地标。
+    UpcomingLandmark GetUpcoming(WaypointIndex index, LandmarkType type) const;
+
+    /// 返回车辆在路径点 @a index 处因前方地标需要降低到的目标速度（m/s），
+    /// 检测距离内没有地标时返回float的最大值。
+    ///
+    /// 检测距离为 LANDMARK_DETECTION_TIME 秒内以 @a max_target_velocity 行驶的
+    /// 距离，但不超过构建索引时的视野长度 LANDMARK_INDEX_HORIZON；更远的地标
+    /// 不在索引中，因此车速很高时从视野长度处开始减速。
+    float GetTargetVelocity(WaypointIndex index,
+                            const cg::Location &vehicle_location,
+                            const VehicleParameters &vehicle_parameters,
+                            float max_target_velocity) const;
+
+    /// 返回索引占用的堆内存字节数。
+    size_t GetMemoryUsage() const;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
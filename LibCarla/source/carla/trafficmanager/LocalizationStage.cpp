@@ -35,11 +35,45 @@ LocalizationStage::LocalizationStage(
     output_array(output_array),            // 初始化输出数组
     random_device(random_device){}        // 初始化随机数生成器
 
+void LocalizationStage::PrepareCycle() {
+  buffer_front_snapshot.clear();
+  for (const ActorId actor_id : vehicle_id_list) {
+    // 预先插入缓冲区，并行更新期间 buffer_map 的结构不再改变
+    auto buffer = buffer_map.find(actor_id);
+    if (buffer == buffer_map.end()) {
+      buffer = buffer_map.insert({actor_id, Buffer()}).first;
+    }
+    if (!buffer->second.empty()) {
+      buffer_front_snapshot.insert({actor_id, buffer->second.front()});
+    }
+  }
+  pending_removal.clear();
+  track_traffic.BeginDeferredUpdates(vehicle_id_list);
+}
+
+void LocalizationStage::CommitCycle() {
+  track_traffic.CommitDeferredUpdates();
+  if (!pending_removal.empty()) {
+    for (const ActorId actor_id : vehicle_id_list) {
+      if (pending_removal.find(actor_id) != pending_removal.end()) {
+        marked_for_removal.push_back(actor_id);
+      }
+    }
+    pending_removal.clear();
+  }
+}
+
+void LocalizationStage::MarkForRemoval(const ActorId actor_id) {
+  std::lock_guard<std::mutex> lock(pending_removal_mutex);
+  pending_removal.insert(actor_id);
+}
+
 // 更新本地化信息
 void LocalizationStage::Update(const unsigned long index) {
 
     // 获取当前车辆的ID和相关信息
   const ActorId actor_id = vehicle_id_list.at(index);
+  const VehicleParameters &vehicle_parameters = parameters.GetSnapshot().GetVehicle(index);
   const cg::Location vehicle_location = simulation_state.GetLocation(actor_id);
   const cg::Vector3D heading_vector = simulation_state.GetHeading(actor_id);
   const cg::Vector3D vehicle_velocity_vector = simulation_state.GetVelocity(actor_id);
@@ -86,13 +120,14 @@ void LocalizationStage::Update(const unsigned long index) {
     if (!waypoint_buffer.empty()) {
       // 确定车辆是否在交叉路口入口处
       SimpleWaypointPtr look_ahead_point = GetTargetWaypoint(waypoint_buffer, JUNCTION_LOOK_AHEAD).first;
-      SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
-      bool front_waypoint_junction = front_waypoint->CheckJunction();
+      const WaypointGraph &waypoint_graph = local_map->GetWaypointGraph();
+      const WaypointIndex front_index = waypoint_buffer.front()->GetIndex();
+      bool front_waypoint_junction = waypoint_graph.CheckJunction(front_index);
       is_at_junction_entrance = !front_waypoint_junction && look_ahead_point->CheckJunction();
       if (!is_at_junction_entrance) {
-        std::vector<SimpleWaypointPtr> last_passed_waypoints = front_waypoint->GetPreviousWaypoint();
+        const WaypointIndexRange last_passed_waypoints = waypoint_graph.GetPrevious(front_index);
         if (last_passed_waypoints.size() == 1) {
-          is_at_junction_entrance = !last_passed_waypoints.front()->CheckJunction() && front_waypoint_junction;
+          is_at_junction_entrance = !waypoint_graph.CheckJunction(last_passed_waypoints.front()) && front_waypoint_junction;
         }
       }
       if (is_at_junction_entrance
@@ -119,18 +154,22 @@ void LocalizationStage::Update(const unsigned long index) {
   }
 
   // 分配变道
-  const ChangeLaneInfo lane_change_info = parameters.GetForceLaneChange(actor_id);
+  // 只有快照中有待处理的强制变道时才需要读取并消费该命令
+  ChangeLaneInfo lane_change_info;
+  if (vehicle_parameters.force_lane_change) {
+    lane_change_info = parameters.GetForceLaneChange(actor_id);
+  }
   bool force_lane_change = lane_change_info.change_lane;
   bool lane_change_direction = lane_change_info.direction;
 
   //应用保持右侧规则和随机变道参数
   if (!force_lane_change && vehicle_speed > MIN_LANE_CHANGE_SPEED){
-    const float perc_keep_right = parameters.GetKeepRightPercentage(actor_id);
-    const float perc_random_leftlanechange = parameters.GetRandomLeftLaneChangePercentage(actor_id);
-    const float perc_random_rightlanechange = parameters.GetRandomRightLaneChangePercentage(actor_id);
-    const bool is_keep_right = perc_keep_right > random_device.next();
-    const bool is_random_left_change = perc_random_leftlanechange >= random_device.next();
-    const bool is_random_right_change = perc_random_rightlanechange >= random_device.next();
+    const float perc_keep_right = vehicle_parameters.perc_keep_right;
+    const float perc_random_leftlanechange = vehicle_parameters.perc_random_left;
+    const float perc_random_rightlanechange = vehicle_parameters.perc_random_right;
+    const bool is_keep_right = perc_keep_right > random_device.next(actor_id);
+    const bool is_random_left_change = perc_random_leftlanechange >= random_device.next(actor_id);
+    const bool is_random_right_change = perc_random_rightlanechange >= random_device.next(actor_id);
 
     //确定应应用的参数
     if (is_keep_right || is_random_right_change) {
@@ -143,7 +182,7 @@ void LocalizationStage::Update(const unsigned long index) {
         lane_change_direction = false;
       } else {
         // 左右车道变更都是强制性的。请在其中选择一个
-        lane_change_direction = FIFTYPERC > random_device.next();
+        lane_change_direction = FIFTYPERC > random_device.next(actor_id);
       }
     }
   }
@@ -151,14 +190,19 @@ void LocalizationStage::Update(const unsigned long index) {
   const SimpleWaypointPtr front_waypoint = waypoint_buffer.front();
   const float lane_change_distance = SQUARE(std::max(10.0f * vehicle_speed, INTER_LANE_CHANGE_DISTANCE));
 
-  bool recently_not_executed_lane_change = last_lane_change_swpt.find(actor_id) == last_lane_change_swpt.end();
+  bool recently_not_executed_lane_change = true;
   bool done_with_previous_lane_change = true;
-  if (!recently_not_executed_lane_change) {
-    float distance_frm_previous = cg::Math::DistanceSquared(last_lane_change_swpt.at(actor_id)->GetLocation(), vehicle_location);
-    done_with_previous_lane_change = distance_frm_previous > lane_change_distance;
-    if (done_with_previous_lane_change) last_lane_change_swpt.erase(actor_id);
+  {
+    std::lock_guard<std::mutex> lock(vehicle_state_mutex);
+    auto last_lane_change = last_lane_change_swpt.find(actor_id);
+    recently_not_executed_lane_change = last_lane_change == last_lane_change_swpt.end();
+    if (!recently_not_executed_lane_change) {
+      float distance_frm_previous = cg::Math::DistanceSquared(last_lane_change->second->GetLocation(), vehicle_location);
+      done_with_previous_lane_change = distance_frm_previous > lane_change_distance;
+      if (done_with_previous_lane_change) last_lane_change_swpt.erase(last_lane_change);
+    }
   }
-  bool auto_or_force_lane_change = parameters.GetAutoLaneChange(actor_id) || force_lane_change;
+  bool auto_or_force_lane_change = vehicle_parameters.auto_lane_change || force_lane_change;
   bool front_waypoint_not_junction = !front_waypoint->CheckJunction();
 
   if (auto_or_force_lane_change
@@ -169,10 +213,9 @@ void LocalizationStage::Update(const unsigned long index) {
                                                            force_lane_change, lane_change_direction);
 
     if (change_over_point != nullptr) {
-      if (last_lane_change_swpt.find(actor_id) != last_lane_change_swpt.end()) {
-        last_lane_change_swpt.at(actor_id) = change_over_point;
-      } else {
-        last_lane_change_swpt.insert({actor_id, change_over_point});
+      {
+        std::lock_guard<std::mutex> lock(vehicle_state_mutex);
+        last_lane_change_swpt[actor_id] = change_over_point;
       }
       auto number_of_pops = waypoint_buffer.size();
       for (uint64_t j = 0u; j < number_of_pops; ++j) {
@@ -182,8 +225,15 @@ void LocalizationStage::Update(const unsigned long index) {
     }
   }
 
-  Path imported_path = parameters.GetCustomPath(actor_id);
-  Route imported_actions = parameters.GetImportedRoute(actor_id);
+  // 路径和路线只有在快照中存在时才复制
+  Path imported_path;
+  if (vehicle_parameters.custom_path) {
+    imported_path = parameters.GetCustomPath(actor_id);
+  }
+  Route imported_actions;
+  if (imported_path.empty() && vehicle_parameters.imported_route) {
+    imported_actions = parameters.GetImportedRoute(actor_id);
+  }
   // 我们实际上是在导入一个路径
   if (!imported_path.empty()) {
 
@@ -197,24 +247,27 @@ void LocalizationStage::Update(const unsigned long index) {
 
   // 通过随机选择航点填充缓冲区
   else {
-    while (waypoint_buffer.back()->DistanceSquared(waypoint_buffer.front()) <= horizon_square) {
-      SimpleWaypointPtr furthest_waypoint = waypoint_buffer.back();
-      std::vector<SimpleWaypointPtr> next_waypoints = furthest_waypoint->GetNextWaypoint();
+    // 沿紧凑路径点图按索引扩展，只有压入缓冲区的路径点才需要复制共享指针
+    const WaypointGraph &waypoint_graph = local_map->GetWaypointGraph();
+    const WaypointIndex front_index = waypoint_buffer.front()->GetIndex();
+    WaypointIndex furthest_index = waypoint_buffer.back()->GetIndex();
+    while (waypoint_graph.DistanceSquared(furthest_index, front_index) <= horizon_square) {
+      const WaypointIndexRange next_waypoints = waypoint_graph.GetNext(furthest_index);
       uint64_t selection_index = 0u;
       // 伪随机路径选择，如果发现多个选择
       if (next_waypoints.size() > 1) {
-        double r_sample = random_device.next();
+        double r_sample = random_device.next(actor_id);
         selection_index = static_cast<uint64_t>(r_sample*next_waypoints.size()*0.01);
       } else if (next_waypoints.size() == 0) {
         if (!parameters.GetOSMMode()) {
           std::cout << "This map has dead-end roads, please change the set_open_street_map parameter to true" << std::endl;
         }
-        marked_for_removal.push_back(actor_id);
+        MarkForRemoval(actor_id);
         break;
       }
-      SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
-      PushWaypoint(actor_id, track_traffic, waypoint_buffer, next_wp_selection);
-      if (next_wp_selection->GetId() == waypoint_buffer.front()->GetId()){
+      furthest_index = next_waypoints[selection_index];
+      PushWaypoint(actor_id, track_traffic, waypoint_buffer, local_map->GetWaypointByIndex(furthest_index));
+      if (waypoint_graph.GetId(furthest_index) == waypoint_graph.GetId(front_index)){
         // 发现了一个环，停止。不要使用零距离，因为可能有两个航点在同一位置
         break;
       }
@@ -227,6 +280,7 @@ void LocalizationStage::Update(const unsigned long index) {
   output.is_at_junction_entrance = is_at_junction_entrance;
 
   if (is_at_junction_entrance) {
+    std::lock_guard<std::mutex> lock(vehicle_state_mutex);
     const SimpleWaypointPair &safe_space_end_points = vehicles_at_junction_entrance.at(actor_id);
     output.junction_end_point = safe_space_end_points.first;
     output.safe_point = safe_space_end_points.second;
@@ -246,8 +300,13 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
   SimpleWaypointPtr junction_end_point = nullptr;
   SimpleWaypointPtr safe_point_after_junction = nullptr;
 
-  if (is_at_junction_entrance
-      && vehicles_at_junction_entrance.find(actor_id) == vehicles_at_junction_entrance.end()) {
+  bool tracked_at_junction_entrance = false;
+  {
+    std::lock_guard<std::mutex> lock(vehicle_state_mutex);
+    tracked_at_junction_entrance = vehicles_at_junction_entrance.find(actor_id) != vehicles_at_junction_entrance.end();
+  }
+
+  if (is_at_junction_entrance && !tracked_at_junction_entrance) {
 
     bool entered_junction = false;
     bool past_junction = false;
@@ -318,21 +377,24 @@ void LocalizationStage::ExtendAndFindSafeSpace(const ActorId actor_id,
       safe_point_after_junction = nullptr;
     }
 
+    std::lock_guard<std::mutex> lock(vehicle_state_mutex);
     vehicles_at_junction_entrance.insert({actor_id, {junction_end_point, safe_point_after_junction}});
   }
-  else if (!is_at_junction_entrance
-           && vehicles_at_junction_entrance.find(actor_id) != vehicles_at_junction_entrance.end()) {
+  else if (!is_at_junction_entrance && tracked_at_junction_entrance) {
 
+    std::lock_guard<std::mutex> lock(vehicle_state_mutex);
     vehicles_at_junction_entrance.erase(actor_id);
   }
 }
 
 void LocalizationStage::RemoveActor(ActorId actor_id) {
+    std::lock_guard<std::mutex> lock(vehicle_state_mutex);
     last_lane_change_swpt.erase(actor_id);
     vehicles_at_junction.erase(actor_id);
 }
 
 void LocalizationStage::Reset() {
+  std::lock_guard<std::mutex> lock(vehicle_state_mutex);
   last_lane_change_swpt.clear();
   vehicles_at_junction.clear();
 }
@@ -367,10 +429,10 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
          i != blocking_vehicles.end() && !obstacle_too_close && !force;
          ++i) {
       const ActorId &other_actor_id = *i;
-      // 在缓冲区地图中查找车辆，并检查其缓冲区是否不为空
-      if (buffer_map.find(other_actor_id) != buffer_map.end() && !buffer_map.at(other_actor_id).empty()) {
-        const Buffer &other_buffer = buffer_map.at(other_actor_id);
-        const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
+      // 在本周期开始时的缓冲区快照中查找车辆，其他车辆的缓冲区可能正在被并行修改
+      auto other_front = buffer_front_snapshot.find(other_actor_id);
+      if (other_front != buffer_front_snapshot.end()) {
+        const SimpleWaypointPtr &other_current_waypoint = other_front->second;
         const cg::Location other_location = other_current_waypoint->GetLocation();
 
         const cg::Vector3D reference_heading = current_waypoint->GetForwardVector();
@@ -405,8 +467,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
 
     // 如果发现有效的即时障碍
     if (!obstacle_too_close && obstacle_actor_id != 0u && !force) {
-      const Buffer &other_buffer = buffer_map.at(obstacle_actor_id);
-      const SimpleWaypointPtr &other_current_waypoint = other_buffer.front();
+      const SimpleWaypointPtr &other_current_waypoint = buffer_front_snapshot.at(obstacle_actor_id);
       const auto other_neighbouring_lanes = {other_current_waypoint->GetLeftWaypoint(),
                                              other_current_waypoint->GetRightWaypoint()};
 
@@ -418,7 +479,7 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
       bool left_right = true;
       for (auto &candidate_lane_wp : other_neighbouring_lanes) {
         if (candidate_lane_wp != nullptr &&
-            track_traffic.GetPassingVehicles(candidate_lane_wp->GetId()).size() == 0) {
+            !track_traffic.HasPassingVehicles(candidate_lane_wp->GetId())) {
 
           if (left_right)
             distant_left_lane_free = true;
@@ -431,10 +492,10 @@ SimpleWaypointPtr LocalizationStage::AssignLaneChange(const ActorId actor_id,
       //基于障碍物附近哪些车道是空闲的，
       // 找到没有车辆通过的变更点
       if (distant_right_lane_free && right_waypoint != nullptr
-          && track_traffic.GetPassingVehicles(right_waypoint->GetId()).size() == 0) {
+          && !track_traffic.HasPassingVehicles(right_waypoint->GetId())) {
         change_over_point = right_waypoint;
       } else if (distant_left_lane_free && left_waypoint != nullptr
-               && track_traffic.GetPassingVehicles(left_waypoint->GetId()).size() == 0) {
+               && !track_traffic.HasPassingVehicles(left_waypoint->GetId())) {
         change_over_point = left_waypoint;
       }
     } else if (force) {
@@ -512,7 +573,7 @@ void LocalizationStage::ImportPath(Path &imported_path, Buffer &waypoint_buffer,
         if (!parameters.GetOSMMode()) {
           std::cout << "This map has dead-end roads, please change the set_open_street_map parameter to true" << std::endl;
         }
-        marked_for_removal.push_back(actor_id);
+        MarkForRemoval(actor_id);
         break;
       }
       SimpleWaypointPtr next_wp_selection = next_waypoints.at(selection_index);
@@ -575,7 +636,7 @@ void LocalizationStage::ImportRoute(Route &imported_actions, Buffer &waypoint_bu
         if (!parameters.GetOSMMode()) {
           std::cout << "This map has dead-end roads, please change the set_open_street_map parameter to true" << std::endl;
         }
-        marked_for_removal.push_back(actor_id);
+        MarkForRemoval(actor_id);
         break;
       }
 
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <memory>  // 引入智能指针头文件
+#include <mutex>  // 引入互斥锁头文件
 
 #include "carla/trafficmanager/DataStructures.h"  // 引入数据结构定义
 #include "carla/trafficmanager/InMemoryMap.h"  // 引入内存地图相关定义
@@ -43,6 +44,16 @@ private:
   using SimpleWaypointPair = std::pair<SimpleWaypointPtr, SimpleWaypointPtr>;  // 定义简易路径点对
   std::unordered_map<ActorId, SimpleWaypointPair> vehicles_at_junction_entrance;  // 存储在交叉口入口的车辆及路径点对
   RandomGenerator &random_device;  // 引用随机数生成器
+  // 并行更新期间保护 last_lane_change_swpt 与 vehicles_at_junction_entrance 的互斥锁
+  std::mutex vehicle_state_mutex;
+  // 本周期内需要移除的车辆，CommitCycle 中按车辆列表顺序写入 marked_for_removal
+  ActorIdSet pending_removal;
+  std::mutex pending_removal_mutex;
+  // 本周期开始时各车辆缓冲区的第一个路点，并行更新期间代替其他车辆正在修改的缓冲区
+  std::unordered_map<ActorId, SimpleWaypointPtr> buffer_front_snapshot;
+
+  // 标记车辆需要移除
+  void MarkForRemoval(const ActorId actor_id);
 
   // 分配车道变更路径点
   SimpleWaypointPtr AssignLaneChange(const ActorId actor_id,
@@ -79,9 +90,15 @@ public:
                     LocalizationFrame &output_array,
                     RandomGenerator &random_device);
 
-  // 更新方法
+  // 更新方法，不同 index 可以并行调用
   void Update(const unsigned long index) override;
 
+  // 预先创建缓冲区、保存缓冲区前端快照并开始推迟交通跟踪的修改
+  void PrepareCycle() override;
+
+  // 按车辆列表顺序提交交通跟踪的修改与待移除车辆
+  void CommitCycle() override;
+
   // 移除演员方法
   void RemoveActor(const ActorId actor_id) override;
 
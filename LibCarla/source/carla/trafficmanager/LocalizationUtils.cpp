@@ -38,10 +38,10 @@ float DeviationDotProduct(const cg::Location &reference_location, // 参考位
 
 // 将一个航点添加到缓冲区并更新经过的车辆信息
 void PushWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和交通轨迹引用
-                  Buffer &buffer, SimpleWaypointPtr &waypoint) { // 缓冲区和航点指针
+                  Buffer &buffer, const SimpleWaypointPtr &waypoint) { // 缓冲区和航点指针
   const uint64_t waypoint_id = waypoint->GetId(); // 获取航点ID
   buffer.push_back(waypoint); // 将航点添加到缓冲区
-  track_traffic.UpdatePassingVehicle(waypoint_id, actor_id); // 更新经过该航点的车辆信息
+  track_traffic.AddBufferWaypoint(actor_id, waypoint_id, waypoint->GetGeodesicGridId()); // 更新经过该航点的车辆及占据的网格
 }
 
 // 从缓冲区中移除一个航点并更新经过的车辆信息
@@ -54,7 +54,7 @@ void PopWaypoint(ActorId actor_id, TrackTraffic &track_traffic, // 车辆ID和
   } else { // 如果是后方
     buffer.pop_back(); // 移除后方航点
   }
-  track_traffic.RemovePassingVehicle(removed_waypoint_id, actor_id); // 更新经过的车辆信息
+  track_traffic.RemoveBufferWaypoint(actor_id, removed_waypoint_id, removed_waypoint->GetGeodesicGridId()); // 更新经过的车辆及占据的网格
 }
 
 // 获取目标航点及其索引
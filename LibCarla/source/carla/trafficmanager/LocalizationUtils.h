@@ -43,7 +43,7 @@ namespace traffic_manager {
 
   // 将一个路点添加到路径缓冲区并更新路点跟踪
   void PushWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
-                    Buffer& buffer, SimpleWaypointPtr& waypoint);
+                    Buffer& buffer, const SimpleWaypointPtr& waypoint);
 
   // 从路径缓冲区中移除一个路点并更新路点跟踪
   void PopWaypoint(ActorId actor_id, TrackTraffic& track_traffic,
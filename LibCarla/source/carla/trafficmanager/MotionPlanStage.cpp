@@ -59,6 +59,46 @@ MotionPlanStage::MotionPlanStage(
     output_array(output_array),
     random_device(random_device),
     local_map(local_map) {}
+
+void MotionPlanStage::PrepareCycle() {
+  // 获取当前世界的时间戳，本周期内所有车辆使用同一个时间戳
+  current_timestamp = world.GetSnapshot().GetTimestamp();
+  respawn_requests.resize(vehicle_id_list.size());
+  for (RespawnRequest &request : respawn_requests) {
+    request.pending = false;
+    request.candidates.clear();
+  }
+}
+
+void MotionPlanStage::CommitCycle() {
+  for (unsigned long index = 0u; index < respawn_requests.size(); ++index) {
+    RespawnRequest &request = respawn_requests.at(index);
+    if (!request.pending) {
+      continue;
+    }
+    const ActorId actor_id = vehicle_id_list.at(index);
+    cg::Transform teleportation_transform = request.transform;
+    for (auto &teleport_waypoint : request.candidates) {
+      GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
+      if (track_traffic.IsGeoGridFree(geogrid_id)) {
+        teleportation_transform = teleport_waypoint->GetTransform();
+        teleportation_transform.location.z += 0.5f;
+        track_traffic.AddTakenGrid(geogrid_id, actor_id);
+        break;
+      }
+    }
+    output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
+
+    // 在传送车辆后，使用新的变换更新模拟状态
+    KinematicState &kinematic_state = request.state;
+    kinematic_state.location = teleportation_transform.location;
+    kinematic_state.rotation = teleportation_transform.rotation;
+    kinematic_state.hybrid_end_location = teleportation_transform.location;
+    simulation_state.UpdateKinematicState(actor_id, kinematic_state);
+    request.pending = false;
+    request.candidates.clear();
+  }
+}
 // 定义名为 Update 的成员函数，它属于 MotionPlanStage 类，用于更新相关状态信息或者执行一些基于当前状态的计算操作
 // 参数 index：一个无符号长整型参数，可能用于在一些容器（比如存储车辆相关信息的数组或向量等）中定位特定车辆对应的索引位置，从而获取该车辆的相关信息进行后续处理
 void MotionPlanStage::Update(const unsigned long index) {    
@@ -77,7 +117,6 @@ void MotionPlanStage::Update(const unsigned long index) {
   // 根据传入的索引 index，从 localization_frame 中获取对应的车辆定位数据（LocalizationData 类型，包含更详细的车辆定位相关信息，比如定位精度、定位方式等补充数据）
   const CollisionHazardData &collision_hazard = collision_frame.at(index);  // 根据传入的索引 index，从 collision_frame 中获取对应的车辆碰撞危险数据（CollisionHazardData 类型，包含车辆周围是否存在碰撞风险、碰撞危险程度等相关详细信息）
   const bool &tl_hazard = tl_frame.at(index);// 根据传入的索引 index，从 tl_frame 中获取对应的交通信号灯相关危险信息（返回布尔值，用于判断当前车辆是否面临因交通信号灯产生的危险情况，比如即将闯红灯等）
-  current_timestamp = world.GetSnapshot().GetTimestamp();  // 获取当前世界的时间戳信息，通过 world 对象调用 GetSnapshot 函数获取世界的一个快照（可能包含了当前世界的各种状态信息），再从快照中获取时间戳（用于记录当前操作或者决策所处的时间点）
   StateEntry current_state;// 这里声明了一个 StateEntry 类型的变量 current_state，但后续代码缺失，不清楚具体用途，可能用于记录当前车辆或者整个模拟系统的某种状态信息，等待进一步赋值和使用
 
   // 实例化传送变换为当前载具变换
@@ -94,8 +133,14 @@ void MotionPlanStage::Update(const unsigned long index) {
                     0.0f};
 
     // 如果表中不存在，则将条目添加到传送持续时间时钟表中
-    if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-      teleportation_instance.insert({actor_id, current_timestamp});
+    double teleportation_elapsed_seconds = current_timestamp.elapsed_seconds;
+    {
+      std::lock_guard<std::mutex> lock(controller_state_mutex);
+      auto instance = teleportation_instance.find(actor_id);
+      if (instance == teleportation_instance.end()) {
+        instance = teleportation_instance.insert({actor_id, current_timestamp}).first;
+      }
+      teleportation_elapsed_seconds = instance->second.elapsed_seconds;
     }
 
     // 获取传送载具的下限和上限
@@ -104,41 +149,32 @@ void MotionPlanStage::Update(const unsigned long index) {
     float dilate_factor = (upper_bound-lower_bound)/100.0f;
 
     // 测量车辆自上次传送以来所经过的时间
-    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+    double elapsed_time = current_timestamp.elapsed_seconds - teleportation_elapsed_seconds;
 
+    // 候选路点的选择会占用测地线网格，推迟到 CommitCycle 中按顺序进行
+    RespawnRequest &request = respawn_requests.at(index);
     if (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT) {
-      float random_sample = (static_cast<float>(random_device.next())*dilate_factor) + lower_bound;
-      NodeList teleport_waypoint_list = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
-      if (!teleport_waypoint_list.empty()) {
-        for (auto &teleport_waypoint : teleport_waypoint_list) {
-          GeoGridId geogrid_id = teleport_waypoint->GetGeodesicGridId();
-          if (track_traffic.IsGeoGridFree(geogrid_id)) {
-            teleportation_transform = teleport_waypoint->GetTransform();
-            teleportation_transform.location.z += 0.5f;
-            track_traffic.AddTakenGrid(geogrid_id, actor_id);
-            break;
-          }
-        }
-      }
+      float random_sample = (static_cast<float>(random_device.next(actor_id))*dilate_factor) + lower_bound;
+      request.candidates = local_map->GetWaypointsInDelta(hero_location, ATTEMPTS_TO_TELEPORT, random_sample);
     }
-    output_array.at(index) = carla::rpc::Command::ApplyTransform(actor_id, teleportation_transform);
-
-    // 在传送车辆后，使用新的变换更新模拟状态
-    KinematicState kinematic_state{teleportation_transform.location,
+    request.pending = true;
+    request.transform = teleportation_transform;
+    request.state = KinematicState{teleportation_transform.location,
                                    teleportation_transform.rotation,
                                    vehicle_velocity, vehicle_speed_limit,
                                    vehicle_physics_enabled, simulation_state.IsDormant(actor_id),
                                    teleportation_transform.location};
-    simulation_state.UpdateKinematicState(actor_id, kinematic_state);
   }
 
   else {
 
     // 目标车速
-    float max_target_velocity = parameters.GetVehicleTargetVelocity(actor_id, vehicle_speed_limit) / 3.6f;
+    const VehicleParameters &vehicle_parameters = parameters.GetSnapshot().GetVehicle(index);
+    float max_target_velocity = vehicle_parameters.GetVehicleTargetVelocity(vehicle_speed_limit) / 3.6f;
 
     // 接近地标时减速的算法
-    float max_landmark_target_velocity = GetLandmarkTargetVelocity(*(waypoint_buffer.at(0)), vehicle_location, actor_id, max_target_velocity);
+    float max_landmark_target_velocity = local_map->GetLandmarkIndex().GetTargetVelocity(
+        waypoint_buffer.at(0)->GetIndex(), vehicle_location, vehicle_parameters, max_target_velocity);
 
     // 转弯处减速算法
     float max_turn_target_velocity = GetTurnTargetVelocity(waypoint_buffer, max_target_velocity);
@@ -164,7 +200,7 @@ void MotionPlanStage::Update(const unsigned long index) {
       const SimpleWaypointPtr &target_waypoint = GetTargetWaypoint(waypoint_buffer, target_point_distance).first;// 调用GetTargetWaypoint函数，传入路点缓冲区（waypoint_buffer）和刚计算出的目标点距离（target_point_distance），
       cg::Location target_location = target_waypoint->GetLocation();    // 获取目标路点的位置信息（cg::Location类型，可能包含三维坐标等位置相关数据），赋值给target_location变量
 
-      float offset = parameters.GetLaneOffset(actor_id); // 获取车辆在车道上的偏移量，通过parameters对象调用GetLaneOffset函数，传入车辆ID（actor_id）获取对应的车道偏移量，
+      float offset = vehicle_parameters.lane_offset; // 获取车辆在车道上的偏移量，从本周期的参数快照中读取，
       auto right_vector = target_waypoint->GetTransform().GetRightVector();    // 获取目标路点的右方向向量（GetRightVector函数返回的可能是表示路点所在位置的右侧方向的三维向量，用于确定横向方向），
       auto offset_location = cg::Location(cg::Vector3D(offset*right_vector.x, offset*right_vector.y, 0.0f));// 根据车道偏移量和右方向向量计算出偏移后的位置向量，通过将偏移量与右方向向量的各分量相乘构建一个新的三维向量，
       target_location = target_location + offset_location;// 将之前获取的目标位置（target_location）加上计算出的偏移位置（offset_location），得到考虑车道偏移后的实际目标位置
@@ -182,14 +218,17 @@ void MotionPlanStage::Update(const unsigned long index) {
       const float velocity_deviation = (dynamic_target_velocity - vehicle_speed) / dynamic_target_velocity; 
 // 计算速度偏差，用动态目标速度（dynamic_target_velocity，可能是根据路况、规划等因素设定的车辆期望达到的目标速度）减去车辆当前速度（vehicle_speed）
       // 如果未找到车辆的上一个状态，则初始化状态条目
-      if (pid_state_map.find(actor_id) == pid_state_map.end()) {
-        const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
-        pid_state_map.insert({actor_id, initial_state});
-      }
-
       // 检索先前状态
       traffic_manager::StateEntry previous_state;
-      previous_state = pid_state_map.at(actor_id);
+      {
+        std::lock_guard<std::mutex> lock(controller_state_mutex);
+        auto entry = pid_state_map.find(actor_id);
+        if (entry == pid_state_map.end()) {
+          const auto initial_state = StateEntry{current_timestamp, 0.0f, 0.0f, 0.0f};
+          entry = pid_state_map.insert({actor_id, initial_state}).first;
+        }
+        previous_state = entry->second;
+      }
 
       // 选择PID参数
       std::vector<float> longitudinal_parameters;
@@ -226,8 +265,10 @@ void MotionPlanStage::Update(const unsigned long index) {
 
       // 更新PID状态
       current_state.steer = actuation_signal.steer;
-      StateEntry &state = pid_state_map.at(actor_id);
-      state = current_state;
+      {
+        std::lock_guard<std::mutex> lock(controller_state_mutex);
+        pid_state_map.at(actor_id) = current_state;
+      }
     }
     // 对于无物理特性的载具，确定传送时的位置和方向
     else {
@@ -237,12 +278,18 @@ void MotionPlanStage::Update(const unsigned long index) {
                       0.0f};
 
       // 如果不在表中，则将条目添加到传送持续时间时钟表中
-      if (teleportation_instance.find(actor_id) == teleportation_instance.end()) {
-        teleportation_instance.insert({actor_id, current_timestamp});
+      double teleportation_elapsed_seconds = current_timestamp.elapsed_seconds;
+      {
+        std::lock_guard<std::mutex> lock(controller_state_mutex);
+        auto instance = teleportation_instance.find(actor_id);
+        if (instance == teleportation_instance.end()) {
+          instance = teleportation_instance.insert({actor_id, current_timestamp}).first;
+        }
+        teleportation_elapsed_seconds = instance->second.elapsed_seconds;
       }
 
       // 测量车辆自上次传送以来的时间
-      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_instance.at(actor_id).elapsed_seconds;
+      double elapsed_time = current_timestamp.elapsed_seconds - teleportation_elapsed_seconds;
 
       // 在车辆前方找到一个传送位置，以实现预期的速度
       if (!emergency_stop && (parameters.GetSynchronousMode() || elapsed_time > HYBRID_MODE_DT)) {
@@ -379,56 +426,6 @@ std::pair<bool, float> MotionPlanStage::CollisionHandling(const CollisionHazardD
   return {collision_emergency_stop, dynamic_target_velocity};
 }
 
-float MotionPlanStage::GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
-                                                 const cg::Location vehicle_location,
-                                                 const ActorId actor_id,
-                                                 float max_target_velocity) {// MotionPlanStage类中的成员函数GetLandmarkTargetVelocity，用于根据路点信息、车辆位置以及其他相关条件，获取基于地标（landmark）的目标速度
-
-    auto const max_distance = LANDMARK_DETECTION_TIME * max_target_velocity; 
-// 计算地标检测的最大距离，通过将地标检测时间（LANDMARK_DETECTION_TIME，可能是预设的一个用于检测地标有效范围的时间值）乘以最大目标速度得到，
-
-    float landmark_target_velocity = std::numeric_limits<float>::max(); 
-// 初始化地标目标速度为正无穷大（std::numeric_limits<float>::max()），后续会在循环中根据具体地标情况更新为合理的值
-
-    auto all_landmarks = waypoint.GetWaypoint()->GetAllLandmarksInDistance(max_distance, false); 
-// 初始化地标目标速度为正无穷大（std::numeric_limits<float>::max()），后续会在循环中根据具体地标情况更新为合理的值
-
-
-    for (auto &landmark: all_landmarks) {// 遍历获取到的所有地标
-
-      auto landmark_location = landmark->GetWaypoint()->GetTransform().location;// 获取地标所在位置信息（cg::Location类型），通过先获取地标对应的路点（landmark->GetWaypoint()），再获取其变换信息中的位置信息（GetTransform().location）得到
-      auto landmark_type = landmark->GetType();// 获取地标类型信息（可能是一个字符串标识，用于区分不同种类的地标，比如交通信号灯、停止标志等），通过调用landmark的GetType函数获取
-      auto distance = landmark_location.Distance(vehicle_location);// 计算地标位置与车辆当前位置之间的距离，调用Distance函数来获取，单位可能根据具体场景设定（比如米等）
-
-      if (distance > max_distance) { 
-// 如果地标与车辆的距离大于最大距离，说明该地标不在本次考虑的有效范围内，直接跳过本次循环，继续检查下一个地标
-        continue;
-      }
-
-      float minimum_velocity = max_target_velocity;// 初始化一个最小速度值为最大目标速度，后续会根据地标类型进行调整，用于表示基于当前地标情况下车辆应达到的最小允许速度
-      if (landmark_type == "1000001") {  // 交通信号灯
-        minimum_velocity = TL_TARGET_VELOCITY;  // 将最小速度设置为交通信号灯对应的目标速度（TL_TARGET_VELOCITY，应该是预定义的一个针对交通信号灯场景下车辆合适速度的常量值）
-      } else if (landmark_type == "206") {  // 停止
-        minimum_velocity = STOP_TARGET_VELOCITY; // 将最小速度设置为停止标志对应的目标速度（STOP_TARGET_VELOCITY，同样是预定义的适合在停止标志场景下的车辆速度常量值）
-      } else if (landmark_type == "205") {  // 产出
-        minimum_velocity = YIELD_TARGET_VELOCITY;// 将最小速度设置为让行标志对应的目标速度（YIELD_TARGET_VELOCITY，预定义的在让行场景下的车辆合适速度常量值）
-      } else if (landmark_type == "274") {  // 速度限制
-        float value = static_cast<float>(landmark->GetValue()) / 3.6f;
-        value = parameters.GetVehicleTargetVelocity(actor_id, value);// 根据车辆ID（actor_id）和获取到的速度值，调用parameters对象的GetVehicleTargetVelocity函数进一步调整速度值，
-        minimum_velocity = (value < max_target_velocity) ? value : max_target_velocity;// 取调整后的速度值和最大目标速度中的较小值作为最小速度，确保不超过最大目标速度限制
-      } else { 
-// 如果地标类型不属于上述已知的类型，直接跳过本次循环，不考虑该地标对目标速度的影响
-        continue;
-      }
-
-      float v = std::max(((max_target_velocity - minimum_velocity) / max_distance) * distance + minimum_velocity, minimum_velocity);// 根据距离、最大目标速度以及最小速度计算一个基于当前地标的速度值v，计算公式可能基于某种线性关系或者项目特定的规则
-      landmark_target_velocity = std::min(landmark_target_velocity, v); 
-// 取计算出的基于当前地标的速度值v和之前记录的地标目标速度（landmark_target_velocity）中的较小值，更新地标目标速度
-    }
-
-    return landmark_target_velocity;// 返回最终确定的基于地标情况的目标速度，外部调用者可以根据这个速度值来调整车辆的行驶速度计划等操作
-}
-
 float MotionPlanStage::GetTurnTargetVelocity(const Buffer &waypoint_buffer,// MotionPlanStage类中的成员函数GetTurnTargetVelocity，用于根据路点缓冲区信息计算车辆在转弯处的目标速度
                                              float max_target_velocity) {
 
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "carla/trafficmanager/DataStructures.h"
 #include "carla/trafficmanager/InMemoryMap.h"
 #include "carla/trafficmanager/LocalizationUtils.h"
@@ -41,8 +43,19 @@ private:
   // Structure to keep track of duration between teleportation
   // in hybrid physics mode.
   std::unordered_map<ActorId, cc::Timestamp> teleportation_instance;
+  // 并行更新期间保护 pid_state_map 与 teleportation_instance 结构的互斥锁。
+  std::mutex controller_state_mutex;
   ControlFrame &output_array;
-  cc::Timestamp current_timestamp;// 当前时间戳。
+  cc::Timestamp current_timestamp;// 当前时间戳，每个周期开始时获取一次。
+  // 休眠车辆的重生请求。选择空闲测地线网格依赖于其他车辆的选择，
+  // 因此并行更新期间只记录候选路点，在 CommitCycle 中按 index 顺序选择。
+  struct RespawnRequest {
+    bool pending;
+    NodeList candidates;
+    cg::Transform transform;
+    KinematicState state;
+  };
+  std::vector<RespawnRequest> respawn_requests;
   RandomGenerator &random_device;// 引用随机数生成器对象。
   const LocalMapPtr &local_map;// 引用本地地图指针对象。
 // 处理碰撞的私有方法。
@@ -55,11 +68,6 @@ private:
   bool SafeAfterJunction(const LocalizationData &localization,
                          const bool tl_hazard,
                          const bool collision_emergency_stop);
- // 根据地标获取目标速度的私有方法。
-  float GetLandmarkTargetVelocity(const SimpleWaypoint& waypoint,
-                                  const cg::Location vehicle_location,
-                                  const ActorId actor_id,
-                                  float max_target_velocity);
 // 根据路点缓冲区获取转弯目标速度的私有方法。
   float GetTurnTargetVelocity(const Buffer &waypoint_buffer,
                               float max_target_velocity);
@@ -90,6 +98,10 @@ public:
  // 这里通常会放置函数具体的实现逻辑代码，来根据传入的这些参数进行运动规划计算，生成相应的控制输出存放在output_array中，但目前函数体内部代码缺失
  // 更新方法，根据给定的索引进行更新。
   void Update(const unsigned long index);
+// 获取本周期的时间戳并准备重生请求。
+  void PrepareCycle() override;
+// 按 index 顺序处理休眠车辆的重生请求。
+  void CommitCycle() override;
 // 移除指定 actor 的方法。
   void RemoveActor(const ActorId actor_id);
 // 重置方法。
@@ -7,6 +7,9 @@
 #include "carla/trafficmanager/Parameters.h"  // 引入参数头文件
 #include "carla/trafficmanager/Constants.h"  // 引入常量头文件
 
+#include <algorithm>
+#include <limits>
+
 namespace carla {
 namespace traffic_manager {
 
@@ -44,11 +47,13 @@ void Parameters::SetPercentageSpeedDifference(const ActorPtr &actor, const float
   if (exact_desired_speed.Contains(actor->GetId())) {  // 如果参与者的精确期望速度存在
     exact_desired_speed.RemoveEntry(actor->GetId());  // 移除该参与者的精确期望速度
   }
+  ++version;
 }
 
 void Parameters::SetLaneOffset(const ActorPtr &actor, const float offset) {  // 设置车道偏移
   const auto entry = std::make_pair(actor->GetId(), offset);  // 创建参与者ID和偏移的条目
   lane_offset.AddEntry(entry);  // 添加车道偏移记录
+  ++version;
 }
 
 void Parameters::SetDesiredSpeed(const ActorPtr &actor, const float value) {  // 设置期望速度
@@ -57,15 +62,18 @@ void Parameters::SetDesiredSpeed(const ActorPtr &actor, const float value) {  //
   if (percentage_difference_from_speed_limit.Contains(actor->GetId())) {  // 如果速度差记录存在
     percentage_difference_from_speed_limit.RemoveEntry(actor->GetId());  // 移除该参与者的速度差记录
   }
+  ++version;
 }
 
 void Parameters::SetGlobalPercentageSpeedDifference(const float percentage) {  // 设置全局速度差百分比
   float new_percentage = std::min(100.0f, percentage);  // 限制最大百分比为100
   global_percentage_difference_from_limit = new_percentage;  // 设置全局速度差
+  ++version;
 }
 
 void Parameters::SetGlobalLaneOffset(const float offset) {  // 设置全局车道偏移
   global_lane_offset = offset;  // 设置全局偏移量
+  ++version;
 }
 
 void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const ActorPtr &other_actor, const bool detect_collision) {  // 设置碰撞检测
@@ -92,27 +100,32 @@ void Parameters::SetCollisionDetection(const ActorPtr &reference_actor, const Ac
       ignore_collision.AddEntry(entry);  // 添加条目到忽略碰撞列表
     }
   }
+  ++version;
 }
 
 void Parameters::SetForceLaneChange(const ActorPtr &actor, const bool direction) {  // 设置强制变道
   const ChangeLaneInfo lane_change_info = {true, direction};  // 创建变道信息
   const auto entry = std::make_pair(actor->GetId(), lane_change_info);  // 创建参与者ID和变道信息的条目
   force_lane_change.AddEntry(entry);  // 添加变道记录
+  ++version;
 }
 
 void Parameters::SetKeepRightPercentage(const ActorPtr &actor, const float percentage) {  // 设置保持右侧的百分比
   const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和保持右侧百分比的条目
   perc_keep_right.AddEntry(entry);  // 添加保持右侧记录
+  ++version;
 }
 
 void Parameters::SetRandomLeftLaneChangePercentage(const ActorPtr &actor, const float percentage) {  // 设置随机左变道的百分比
   const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和随机左变道百分比的条目
   perc_random_left.AddEntry(entry);  // 添加随机左变道记录
+  ++version;
 }
 
 void Parameters::SetRandomRightLaneChangePercentage(const ActorPtr &actor, const float percentage) {  // 设置随机右变道的百分比
   const auto entry = std::make_pair(actor->GetId(), percentage);  // 创建参与者ID和随机右变道百分比的条目
   perc_random_right.AddEntry(entry);  // 添加随机右变道记录
+  ++version;
 }
 
 void Parameters::SetUpdateVehicleLights(const ActorPtr &actor, const bool do_update) {
@@ -121,6 +134,7 @@ void Parameters::SetUpdateVehicleLights(const ActorPtr &actor, const bool do_upd
     // 创建参与者ID和更新状态的条目
     auto_update_vehicle_lights.AddEntry(entry);
     // 将条目添加到自动更新车辆灯光列表中
+    ++version;
 }
 
 void Parameters::SetAutoLaneChange(const ActorPtr &actor, const bool enable) {
@@ -129,6 +143,7 @@ void Parameters::SetAutoLaneChange(const ActorPtr &actor, const bool enable) {
     // 创建参与者ID和变道使能状态的条目
     auto_lane_change.AddEntry(entry);
     // 将条目添加到自动变道列表中
+    ++version;
 }
 
 void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float distance) {
@@ -139,6 +154,78 @@ void Parameters::SetDistanceToLeadingVehicle(const ActorPtr &actor, const float
     // 创建参与者ID和距离的条目
     distance_to_leading_vehicle.AddEntry(entry);
     // 将条目添加到前车距离列表中
+    ++version;
+}
+
+void Parameters::SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values) {
+    // 与逐辆车的设置方法使用相同的取值范围
+    const auto clamp = [&values](const float lower, const float upper) {
+        VehicleParameterList entries;
+        entries.reserve(values.size());
+        for (const auto &entry : values) {
+            entries.emplace_back(entry.first, cg::Math::Clamp(entry.second, lower, upper));
+        }
+        return entries;
+    };
+    const auto to_bool = [&values]() {
+        std::vector<std::pair<ActorId, bool>> entries;
+        entries.reserve(values.size());
+        for (const auto &entry : values) {
+            entries.emplace_back(entry.first, entry.second != 0.0f);
+        }
+        return entries;
+    };
+    constexpr float lowest = std::numeric_limits<float>::lowest();
+    constexpr float highest = std::numeric_limits<float>::max();
+
+    switch (parameter) {
+        case VehicleParameter::PercentageSpeedDifference:
+            // 速度差与期望速度互斥
+            percentage_difference_from_speed_limit.AddEntries(clamp(lowest, 100.0f));
+            exact_desired_speed.RemoveEntries(values);
+            break;
+        case VehicleParameter::LaneOffset:
+            lane_offset.AddEntries(values);
+            break;
+        case VehicleParameter::DesiredSpeed:
+            exact_desired_speed.AddEntries(clamp(0.0f, highest));
+            percentage_difference_from_speed_limit.RemoveEntries(values);
+            break;
+        case VehicleParameter::DistanceToLeadingVehicle:
+            distance_to_leading_vehicle.AddEntries(clamp(0.0f, highest));
+            break;
+        case VehicleParameter::PercentageRunningLight:
+            perc_run_traffic_light.AddEntries(clamp(0.0f, 100.0f));
+            break;
+        case VehicleParameter::PercentageRunningSign:
+            perc_run_traffic_sign.AddEntries(clamp(0.0f, 100.0f));
+            break;
+        case VehicleParameter::PercentageIgnoreWalkers:
+            perc_ignore_walkers.AddEntries(clamp(0.0f, 100.0f));
+            break;
+        case VehicleParameter::PercentageIgnoreVehicles:
+            perc_ignore_vehicles.AddEntries(clamp(0.0f, 100.0f));
+            break;
+        case VehicleParameter::KeepRightPercentage:
+            perc_keep_right.AddEntries(values);
+            break;
+        case VehicleParameter::RandomLeftLaneChangePercentage:
+            perc_random_left.AddEntries(values);
+            break;
+        case VehicleParameter::RandomRightLaneChangePercentage:
+            perc_random_right.AddEntries(values);
+            break;
+        case VehicleParameter::AutoLaneChange:
+            auto_lane_change.AddEntries(to_bool());
+            break;
+        case VehicleParameter::UpdateVehicleLights:
+            auto_update_vehicle_lights.AddEntries(to_bool());
+            break;
+        default:
+            // 无效的参数类型，由调用方检查
+            return;
+    }
+    ++version;
 }
 
 void Parameters::SetSynchronousMode(const bool mode_switch) {
@@ -154,6 +241,7 @@ void Parameters::SetSynchronousModeTimeOutInMiliSecond(const double time) {
 void Parameters::SetGlobalDistanceToLeadingVehicle(const float dist) {
     // 设置全局前车距离
    distance_margin.store(dist);
+    ++version;
 }
 
 void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float perc) {
@@ -164,6 +252,7 @@ void Parameters::SetPercentageRunningLight(const ActorPtr &actor, const float pe
     // 创建参与者ID和百分比的条目
     perc_run_traffic_light.AddEntry(entry);
     // 将条目添加到运行信号灯百分比列表中
+    ++version;
 }
 
 void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float perc) {
@@ -171,6 +260,7 @@ void Parameters::SetPercentageRunningSign(const ActorPtr &actor, const float per
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
    const auto entry = std::make_pair(actor->GetId(), new_perc);
    perc_run_traffic_sign.AddEntry(entry);
+    ++version;
 }
 
 void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float perc) {
@@ -178,6 +268,7 @@ void Parameters::SetPercentageIgnoreVehicles(const ActorPtr &actor, const float
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
    const auto entry = std::make_pair(actor->GetId(), new_perc);
    perc_ignore_vehicles.AddEntry(entry);
+    ++version;
 }
 
 void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float perc) {
@@ -185,6 +276,7 @@ void Parameters::SetPercentageIgnoreWalkers(const ActorPtr &actor, const float p
    float new_perc = cg::Math::Clamp(perc, 0.0f, 100.0f);
    const auto entry = std::make_pair(actor->GetId(), new_perc);
    perc_ignore_walkers.AddEntry(entry);
+    ++version;
 }
 
 void Parameters::SetHybridPhysicsRadius(const float radius) {
@@ -199,6 +291,17 @@ void Parameters::SetOSMMode(const bool mode_switch) {
     osm_mode.store(mode_switch);
 }
 
+void Parameters::SetWorkerThreadCount(const unsigned count) {
+    // 设置并行执行各阶段的工作线程数
+    worker_thread_count.store(count);
+}
+
+void Parameters::SetControlFrameDiffing(const bool mode_switch, const float tolerance) {
+    // 设置控制帧差分，容差不能为负
+    control_frame_tolerance.store(std::max(tolerance, 0.0f));
+    control_frame_diffing.store(mode_switch);
+}
+
 void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const bool empty_buffer) {
     // 设置参与者的自定义路径
     const auto entry = std::make_pair(actor->GetId(), path);
@@ -207,6 +310,7 @@ void Parameters::SetCustomPath(const ActorPtr &actor, const Path path, const boo
     const auto entry2 = std::make_pair(actor->GetId(), empty_buffer);
     upload_path.AddEntry(entry2);
     // 将空缓冲区条目添加到上传路径列表中
+    ++version;
 }
 
 void Parameters::RemoveUploadPath(const ActorId &actor_id, const bool remove_path) {
@@ -215,6 +319,8 @@ void Parameters::RemoveUploadPath(const ActorId &actor_id, const bool remove_pat
         upload_path.RemoveEntry(actor_id);
     } else {
         custom_path.RemoveEntry(actor_id);
+        // 快照中的提示需要在下一个周期清除
+        ++version;
     }
 }
 
@@ -233,6 +339,7 @@ void Parameters::SetImportedRoute(const ActorPtr &actor, const Route route, cons
     custom_route.AddEntry(entry);
     const auto entry2 = std::make_pair(actor->GetId(), empty_buffer);
     upload_route.AddEntry(entry2);
+    ++version;
 }
 
 void Parameters::RemoveImportedRoute(const ActorId &actor_id, const bool remove_path) {
@@ -241,6 +348,8 @@ void Parameters::RemoveImportedRoute(const ActorId &actor_id, const bool remove_
         upload_route.RemoveEntry(actor_id);
     } else {
         custom_route.RemoveEntry(actor_id);
+        // 快照中的提示需要在下一个周期清除
+        ++version;
     }
 }
 
@@ -260,6 +369,21 @@ float Parameters::GetHybridPhysicsRadius() const {
    return hybrid_physics_radius.load();
 }
 
+unsigned Parameters::GetWorkerThreadCount() const {
+    // 获取并行执行各阶段的工作线程数
+    return worker_thread_count.load();
+}
+
+bool Parameters::GetControlFrameDiffing() const {
+    // 获取是否启用控制帧差分
+    return control_frame_diffing.load();
+}
+
+float Parameters::GetControlFrameTolerance() const {
+    // 获取控制帧差分的容差
+    return control_frame_tolerance.load();
+}
+
 bool Parameters::GetSynchronousMode() const {
     // 获取同步模式状态
     return synchronous_mode.load();
@@ -321,8 +445,11 @@ ChangeLaneInfo Parameters::GetForceLaneChange(const ActorId &actor_id) {
         change_lane_info = force_lane_change.GetValue(actor_id);
     }
 
-    // 移除该参与者的强制车道变更条目
-    force_lane_change.RemoveEntry(actor_id);
+    // 移除该参与者的强制车道变更条目，快照中的提示在下一个周期清除
+    if (change_lane_info.change_lane) {
+        force_lane_change.RemoveEntry(actor_id);
+        ++version;
+    }
 
    return change_lane_info; // 返回车道变更信息
 }
@@ -523,5 +650,64 @@ Route Parameters::GetImportedRoute(const ActorId &actor_id) const {
 }
 
 
+bool ParametersSnapshot::GetCollisionDetection(const VehicleParameters &reference, const ActorId other_actor_id) const {
+    const auto begin = ignore_collision.begin() + reference.ignore_collision_begin;
+    const auto end = ignore_collision.begin() + reference.ignore_collision_end;
+    return !std::binary_search(begin, end, other_actor_id);
+}
+
+void Parameters::UpdateSnapshot(const std::vector<ActorId> &vehicle_id_list) {
+    // 先读取版本号，生成快照期间的修改会在下一个周期触发更新
+    const uint64_t current_version = version.load();
+    if (current_version == snapshot.version && vehicle_id_list == snapshot.vehicle_ids) {
+        return;
+    }
+    snapshot.version = current_version;
+    snapshot.vehicle_ids = vehicle_id_list;
+    snapshot.vehicles.resize(vehicle_id_list.size());
+    snapshot.vehicle_index.clear();
+    snapshot.ignore_collision.clear();
+
+    const float global_percentage = global_percentage_difference_from_limit;
+    const float global_offset = global_lane_offset;
+    const float global_distance = distance_margin.load();
+    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
+        const ActorId actor_id = vehicle_id_list[index];
+        VehicleParameters &vehicle = snapshot.vehicles[index];
+        vehicle = VehicleParameters();
+        snapshot.vehicle_index.emplace(actor_id, index);
+
+        vehicle.percentage_speed_difference = global_percentage;
+        if (!percentage_difference_from_speed_limit.TryGetValue(actor_id, vehicle.percentage_speed_difference)) {
+            vehicle.has_exact_desired_speed = exact_desired_speed.TryGetValue(actor_id, vehicle.exact_desired_speed);
+        }
+        vehicle.lane_offset = global_offset;
+        lane_offset.TryGetValue(actor_id, vehicle.lane_offset);
+        vehicle.distance_to_leading_vehicle = global_distance;
+        distance_to_leading_vehicle.TryGetValue(actor_id, vehicle.distance_to_leading_vehicle);
+        perc_run_traffic_light.TryGetValue(actor_id, vehicle.perc_run_traffic_light);
+        perc_run_traffic_sign.TryGetValue(actor_id, vehicle.perc_run_traffic_sign);
+        perc_ignore_walkers.TryGetValue(actor_id, vehicle.perc_ignore_walkers);
+        perc_ignore_vehicles.TryGetValue(actor_id, vehicle.perc_ignore_vehicles);
+        perc_keep_right.TryGetValue(actor_id, vehicle.perc_keep_right);
+        perc_random_left.TryGetValue(actor_id, vehicle.perc_random_left);
+        perc_random_right.TryGetValue(actor_id, vehicle.perc_random_right);
+        auto_lane_change.TryGetValue(actor_id, vehicle.auto_lane_change);
+        auto_update_vehicle_lights.TryGetValue(actor_id, vehicle.auto_update_vehicle_lights);
+        vehicle.force_lane_change = force_lane_change.Contains(actor_id);
+        vehicle.custom_path = custom_path.Contains(actor_id);
+        vehicle.imported_route = custom_route.Contains(actor_id);
+
+        vehicle.ignore_collision_begin = static_cast<uint32_t>(snapshot.ignore_collision.size());
+        std::shared_ptr<AtomicActorSet> actor_set;
+        if (ignore_collision.TryGetValue(actor_id, actor_set)) {
+            const std::vector<ActorId> ignored = actor_set->GetIDList();
+            snapshot.ignore_collision.insert(snapshot.ignore_collision.end(), ignored.begin(), ignored.end());
+            std::sort(snapshot.ignore_collision.begin() + vehicle.ignore_collision_begin, snapshot.ignore_collision.end());
+        }
+        vehicle.ignore_collision_end = static_cast<uint32_t>(snapshot.ignore_collision.size());
+    }
+}
+
 } // namespace traffic_manager
 } // namespace carla
@@ -10,6 +10,7 @@
 #include <chrono>  /// 提供时间功能，用于时间计算
 #include <random>  /// 提供随机数生成功能
 #include <unordered_map> /// 提供无序映射容器，用于快速查找
+#include <vector>
 /// 包含Carla客户端相关的头文件
 #include "carla/client/Actor.h"
 #include "carla/client/Vehicle.h"
@@ -18,6 +19,7 @@
 
 #include "carla/trafficmanager/AtomicActorSet.h"/// 包含Carla交通管理器的相关头文件
 #include "carla/trafficmanager/AtomicMap.h"
+#include "carla/trafficmanager/VehicleParameter.h"
 
 namespace carla {
     namespace traffic_manager {
@@ -33,6 +35,80 @@ namespace carla {
             bool change_lane = false;/// 是否换道
             bool direction = false;/// 换道方向
         };
+        /// 一辆车在一个周期内生效的参数，已合并全局设置。
+        struct VehicleParameters {
+            /// 与速度限制的差异百分比，设置了期望速度时不使用
+            float percentage_speed_difference = 0.0f;
+            /// 期望速度
+            float exact_desired_speed = 0.0f;
+            float lane_offset = 0.0f;
+            float distance_to_leading_vehicle = 0.0f;
+            float perc_run_traffic_light = 0.0f;
+            float perc_run_traffic_sign = 0.0f;
+            float perc_ignore_walkers = 0.0f;
+            float perc_ignore_vehicles = 0.0f;
+            float perc_keep_right = -1.0f;
+            float perc_random_left = -1.0f;
+            float perc_random_right = -1.0f;
+            /// 忽略碰撞的车辆在 ParametersSnapshot 中的范围
+            uint32_t ignore_collision_begin = 0u;
+            uint32_t ignore_collision_end = 0u;
+            bool has_exact_desired_speed = false;
+            bool auto_lane_change = true;
+            bool auto_update_vehicle_lights = false;
+            /// 以下为待处理命令的提示，为真时需要通过 Parameters 读取（并消费）命令
+            bool force_lane_change = false;
+            bool custom_path = false;
+            bool imported_route = false;
+
+            /// 与 Parameters::GetVehicleTargetVelocity 相同
+            float GetVehicleTargetVelocity(const float speed_limit) const {
+                return has_exact_desired_speed ?
+                    exact_desired_speed :
+                    speed_limit * (1.0f - percentage_speed_difference / 100.0f);
+            }
+        };
+
+        /// 一个周期开始时各车辆参数的只读快照，按 vehicle_id_list 的顺序存放。
+        ///
+        /// 快照只在各阶段运行前由 Parameters::UpdateSnapshot 更新，阶段中
+        /// 可以不加锁地并行读取。
+        class ParametersSnapshot {
+        public:
+            /// 生成快照时 Parameters 的版本号
+            uint64_t GetVersion() const {
+                return version;
+            }
+
+            size_t Size() const {
+                return vehicles.size();
+            }
+
+            /// 第 @a index 辆车的参数，与 vehicle_id_list 的索引一致
+            const VehicleParameters &GetVehicle(const unsigned long index) const {
+                return vehicles[index];
+            }
+
+            /// 按 ID 查找车辆的参数，不在快照中时返回 nullptr
+            const VehicleParameters *FindVehicle(const ActorId actor_id) const {
+                const auto it = vehicle_index.find(actor_id);
+                return it != vehicle_index.end() ? &vehicles[it->second] : nullptr;
+            }
+
+            /// 与 Parameters::GetCollisionDetection 相同
+            bool GetCollisionDetection(const VehicleParameters &reference, const ActorId other_actor_id) const;
+
+        private:
+            friend class Parameters;
+
+            uint64_t version = 0u;
+            std::vector<ActorId> vehicle_ids;
+            std::vector<VehicleParameters> vehicles;
+            std::unordered_map<ActorId, unsigned long> vehicle_index;
+            /// 每辆车忽略碰撞的车辆，各段已排序
+            std::vector<ActorId> ignore_collision;
+        };
+
         /// 交通管理参数
         class Parameters {
 
@@ -91,6 +167,12 @@ namespace carla {
             std::atomic<float> hybrid_physics_radius{ 70.0 };
             /// Open Street Map模式参数
             std::atomic<bool> osm_mode{ true };
+            /// 并行执行各阶段的工作线程数，0 表示使用硬件并发数
+            std::atomic<unsigned> worker_thread_count{ 1u };
+            /// 是否只发送变化超过容差的控制命令
+            std::atomic<bool> control_frame_diffing{ false };
+            /// 控制帧差分的容差
+            std::atomic<float> control_frame_tolerance{ 0.01f };
             /// 是否导入自定义路径的参数映射
             AtomicMap<ActorId, bool> upload_path;
             /// 存储所有自定义路径的结构
@@ -167,6 +249,10 @@ namespace carla {
             /// 设置是否自动更新车辆灯光状态的方法
             void SetUpdateVehicleLights(const ActorPtr& actor, const bool do_update);///<车辆指针和是否更新的布尔值
 
+            /// 批量设置多辆车的同一个参数的方法，取值范围与对应的逐辆车设置方法相同，
+            /// 每个映射只加锁一次。只使用车辆ID，车辆不需要存在于当前的模拟中
+            void SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList& values);///< 参数类型和车辆ID与参数值的列表
+
             /// 设置所有注册车辆应保持与前车的距离的方法
             void SetGlobalDistanceToLeadingVehicle(const float dist);///< 所有车辆应保持的距离值
 
@@ -185,6 +271,12 @@ namespace carla {
             /// 设置Open Street Map模式的方法
             void SetOSMMode(const bool mode_switch);///< 是否启用OSM模式的布尔值
 
+            /// 设置并行执行各阶段的工作线程数的方法
+            void SetWorkerThreadCount(const unsigned count);///< 工作线程数，0 表示使用硬件并发数
+
+            /// 设置是否只发送变化超过容差的控制命令的方法
+            void SetControlFrameDiffing(const bool mode_switch, const float tolerance);///< 是否启用的布尔值和容差
+
             /// 设置是否自动重生休眠车辆的方法
             void SetRespawnDormantVehicles(const bool mode_switch); ///< 是否启用的布尔值
 
@@ -217,6 +309,15 @@ namespace carla {
             /// 获取混合物理半径的方法
             float GetHybridPhysicsRadius() const;
 
+            /// 获取并行执行各阶段的工作线程数的方法
+            unsigned GetWorkerThreadCount() const;
+
+            /// 获取是否只发送变化超过容差的控制命令的方法
+            bool GetControlFrameDiffing() const;
+
+            /// 获取控制帧差分容差的方法
+            float GetControlFrameTolerance() const;
+
             /// 查询车辆目标速度的方法
             float GetVehicleTargetVelocity(const ActorId& actor_id, const float speed_limit) const;
 
@@ -292,8 +393,25 @@ namespace carla {
             /// 获取自定义路由的方法
             Route GetImportedRoute(const ActorId& actor_id) const;
 
+            /// 按当前设置为 @a vehicle_id_list 中的车辆生成参数快照。
+            ///
+            /// 在交通管理器每个周期开始、各阶段运行之前调用；设置没有变化且
+            /// 车辆列表相同时不做任何事情。周期内的修改从下一个周期开始生效。
+            void UpdateSnapshot(const std::vector<ActorId> &vehicle_id_list);
+
+            /// 当前周期的参数快照
+            const ParametersSnapshot &GetSnapshot() const {
+                return snapshot;
+            }
+
             /// 同步模式超时变量
             std::chrono::duration<double, std::milli> synchronous_time_out;
+
+        private:
+            /// 每次修改车辆参数时递增，用于判断快照是否需要更新
+            std::atomic<uint64_t> version{ 1u };
+
+            ParametersSnapshot snapshot;
         };
 
     } // namespace traffic_manager
@@ -3,10 +3,11 @@
 
 // 引入C++标准库中的随机数相关头文件，用于生成随机数相关功能
 #include <random>
-// 引入无序映射相关头文件，虽然在此代码片段中未体现其具体使用，但可能在更广泛的上下文中会涉及
+// 引入无序映射相关头文件，用于保存每辆车独立的随机数流
 #include <unordered_map>
+#include <vector>
 
-// 引入Carla项目中定义ActorId相关的头文件，此处代码未直接体现其使用，但可能与之相关联
+// 引入Carla项目中定义ActorId相关的头文件
 #include "carla/rpc/ActorId.h"
 
 namespace carla {
@@ -17,16 +18,52 @@ class RandomGenerator {
 public:
     // 构造函数，接收一个无符号64位整数作为随机数生成器的种子
     // 使用该种子初始化一个基于梅森旋转算法的伪随机数生成器（std::mt19937），并设定生成的随机数范围为0.0到100.0
-    RandomGenerator(const uint64_t seed): mt(std::mt19937(seed)), dist(0.0, 100.0) {}
-    
+    RandomGenerator(const uint64_t seed): seed(seed), mt(std::mt19937(seed)), dist(0.0, 100.0) {}
+
     // 生成并返回下一个随机数，通过调用std::uniform_real_distribution的操作符，利用已初始化的随机数生成器（mt）来生成符合设定范围（0.0到100.0）的随机数
     double next() { return dist(mt); }
 
+    // 从指定车辆自己的随机数流中生成下一个随机数（0.0到100.0）。
+    // 每辆车的随机数流只由种子和车辆ID决定，与车辆的处理顺序无关，因此各阶段可以并行更新而结果保持确定。
+    // 调用前必须已经通过 UpdateActors 为该车辆创建了随机数流。
+    double next(const carla::rpc::ActorId actor_id) {
+        std::uniform_real_distribution<double> actor_dist(0.0, 100.0);
+        return actor_dist(actor_streams.at(actor_id));
+    }
+
+    // 为列表中的新车辆创建随机数流，并删除已不在列表中的车辆的随机数流。
+    // 只能在没有并行阶段运行时调用。
+    void UpdateActors(const std::vector<carla::rpc::ActorId> &actor_ids) {
+        if (actor_streams.size() != actor_ids.size()) {
+            std::unordered_map<carla::rpc::ActorId, std::mt19937> retained;
+            retained.reserve(actor_ids.size());
+            for (const carla::rpc::ActorId actor_id : actor_ids) {
+                auto stream = actor_streams.find(actor_id);
+                if (stream != actor_streams.end()) {
+                    retained.insert({actor_id, stream->second});
+                }
+            }
+            actor_streams.swap(retained);
+        }
+        for (const carla::rpc::ActorId actor_id : actor_ids) {
+            if (actor_streams.find(actor_id) == actor_streams.end()) {
+                std::seed_seq stream_seed{static_cast<uint32_t>(seed),
+                                          static_cast<uint32_t>(seed >> 32u),
+                                          static_cast<uint32_t>(actor_id)};
+                actor_streams.insert({actor_id, std::mt19937(stream_seed)});
+            }
+        }
+    }
+
 private:
+    // 构造时使用的种子，用于派生每辆车的随机数流
+    uint64_t seed;
     // 基于梅森旋转算法的伪随机数生成器对象，用于生成伪随机数序列的基础，其状态由传入的种子决定
     std::mt19937 mt;
     // 均匀分布的实数随机数分布对象，定义了生成随机数的范围（在此为0.0到100.0），与随机数生成器（mt）配合使用来生成符合该范围的随机数
     std::uniform_real_distribution<double> dist;
+    // 每辆车独立的随机数流
+    std::unordered_map<carla::rpc::ActorId, std::mt19937> actor_streams;
 };
 
 } // namespace traffic_manager
@@ -17,23 +17,62 @@ namespace traffic_manager {
     waypoint = _waypoint; // 初始化成员waypoint
     next_left_waypoint = nullptr; // 初始化左侧下一个路点为空
     next_right_waypoint = nullptr; // 初始化右侧下一个路点为空
+    if (waypoint != nullptr) {
+      transform = waypoint->GetTransform(); // 缓存变换
+      waypoint_id = waypoint->GetId(); // 缓存ID
+      waypoint_is_junction = waypoint->IsJunction(); // 缓存是否位于交叉口
+      junction_id = waypoint->GetJunctionId(); // 缓存交叉口ID
+      road_id = waypoint->GetRoadId(); // 缓存OpenDrive道路ID
+      lane_id = waypoint->GetLaneId(); // 缓存OpenDrive车道ID
+      s = static_cast<float>(waypoint->GetDistance()); // 缓存沿车道的距离
+    }
+  }
+
+  SimpleWaypoint::SimpleWaypoint(WorldMap _world_map, const ResolvedWaypoint &resolved) { // 构造函数，接受缓存中已解析的数据
+    world_map = std::move(_world_map); // 保存地图，用于延迟创建waypoint
+    road_id = resolved.road_id; // 保存OpenDrive道路ID
+    lane_id = resolved.lane_id; // 保存OpenDrive车道ID
+    s = resolved.s; // 保存沿车道的距离
+    next_left_waypoint = nullptr; // 初始化左侧下一个路点为空
+    next_right_waypoint = nullptr; // 初始化右侧下一个路点为空
+    transform = resolved.transform; // 使用缓存的变换
+    waypoint_id = resolved.id; // 使用缓存的ID
+    waypoint_is_junction = resolved.is_junction; // 使用缓存的交叉口标志
+    junction_id = resolved.junction_id; // 使用缓存的交叉口ID
   }
   SimpleWaypoint::~SimpleWaypoint() {} // 析构函数
 
-  std::vector<SimpleWaypointPtr> SimpleWaypoint::GetNextWaypoint() const { // 获取下一个路点
+  const std::vector<SimpleWaypointPtr> &SimpleWaypoint::GetNextWaypoint() const { // 获取下一个路点
     return next_waypoints; // 返回下一个路点的向量
   }
 
-  std::vector<SimpleWaypointPtr> SimpleWaypoint::GetPreviousWaypoint() const { // 获取上一个路点
+  const std::vector<SimpleWaypointPtr> &SimpleWaypoint::GetPreviousWaypoint() const { // 获取上一个路点
     return previous_waypoints; // 返回上一个路点的向量
   }
 
   WaypointPtr SimpleWaypoint::GetWaypoint() const { // 获取当前的Waypoint
+    std::call_once(resolve_flag, [this]() { // 从缓存恢复的路点在第一次访问时创建Waypoint
+      if (waypoint == nullptr && world_map != nullptr) {
+        waypoint = world_map->GetWaypointXODR(road_id, lane_id, s);
+      }
+    });
     return waypoint; // 返回waypoint
   }
 
   uint64_t SimpleWaypoint::GetId() const { // 获取当前路点的ID
-    return waypoint->GetId(); // 返回waypoint的ID
+    return waypoint_id; // 返回waypoint的ID
+  }
+
+  ResolvedWaypoint SimpleWaypoint::GetResolvedWaypoint() const { // 获取已解析的数据
+    ResolvedWaypoint resolved;
+    resolved.transform = transform;
+    resolved.id = waypoint_id;
+    resolved.road_id = road_id;
+    resolved.lane_id = lane_id;
+    resolved.s = s;
+    resolved.junction_id = junction_id;
+    resolved.is_junction = waypoint_is_junction;
+    return resolved; // 返回已解析的数据
   }
 
   SimpleWaypointPtr SimpleWaypoint::GetLeftWaypoint() { // 获取左侧下一个路点
@@ -45,11 +84,11 @@ namespace traffic_manager {
   }
 
   cg::Location SimpleWaypoint::GetLocation() const { // 获取当前路点的位置
-    return waypoint->GetTransform().location; // 返回位置
+    return transform.location; // 返回位置
   }
 
   cg::Vector3D SimpleWaypoint::GetForwardVector() const { // 获取当前路点的前进方向向量
-    return waypoint->GetTransform().rotation.GetForwardVector(); // 返回前进方向向量
+    return transform.rotation.GetForwardVector(); // 返回前进方向向量
   }
 
   uint64_t SimpleWaypoint::SetNextWaypoint(const std::vector<SimpleWaypointPtr> &waypoints) { // 设置下一个路点
@@ -67,7 +106,7 @@ namespace traffic_manager {
   }
 
   void SimpleWaypoint::SetLeftWaypoint(SimpleWaypointPtr &_waypoint) { // 设置左侧下一个路点
-    const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector(); // 获取前进方向向量
+    const cg::Vector3D heading_vector = transform.GetForwardVector(); // 获取前进方向向量
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation(); // 计算相对位置向量
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) > 0.0f) { // 判断是否为左侧
       next_left_waypoint = _waypoint; // 设置左侧下一个路点
@@ -75,7 +114,7 @@ namespace traffic_manager {
   }
 
   void SimpleWaypoint::SetRightWaypoint(SimpleWaypointPtr &_waypoint) { // 设置右侧下一个路点
-    const cg::Vector3D heading_vector = waypoint->GetTransform().GetForwardVector(); // 获取前进方向向量
+    const cg::Vector3D heading_vector = transform.GetForwardVector(); // 获取前进方向向量
     const cg::Vector3D relative_vector = GetLocation() - _waypoint->GetLocation(); // 计算相对位置向量
     if ((heading_vector.x * relative_vector.y - heading_vector.y * relative_vector.x) < 0.0f) { // 判断是否为右侧
       next_right_waypoint = _waypoint; // 设置右侧下一个路点
@@ -116,8 +155,8 @@ namespace traffic_manager {
 
   GeoGridId SimpleWaypoint::GetGeodesicGridId() { // 获取地理网格ID
     GeoGridId grid_id; // 声明变量存储网格ID
-    if (waypoint->IsJunction()) { // 如果当前路点是交叉口
-      grid_id = waypoint->GetJunctionId(); // 获取交叉口ID
+    if (waypoint_is_junction) { // 如果当前路点是交叉口
+      grid_id = junction_id; // 获取交叉口ID
     } else {
       grid_id = geodesic_grid_id; // 否则获取地理网格ID
     }
@@ -125,11 +164,11 @@ namespace traffic_manager {
   }
 
   GeoGridId SimpleWaypoint::GetJunctionId() const { // 获取交叉口ID
-    return waypoint->GetJunctionId(); // 返回交叉口ID
+    return junction_id; // 返回交叉口ID
   }
 
   cg::Transform SimpleWaypoint::GetTransform() const { // 获取当前路点的变换信息
-    return waypoint->GetTransform(); // 返回变换信息
+    return transform; // 返回变换信息
   }
 
   void SimpleWaypoint::SetRoadOption(RoadOption _road_option) { // 设置道路选项
@@ -140,5 +179,13 @@ namespace traffic_manager {
     return road_option; // 返回道路选项
   }
 
+  void SimpleWaypoint::SetIndex(WaypointIndex _index) { // 设置稠密拓扑中的索引
+    index = _index; // 更新索引
+  }
+
+  WaypointIndex SimpleWaypoint::GetIndex() const { // 获取稠密拓扑中的索引
+    return index; // 返回索引
+  }
+
 } // namespace traffic_manager
 } // namespace carla
\ No newline at end of file
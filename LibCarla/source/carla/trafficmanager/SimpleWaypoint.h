@@ -6,8 +6,11 @@
 
 #pragma once
 
+#include <limits> // 引入数值极限相关的头文件
 #include <memory.h> // 引入内存操作相关的头文件
+#include <mutex> // 引入std::call_once相关的头文件
 
+#include "carla/client/Map.h" // 引入Carla客户端的Map类
 #include "carla/client/Waypoint.h" // 引入Carla客户端的Waypoint类
 #include "carla/geom/Location.h" // 引入Carla几何位置类
 #include "carla/geom/Transform.h" // 引入Carla变换类
@@ -21,7 +24,9 @@ namespace traffic_manager {
   namespace cc = carla::client; // 简化命名空间cc为carla::client
   namespace cg = carla::geom; // 简化命名空间cg为carla::geom
   using WaypointPtr = carla::SharedPtr<cc::Waypoint>; // 定义WaypointPtr为Waypoint的智能指针类型
+  using WorldMap = carla::SharedPtr<const cc::Map>; // 定义WorldMap为世界地图的智能指针类型
   using GeoGridId = carla::road::JuncId; // 定义GeoGridId为交叉口ID类型
+  using WaypointIndex = uint32_t; // 定义WaypointIndex为路径点在稠密拓扑中的索引类型
   enum class RoadOption : uint8_t { // 定义道路选项的枚举类
     Void = 0, // 无效选项
     Left = 1, // 向左
@@ -33,6 +38,18 @@ namespace traffic_manager {
     RoadEnd = 7 // 道路结束
   };
 
+  /// 从缓存恢复路径点时使用的已解析数据。
+  /// 路径点的位置与交叉口信息直接来自缓存，Carla的Waypoint对象在第一次访问时才通过OpenDrive坐标创建。
+  struct ResolvedWaypoint {
+    cg::Transform transform;
+    uint64_t id = 0u;
+    carla::road::RoadId road_id = 0u;
+    carla::road::LaneId lane_id = 0;
+    float s = 0.0f;
+    carla::road::JuncId junction_id = -1;
+    bool is_junction = false;
+  };
+
   /// 该类是Carla的Waypoint对象的简单封装。
   /// 该类用于表示世界地图的离散样本。
   class SimpleWaypoint {
@@ -42,7 +59,20 @@ namespace traffic_manager {
   private:
 
     /// 指向Carla的Waypoint对象的指针，作为此类的封装对象。
-    WaypointPtr waypoint;
+    /// 从缓存恢复的路径点在第一次调用GetWaypoint()时才创建该对象。
+    mutable WaypointPtr waypoint;
+    /// 保证延迟创建的Waypoint对象只被解析一次。
+    mutable std::once_flag resolve_flag;
+    /// 延迟解析Waypoint对象所需的地图与OpenDrive坐标。
+    WorldMap world_map;
+    carla::road::RoadId road_id = 0u;
+    carla::road::LaneId lane_id = 0;
+    float s = 0.0f;
+    /// waypoint的变换、ID与交叉口信息，避免每次访问都经过Waypoint对象。
+    cg::Transform transform;
+    uint64_t waypoint_id = 0u;
+    carla::road::JuncId junction_id = -1;
+    bool waypoint_is_junction = false;
     /// 指向下一个连接waypoint的指针列表。
     std::vector<SimpleWaypointPtr> next_waypoints;
     /// 指向前一个连接waypoint的指针列表。
@@ -57,10 +87,13 @@ namespace traffic_manager {
     GeoGridId geodesic_grid_id = 0; // 初始化为0
     // 布尔值，表示waypoint是否属于交叉口。
     bool _is_junction = false; // 默认设置为false
+    /// waypoint在稠密拓扑中的索引，由WaypointGraph设置。
+    WaypointIndex index = std::numeric_limits<WaypointIndex>::max(); // 默认设置为无效索引
 
   public:
 
     SimpleWaypoint(WaypointPtr _waypoint); // 构造函数，初始化waypoint
+    SimpleWaypoint(WorldMap _world_map, const ResolvedWaypoint &resolved); // 构造函数，从缓存数据初始化并延迟创建waypoint
     ~SimpleWaypoint(); // 析构函数
 
     /// 返回此waypoint的位置信息。
@@ -70,10 +103,10 @@ namespace traffic_manager {
     WaypointPtr GetWaypoint() const;
 
     /// 返回下一个waypoint的列表。
-    std::vector<SimpleWaypointPtr> GetNextWaypoint() const;
+    const std::vector<SimpleWaypointPtr> &GetNextWaypoint() const;
 
     /// 返回前一个waypoint的列表。
-    std::vector<SimpleWaypointPtr> GetPreviousWaypoint() const;
+    const std::vector<SimpleWaypointPtr> &GetPreviousWaypoint() const;
 
     /// 返回沿waypoint方向的向量。
     cg::Vector3D GetForwardVector() const;
@@ -81,6 +114,9 @@ namespace traffic_manager {
     /// 返回waypoint的唯一ID。
     uint64_t GetId() const;
 
+    /// 返回写入缓存所需的已解析数据，不会触发Waypoint对象的创建。
+    ResolvedWaypoint GetResolvedWaypoint() const;
+
     /// 此方法用于设置下一个waypoint。
     uint64_t SetNextWaypoint(const std::vector<SimpleWaypointPtr> &next_waypoints);
 
@@ -136,6 +172,12 @@ namespace traffic_manager {
     
     // 访问器方法，用于获取道路选项。
     RoadOption GetRoadOption();
+
+    /// 访问器方法，用于设置waypoint在稠密拓扑中的索引。
+    void SetIndex(WaypointIndex _index);
+
+    /// 访问器方法，用于获取waypoint在稠密拓扑中的索引。
+    WaypointIndex GetIndex() const;
   };
 
 } // namespace traffic_manager
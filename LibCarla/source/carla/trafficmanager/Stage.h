@@ -48,6 +48,20 @@ public:
      * @param index 当前更新周期的索引。
      */
     virtual void Update(const unsigned long index) = 0;
+    /**
+     * @brief 更新周期开始前的准备。
+     *
+     * 在本周期第一次调用 Update 之前由单线程调用。Update 可能被多个线程以不同的 index 并行调用，
+     * 阶段应在这里准备好并行期间只读的快照和按 index 划分的输出槽。
+     */
+    virtual void PrepareCycle() {}
+    /**
+     * @brief 更新周期结束后的提交。
+     *
+     * 在本周期所有 Update 调用完成后由单线程调用，按 index 顺序提交并行期间推迟的共享状态修改，
+     * 使结果与执行顺序和线程数无关。
+     */
+    virtual void CommitCycle() {}
     /**
      * @brief 移除参与者方法。
      *
@@ -0,0 +1,189 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/StageExecutor.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace carla {
+namespace traffic_manager {
+
+StageExecutor::StageExecutor(const unsigned number_of_workers) {
+  SetNumberOfWorkers(number_of_workers);
+}
+
+StageExecutor::~StageExecutor() {
+  StopWorkers();
+}
+
+void StageExecutor::SetNumberOfWorkers(const unsigned number_of_workers) {
+  unsigned workers = number_of_workers;
+  if (workers == 0u) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (workers == _number_of_workers && _ranges.size() == workers) {
+    return;
+  }
+  StopWorkers();
+  _number_of_workers = workers;
+  _ranges.clear();
+  for (unsigned i = 0u; i < workers; ++i) {
+    _ranges.emplace_back(std::make_unique<WorkRange>());
+  }
+  StartWorkers();
+}
+
+void StageExecutor::StartWorkers() {
+  _stop = false;
+  // 第 0 号工作线程就是调用 ParallelFor 的线程，只需创建其余线程。
+  const uint64_t generation = _generation;
+  for (unsigned worker = 1u; worker < _number_of_workers; ++worker) {
+    _workers.CreateThread([this, worker, generation]() { WorkerLoop(worker, generation); });
+  }
+}
+
+void StageExecutor::StopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _start_trigger.notify_all();
+  _workers.JoinAll();
+}
+
+void StageExecutor::ParallelFor(const unsigned long count, const Task &task) {
+  if (count == 0u) {
+    return;
+  }
+  // 单线程或任务太少时直接在调用线程上按顺序执行，省去同步开销。
+  if (_number_of_workers <= 1u || count == 1u) {
+    for (unsigned long index = 0u; index < count; ++index) {
+      task(index);
+    }
+    return;
+  }
+
+  // 按工作线程数平均切分区间。
+  const uint64_t workers = _number_of_workers;
+  const uint64_t chunk = count / workers;
+  const uint64_t remainder = count % workers;
+  uint64_t begin = 0u;
+  for (uint64_t worker = 0u; worker < workers; ++worker) {
+    const uint64_t end = begin + chunk + (worker < remainder ? 1u : 0u);
+    _ranges[worker]->range.store(Pack(begin, end), std::memory_order_relaxed);
+    begin = end;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = &task;
+    _exception = nullptr;
+    _pending_workers = _number_of_workers - 1u;
+    ++_generation;
+  }
+  _start_trigger.notify_all();
+
+  Execute(0u);
+
+  std::exception_ptr exception;
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _end_trigger.wait(lock, [this]() { return _pending_workers == 0u; });
+    _task = nullptr;
+    exception = _exception;
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+bool StageExecutor::PopFront(const unsigned worker, unsigned long &index) {
+  std::atomic<uint64_t> &range = _ranges[worker]->range;
+  uint64_t current = range.load(std::memory_order_acquire);
+  for (;;) {
+    const uint64_t begin = current >> 32u;
+    const uint64_t end = current & 0xFFFFFFFFu;
+    if (begin >= end) {
+      return false;
+    }
+    if (range.compare_exchange_weak(current, Pack(begin + 1u, end),
+                                    std::memory_order_acq_rel,
+                                    std::memory_order_acquire)) {
+      index = static_cast<unsigned long>(begin);
+      return true;
+    }
+  }
+}
+
+bool StageExecutor::Steal(const unsigned thief) {
+  for (unsigned offset = 1u; offset < _number_of_workers; ++offset) {
+    const unsigned victim = (thief + offset) % _number_of_workers;
+    std::atomic<uint64_t> &range = _ranges[victim]->range;
+    uint64_t current = range.load(std::memory_order_acquire);
+    for (;;) {
+      const uint64_t begin = current >> 32u;
+      const uint64_t end = current & 0xFFFFFFFFu;
+      if (begin >= end) {
+        break;
+      }
+      // 从后端拿走一半（至少一个），前端留给原线程继续顺序处理。
+      const uint64_t stolen = (end - begin + 1u) / 2u;
+      if (range.compare_exchange_weak(current, Pack(begin, end - stolen),
+                                      std::memory_order_acq_rel,
+                                      std::memory_order_acquire)) {
+        // 自己的区间此时必定为空，其他线程不会对它做 CAS，可以直接写入。
+        _ranges[thief]->range.store(Pack(end - stolen, end), std::memory_order_release);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+void StageExecutor::Execute(const unsigned worker) {
+  const Task &task = *_task;
+  unsigned long index = 0u;
+  for (;;) {
+    while (PopFront(worker, index)) {
+      try {
+        task(index);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_exception) {
+          _exception = std::current_exception();
+        }
+      }
+    }
+    if (!Steal(worker)) {
+      return;
+    }
+  }
+}
+
+void StageExecutor::WorkerLoop(const unsigned worker, uint64_t seen_generation) {
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(_mutex);
+      _start_trigger.wait(lock, [&]() { return _stop || _generation != seen_generation; });
+      if (_stop) {
+        return;
+      }
+      seen_generation = _generation;
+    }
+
+    Execute(worker);
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      --_pending_workers;
+    }
+    _end_trigger.notify_one();
+  }
+}
+
+} // namespace traffic_manager
+} // namespace carla
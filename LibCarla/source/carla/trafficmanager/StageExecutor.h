@@ -0,0 +1,103 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "carla/NonCopyable.h"
+#include "carla/ThreadGroup.h"
+
+namespace carla {
+namespace traffic_manager {
+
+/// 以工作窃取方式并行执行各阶段 Update(index) 调用的执行器。
+///
+/// 每次 ParallelFor 会把 [0, count) 平均切分给各个工作线程（调用线程本身作为第 0 号工作线程），
+/// 线程从自己区间的前端取任务，自己的区间耗尽后从其他线程区间的后端窃取一半。
+/// 执行器本身不保证任何顺序，确定性由各阶段保证：并行调用期间每个 index 只写入属于自己的输出槽，
+/// 共享状态的修改推迟到单线程的 CommitCycle() 中按 index 顺序提交。
+class StageExecutor : private NonCopyable {
+public:
+
+  using Task = std::function<void(const unsigned long)>;
+
+  /// @param number_of_workers 工作线程数（包括调用线程），0 表示使用硬件并发数
+  explicit StageExecutor(const unsigned number_of_workers = 1u);
+
+  ~StageExecutor();
+
+  /// 修改工作线程数，只能在两次 ParallelFor 之间由调用线程调用。数量未变化时不做任何事。
+  void SetNumberOfWorkers(const unsigned number_of_workers);
+
+  unsigned GetNumberOfWorkers() const {
+    return _number_of_workers;
+  }
+
+  /// 对 [0, count) 中的每个 index 调用 task，所有调用完成后返回。
+  /// 任意一次调用抛出的异常会在所有工作线程停止后于调用线程重新抛出。
+  void ParallelFor(const unsigned long count, const Task &task);
+
+private:
+
+  /// 打包的 [begin, end) 区间，高 32 位为 begin，低 32 位为 end，使取任务与窃取都只需一次 CAS。
+  struct alignas(64) WorkRange {
+    std::atomic<uint64_t> range{0u};
+  };
+
+  static uint64_t Pack(const uint64_t begin, const uint64_t end) {
+    return (begin << 32u) | end;
+  }
+
+  /// 从自己区间的前端取出一个 index。
+  bool PopFront(const unsigned worker, unsigned long &index);
+
+  /// 从其他线程区间的后端窃取一半任务放入自己的区间。
+  bool Steal(const unsigned thief);
+
+  /// 执行任务直到所有区间都为空。
+  void Execute(const unsigned worker);
+
+  /// 后台工作线程主循环，seen_generation 为线程创建时的批次号。
+  void WorkerLoop(const unsigned worker, uint64_t seen_generation);
+
+  void StartWorkers();
+
+  void StopWorkers();
+
+  unsigned _number_of_workers = 1u;
+
+  std::vector<std::unique_ptr<WorkRange>> _ranges;
+
+  ThreadGroup _workers;
+
+  std::mutex _mutex;
+
+  std::condition_variable _start_trigger;
+
+  std::condition_variable _end_trigger;
+
+  /// 每次 ParallelFor 递增，后台线程据此判断是否有新任务。
+  uint64_t _generation = 0u;
+
+  unsigned _pending_workers = 0u;
+
+  bool _stop = false;
+
+  const Task *_task = nullptr;
+
+  std::exception_ptr _exception;
+};
+
+} // namespace traffic_manager
+} // namespace carla
@@ -3,6 +3,8 @@
 
 #include "carla/trafficmanager/TrackTraffic.h"
 
+#include <algorithm>
+
 namespace carla {
 namespace traffic_manager {
 // 使用命名空间中的常量
@@ -16,90 +18,169 @@ void TrackTraffic::UpdateUnregisteredGridPosition(const ActorId actor_id,
 // 删除指定参与者的现有信息
     DeleteActor(actor_id);
 
-    std::unordered_set<GeoGridId> current_grids;
-    // Step through waypoints and update grid list for actor and actor list for grids.
+    // 逐个加入航点，更新参与者的网格列表和网格的参与者列表
     for (auto &waypoint : waypoints) {
-    	 // 更新经过的车辆信息
-        UpdatePassingVehicle(waypoint->GetId(), actor_id);
-// 获取路点的地理网格 ID
-        GeoGridId ggid = waypoint->GetGeodesicGridId();
-        // 将网格 ID 插入当前网格集合
-        current_grids.insert(ggid);
-// 如果网格到参与者的映射中存在该网格 ID
-        if (grid_to_actors.find(ggid) != grid_to_actors.end()) {
-        	// 获取对应网格的参与者集合
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            // 如果参与者 ID 不在集合中，插入参与者 ID
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
+        AddBufferWaypoint(actor_id, waypoint->GetId(), waypoint->GetGeodesicGridId());
+    }
+}
+
+bool TrackTraffic::Defer(const ActorId actor_id, const DeferredUpdate &update) {
+    if (!deferred_updates) {
+        return false;
+    }
+    auto slot = deferred_slot.find(actor_id);
+    if (slot == deferred_slot.end()) {
+        return false;
+    }
+    deferred_log[slot->second].push_back(update);
+    return true;
+}
+
+void TrackTraffic::BeginDeferredUpdates(const std::vector<ActorId> &actor_ids) {
+    deferred_slot.clear();
+    deferred_slot.reserve(actor_ids.size());
+    // 保留各槽位已分配的容量，避免每一帧重新分配
+    if (deferred_log.size() < actor_ids.size()) {
+        deferred_log.resize(actor_ids.size());
+    }
+    for (std::size_t i = 0u; i < actor_ids.size(); ++i) {
+        deferred_slot.insert({actor_ids[i], i});
+        deferred_log[i].clear();
+    }
+    deferred_updates = true;
+}
+
+void TrackTraffic::CommitDeferredUpdates() {
+    if (!deferred_updates) {
+        return;
+    }
+    deferred_updates = false;
+    const std::size_t number_of_slots = deferred_slot.size();
+    std::vector<ActorId> slot_to_actor(number_of_slots);
+    for (const auto &slot : deferred_slot) {
+        slot_to_actor[slot.second] = slot.first;
+    }
+    // 按列表顺序重放，结果与串行执行各参与者的更新完全相同
+    for (std::size_t i = 0u; i < number_of_slots; ++i) {
+        const ActorId actor_id = slot_to_actor[i];
+        for (const DeferredUpdate &update : deferred_log[i]) {
+            switch (update.type) {
+                case DeferredUpdate::Type::PassingVehicle:
+                    UpdatePassingVehicle(update.waypoint_id, actor_id);
+                    break;
+                case DeferredUpdate::Type::RemovePassingVehicle:
+                    RemovePassingVehicle(update.waypoint_id, actor_id);
+                    break;
+                case DeferredUpdate::Type::AddBufferWaypoint:
+                    AddBufferWaypoint(actor_id, update.waypoint_id, update.grid_id);
+                    break;
+                case DeferredUpdate::Type::RemoveBufferWaypoint:
+                    RemoveBufferWaypoint(actor_id, update.waypoint_id, update.grid_id);
+                    break;
+                case DeferredUpdate::Type::GridPosition:
+                    UpdateGridPosition(actor_id, *update.buffer);
+                    break;
             }
-        } else {
-        	// 如果映射中不存在该网格 ID，创建新的映射关系
-            grid_to_actors.insert({ggid, {actor_id}});
         }
+        deferred_log[i].clear();
     }
-// 将参与者 ID 和当前网格集合插入参与者到网格的映射中
-    actor_to_grids.insert({actor_id, current_grids});
+    deferred_slot.clear();
 }
 
-void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
-	// 如果缓冲区不为空
-    if (!buffer.empty()) {
-
-        // Clear current actor from all grids containing itself.
-        if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-            std::unordered_set<GeoGridId> &current_grids = actor_to_grids.at(actor_id);
-            // 遍历当前参与者所在的网格集合
-            for (auto &grid_id : current_grids) {
-            	// 如果网格到参与者的映射中存在该网格 ID
-                if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-                	// 获取对应网格的参与者集合
-                    ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                    // 从集合中删除该参与者 ID
-                    actor_ids.erase(actor_id);
+void TrackTraffic::AddGridWaypoint(ActorTrack &track, const ActorId actor_id, const GeoGridId grid_id) {
+    ++track.grid_waypoints;
+    for (GridCount &grid : track.grids) {
+        if (grid.grid_id == grid_id) {
+            ++grid.count;
+            return;
+        }
+    }
+    // 参与者第一次进入该网格
+    track.grids.push_back({grid_id, 1u});
+    ActorIdList &actor_ids = grid_to_actors[grid_id];
+    if (std::find(actor_ids.begin(), actor_ids.end(), actor_id) == actor_ids.end()) {
+        actor_ids.push_back(actor_id);
+    }
+}
+
+void TrackTraffic::RemoveGridWaypoint(ActorTrack &track, const ActorId actor_id, const GeoGridId grid_id) {
+    for (auto grid = track.grids.begin(); grid != track.grids.end(); ++grid) {
+        if (grid->grid_id == grid_id) {
+            --track.grid_waypoints;
+            if (--grid->count == 0u) {
+                // 参与者的路径离开了该网格
+                *grid = track.grids.back();
+                track.grids.pop_back();
+                ActorIdList *actor_ids = grid_to_actors.Find(grid_id);
+                if (actor_ids != nullptr) {
+                    actor_ids->erase(std::remove(actor_ids->begin(), actor_ids->end(), actor_id), actor_ids->end());
                 }
             }
-// 从参与者到网格的映射中删除该参与者
-            actor_to_grids.erase(actor_id);
+            return;
         }
+    }
+}
 
-        // Step through buffer and update grid list for actor and actor list for grids.
-        std::unordered_set<GeoGridId> current_grids;
-        uint64_t buffer_size = buffer.size();
-        // 遍历缓冲区中的路点
-        for (uint64_t i = 0u; i <= buffer_size - 1u; ++i) {
-            auto waypoint = buffer.at(i);
-            GeoGridId ggid = waypoint->GetGeodesicGridId();
-            current_grids.insert(ggid);
-            // Add grid entry if not present.
-            if (grid_to_actors.find(ggid) == grid_to_actors.end()) {
-                grid_to_actors.insert({ggid, {}});
-            }
-// 获取对应网格的参与者集合
-            ActorIdSet &actor_ids = grid_to_actors.at(ggid);
-            // 如果参与者 ID 不在集合中，插入参与者 ID
-            if (actor_ids.find(actor_id) == actor_ids.end()) {
-                actor_ids.insert(actor_id);
-            }
+void TrackTraffic::ClearGrids(ActorTrack &track, const ActorId actor_id) {
+    for (const GridCount &grid : track.grids) {
+        ActorIdList *actor_ids = grid_to_actors.Find(grid.grid_id);
+        if (actor_ids != nullptr) {
+            actor_ids->erase(std::remove(actor_ids->begin(), actor_ids->end(), actor_id), actor_ids->end());
         }
-// 将参与者 ID 和当前网格集合插入参与者到网格的映射中
-        actor_to_grids.insert({actor_id, current_grids});
     }
+    track.grids.clear();
+    track.grid_waypoints = 0u;
 }
 
+void TrackTraffic::AddBufferWaypoint(ActorId actor_id, uint64_t waypoint_id, GeoGridId grid_id) {
+    if (Defer(actor_id, {DeferredUpdate::Type::AddBufferWaypoint, waypoint_id, grid_id, nullptr})) {
+        return;
+    }
+    UpdatePassingVehicle(waypoint_id, actor_id);
+    AddGridWaypoint(actor_tracks[actor_id], actor_id, grid_id);
+}
 
-bool TrackTraffic::IsGeoGridFree(const GeoGridId geogrid_id) const {
-    if (grid_to_actors.find(geogrid_id) != grid_to_actors.end()) {
-        return grid_to_actors.at(geogrid_id).empty();
+void TrackTraffic::RemoveBufferWaypoint(ActorId actor_id, uint64_t waypoint_id, GeoGridId grid_id) {
+    if (Defer(actor_id, {DeferredUpdate::Type::RemoveBufferWaypoint, waypoint_id, grid_id, nullptr})) {
+        return;
+    }
+    RemovePassingVehicle(waypoint_id, actor_id);
+    ActorTrack *track = actor_tracks.Find(actor_id);
+    if (track != nullptr) {
+        RemoveGridWaypoint(*track, actor_id, grid_id);
     }
-    return true;
+}
+
+void TrackTraffic::UpdateGridPosition(const ActorId actor_id, const Buffer &buffer) {
+    if (Defer(actor_id, {DeferredUpdate::Type::GridPosition, 0u, 0, &buffer})) {
+        return;
+    }
+    // 缓冲区为空时保留之前的网格
+    if (buffer.empty()) {
+        return;
+    }
+    ActorTrack &track = actor_tracks[actor_id];
+    // 缓冲区的修改都已按增量计入时无需重新计算
+    if (track.grid_waypoints == buffer.size()) {
+        return;
+    }
+    ClearGrids(track, actor_id);
+    for (const SimpleWaypointPtr &waypoint : buffer) {
+        AddGridWaypoint(track, actor_id, waypoint->GetGeodesicGridId());
+    }
+}
+
+
+bool TrackTraffic::IsGeoGridFree(const GeoGridId geogrid_id) const {
+    const ActorIdList *actor_ids = grid_to_actors.Find(geogrid_id);
+    return actor_ids == nullptr || actor_ids->empty();
 }
 
 void TrackTraffic::AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id) {
 	// 如果网格到参与者的映射中不存在该网格 ID
-    if (grid_to_actors.find(geogrid_id) == grid_to_actors.end()) {
-    	// 创建新的映射关系（网格 ID 到包含该演员 ID 的集合）
-        grid_to_actors.insert({geogrid_id, {actor_id}});
+    if (!grid_to_actors.Contains(geogrid_id)) {
+    	// 创建新的映射关系（网格 ID 到包含该演员 ID 的列表）
+        grid_to_actors[geogrid_id].push_back(actor_id);
     }
 }
 
@@ -112,116 +193,111 @@ cg::Location TrackTraffic::GetHeroLocation() const {
     return hero_location;
 }
 
-ActorIdSet TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
-    ActorIdSet actor_id_set;
-// 如果参与者在参与者到网格的映射中
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        const std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        // 遍历参与者所在的网格集合
-        for (auto &grid_id : grid_ids) {
-        	// 如果网格到参与者的映射中存在该网格 ID
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-            	 // 获取对应网格的参与者集合
-                const ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                 // 将集合中的参与者 ID 插入结果集合
-                actor_id_set.insert(actor_ids.begin(), actor_ids.end());
+std::vector<ActorId> TrackTraffic::GetOverlappingVehicles(ActorId actor_id) const {
+    std::vector<ActorId> actor_ids;
+    const ActorTrack *track = actor_tracks.Find(actor_id);
+    if (track != nullptr) {
+        // 合并参与者所在各网格中的参与者
+        for (const GridCount &grid : track->grids) {
+            const ActorIdList *grid_actor_ids = grid_to_actors.Find(grid.grid_id);
+            if (grid_actor_ids != nullptr) {
+                actor_ids.insert(actor_ids.end(), grid_actor_ids->begin(), grid_actor_ids->end());
             }
         }
+        std::sort(actor_ids.begin(), actor_ids.end());
+        actor_ids.erase(std::unique(actor_ids.begin(), actor_ids.end()), actor_ids.end());
     }
-
-    return actor_id_set;
+    return actor_ids;
 }
 
 void TrackTraffic::DeleteActor(ActorId actor_id) {
-	// 如果参与者在参与者到网格的映射中
-    if (actor_to_grids.find(actor_id) != actor_to_grids.end()) {
-        std::unordered_set<GeoGridId> &grid_ids = actor_to_grids.at(actor_id);
-        // 遍历参与者所在的网格集合
-        for (auto &grid_id : grid_ids) {
-        	// 如果网格到参与者的映射中存在该网格 ID
-            if (grid_to_actors.find(grid_id) != grid_to_actors.end()) {
-            	// 获取对应网格的参与者集合
-                ActorIdSet &actor_ids = grid_to_actors.at(grid_id);
-                // 从集合中删除该参与者 ID
-                actor_ids.erase(actor_id);
-                }
+    ActorTrack *track = actor_tracks.Find(actor_id);
+    if (track == nullptr) {
+        return;
+    }
+    // 从参与者所在的网格中删除该参与者
+    ClearGrids(*track, actor_id);
+    // 从参与者占用的航点中删除该参与者
+    for (const uint64_t waypoint_id : track->occupied_waypoints) {
+        ActorIdList *actor_ids = waypoint_overlap_tracker.Find(waypoint_id);
+        if (actor_ids != nullptr) {
+            actor_ids->erase(std::remove(actor_ids->begin(), actor_ids->end(), actor_id), actor_ids->end());
+            if (actor_ids->empty()) {
+                waypoint_overlap_tracker.Erase(waypoint_id);
             }
-            // 从参与者到网格的映射中删除该参与者
-        actor_to_grids.erase(actor_id);
-    }
-// 如果参与者在路点占用的映射中
-    if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
-        WaypointIdSet waypoint_id_set = waypoint_occupied.at(actor_id);
-        // 遍历参与者占用的路点 ID 集合
-        for (const uint64_t &waypoint_id : waypoint_id_set) {
-        	// 移除经过的车辆
-            RemovePassingVehicle(waypoint_id, actor_id);
         }
     }
+    actor_tracks.Erase(actor_id);
 }
 
 void TrackTraffic::UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id) {
-	 // 如果路点重叠追踪器中存在该路点 ID
-    if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
-    	// 获取对应路点的参与者集合
-        ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_id);
-        // 如果参与者 ID 不在集合中，插入参与者 ID
-        if (actor_id_set.find(actor_id) == actor_id_set.end()) {
-            actor_id_set.insert(actor_id);
-        }
-    } else {
-    	// 如果路点重叠追踪器中不存在该路点 ID，创建新的映射关系
-        waypoint_overlap_tracker.insert({waypoint_id, {actor_id}});
-    }
-// 如果参与者在路点占用的映射中
-    if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
-    	// 获取对应参与者的路点 ID 集合
-        WaypointIdSet &waypoint_id_set = waypoint_occupied.at(actor_id);
-        // 如果路点 ID 不在集合中，插入路点 ID
-        if (waypoint_id_set.find(waypoint_id) == waypoint_id_set.end()) {
-            waypoint_id_set.insert(waypoint_id);
-        }
-    } else {
-    	// 如果参与者不在路点占用的映射中，创建新的映射关系
-        waypoint_occupied.insert({actor_id, {waypoint_id}});
+    if (Defer(actor_id, {DeferredUpdate::Type::PassingVehicle, waypoint_id, 0, nullptr})) {
+        return;
+    }
+    ActorIdList &actor_ids = waypoint_overlap_tracker[waypoint_id];
+    // 参与者已经在经过该航点时不重复记录
+    if (std::find(actor_ids.begin(), actor_ids.end(), actor_id) == actor_ids.end()) {
+        actor_ids.push_back(actor_id);
+        actor_tracks[actor_id].occupied_waypoints.push_back(waypoint_id);
     }
 }
 
 void TrackTraffic::RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id) {
-	// 如果路点重叠追踪器中存在该路点 ID
-    if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
-        ActorIdSet &actor_id_set = waypoint_overlap_tracker.at(waypoint_id);
-        actor_id_set.erase(actor_id);
-// 如果集合为空，从路点重叠追踪器中删除该路点 ID
-        if (actor_id_set.size() == 0) {
-            waypoint_overlap_tracker.erase(waypoint_id);
-        }
+    if (Defer(actor_id, {DeferredUpdate::Type::RemovePassingVehicle, waypoint_id, 0, nullptr})) {
+        return;
+    }
+    ActorIdList *actor_ids = waypoint_overlap_tracker.Find(waypoint_id);
+    if (actor_ids == nullptr) {
+        return;
+    }
+    auto position = std::find(actor_ids->begin(), actor_ids->end(), actor_id);
+    if (position == actor_ids->end()) {
+        return;
+    }
+    actor_ids->erase(position);
+    // 如果列表为空，从路点重叠追踪器中删除该路点 ID
+    if (actor_ids->empty()) {
+        waypoint_overlap_tracker.Erase(waypoint_id);
     }
-// 如果参与者在路点占用的映射中
-    if (waypoint_occupied.find(actor_id) != waypoint_occupied.end()) {
-        WaypointIdSet &waypoint_id_set = waypoint_occupied.at(actor_id);
-        waypoint_id_set.erase(waypoint_id);
-// 如果集合为空，从参与者占用的映射中删除该参与者 ID
-        if (waypoint_id_set.size() == 0) {
-            waypoint_occupied.erase(actor_id);
+
+    ActorTrack *track = actor_tracks.Find(actor_id);
+    if (track != nullptr) {
+        // 航点通常从缓冲区前端弹出，其次是后端
+        std::deque<uint64_t> &occupied = track->occupied_waypoints;
+        if (!occupied.empty() && occupied.front() == waypoint_id) {
+            occupied.pop_front();
+        } else if (!occupied.empty() && occupied.back() == waypoint_id) {
+            occupied.pop_back();
+        } else {
+            auto occupied_position = std::find(occupied.begin(), occupied.end(), waypoint_id);
+            if (occupied_position != occupied.end()) {
+                occupied.erase(occupied_position);
+            }
         }
     }
 }
 
 ActorIdSet TrackTraffic::GetPassingVehicles(uint64_t waypoint_id) const {
-
-    if (waypoint_overlap_tracker.find(waypoint_id) != waypoint_overlap_tracker.end()) {
-        return waypoint_overlap_tracker.at(waypoint_id);
+    const ActorIdList *actor_ids = waypoint_overlap_tracker.Find(waypoint_id);
+    if (actor_ids != nullptr) {
+        return ActorIdSet(actor_ids->begin(), actor_ids->end());
     } else {
         return ActorIdSet();
     }
 }
+
+bool TrackTraffic::HasPassingVehicles(uint64_t waypoint_id) const {
+    const ActorIdList *actor_ids = waypoint_overlap_tracker.Find(waypoint_id);
+    return actor_ids != nullptr && !actor_ids->empty();
+}
+
 // 清空所有数据结构
 void TrackTraffic::Clear() {
-    waypoint_overlap_tracker.clear();
-    waypoint_occupied.clear();
-    actor_to_grids.clear();
-    grid_to_actors.clear();
+    deferred_updates = false;
+    deferred_slot.clear();
+    waypoint_overlap_tracker.Clear();
+    actor_tracks.Clear();
+    grid_to_actors.Clear();
 }
 
 } // namespace traffic_manager
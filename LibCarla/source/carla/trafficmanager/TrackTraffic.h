@@ -1,9 +1,15 @@
 
 #pragma once
 
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "carla/road/RoadTypes.h"
 #include "carla/rpc/ActorId.h"
 
+#include "carla/trafficmanager/FlatHashMap.h"
 #include "carla/trafficmanager/SimpleWaypoint.h"
 
 namespace carla {
@@ -19,22 +25,64 @@ using GeoGridId = carla::road::JuncId;
 class TrackTraffic {
 
 private:
-    /// 用于跟踪车辆间重叠航点的结构
-    using WaypointOverlap = std::unordered_map<uint64_t, ActorIdSet>;
-    WaypointOverlap waypoint_overlap_tracker;
-
-    /// 用于跟踪车辆所占用航点的结构
-    using WaypointIdSet = std::unordered_set<uint64_t>;
-    using WaypointOccupancyMap = std::unordered_map<ActorId, WaypointIdSet>;
-    WaypointOccupancyMap waypoint_occupied;
-
-    /// 参与者路径所占据的测地线网格
-    std::unordered_map<ActorId, std::unordered_set<GeoGridId>> actor_to_grids;
-    /// 参与者当前经过的网格
-    std::unordered_map<GeoGridId, ActorIdSet> grid_to_actors;
+    using ActorIdList = std::vector<ActorId>;
+
+    /// 用于跟踪车辆间重叠航点的结构，值为经过该航点的车辆（无重复）
+    FlatHashMap<uint64_t, ActorIdList> waypoint_overlap_tracker;
+
+    /// 参与者路径在某个测地线网格中的航点数量
+    struct GridCount {
+        GeoGridId grid_id;
+        uint32_t count;
+    };
+
+    /// 每个参与者的跟踪状态
+    struct ActorTrack {
+        /// 参与者占用的航点，按加入顺序排列，便于从缓冲区前端或后端弹出时快速删除
+        std::deque<uint64_t> occupied_waypoints;
+        /// 参与者路径所占据的测地线网格及其中的航点数量
+        std::vector<GridCount> grids;
+        /// 计入 grids 的航点总数，用于检查与缓冲区是否一致
+        uint64_t grid_waypoints = 0u;
+    };
+    FlatHashMap<ActorId, ActorTrack> actor_tracks;
+
+    /// 参与者当前经过的网格，值为网格中的参与者（无重复）
+    FlatHashMap<GeoGridId, ActorIdList> grid_to_actors;
     /// 当前英雄位置
     cg::Location hero_location = cg::Location(0,0,0);
 
+    /// 并行阶段中推迟执行的修改操作
+    struct DeferredUpdate {
+        enum class Type : uint8_t {
+            PassingVehicle,
+            RemovePassingVehicle,
+            AddBufferWaypoint,
+            RemoveBufferWaypoint,
+            GridPosition
+        };
+        Type type;
+        uint64_t waypoint_id;
+        GeoGridId grid_id;
+        const Buffer *buffer;
+    };
+    /// 是否处于推迟修改模式
+    bool deferred_updates = false;
+    /// 参与者到其修改日志槽位的映射，只在推迟修改模式开始时写入
+    std::unordered_map<ActorId, std::size_t> deferred_slot;
+    /// 每个参与者的修改日志，每个槽位只被处理该参与者的线程写入
+    std::vector<std::vector<DeferredUpdate>> deferred_log;
+
+    /// 如果处于推迟修改模式且参与者有槽位，则把操作记入日志并返回 true
+    bool Defer(const ActorId actor_id, const DeferredUpdate &update);
+
+    /// 参与者路径在网格中的航点数量增加或减少一个，数量在零与非零之间变化时更新网格索引
+    void AddGridWaypoint(ActorTrack &track, const ActorId actor_id, const GeoGridId grid_id);
+    void RemoveGridWaypoint(ActorTrack &track, const ActorId actor_id, const GeoGridId grid_id);
+
+    /// 将参与者从其所有网格中移除
+    void ClearGrids(ActorTrack &track, const ActorId actor_id);
+
 
 public:
     TrackTraffic();
@@ -43,12 +91,21 @@ public:
     void UpdatePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
     void RemovePassingVehicle(uint64_t waypoint_id, ActorId actor_id);
     ActorIdSet GetPassingVehicles(uint64_t waypoint_id) const;
+    bool HasPassingVehicles(uint64_t waypoint_id) const;
 
+    /// 参与者的缓冲区前端或后端加入或弹出一个航点时调用，
+    /// 同时更新经过该航点的车辆和参与者所占据的网格，只处理变化的部分。
+    void AddBufferWaypoint(ActorId actor_id, uint64_t waypoint_id, GeoGridId grid_id);
+    void RemoveBufferWaypoint(ActorId actor_id, uint64_t waypoint_id, GeoGridId grid_id);
+
+    /// 确认参与者所占据的网格与缓冲区一致。缓冲区的所有修改都经过
+    /// AddBufferWaypoint/RemoveBufferWaypoint 时无需任何操作，否则按缓冲区重新计算。
     void UpdateGridPosition(const ActorId actor_id, const Buffer &buffer);
     void UpdateUnregisteredGridPosition(const ActorId actor_id,
                                         const std::vector<SimpleWaypointPtr> waypoints);
 
-    ActorIdSet GetOverlappingVehicles(ActorId actor_id) const;
+    /// 返回与参与者路径共享网格的所有参与者（包括其自身），按ID升序排列且无重复。
+    std::vector<ActorId> GetOverlappingVehicles(ActorId actor_id) const;
     bool IsGeoGridFree(const GeoGridId geogrid_id) const;
     void AddTakenGrid(const GeoGridId geogrid_id, const ActorId actor_id);
 
@@ -56,6 +113,14 @@ public:
     cg::Location GetHeroLocation() const;
 
 
+    /// 开始推迟修改模式。之后列表中参与者的 UpdatePassingVehicle、RemovePassingVehicle、
+    /// AddBufferWaypoint、RemoveBufferWaypoint 和 UpdateGridPosition 只记录到各自的日志中，查询方法继续返回开始时的状态，
+    /// 因此不同参与者的更新可以并行进行。
+    void BeginDeferredUpdates(const std::vector<ActorId> &actor_ids);
+    /// 按参与者列表的顺序重放所有推迟的修改并退出推迟修改模式，必须由单线程调用。
+    /// GridPosition 操作在重放时读取缓冲区，调用者需保证缓冲区在此之前未被释放。
+    void CommitDeferredUpdates();
+
     /// 从跟踪中删除参与者数据的方法
     void DeleteActor(ActorId actor_id);
 
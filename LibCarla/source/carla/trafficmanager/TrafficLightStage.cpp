@@ -30,11 +30,19 @@ TrafficLightStage::TrafficLightStage(
     output_array(output_array), // 初始化输出数组
     random_device(random_device) {} // 初始化随机数生成器
 
+void TrafficLightStage::PrepareCycle() {
+  current_timestamp = world.GetSnapshot().GetTimestamp(); // 获取当前时间戳
+  junction_decisions.assign(vehicle_id_list.size(), {JunctionAction::None, -1});
+}
+
 // 更新函数
+// 只读取路口映射中当前车辆自己的条目，对路口映射的修改记录在 junction_decisions 中
 void TrafficLightStage::Update(const unsigned long index) {
   bool traffic_light_hazard = false; // 交通信号灯危险标志
+  JunctionDecision &decision = junction_decisions.at(index);
 
   const ActorId ego_actor_id = vehicle_id_list.at(index); // 获取当前车辆 ID
+  const VehicleParameters &ego_parameters = parameters.GetSnapshot().GetVehicle(index);
   if (!simulation_state.IsDormant(ego_actor_id)) { // 如果车辆不处于休眠状态
 
     JunctionID current_junction_id = -1; // 当前交叉口 ID 初始化为 -1
@@ -43,8 +51,6 @@ void TrafficLightStage::Update(const unsigned long index) {
     }
     auto affected_junction_id = GetAffectedJunctionId(ego_actor_id); // 获取受影响的交叉口 ID
 
-    current_timestamp = world.GetSnapshot().GetTimestamp(); // 获取当前时间戳
-
     const TrafficLightState tl_state = simulation_state.GetTLS(ego_actor_id); // 获取交通信号灯状态
     const TLS traffic_light_state = tl_state.tl_state; // 交通信号灯当前状态
     const bool is_at_traffic_light = tl_state.at_traffic_light; // 判断是否在交通信号灯处
@@ -53,10 +59,10 @@ void TrafficLightStage::Update(const unsigned long index) {
     if (is_at_traffic_light &&
         traffic_light_state != TLS::Green &&
         traffic_light_state != TLS::Off &&
-        parameters.GetPercentageRunningLight(ego_actor_id) <= random_device.next()) {
+        ego_parameters.perc_run_traffic_light <= random_device.next(ego_actor_id)) {
       // 如果车辆在受交通信号灯影响的非信号交叉口，移除车辆
       if (current_junction_id != -1) {
-        RemoveActor(ego_actor_id);
+        decision = {JunctionAction::RemoveActor, current_junction_id};
       }
       traffic_light_hazard = true; // 设置交通信号灯危险标志为真
     }
@@ -64,24 +70,45 @@ void TrafficLightStage::Update(const unsigned long index) {
     // 不要使用下一个条件，因为边界框可能会变为绿色
     else if (current_junction_id != -1) {
       if (affected_junction_id == -1 || affected_junction_id != current_junction_id) {
-        RemoveActor(ego_actor_id); // 移除车辆
+        decision = {JunctionAction::RemoveActor, current_junction_id}; // 移除车辆
       } else {
-        traffic_light_hazard = HandleNonSignalisedJunction(ego_actor_id, affected_junction_id, current_timestamp); // 处理非信号交叉口
+        // 优先级取决于同一路口其他车辆的到达顺序，在 CommitCycle 中处理
+        decision = {JunctionAction::HandleJunction, affected_junction_id};
       }
     }
     // 如果在受影响的交叉口且不在交通信号灯处
     else if (affected_junction_id != -1 &&
             !is_at_traffic_light &&
             traffic_light_state != TLS::Green &&
-            parameters.GetPercentageRunningSign(ego_actor_id) <= random_device.next()) {
+            ego_parameters.perc_run_traffic_sign <= random_device.next(ego_actor_id)) {
 
-      AddActorToNonSignalisedJunction(ego_actor_id, affected_junction_id); // 将车辆添加到非信号交叉口
+      decision = {JunctionAction::AddActor, affected_junction_id}; // 将车辆添加到非信号交叉口
       traffic_light_hazard = true; // 设置交通信号灯危险标志为真
     }
   }
   output_array.at(index) = traffic_light_hazard; // 将结果输出到数组
 }
 
+void TrafficLightStage::CommitCycle() {
+  for (unsigned long index = 0u; index < junction_decisions.size(); ++index) {
+    const JunctionDecision &decision = junction_decisions.at(index);
+    const ActorId ego_actor_id = vehicle_id_list.at(index);
+    switch (decision.action) {
+      case JunctionAction::None:
+        break;
+      case JunctionAction::RemoveActor:
+        RemoveActor(ego_actor_id);
+        break;
+      case JunctionAction::HandleJunction:
+        output_array.at(index) = HandleNonSignalisedJunction(ego_actor_id, decision.junction_id, current_timestamp);
+        break;
+      case JunctionAction::AddActor:
+        AddActorToNonSignalisedJunction(ego_actor_id, decision.junction_id);
+        break;
+    }
+  }
+}
+
 // 将车辆添加到非信号交叉口的函数
 void TrafficLightStage::AddActorToNonSignalisedJunction(const ActorId ego_actor_id, const JunctionID junction_id) {
 
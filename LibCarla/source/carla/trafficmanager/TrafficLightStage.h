@@ -29,7 +29,20 @@ private:
   std::unordered_map<ActorId, cc::Timestamp> vehicle_stop_time;    // 车辆 ID 到时间戳的无序映射
   TLFrame &output_array;   // 输出数组的引用
   RandomGenerator &random_device;        // 随机数生成器的引用
-  cc::Timestamp current_timestamp; // 当前时间戳
+  cc::Timestamp current_timestamp; // 当前时间戳，每个周期开始时获取一次
+
+  // 并行更新期间对无信号灯路口映射的操作，推迟到 CommitCycle 中按 index 顺序执行
+  enum class JunctionAction : uint8_t {
+    None,                 // 不操作路口映射
+    RemoveActor,          // 将车辆从路口映射中移除
+    HandleJunction,       // 按到达顺序处理车辆在无信号灯路口的优先级
+    AddActor              // 将车辆加入无信号灯路口映射
+  };
+  struct JunctionDecision {
+    JunctionAction action;
+    JunctionID junction_id;
+  };
+  std::vector<JunctionDecision> junction_decisions; // 每个 index 的推迟操作
 
   // 这个函数控制所有车辆在无信号灯路口的交互。优先级按照到达顺序确定，并且没有两辆车会同时进入路口。只有当前一辆车离开后，下一辆车才能进入。此外，所有车辆在停车标志处总是会刹车一段时间。
   bool HandleNonSignalisedJunction(const ActorId ego_actor_id, const JunctionID junction_id,
@@ -51,7 +64,11 @@ public:
                     RandomGenerator &random_device);
 // 构造函数
 
-  void Update(const unsigned long index) override;     // 重写的更新函数
+  void Update(const unsigned long index) override;     // 重写的更新函数，不同 index 可以并行调用
+
+  void PrepareCycle() override;    // 获取本周期的时间戳并准备推迟操作
+
+  void CommitCycle() override;     // 按 index 顺序执行无信号灯路口的推迟操作
 
   void RemoveActor(const ActorId actor_id) override;      // 重写的移除参与者函数
 
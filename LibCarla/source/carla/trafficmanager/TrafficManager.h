@@ -183,6 +183,56 @@ public:
     }
   }
 
+  /// @brief 设置并行执行各阶段的工作线程数。  
+/// 工作线程数不影响交通管理器的输出，只影响每个周期的耗时。  
+/// @param count 工作线程数，0 表示使用硬件并发数，默认为 1。
+  void SetWorkerThreadCount(const unsigned count) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if(tm_ptr != nullptr){
+      tm_ptr->SetWorkerThreadCount(count);
+    }
+  }
+
+  /// @brief 设置是否只发送变化超过容差的控制命令。  
+/// 启用后，与上一次发送的命令相比没有明显变化的车辆控制命令不再发送，
+/// 可以减少大量匀速行驶车辆时的 RPC 数据量与服务器端的批处理开销。  
+/// @param mode_switch 是否启用，默认为 false。  
+/// @param tolerance 油门、转向与刹车的容差。混合物理模式下的传送总是发送。
+  void SetControlFrameDiffing(const bool mode_switch, const float tolerance = 0.01f) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if(tm_ptr != nullptr){
+      tm_ptr->SetControlFrameDiffing(mode_switch, tolerance);
+    }
+  }
+
+  /// @brief 批量设置多辆车的同一个参数。  
+/// 与逐辆调用对应的设置方法效果相同，远程交通管理器只需要一次 RPC 调用。
+/// 开关类的参数以非零值表示启用。  
+/// @param parameter 要设置的参数。  
+/// @param values 车辆与参数值的列表。
+  void SetVehicleParameters(const VehicleParameter parameter, const std::vector<std::pair<ActorPtr, float>> &values) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if(tm_ptr != nullptr){
+      VehicleParameterList id_values;
+      id_values.reserve(values.size());
+      for (const auto &entry : values) {
+        id_values.emplace_back(entry.first->GetId(), entry.second);
+      }
+      tm_ptr->SetVehicleParameters(parameter, id_values);
+    }
+  }
+
+  /// @brief 设置批量参数是否以异步方式发送。  
+/// 只对连接到其他客户端的交通管理器的远程交通管理器有效，启用后
+/// SetVehicleParameters 发送后立即返回，不等待服务器应用参数。  
+/// @param mode_switch 是否启用，默认为 false。
+  void SetAsynchronousParameterUpdates(const bool mode_switch) {
+    TrafficManagerBase* tm_ptr = GetTM(_port);
+    if(tm_ptr != nullptr){
+      tm_ptr->SetAsynchronousParameterUpdates(mode_switch);
+    }
+  }
+
   /// @brief 向交通管理器注册车辆。  
 /// 此方法用于将一组车辆注册到TrafficManager中。  
 /// @param actor_list 要注册的车辆列表。
@@ -9,6 +9,7 @@
 #include <memory>
 #include "carla/client/Actor.h"/// @brief 包含CARLA客户端中Actor类的定义
 #include "carla/trafficmanager/SimpleWaypoint.h"/// @brief 包含CARLA交通管理器中SimpleWaypoint类的定义
+#include "carla/trafficmanager/VehicleParameter.h"/// @brief 包含可以批量设置的单车参数的定义
 /**
  * @namespace carla::traffic_manager
  * @brief CARLA交通管理器的命名空间。
@@ -280,6 +281,36 @@ public:
  */
   virtual void SetHybridPhysicsRadius(const float radius) = 0;
 
+  /**
+ * @brief 设置并行执行各阶段的工作线程数。
+ *
+ * @param count 工作线程数，0 表示使用硬件并发数。
+ */
+  virtual void SetWorkerThreadCount(const unsigned count) = 0;
+
+  /**
+ * @brief 设置是否只发送变化超过容差的控制命令。
+ *
+ * @param mode_switch 是否启用控制帧差分。
+ * @param tolerance 油门、转向与刹车的容差。
+ */
+  virtual void SetControlFrameDiffing(const bool mode_switch, const float tolerance) = 0;
+
+  /**
+ * @brief 批量设置多辆车的同一个参数。
+ *
+ * @param parameter 要设置的参数。
+ * @param values 车辆ID与参数值的列表。
+ */
+  virtual void SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values) = 0;
+
+  /**
+ * @brief 设置批量参数是否以异步方式发送，只对远程交通管理器有效。
+ *
+ * @param mode_switch 为true时发送后不等待服务器的回复。
+ */
+  virtual void SetAsynchronousParameterUpdates(const bool mode_switch) = 0;
+
   /**
  * @brief 设置随机化种子。
  *
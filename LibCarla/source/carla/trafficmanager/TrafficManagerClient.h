@@ -8,6 +8,7 @@
 
 #include "carla/trafficmanager/Constants.h"// 引入常量定义
 #include "carla/rpc/Actor.h"// 引入Actor类的定义
+#include "carla/trafficmanager/VehicleParameter.h"// 引入可以批量设置的单车参数
 
 #include <rpc/client.h>// 引入RPC客户端库
 
@@ -278,6 +279,29 @@ public:
     _client->call("set_hybrid_physics_radius", radius);/// 调用_client的call方法设置混合物理模式的半径
   }
 
+  /// 设置并行执行各阶段的工作线程数
+  void SetWorkerThreadCount(const unsigned count) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_worker_thread_count", count);/// 调用_client的call方法设置工作线程数
+  }
+
+  /// 设置是否只发送变化超过容差的控制命令
+  void SetControlFrameDiffing(const bool mode_switch, const float tolerance) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    _client->call("set_control_frame_diffing", mode_switch, tolerance);/// 调用_client的call方法设置控制帧差分
+  }
+
+  /// 批量设置多辆车的同一个参数
+  /// @param asynchronous 为true时以通知的形式发送，不等待服务器的回复
+  void SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values, const bool asynchronous) {
+    DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
+    if (asynchronous) {
+      _client->send("set_vehicle_parameters", parameter, values);/// 调用_client的send方法发送后立即返回
+    } else {
+      _client->call("set_vehicle_parameters", parameter, values);/// 调用_client的call方法等待参数生效
+    }
+  }
+
   /// 设置随机化种子
   void SetRandomDeviceSeed(const uint64_t seed) {
     DEBUG_ASSERT(_client != nullptr);/// 断言_client指针不为空
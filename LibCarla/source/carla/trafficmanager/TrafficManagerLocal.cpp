@@ -121,15 +121,16 @@ void TrafficManagerLocal::SetupLocalMap() {
   local_map = std::make_shared<InMemoryMap>(world_map);
  // 获取缓存的地图文件
   auto files = episode_proxy.Lock()->GetRequiredFiles("TM");
+  bool loaded = false;
   if (!files.empty()) {
-    auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
-    if (content.size() != 0) {
-      local_map->Load(content);
-    } else {
-      log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
-      local_map->SetUp();
+    // 缓存文件已在本地时直接映射到内存，否则按原方式读取或下载
+    loaded = local_map->LoadFromFileCache(files[0]);
+    if (!loaded) {
+      auto content = episode_proxy.Lock()->GetCacheFile(files[0], true);
+      loaded = content.size() != 0 && local_map->Load(content);
     }
-  } else {
+  }
+  if (!loaded) {
     log_warning("No InMemoryMap cache found. Setting up local map. This may take a while...");
     local_map->SetUp();
   }
@@ -200,7 +201,10 @@ void TrafficManagerLocal::Run() {
         collision_frame.reserve(new_frame_capacity);
         tl_frame.reserve(new_frame_capacity);
         control_frame.reserve(new_frame_capacity);
+        control_batch.reserve(2 * new_frame_capacity);
       }
+      // 丢弃已注销车辆最后发送的命令
+      control_frame_filter.Retain(vehicle_id_list);
 
       registered_vehicles_state = registered_vehicles.GetState();
     }
@@ -220,31 +224,49 @@ void TrafficManagerLocal::Run() {
     // 这将在运动规划阶段插入
     control_frame.resize(number_of_vehicles);
 
-    // 运行核心操作阶段
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      localization_stage.Update(index);
-    }
-    for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      collision_stage.Update(index);
-    }
-    collision_stage.ClearCycleCache();
+    // 为新注册的车辆创建独立的随机数流，使随机决策与车辆的处理顺序无关
+    random_device.UpdateActors(vehicle_id_list);
+    // 发布本周期的参数快照，各阶段不加锁地读取
+    parameters.UpdateSnapshot(vehicle_id_list);
+    stage_executor.SetNumberOfWorkers(parameters.GetWorkerThreadCount());
+
+    // 运行核心操作阶段，每个阶段内各车辆的更新并行执行
+    RunStage(localization_stage);
+    RunStage(collision_stage);
     vehicle_light_stage.UpdateWorldInfo();
+    RunStage(traffic_light_stage);
+    RunStage(motion_plan_stage);
+    // 车辆灯光阶段会向 control_frame 追加命令，保持按顺序执行
     for (unsigned long index = 0u; index < vehicle_id_list.size(); ++index) {
-      traffic_light_stage.Update(index);
-      motion_plan_stage.Update(index);
       vehicle_light_stage.Update(index);
     }
 
+    // 启用控制帧差分时只发送变化超过容差的命令
+    carla::rpc::CommandBatchView batch(control_frame);
+    if (parameters.GetControlFrameDiffing()) {
+      control_batch.clear();
+      control_frame_filter.Filter(
+          control_frame,
+          vehicle_id_list.size(),
+          parameters.GetControlFrameTolerance(),
+          stage_executor,
+          control_batch);
+      batch = carla::rpc::CommandBatchView(control_batch);
+    } else {
+      // 重新启用时先发送一次全部命令
+      control_frame_filter.Reset();
+    }
+
     registration_lock.unlock();
 
-    // 将当前周期的批处理命令发送给模拟器
+    // 将当前周期的批处理命令发送给模拟器，命令直接从缓冲区打包，不复制
     if (synchronous_mode) {
-      episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+      episode_proxy.Lock()->ApplyBatchSync(batch, false);
       step_end.store(true);
       step_end_trigger.notify_one();
     } else {
-      if (control_frame.size() > 0){
-        episode_proxy.Lock()->ApplyBatchSync(control_frame, false);
+      if (!batch.empty()) {
+        episode_proxy.Lock()->ApplyBatchSync(batch, false);
       }
     }
   }
@@ -295,6 +317,8 @@ void TrafficManagerLocal::Stop() {
   collision_frame.clear();
   tl_frame.clear();
   control_frame.clear();
+  control_batch.clear();
+  control_frame_filter.Reset();
    // 恢复状态变量
   run_traffic_manger.store(true); // 恢复交通管理器的运行状态
   step_begin.store(false);// 重置步开始标志
@@ -409,6 +433,20 @@ void TrafficManagerLocal::SetHybridPhysicsMode(const bool mode_switch) {
 void TrafficManagerLocal::SetHybridPhysicsRadius(const float radius) {
   parameters.SetHybridPhysicsRadius(radius);
 }
+// 设置并行执行各阶段的工作线程数，在下一个周期开始时生效
+void TrafficManagerLocal::SetWorkerThreadCount(const unsigned count) {
+  parameters.SetWorkerThreadCount(count);
+}
+// 设置是否只发送变化超过容差的控制命令，在下一个周期生效
+void TrafficManagerLocal::SetControlFrameDiffing(const bool mode_switch, const float tolerance) {
+  parameters.SetControlFrameDiffing(mode_switch, tolerance);
+}
+// 批量设置多辆车的同一个参数
+void TrafficManagerLocal::SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values) {
+  parameters.SetVehicleParameters(parameter, values);
+}
+// 本地交通管理器没有需要异步发送的请求
+void TrafficManagerLocal::SetAsynchronousParameterUpdates(const bool) {}
 // 设置是否启用OSM模式（Open Street Map）
 void TrafficManagerLocal::SetOSMMode(const bool mode_switch) {
   parameters.SetOSMMode(mode_switch);
@@ -489,8 +527,12 @@ std::vector<ActorId> TrafficManagerLocal::GetRegisteredVehiclesIDs() {
 }
 
 void TrafficManagerLocal::SetRandomDeviceSeed(const uint64_t _seed) {
-  seed = _seed;
-  random_device = RandomGenerator(seed);
+  {
+    // 避免在各阶段使用随机数流时替换随机数生成器
+    std::lock_guard<std::mutex> registration_lock(registration_mutex);
+    seed = _seed;
+    random_device = RandomGenerator(seed);
+  }
   world.ResetAllTrafficLights();
 }
 
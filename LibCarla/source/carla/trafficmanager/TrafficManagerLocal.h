@@ -17,12 +17,15 @@
 #include "carla/client/World.h"///@brief 包含CARLA客户端的世界管理类，用于访问和修改仿真世界
 #include "carla/Memory.h"///@brief 包含CARLA的内存管理类，用于管理内存分配和释放
 #include "carla/rpc/Command.h"///@brief 包含CARLA的RPC命令处理类，用于远程过程调用
+#include "carla/rpc/CommandBatch.h"///@brief 包含CARLA的RPC命令批次视图，用于不复制地发送控制命令
 
 #include "carla/trafficmanager/AtomicActorSet.h"///@brief 包含交通管理器中的原子参与者集合类，用于管理仿真中的参与者（如车辆、行人）
+#include "carla/trafficmanager/ControlFrameFilter.h"///@brief 包含交通管理器的控制帧差分类，用于只发送发生变化的控制命令
 #include "carla/trafficmanager/InMemoryMap.h"///@brief 包含交通管理器的内存地图类，用于在内存中存储地图数据
 #include "carla/trafficmanager/Parameters.h"///@brief 包含交通管理器的参数配置类，用于配置交通管理器的各种参数
 #include "carla/trafficmanager/RandomGenerator.h"///@brief 包含交通管理器的随机数生成器类，用于生成随机数或随机序列
 #include "carla/trafficmanager/SimulationState.h"///@brief 包含交通管理器的仿真状态类，用于管理仿真的全局状态
+#include "carla/trafficmanager/StageExecutor.h"///@brief 包含交通管理器的阶段执行器类，用于并行执行各阶段对每辆车的更新
 #include "carla/trafficmanager/TrackTraffic.h"///@brief 包含交通管理器的流量跟踪类，用于跟踪和管理仿真中的交通流量
 #include "carla/trafficmanager/TrafficManagerBase.h"///@brief 包含交通管理器的基类，定义了交通管理器的基本接口和功能
 #include "carla/trafficmanager/TrafficManagerServer.h"///@brief 包含交通管理器的服务器类，用于管理交通管理器的网络通信
@@ -135,6 +138,10 @@ private:
   /// @brief 存储运动规划阶段输出数据的数组  
   /// 用于存储运动规划阶段产生的控制指令
   ControlFrame control_frame;
+  /// @brief 启用控制帧差分时实际发送的命令，在各周期之间复用以避免重新分配
+  ControlFrame control_batch;
+  /// @brief 记录上一次发送的控制命令，用于控制帧差分
+  ControlFrameFilter control_frame_filter;
   /// @brief 用于跟踪当前为帧保留的数组空间的变量 
   /// 这是一个无符号64位整数，用于记录为各个帧数组预留的空间大小
   uint64_t current_reserved_capacity {0u};
@@ -145,6 +152,8 @@ private:
   TrafficLightStage traffic_light_stage;
   MotionPlanStage motion_plan_stage;
   VehicleLightStage vehicle_light_stage;
+  /// @brief 以工作窃取方式并行执行各阶段对每辆车的更新的执行器
+  StageExecutor stage_executor;
   /// @brief 自动驾驶局部路径规划模块（ALSM）  
   /// ALSM可能是一个用于生成局部路径规划算法的模块或对象
   ALSM alsm;
@@ -185,6 +194,20 @@ private:
   /// @param tl_to_freeze 要检查的交通灯组 
   /// @return 如果所有交通灯都被冻结，则返回true；否则返回false
   bool CheckAllFrozen(TLGroup tl_to_freeze);
+  /// @brief 为当前周期的所有车辆运行一个阶段
+  ///
+  /// 先单线程调用 PrepareCycle，再由执行器并行调用 Update，最后单线程调用 CommitCycle，
+  /// 因此阶段的输出与工作线程数无关。
+  ///
+  /// @param stage 要运行的阶段
+  template <typename StageType>
+  void RunStage(StageType &stage) {
+    stage.PrepareCycle();
+    stage_executor.ParallelFor(vehicle_id_list.size(), [&stage](const unsigned long index) {
+      stage.Update(index);
+    });
+    stage.CommitCycle();
+  }
 
 public:
     /// @brief 私有构造函数，用于单例生命周期管理  
@@ -372,6 +395,28 @@ public:
 /// @param radius 混合物理模式的半径值
   void SetHybridPhysicsRadius(const float radius);
 
+  /// @brief 设置并行执行各阶段的工作线程数。  
+///   
+/// @param count 工作线程数，0 表示使用硬件并发数
+  void SetWorkerThreadCount(const unsigned count);
+
+  /// @brief 设置是否只发送变化超过容差的控制命令。  
+///   
+/// @param mode_switch 是否启用控制帧差分
+/// @param tolerance 油门、转向与刹车的容差
+  void SetControlFrameDiffing(const bool mode_switch, const float tolerance);
+
+  /// @brief 批量设置多辆车的同一个参数。  
+///   
+/// @param parameter 要设置的参数
+/// @param values 车辆ID与参数值的列表
+  void SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values);
+
+  /// @brief 本地交通管理器直接修改参数，忽略此设置。  
+///   
+/// @param mode_switch 是否异步发送批量参数
+  void SetAsynchronousParameterUpdates(const bool mode_switch);
+
   /// @brief 设置随机化种子。  
 ///   
 /// @param _seed 随机化种子值
@@ -282,6 +282,26 @@ void TrafficManagerRemote::SetHybridPhysicsRadius(const float radius) {
 // 通过客户端设置混合物理模式半径
 }
 
+void TrafficManagerRemote::SetWorkerThreadCount(const unsigned count) {
+  client.SetWorkerThreadCount(count);
+// 通过客户端设置并行执行各阶段的工作线程数
+}
+
+void TrafficManagerRemote::SetControlFrameDiffing(const bool mode_switch, const float tolerance) {
+  client.SetControlFrameDiffing(mode_switch, tolerance);
+// 通过客户端设置控制帧差分
+}
+
+void TrafficManagerRemote::SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values) {
+  client.SetVehicleParameters(parameter, values, _asynchronous_parameter_updates.load());
+// 通过客户端一次发送所有车辆的参数
+}
+
+void TrafficManagerRemote::SetAsynchronousParameterUpdates(const bool mode_switch) {
+  _asynchronous_parameter_updates.store(mode_switch);
+// 只影响客户端发送批量参数的方式
+}
+
 void TrafficManagerRemote::SetOSMMode(const bool mode_switch) {
   client.SetOSMMode(mode_switch);
 // 通过客户端设置 OSM 模式开关
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <atomic>/// @brief 引入原子类型，用于无锁读取的标志
 #include <condition_variable>/// @brief 引入条件变量类，用于线程间的同步
 #include <mutex>/// @brief 引入互斥锁类，用于保护共享数据的访问
 #include <vector>/// @brief 引入动态数组类，用于储存多个元素
@@ -286,6 +287,40 @@ public:
  */
   void SetHybridPhysicsRadius(const float radius);
 
+  /**
+ * @brief 设置并行执行各阶段的工作线程数。
+ *
+ * @param count 工作线程数，0 表示使用硬件并发数。
+ */
+  void SetWorkerThreadCount(const unsigned count);
+
+  /**
+ * @brief 设置是否只发送变化超过容差的控制命令。
+ *
+ * @param mode_switch 是否启用控制帧差分。
+ * @param tolerance 控制命令的容差。
+ */
+  void SetControlFrameDiffing(const bool mode_switch, const float tolerance);
+
+  /**
+ * @brief 批量设置多辆车的同一个参数，整个列表通过一次RPC调用发送。
+ *
+ * @param parameter 要设置的参数。
+ * @param values 车辆ID与参数值的列表。
+ */
+  void SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values);
+
+  /**
+ * @brief 设置批量参数是否以异步方式发送。
+ *
+ * 启用后 SetVehicleParameters 发送后立即返回，不等待服务器应用参数，服务器端的
+ * 错误也不会报告给客户端。服务器按收到的顺序处理请求，之后的任何同步调用返回时，
+ * 之前异步发送的参数都已经生效。
+ *
+ * @param mode_switch 是否异步发送。
+ */
+  void SetAsynchronousParameterUpdates(const bool mode_switch);
+
   /**
  * @brief 设置Open Street Map（OSM）模式。
  *
@@ -435,6 +470,10 @@ private:
  * @brief 保持活动状态标志。
  */
   bool _keep_alive = true;
+  /**
+ * @brief 批量参数是否以异步方式发送。
+ */
+  std::atomic<bool> _asynchronous_parameter_updates{false};
 };
 
 } // namespace traffic_manager
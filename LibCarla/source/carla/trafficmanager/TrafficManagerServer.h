@@ -21,6 +21,10 @@
    * 用于处理CARLA项目中可能出现的各种异常情况。
    */
 #include "carla/Exception.h"
+   /**
+    * @brief 引入CARLA项目中的日志函数
+    */
+#include "carla/Logging.h"
    /**
     * @brief 引入CARLA客户端中的参与者（Actor）管理相关类
     *
@@ -293,6 +297,32 @@ public:
         tm->SetHybridPhysicsRadius(radius);
       });
 
+      /// 设置并行执行各阶段的工作线程数的方法  
+      /// @param count 工作线程数，0 表示使用硬件并发数
+      server->bind("set_worker_thread_count", [=](const unsigned count) {
+        tm->SetWorkerThreadCount(count);
+      });
+
+      /// 设置是否只发送变化超过容差的控制命令的方法  
+      /// @param mode_switch 是否启用控制帧差分
+      /// @param tolerance 控制命令的容差
+      server->bind("set_control_frame_diffing", [=](const bool mode_switch, const float tolerance) {
+        tm->SetControlFrameDiffing(mode_switch, tolerance);
+      });
+
+      /// 批量设置多辆车的同一个参数的方法，只使用车辆ID，不需要在服务器端创建参与者
+      /// @param parameter 要设置的参数
+      /// @param values 车辆ID与参数值的列表
+      server->bind("set_vehicle_parameters", [=](const VehicleParameter parameter, const VehicleParameterList &values) {
+        // 服务器没有抑制异常，处理函数中抛出异常会终止服务器；异步调用也无法
+        // 返回错误，所以只记录警告并忽略无效的参数类型
+        if (parameter >= VehicleParameter::SIZE) {
+          log_warning("TrafficManagerServer: ignoring invalid vehicle parameter", static_cast<int>(parameter));
+          return;
+        }
+        tm->SetVehicleParameters(parameter, values);
+      });
+
       /// 设置OSM（OpenStreetMap）模式的方法  
       /// @param mode_switch 是否开启OSM模式
       server->bind("set_osm_mode", [=](const bool mode_switch) {
@@ -33,7 +33,7 @@ void VehicleLightStage::UpdateWorldInfo() {
 void VehicleLightStage::Update(const unsigned long index) {
   ActorId actor_id = vehicle_id_list.at(index); // 根据索引获取车辆ID
 
-  if (!parameters.GetUpdateVehicleLights(actor_id))
+  if (!parameters.GetSnapshot().GetVehicle(index).auto_update_vehicle_lights)
     return; // 如果该车辆未设置为自动更新灯光状态，则返回
 
   rpc::VehicleLightState::flag_type light_states = uint32_t(-1); // 初始化灯光状态
@@ -0,0 +1,44 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include "carla/MsgPack.h"
+#include "carla/rpc/ActorId.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace carla {
+namespace traffic_manager {
+
+  /// 可以批量设置的单车参数，每一项对应 TrafficManager 中一个逐辆车的设置方法。
+  enum class VehicleParameter : uint8_t {
+    PercentageSpeedDifference,        ///< SetPercentageSpeedDifference
+    LaneOffset,                       ///< SetLaneOffset
+    DesiredSpeed,                     ///< SetDesiredSpeed
+    DistanceToLeadingVehicle,         ///< SetDistanceToLeadingVehicle
+    PercentageRunningLight,           ///< SetPercentageRunningLight
+    PercentageRunningSign,            ///< SetPercentageRunningSign
+    PercentageIgnoreWalkers,          ///< SetPercentageIgnoreWalkers
+    PercentageIgnoreVehicles,         ///< SetPercentageIgnoreVehicles
+    KeepRightPercentage,              ///< SetKeepRightPercentage
+    RandomLeftLaneChangePercentage,   ///< SetRandomLeftLaneChangePercentage
+    RandomRightLaneChangePercentage,  ///< SetRandomRightLaneChangePercentage
+    AutoLaneChange,                   ///< SetAutoLaneChange，非零值表示启用
+    UpdateVehicleLights,              ///< SetUpdateVehicleLights，非零值表示启用
+
+    SIZE                              ///< 枚举大小，用于边界检查
+  };
+
+  /// 批量设置的车辆ID与参数值。
+  using VehicleParameterList = std::vector<std::pair<ActorId, float>>;
+
+} // namespace traffic_manager
+} // namespace carla
+
+MSGPACK_ADD_ENUM(carla::traffic_manager::VehicleParameter);
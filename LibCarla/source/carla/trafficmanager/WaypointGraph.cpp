@@ -0,0 +1,147 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "carla/trafficmanager/WaypointGraph.h"
+
+#include "carla/Debug.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  namespace {
+
+    /// 返回路径点在稠密拓扑中的索引，不属于该拓扑时返回无效索引。
+    WaypointIndex IndexOf(const NodeList &dense_topology, const SimpleWaypointPtr &swp) {
+      if (swp == nullptr) {
+        return INVALID_WAYPOINT_INDEX;
+      }
+      const WaypointIndex index = swp->GetIndex();
+      if (index >= dense_topology.size() || dense_topology[index] != swp) {
+        return INVALID_WAYPOINT_INDEX;
+      }
+      return index;
+    }
+
+    /// 将路径点列表追加到CSR数组中，并写入下一行的偏移。
+    void AppendLinks(const NodeList &dense_topology,
+                     const NodeList &links,
+                     std::vector<WaypointIndex> &indices,
+                     std::vector<uint32_t> &offsets) {
+      for (auto &link : links) {
+        const WaypointIndex index = IndexOf(dense_topology, link);
+        if (index != INVALID_WAYPOINT_INDEX) {
+          indices.push_back(index);
+        }
+      }
+      offsets.push_back(static_cast<uint32_t>(indices.size()));
+    }
+
+  } // namespace
+
+  void WaypointGraph::Build(const NodeList &dense_topology) {
+    Clear();
+
+    const size_t size = dense_topology.size();
+    DEBUG_ASSERT(size < INVALID_WAYPOINT_INDEX);
+
+    // 先为所有路径点分配索引，之后才能把链接转换为索引
+    for (size_t i = 0u; i < size; ++i) {
+      if (dense_topology[i] != nullptr) {
+        dense_topology[i]->SetIndex(static_cast<WaypointIndex>(i));
+      }
+    }
+
+    _x.reserve(size);
+    _y.reserve(size);
+    _z.reserve(size);
+    _forward_x.reserve(size);
+    _forward_y.reserve(size);
+    _forward_z.reserve(size);
+    _ids.reserve(size);
+    _geodesic_grid_ids.reserve(size);
+    _road_options.reserve(size);
+    _flags.reserve(size);
+    _left.reserve(size);
+    _right.reserve(size);
+    _next_offsets.reserve(size + 1u);
+    _previous_offsets.reserve(size + 1u);
+    _next_offsets.push_back(0u);
+    _previous_offsets.push_back(0u);
+
+    for (auto &swp : dense_topology) {
+      if (swp == nullptr) {
+        _x.push_back(0.0f);
+        _y.push_back(0.0f);
+        _z.push_back(0.0f);
+        _forward_x.push_back(0.0f);
+        _forward_y.push_back(0.0f);
+        _forward_z.push_back(0.0f);
+        _ids.push_back(0u);
+        _geodesic_grid_ids.push_back(0);
+        _road_options.push_back(RoadOption::Void);
+        _flags.push_back(0u);
+        _left.push_back(INVALID_WAYPOINT_INDEX);
+        _right.push_back(INVALID_WAYPOINT_INDEX);
+        _next_offsets.push_back(static_cast<uint32_t>(_next_indices.size()));
+        _previous_offsets.push_back(static_cast<uint32_t>(_previous_indices.size()));
+        continue;
+      }
+
+      const cg::Transform transform = swp->GetTransform();
+      const cg::Vector3D forward = transform.GetForwardVector();
+      _x.push_back(transform.location.x);
+      _y.push_back(transform.location.y);
+      _z.push_back(transform.location.z);
+      _forward_x.push_back(forward.x);
+      _forward_y.push_back(forward.y);
+      _forward_z.push_back(forward.z);
+      _ids.push_back(swp->GetId());
+      _geodesic_grid_ids.push_back(swp->GetGeodesicGridId());
+      _road_options.push_back(swp->GetRoadOption());
+      _flags.push_back(static_cast<uint8_t>(FLAG_VALID | (swp->CheckJunction() ? static_cast<uint8_t>(FLAG_JUNCTION) : 0u)));
+      _left.push_back(IndexOf(dense_topology, swp->GetLeftWaypoint()));
+      _right.push_back(IndexOf(dense_topology, swp->GetRightWaypoint()));
+      AppendLinks(dense_topology, swp->GetNextWaypoint(), _next_indices, _next_offsets);
+      AppendLinks(dense_topology, swp->GetPreviousWaypoint(), _previous_indices, _previous_offsets);
+    }
+
+    _next_indices.shrink_to_fit();
+    _previous_indices.shrink_to_fit();
+  }
+
+  void WaypointGraph::Clear() {
+    _x.clear();
+    _y.clear();
+    _z.clear();
+    _forward_x.clear();
+    _forward_y.clear();
+    _forward_z.clear();
+    _ids.clear();
+    _geodesic_grid_ids.clear();
+    _road_options.clear();
+    _flags.clear();
+    _left.clear();
+    _right.clear();
+    _next_offsets.clear();
+    _next_indices.clear();
+    _previous_offsets.clear();
+    _previous_indices.clear();
+  }
+
+  size_t WaypointGraph::GetMemoryUsage() const {
+    return (_x.capacity() + _y.capacity() + _z.capacity()) * sizeof(float) +
+           (_forward_x.capacity() + _forward_y.capacity() + _forward_z.capacity()) * sizeof(float) +
+           _ids.capacity() * sizeof(uint64_t) +
+           _geodesic_grid_ids.capacity() * sizeof(GeoGridId) +
+           _road_options.capacity() * sizeof(RoadOption) +
+           _flags.capacity() * sizeof(uint8_t) +
+           (_left.capacity() + _right.capacity()) * sizeof(WaypointIndex) +
+           (_next_offsets.capacity() + _previous_offsets.capacity()) * sizeof(uint32_t) +
+           (_next_indices.capacity() + _previous_indices.capacity()) * sizeof(WaypointIndex);
+  }
+
+} // namespace traffic_manager
+} // namespace carla
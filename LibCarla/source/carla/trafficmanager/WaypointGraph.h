@@ -0,0 +1,194 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "carla/geom/Location.h"
+#include "carla/geom/Vector3D.h"
+#include "carla/trafficmanager/SimpleWaypoint.h"
+
+namespace carla {
+namespace traffic_manager {
+
+  using SimpleWaypointPtr = std::shared_ptr<SimpleWaypoint>;
+  using NodeList = std::vector<SimpleWaypointPtr>;
+
+  /// 无效的路径点索引，表示不存在对应的路径点（例如没有左侧变道路径点）。
+  constexpr WaypointIndex INVALID_WAYPOINT_INDEX = std::numeric_limits<WaypointIndex>::max();
+
+  /// 连续存储的一段路径点索引，用于遍历后继或前驱而不分配内存。
+  class WaypointIndexRange {
+
+  private:
+
+    const WaypointIndex *_begin;
+    const WaypointIndex *_end;
+
+  public:
+
+    WaypointIndexRange(const WaypointIndex *begin, const WaypointIndex *end)
+      : _begin(begin),
+        _end(end) {}
+
+    const WaypointIndex *begin() const {
+      return _begin;
+    }
+
+    const WaypointIndex *end() const {
+      return _end;
+    }
+
+    size_t size() const {
+      return static_cast<size_t>(_end - _begin);
+    }
+
+    bool empty() const {
+      return _begin == _end;
+    }
+
+    WaypointIndex operator[](size_t i) const {
+      return _begin[i];
+    }
+
+    WaypointIndex front() const {
+      return *_begin;
+    }
+  };
+
+  /// 以索引寻址的紧凑路径点图。
+  /// 位置、朝向与标志位按字段连续存储，后继与前驱以CSR（压缩稀疏行）格式存储，
+  /// 索引与InMemoryMap稠密拓扑中的位置一致。交通管理器各阶段沿路径扩展时
+  /// 使用该结构可以避免逐跳追踪共享指针以及原子引用计数的开销。
+  class WaypointGraph {
+
+  private:
+
+    /// 路径点位置的各个分量。
+    std::vector<float> _x;
+    std::vector<float> _y;
+    std::vector<float> _z;
+    /// 路径点朝向的单位向量的各个分量。
+    std::vector<float> _forward_x;
+    std::vector<float> _forward_y;
+    std::vector<float> _forward_z;
+    /// 路径点的唯一ID。
+    std::vector<uint64_t> _ids;
+    /// 路径点所属的地理网格ID（交叉口内为交叉口ID）。
+    std::vector<GeoGridId> _geodesic_grid_ids;
+    /// 路径点的道路选项。
+    std::vector<RoadOption> _road_options;
+    /// 路径点标志位，见 Flags。
+    std::vector<uint8_t> _flags;
+    /// 左侧与右侧变道路径点的索引。
+    std::vector<WaypointIndex> _left;
+    std::vector<WaypointIndex> _right;
+    /// 后继路径点的CSR偏移与索引。
+    std::vector<uint32_t> _next_offsets;
+    std::vector<WaypointIndex> _next_indices;
+    /// 前驱路径点的CSR偏移与索引。
+    std::vector<uint32_t> _previous_offsets;
+    std::vector<WaypointIndex> _previous_indices;
+
+    enum Flags : uint8_t {
+      FLAG_JUNCTION = 1u << 0,
+      FLAG_VALID = 1u << 1
+    };
+
+  public:
+
+    /// 根据稠密拓扑构建路径点图，并将每个路径点在拓扑中的位置写回其索引。
+    void Build(const NodeList &dense_topology);
+
+    /// 清空路径点图。
+    void Clear();
+
+    /// 返回路径点的数量。
+    size_t Size() const {
+      return _ids.size();
+    }
+
+    bool Empty() const {
+      return _ids.empty();
+    }
+
+    cg::Location GetLocation(WaypointIndex index) const {
+      return cg::Location(_x[index], _y[index], _z[index]);
+    }
+
+    cg::Vector3D GetForwardVector(WaypointIndex index) const {
+      return cg::Vector3D(_forward_x[index], _forward_y[index], _forward_z[index]);
+    }
+
+    uint64_t GetId(WaypointIndex index) const {
+      return _ids[index];
+    }
+
+    GeoGridId GetGeodesicGridId(WaypointIndex index) const {
+      return _geodesic_grid_ids[index];
+    }
+
+    RoadOption GetRoadOption(WaypointIndex index) const {
+      return _road_options[index];
+    }
+
+    bool CheckJunction(WaypointIndex index) const {
+      return (_flags[index] & FLAG_JUNCTION) != 0u;
+    }
+
+    /// 对应位置的稠密拓扑条目是否为有效路径点。
+    bool IsValid(WaypointIndex index) const {
+      return (_flags[index] & FLAG_VALID) != 0u;
+    }
+
+    WaypointIndex GetLeft(WaypointIndex index) const {
+      return _left[index];
+    }
+
+    WaypointIndex GetRight(WaypointIndex index) const {
+      return _right[index];
+    }
+
+    /// 返回后继路径点的索引。
+    WaypointIndexRange GetNext(WaypointIndex index) const {
+      return WaypointIndexRange(
+          _next_indices.data() + _next_offsets[index],
+          _next_indices.data() + _next_offsets[index + 1u]);
+    }
+
+    /// 返回前驱路径点的索引。
+    WaypointIndexRange GetPrevious(WaypointIndex index) const {
+      return WaypointIndexRange(
+          _previous_indices.data() + _previous_offsets[index],
+          _previous_indices.data() + _previous_offsets[index + 1u]);
+    }
+
+    /// 计算两个路径点之间距离的平方。
+    float DistanceSquared(WaypointIndex a, WaypointIndex b) const {
+      const float dx = _x[a] - _x[b];
+      const float dy = _y[a] - _y[b];
+      const float dz = _z[a] - _z[b];
+      return dx * dx + dy * dy + dz * dz;
+    }
+
+    /// 计算路径点到给定位置距离的平方。
+    float DistanceSquared(WaypointIndex index, const cg::Location &location) const {
+      const float dx = _x[index] - location.x;
+      const float dy = _y[index] - location.y;
+      const float dz = _z[index] - location.z;
+      return dx * dx + dy * dy + dz * dz;
+    }
+
+    /// 返回路径点图占用的堆内存字节数。
+    size_t GetMemoryUsage() const;
+  };
+
+} // namespace traffic_manager
+} // namespace carla
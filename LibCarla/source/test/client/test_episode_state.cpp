@@ -0,0 +1,352 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/client/WorldSnapshot.h>
+#include <carla/client/detail/EpisodeState.h>
+#include <carla/sensor/Deserializer.h>
+#include <carla/sensor/SensorRegistry.h>
+#include <carla/sensor/s11n/SensorHeaderSerializer.h>
+#include <carla/trafficmanager/ActorDeltaTracker.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+using carla::ActorId;
+using carla::client::detail::EpisodeState;
+using carla::sensor::data::ActorDynamicState;
+using carla::sensor::data::RawEpisodeState;
+using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
+
+static constexpr uint64_t EPISODE_ID = 42u;
+
+static ActorDynamicState MakeActor(ActorId id, float x) {
+  ActorDynamicState actor{};
+  actor.id = id;
+  actor.actor_state = carla::rpc::ActorState::Active;
+  actor.transform = carla::geom::Transform(carla::geom::Location(x, 0.0f, 0.0f));
+  return actor;
+}
+
+/// 按照服务器的格式构建一条剧集状态消息并反序列化。
+static carla::SharedPtr<carla::sensor::SensorData> MakeMessage(
+    uint64_t frame,
+    const std::vector<ActorDynamicState> &actors,
+    const std::vector<ActorId> *removed = nullptr,
+    uint64_t keyframe = 0u,
+    uint32_t actor_count = 0u) {
+  using namespace carla::sensor;
+  const auto index = SensorRegistry::get<FWorldObserver *>::index;
+  carla::Buffer sensor_header = s11n::SensorHeaderSerializer::Serialize(index, frame, 0.0, carla::rpc::Transform{});
+
+  Serializer::Header header;
+  header.episode_id = EPISODE_ID;
+  header.platform_timestamp = 0.0;
+  header.delta_seconds = 0.05f;
+  header.map_origin = carla::geom::Vector3DInt{};
+  header.simulation_state = (removed != nullptr) ? Serializer::SimulationState::Delta : Serializer::SimulationState::None;
+
+  std::vector<unsigned char> payload(sensor_header.begin(), sensor_header.end());
+  auto append = [&payload](const void *data, size_t size) {
+    const auto *begin = reinterpret_cast<const unsigned char *>(data);
+    payload.insert(payload.end(), begin, begin + size);
+  };
+  append(&header, sizeof(header));
+  if (removed != nullptr) {
+    Serializer::DeltaHeader delta;
+    delta.keyframe = keyframe;
+    delta.actor_count = actor_count;
+    delta.removed_count = static_cast<uint32_t>(removed->size());
+    append(&delta, sizeof(delta));
+    append(removed->data(), sizeof(ActorId) * removed->size());
+  }
+  append(actors.data(), sizeof(ActorDynamicState) * actors.size());
+
+  carla::Buffer buffer(payload.data(), payload.size());
+  return Deserializer::Deserialize(std::move(buffer));
+}
+
+static const RawEpisodeState &Cast(const carla::SharedPtr<carla::sensor::SensorData> &data) {
+  return static_cast<const RawEpisodeState &>(*data);
+}
+
+static std::vector<ActorId> GetIds(const EpisodeState &state) {
+  std::vector<ActorId> ids;
+  for (auto &&id : state.GetActorIds()) {
+    ids.emplace_back(id);
+  }
+  return ids;
+}
+
+TEST(episode_state, keyframe) {
+  auto message = MakeMessage(10u, {MakeActor(3u, 3.0f), MakeActor(1u, 1.0f), MakeActor(2u, 2.0f)});
+  ASSERT_FALSE(Cast(message).IsDelta());
+  EpisodeState state{Cast(message)};
+  ASSERT_EQ(state.GetEpisodeId(), EPISODE_ID);
+  ASSERT_EQ(state.GetFrame(), 10u);
+  ASSERT_EQ(state.size(), 3u);
+  ASSERT_EQ(GetIds(state), (std::vector<ActorId>{1u, 2u, 3u}));
+  ASSERT_TRUE(state.ContainsActorSnapshot(2u));
+  ASSERT_FALSE(state.ContainsActorSnapshot(4u));
+  ASSERT_EQ(state.GetActorSnapshot(3u).transform.location.x, 3.0f);
+  ASSERT_FALSE(state.GetActorSnapshotIfPresent(4u).has_value());
+}
+
+TEST(episode_state, delta) {
+  auto keyframe = MakeMessage(10u, {MakeActor(1u, 1.0f), MakeActor(2u, 2.0f), MakeActor(3u, 3.0f)});
+  auto first = std::make_shared<EpisodeState>(Cast(keyframe));
+
+  // 参与者2移动，新增参与者5，删除参与者1
+  std::vector<ActorId> removed = {1u};
+  auto delta = MakeMessage(12u, {MakeActor(5u, 5.0f), MakeActor(2u, 20.0f)}, &removed, 10u, 3u);
+  ASSERT_TRUE(Cast(delta).IsDelta());
+  ASSERT_EQ(Cast(delta).GetKeyframe(), 10u);
+  ASSERT_EQ(Cast(delta).size(), 2u);
+  ASSERT_TRUE(first->CanApplyDelta(Cast(delta)));
+
+  EpisodeState second{Cast(delta), *first};
+  ASSERT_EQ(second.GetFrame(), 12u);
+  ASSERT_FALSE(second.HasMapChanged());
+  ASSERT_EQ(second.size(), 3u);
+  ASSERT_EQ(GetIds(second), (std::vector<ActorId>{2u, 3u, 5u}));
+  ASSERT_FALSE(second.ContainsActorSnapshot(1u));
+  ASSERT_EQ(second.GetActorSnapshot(2u).transform.location.x, 20.0f);
+  ASSERT_EQ(second.GetActorSnapshot(3u).transform.location.x, 3.0f);
+  ASSERT_EQ(second.GetActorSnapshot(5u).transform.location.x, 5.0f);
+
+  // 关键帧之前的状态不受影响
+  ASSERT_EQ(first->size(), 3u);
+  ASSERT_EQ(first->GetActorSnapshot(2u).transform.location.x, 2.0f);
+
+  // 下一个增量同样基于关键帧，可以直接应用在第二帧上
+  std::vector<ActorId> none;
+  auto next = MakeMessage(13u, {MakeActor(3u, 30.0f)}, &none, 10u, 3u);
+  ASSERT_TRUE(second.CanApplyDelta(Cast(next)));
+  EpisodeState third{Cast(next), second};
+  ASSERT_EQ(GetIds(third), (std::vector<ActorId>{1u, 2u, 3u}));
+  ASSERT_EQ(third.GetActorSnapshot(2u).transform.location.x, 2.0f);
+  ASSERT_EQ(third.GetActorSnapshot(3u).transform.location.x, 30.0f);
+
+  // 基于其他关键帧的增量，或者还没有收到关键帧时都不能应用
+  auto other = MakeMessage(14u, {}, &none, 11u, 3u);
+  ASSERT_FALSE(third.CanApplyDelta(Cast(other)));
+  ASSERT_FALSE(EpisodeState{EPISODE_ID}.CanApplyDelta(Cast(next)));
+}
+
+TEST(episode_state, actor_id_changes) {
+  auto keyframe = MakeMessage(10u, {MakeActor(1u, 1.0f), MakeActor(2u, 2.0f), MakeActor(3u, 3.0f)});
+  EpisodeState first{Cast(keyframe)};
+
+  // 同一关键帧：第二帧删除1、新增5，第三帧恢复1（相对关键帧没有删除）、新增6
+  std::vector<ActorId> removed = {1u};
+  auto delta = MakeMessage(11u, {MakeActor(5u, 5.0f), MakeActor(2u, 20.0f)}, &removed, 10u, 3u);
+  EpisodeState second{Cast(delta), first};
+  std::vector<ActorId> none;
+  auto next = MakeMessage(12u, {MakeActor(6u, 6.0f)}, &none, 10u, 4u);
+  EpisodeState third{Cast(next), second};
+
+  std::vector<ActorId> spawned;
+  std::vector<ActorId> destroyed;
+  second.GetActorIdChanges(first, spawned, destroyed);
+  ASSERT_EQ(spawned, (std::vector<ActorId>{5u}));
+  ASSERT_EQ(destroyed, (std::vector<ActorId>{1u}));
+
+  spawned.clear();
+  destroyed.clear();
+  third.GetActorIdChanges(second, spawned, destroyed);
+  ASSERT_EQ(spawned, (std::vector<ActorId>{1u, 6u}));
+  ASSERT_EQ(destroyed, (std::vector<ActorId>{5u}));
+
+  // 同一个状态没有变化
+  spawned.clear();
+  destroyed.clear();
+  third.GetActorIdChanges(third, spawned, destroyed);
+  ASSERT_TRUE(spawned.empty());
+  ASSERT_TRUE(destroyed.empty());
+
+  // 不同的关键帧按ID顺序合并
+  auto other = MakeMessage(13u, {MakeActor(2u, 2.0f), MakeActor(7u, 7.0f), MakeActor(6u, 6.0f)});
+  EpisodeState fourth{Cast(other)};
+  spawned.clear();
+  destroyed.clear();
+  fourth.GetActorIdChanges(third, spawned, destroyed);
+  ASSERT_EQ(spawned, (std::vector<ActorId>{7u}));
+  ASSERT_EQ(destroyed, (std::vector<ActorId>{1u, 3u}));
+}
+
+TEST(episode_state, delta_tolerance) {
+  const auto actor = MakeActor(1u, 1.0f);
+  auto moved = actor;
+  moved.transform = carla::geom::Transform(carla::geom::Location(1.0005f, 0.0f, 0.0f));
+  ASSERT_TRUE(Serializer::IsNearlyEqual(actor, moved));
+  moved.transform = carla::geom::Transform(carla::geom::Location(1.01f, 0.0f, 0.0f));
+  ASSERT_FALSE(Serializer::IsNearlyEqual(actor, moved));
+
+  auto stopped = actor;
+  stopped.state.vehicle_data.speed_limit = 30.0f;
+  ASSERT_FALSE(Serializer::IsNearlyEqual(actor, stopped));
+}
+
+/// 与 AtomicActorSet 接口相同的已注册车辆集合，只保存ID。
+class FakeRegisteredSet {
+public:
+
+  bool Contains(ActorId id) const {
+    return _ids.find(id) != _ids.end();
+  }
+
+  int GetState() const {
+    return _state;
+  }
+
+  std::vector<ActorId> GetIDList() const {
+    return {_ids.begin(), _ids.end()};
+  }
+
+  void Insert(ActorId id) {
+    _ids.insert(id);
+    ++_state;
+  }
+
+  void Remove(ActorId id) {
+    _ids.erase(id);
+    ++_state;
+  }
+
+private:
+
+  std::set<ActorId> _ids;
+
+  int _state = 0;
+};
+
+TEST(episode_state, traffic_manager_actor_tracking) {
+  using carla::traffic_manager::ActorDeltaTracker;
+  std::mt19937 engine(7u);
+  std::uniform_int_distribution<int> percent(0, 99);
+
+  std::set<ActorId> world;
+  ActorId next_id = 1u;
+  for (; next_id <= 200u; ++next_id) {
+    world.insert(next_id);
+  }
+
+  ActorDeltaTracker tracker;
+  FakeRegisteredSet registered;
+  std::map<ActorId, int> unregistered;
+  std::shared_ptr<EpisodeState> keyframe_state;
+  uint64_t frame = 0u;
+
+  // 前一半按每4帧一个关键帧发送增量，后一半每一帧都是关键帧
+  for (int tick = 0; tick < 400; ++tick) {
+    ++frame;
+    const bool keyframe = (tick >= 200) || (tick % 4 == 0);
+
+    // 世界中生成与销毁参与者，交通管理器注册与注销车辆
+    std::vector<ActorId> alive(world.begin(), world.end());
+    std::shuffle(alive.begin(), alive.end(), engine);
+    const size_t destroy_count = static_cast<size_t>(percent(engine) % 3);
+    for (size_t i = 0u; i < destroy_count && i < alive.size(); ++i) {
+      world.erase(alive[i]);
+    }
+    const int spawn_count = percent(engine) % 3;
+    for (int i = 0; i < spawn_count; ++i) {
+      world.insert(next_id++);
+    }
+    if (percent(engine) < 20 && !world.empty()) {
+      registered.Insert(*std::next(world.begin(), percent(engine) % static_cast<int>(world.size())));
+    }
+    if (percent(engine) < 10) {
+      const auto ids = registered.GetIDList();
+      if (!ids.empty()) {
+        registered.Remove(ids[static_cast<size_t>(percent(engine)) % ids.size()]);
+      }
+    }
+    // 注册后在同一帧内被销毁的车辆
+    if (percent(engine) < 5 && !world.empty()) {
+      const ActorId id = *world.begin();
+      registered.Insert(id);
+      world.erase(id);
+    }
+
+    std::vector<ActorDynamicState> actors;
+    std::shared_ptr<EpisodeState> state;
+    if (keyframe) {
+      for (const ActorId id : world) {
+        actors.emplace_back(MakeActor(id, 0.0f));
+      }
+      state = std::make_shared<EpisodeState>(Cast(MakeMessage(frame, actors)));
+      keyframe_state = state;
+    } else {
+      // 增量包含关键帧之后出现的全部参与者以及关键帧之后被删除的参与者
+      std::vector<ActorId> removed;
+      for (const auto &actor : *keyframe_state) {
+        if (world.find(actor.id) == world.end()) {
+          removed.emplace_back(actor.id);
+        }
+      }
+      for (const ActorId id : world) {
+        if (!keyframe_state->ContainsActorSnapshot(id)) {
+          actors.emplace_back(MakeActor(id, 0.0f));
+        }
+      }
+      auto message = MakeMessage(
+          frame, actors, &removed, keyframe_state->GetFrame(), static_cast<uint32_t>(world.size()));
+      state = std::make_shared<EpisodeState>(Cast(message), *keyframe_state);
+    }
+
+    // 与 ALSM::Update 相同的处理顺序
+    const auto changes = tracker.Update(carla::client::WorldSnapshot(state), registered, unregistered);
+    for (const ActorId id : changes.destroyed_registered) {
+      registered.Remove(id);
+    }
+    for (const ActorId id : changes.destroyed_unregistered) {
+      unregistered.erase(id);
+    }
+    for (const ActorId id : changes.spawned) {
+      ASSERT_TRUE(world.find(id) != world.end());
+      if (!registered.Contains(id) && unregistered.find(id) == unregistered.end()) {
+        unregistered.emplace(id, 0);
+      }
+    }
+    if (tick > 0) {
+      // 第一帧之后只为变化的参与者创建参与者对象
+      ASSERT_LE(changes.spawned.size(), 6u);
+    }
+
+    // 结果与扫描整个世界相同：已注册的车辆都存活，其余存活的参与者都是未注册参与者
+    for (const ActorId id : registered.GetIDList()) {
+      ASSERT_TRUE(world.find(id) != world.end()) << "tick " << tick << " actor " << id;
+    }
+    std::set<ActorId> expected_unregistered;
+    for (const ActorId id : world) {
+      if (!registered.Contains(id)) {
+        expected_unregistered.insert(id);
+      }
+    }
+    std::set<ActorId> actual_unregistered;
+    for (const auto &entry : unregistered) {
+      actual_unregistered.insert(entry.first);
+    }
+    ASSERT_EQ(actual_unregistered, expected_unregistered) << "tick " << tick;
+  }
+
+  // Reset 之后重新扫描整个快照
+  tracker.Reset();
+  std::vector<ActorDynamicState> actors;
+  for (const ActorId id : world) {
+    actors.emplace_back(MakeActor(id, 0.0f));
+  }
+  auto state = std::make_shared<EpisodeState>(Cast(MakeMessage(++frame, actors)));
+  const auto changes = tracker.Update(carla::client::WorldSnapshot(state), registered, unregistered);
+  ASSERT_EQ(changes.spawned, std::vector<ActorId>(world.begin(), world.end()));
+}
@@ -9,8 +9,14 @@
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/image/SimdColorConverter.h>
+#include <carla/StopWatch.h>
 
+#include <cmath>
 #include <memory>
+#include <random>
+#include <string>
+#include <vector>
 
 template <typename ViewT, typename PixelT>
 struct TestImage {
@@ -218,3 +224,164 @@ TEST(image, semantic_segmentation) {
     }
   }
 }
+
+// 逐个比较两幅BGRA图像的像素（包括alpha通道）
+static void ExpectSamePixels(
+    const std::vector<carla::sensor::data::Color> &expected,
+    const std::vector<carla::sensor::data::Color> &result) {
+  ASSERT_EQ(expected.size(), result.size());
+  for (auto i = 0u; i < expected.size(); ++i) {
+    ASSERT_TRUE(expected[i] == result[i] && expected[i].a == result[i].a)
+        << "at pixel " << i << ": expected ("
+        << int(expected[i].r) << ',' << int(expected[i].g) << ',' << int(expected[i].b) << ',' << int(expected[i].a)
+        << ") got ("
+        << int(result[i].r) << ',' << int(result[i].g) << ',' << int(result[i].b) << ',' << int(result[i].a) << ')';
+  }
+}
+
+template <typename ConverterT>
+static std::vector<carla::sensor::data::Color> ConvertWithViews(
+    std::vector<carla::sensor::data::Color> pixels) {
+  using namespace carla::image;
+  auto view = boost::gil::interleaved_view(
+      pixels.size(),
+      1u,
+      reinterpret_cast<boost::gil::bgra8_pixel_t *>(pixels.data()),
+      static_cast<long>(sizeof(carla::sensor::data::Color) * pixels.size()));
+  // 显式指定模板参数，使用逐像素的视图转换
+  ImageConverter::ConvertInPlace<ConverterT>(view);
+  return pixels;
+}
+
+TEST(image, simd_color_converters) {
+  using namespace carla::image;
+  using carla::sensor::data::Color;
+  using carla::sensor::data::OpticalFlowPixel;
+  using InstructionSet = SimdColorConverter::InstructionSet;
+
+#ifndef NDEBUG
+  constexpr auto number_of_pixels = 100003u;
+#else
+  constexpr auto number_of_pixels = 256u * 256u * 256u + 3u;
+#endif
+  // 发布模式下覆盖全部深度编码，另加几个像素测试尾部的处理
+  std::vector<Color> pixels(number_of_pixels);
+  std::mt19937 rng(42u);
+  for (auto i = 0u; i < pixels.size(); ++i) {
+    const auto value = (number_of_pixels > (1u << 24u)) ? i : static_cast<uint32_t>(rng());
+    pixels[i] = Color(
+        static_cast<uint8_t>(value),
+        static_cast<uint8_t>(value >> 8u),
+        static_cast<uint8_t>(value >> 16u),
+        static_cast<uint8_t>(rng()));
+  }
+  const auto expected_depth = ConvertWithViews<ColorConverter::Depth>(pixels);
+  const auto expected_log_depth = ConvertWithViews<ColorConverter::LogarithmicDepth>(pixels);
+  const auto expected_semseg = ConvertWithViews<ColorConverter::CityScapesPalette>(pixels);
+
+  // 光流包含各个方向、大小跨越多个数量级，以及分量为0的情况
+  std::vector<OpticalFlowPixel> flow(100003u);
+  std::uniform_real_distribution<float> angle(-3.2f, 3.2f);
+  std::uniform_real_distribution<float> exponent(-6.0f, 3.0f);
+  for (auto &pixel : flow) {
+    const float a = angle(rng);
+    const float norm = std::pow(10.0f, exponent(rng));
+    pixel = OpticalFlowPixel(norm * std::cos(a), norm * std::sin(a));
+  }
+  flow[0u] = OpticalFlowPixel(0.0f, 0.0f);
+  flow[1u] = OpticalFlowPixel(1.0f, 0.0f);
+  flow[2u] = OpticalFlowPixel(0.0f, -1.0f);
+  flow[3u] = OpticalFlowPixel(-1.0f, 0.0f);
+  flow[4u] = OpticalFlowPixel(-1.0f, -1e-7f);
+  flow[5u] = OpticalFlowPixel(-1.0f, 1e-7f);
+
+  const auto best = SimdColorConverter::GetInstructionSet();
+  SimdColorConverter::SetInstructionSet(InstructionSet::Scalar);
+  std::vector<Color> expected_flow(flow.size());
+  SimdColorConverter::ColorCodedFlow(flow.data(), flow.size(), expected_flow.data());
+
+  for (auto instruction_set : {InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2}) {
+    if (!SimdColorConverter::IsSupported(instruction_set)) {
+      carla::log_info("instruction set", int(instruction_set), "not supported, skipping.");
+      continue;
+    }
+    ASSERT_EQ(SimdColorConverter::SetInstructionSet(instruction_set), instruction_set);
+
+    auto depth = pixels;
+    SimdColorConverter::Depth(depth.data(), depth.size());
+    ExpectSamePixels(expected_depth, depth);
+
+    auto log_depth = pixels;
+    SimdColorConverter::LogarithmicDepth(log_depth.data(), log_depth.size());
+    ExpectSamePixels(expected_log_depth, log_depth);
+
+    auto semseg = pixels;
+    SimdColorConverter::CityScapesPalette(semseg.data(), semseg.size());
+    ExpectSamePixels(expected_semseg, semseg);
+
+    std::vector<Color> colored_flow(flow.size());
+    SimdColorConverter::ColorCodedFlow(flow.data(), flow.size(), colored_flow.data());
+    ExpectSamePixels(expected_flow, colored_flow);
+  }
+  SimdColorConverter::SetInstructionSet(best);
+}
+
+TEST(image, benchmark_color_converters) {
+  using namespace carla::image;
+  using carla::sensor::data::Color;
+  using carla::sensor::data::OpticalFlowPixel;
+  using InstructionSet = SimdColorConverter::InstructionSet;
+  constexpr auto width = 1920u;
+  constexpr auto height = 1080u;
+  constexpr auto number_of_frames = 10u;
+
+  std::vector<Color> pixels(width * height);
+  std::vector<OpticalFlowPixel> flow(width * height);
+  std::mt19937 rng(7u);
+  std::uniform_real_distribution<float> velocity(-2.0f, 2.0f);
+  for (auto i = 0u; i < pixels.size(); ++i) {
+    const auto value = static_cast<uint32_t>(rng());
+    pixels[i] = Color(
+        static_cast<uint8_t>(value),
+        static_cast<uint8_t>(value >> 8u),
+        static_cast<uint8_t>(value >> 16u));
+    flow[i] = OpticalFlowPixel(velocity(rng), velocity(rng));
+  }
+  std::vector<Color> frame(pixels.size());
+  auto view = boost::gil::interleaved_view(
+      width,
+      height,
+      reinterpret_cast<boost::gil::bgra8_pixel_t *>(frame.data()),
+      static_cast<long>(sizeof(Color) * width));
+
+  const auto measure = [&](const char *name, auto &&convert) {
+    double elapsed = 0.0;
+    for (auto i = 0u; i < number_of_frames; ++i) {
+      frame = pixels;
+      carla::StopWatch watch;
+      convert();
+      watch.Stop();
+      elapsed += static_cast<double>(watch.GetElapsedTime<std::chrono::microseconds>());
+    }
+    carla::logging::log(name, elapsed / (1000.0 * number_of_frames), "ms per 1920x1080 frame.");
+  };
+
+  measure("boost::gil Depth:", [&] { ImageConverter::ConvertInPlace<ColorConverter::Depth>(view); });
+  measure("boost::gil LogarithmicDepth:", [&] { ImageConverter::ConvertInPlace<ColorConverter::LogarithmicDepth>(view); });
+  measure("boost::gil CityScapesPalette:", [&] { ImageConverter::ConvertInPlace<ColorConverter::CityScapesPalette>(view); });
+
+  const auto best = SimdColorConverter::GetInstructionSet();
+  const char *names[] = {"Scalar", "SSE2", "AVX2"};
+  for (auto instruction_set : {InstructionSet::Scalar, InstructionSet::SSE2, InstructionSet::AVX2}) {
+    if (!SimdColorConverter::IsSupported(instruction_set)) {
+      continue;
+    }
+    SimdColorConverter::SetInstructionSet(instruction_set);
+    const std::string prefix = names[static_cast<size_t>(instruction_set)];
+    measure((prefix + " Depth:").c_str(), [&] { ImageConverter::ConvertInPlace(view, ColorConverter::Depth()); });
+    measure((prefix + " LogarithmicDepth:").c_str(), [&] { ImageConverter::ConvertInPlace(view, ColorConverter::LogarithmicDepth()); });
+    measure((prefix + " CityScapesPalette:").c_str(), [&] { ImageConverter::ConvertInPlace(view, ColorConverter::CityScapesPalette()); });
+    measure((prefix + " ColorCodedFlow:").c_str(), [&] { SimdColorConverter::ColorCodedFlow(flow.data(), flow.size(), frame.data()); });
+  }
+  SimdColorConverter::SetInstructionSet(best);
+}
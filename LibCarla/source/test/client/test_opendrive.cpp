@@ -13,16 +13,36 @@
 #include <carla/geom/Location.h>/// @brief 包含地理位置相关的类，如点、向量等。
 #include <carla/geom/Math.h>/// @brief 包含几何数学运算相关的函数和类。
 #include <carla/opendrive/OpenDriveParser.h>/// @brief 包含OpenDrive解析器类，用于解析OpenDrive格式的地图文件。
+#include <carla/opendrive/parser/ControllerParser.h>
+#include <carla/opendrive/parser/GeoReferenceParser.h>
+#include <carla/opendrive/parser/GeometryParser.h>
+#include <carla/opendrive/parser/JunctionParser.h>
+#include <carla/opendrive/parser/LaneParser.h>
+#include <carla/opendrive/parser/ObjectParser.h>
+#include <carla/opendrive/parser/ProfilesParser.h>
+#include <carla/opendrive/parser/RoadParser.h>
+#include <carla/opendrive/parser/SignalParser.h>
+#include <carla/opendrive/parser/TrafficGroupParser.h>
 #include <carla/road/MapBuilder.h>/// @brief 包含CARLA的路网构建器类，用于构建路网。
+#include <carla/road/MapSnapshot.h>
 #include <carla/road/element/RoadInfoElevation.h>/// @brief 包含道路高程信息相关的类。
 #include <carla/road/element/RoadInfoGeometry.h>/// @brief 包含道路几何信息相关的类。
+#include <carla/road/element/RoadInfoIterator.h>
+#include <carla/road/element/RoadInfoLaneOffset.h>
+#include <carla/road/element/RoadInfoLaneWidth.h>
 #include <carla/road/element/RoadInfoMarkRecord.h>/// @brief 包含道路标记记录信息相关的类
 #include <carla/road/element/RoadInfoVisitor.h>/// @brief 包含道路信息访问者模式的基类，用于遍历路网元素。
 
 #include <pugixml/pugixml.hpp>/// @brief 包含pugixml库的头文件，用于XML解析和生成。
 
+#include <boost/filesystem/operations.hpp>
+
+#include <array>
+#include <cstdio>
 #include <fstream>/// @brief 包含C++标准库的文件流类，用于文件读写。
+#include <limits>
 #include <string>/// @brief 包含C++标准库的字符串类。
+#include <unordered_set>
 
 using namespace carla::road;/// 导入CARLA的路面相关命名空间，包括道路定义和元素。
 using namespace carla::road::element;/// 导入CARLA的路面元素相关的命名空间，包括具体的道路元素定义。
@@ -504,3 +524,436 @@ TEST(road, get_waypoint) {
     result.get();
   }
 }
+
+TEST(road, get_waypoint_batch) {
+  constexpr auto number_of_locations = 100'000u;
+  for (const auto& file : util::OpenDrive::GetAvailableFiles()) {
+    auto m = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(m.has_value());
+    auto &map = *m;
+
+    std::vector<Location> locations;
+    locations.reserve(number_of_locations);
+    for (auto i = 0u; i < number_of_locations; ++i) {
+      locations.emplace_back(Random::Location(-500.0f, 500.0f));
+    }
+
+    // 逐个查询，作为对比的基准
+    carla::StopWatch loop_watch;
+    std::vector<boost::optional<Waypoint>> expected;
+    expected.reserve(locations.size());
+    for (const auto &location : locations) {
+      expected.emplace_back(map.GetClosestWaypointOnRoad(location));
+    }
+    loop_watch.Stop();
+
+    // 批量并行查询，结果必须与逐个查询完全一致
+    carla::StopWatch batch_watch;
+    auto result = map.GetWaypointBatch(locations.data(), locations.size());
+    batch_watch.Stop();
+
+    ASSERT_EQ(result.size(), expected.size());
+    for (auto i = 0u; i < result.size(); ++i) {
+      ASSERT_TRUE(result[i] == expected[i]);
+    }
+    carla::logging::log(
+        file, number_of_locations, "locations: loop",
+        1e-3f * loop_watch.GetElapsedTime(), "s, batch",
+        1e-3f * batch_watch.GetElapsedTime(), "s.");
+
+    // 不投影到道路时与 GetWaypoint 一致
+    auto exact = map.GetWaypointBatch(locations.data(), 1'000u, false);
+    for (auto i = 0u; i < exact.size(); ++i) {
+      ASSERT_TRUE(exact[i] == map.GetWaypoint(locations[i]));
+    }
+  }
+}
+
+// 比较查找表插值与精确求解的结果，并测量两者的耗时
+template <typename GeometryT>
+static void test_arc_length_table(const std::string &name, GeometryT exact) {
+  GeometryT cached = exact;
+  cached.PrecomputeArcLengthTable();
+  constexpr auto number_of_samples = 10'000u;
+  const double length = exact.GetLength();
+
+  carla::StopWatch exact_watch;
+  std::vector<DirectedPoint> expected;
+  expected.reserve(number_of_samples);
+  for (auto i = 0u; i < number_of_samples; ++i) {
+    expected.emplace_back(exact.PosFromDist(length * i / (number_of_samples - 1u)));
+  }
+  exact_watch.Stop();
+
+  carla::StopWatch cached_watch;
+  std::vector<DirectedPoint> result;
+  result.reserve(number_of_samples);
+  for (auto i = 0u; i < number_of_samples; ++i) {
+    result.emplace_back(cached.PosFromDist(length * i / (number_of_samples - 1u)));
+  }
+  cached_watch.Stop();
+
+  for (auto i = 0u; i < number_of_samples; ++i) {
+    ASSERT_NEAR(result[i].location.x, expected[i].location.x, 0.01);
+    ASSERT_NEAR(result[i].location.y, expected[i].location.y, 0.01);
+    ASSERT_NEAR(result[i].tangent, expected[i].tangent, 1e-3);
+  }
+  carla::logging::log(
+      name, number_of_samples, "samples: exact",
+      exact_watch.GetElapsedTime<std::chrono::microseconds>(), "us, table",
+      cached_watch.GetElapsedTime<std::chrono::microseconds>(), "us.");
+}
+
+TEST(road, geometry_arc_length_table) {
+  const Location start(10.0f, -5.0f, 0.0f);
+  test_arc_length_table("spiral", GeometrySpiral(0.0, 80.0, 0.3, start, 0.001, 0.05));
+  test_arc_length_table("poly3", GeometryPoly3(0.0, 120.0, -0.2, start, 0.0, 0.05, 0.002, -1e-5));
+  test_arc_length_table("paramPoly3 (arcLength)", GeometryParamPoly3(
+      0.0, 100.0, 1.0, start, 0.0, 1.0, -2e-4, 1e-7, 0.0, 0.0, 3e-3, -1e-5, true));
+  test_arc_length_table("paramPoly3 (normalized)", GeometryParamPoly3(
+      0.0, 60.0, 1.0, start, 0.0, 55.0, 8.0, -3.0, 0.0, 0.0, 20.0, -5.0, false));
+}
+
+// 返回测试目录中最大的OpenDRIVE文件，用于性能测试
+static std::string GetLargestOpenDriveFile() {
+  std::string largest;
+  size_t largest_size = 0u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const auto size = util::OpenDrive::Load(file).size();
+    if (size > largest_size) {
+      largest = file;
+      largest_size = size;
+    }
+  }
+  return largest;
+}
+
+TEST(road, benchmark_generate_waypoints_and_topology) {
+  // 在最大的OpenDRIVE文件上测量，这两个操作都大量调用 PosFromDist
+  const std::string largest = GetLargestOpenDriveFile();
+  ASSERT_FALSE(largest.empty());
+
+  auto m = OpenDriveParser::Load(util::OpenDrive::Load(largest));
+  ASSERT_TRUE(m.has_value());
+  auto &map = *m;
+
+  carla::StopWatch waypoints_watch;
+  const auto waypoints = map.GenerateWaypoints(1.0);
+  waypoints_watch.Stop();
+  ASSERT_FALSE(waypoints.empty());
+
+  carla::StopWatch topology_watch;
+  const auto topology = map.GenerateTopology();
+  topology_watch.Stop();
+  ASSERT_FALSE(topology.empty());
+
+  carla::logging::log(
+      largest, ": GenerateWaypoints", waypoints.size(), "waypoints in",
+      waypoints_watch.GetElapsedTime(), "ms, GenerateTopology",
+      topology.size(), "edges in", topology_watch.GetElapsedTime(), "ms.");
+}
+
+TEST(road, benchmark_generate_mesh) {
+  const std::string largest = GetLargestOpenDriveFile();
+  ASSERT_FALSE(largest.empty());
+  auto m = OpenDriveParser::Load(util::OpenDrive::Load(largest));
+  ASSERT_TRUE(m.has_value());
+  auto &map = *m;
+
+  carla::StopWatch mesh_watch;
+  const auto mesh = map.GenerateMesh(2.0);
+  mesh_watch.Stop();
+  ASSERT_TRUE(mesh.IsValid());
+
+  // 并行生成的结果必须是确定的
+  const auto again = map.GenerateMesh(2.0);
+  ASSERT_EQ(mesh.GetVertices(), again.GetVertices());
+  ASSERT_EQ(mesh.GetIndexes(), again.GetIndexes());
+
+  carla::rpc::OpendriveGenerationParameters params;
+  carla::StopWatch chunked_watch;
+  const auto chunks = map.GenerateChunkedMesh(params);
+  chunked_watch.Stop();
+  ASSERT_FALSE(chunks.empty());
+
+  const auto chunks_again = map.GenerateChunkedMesh(params);
+  ASSERT_EQ(chunks.size(), chunks_again.size());
+  size_t number_of_vertices = 0u;
+  for (size_t i = 0u; i < chunks.size(); ++i) {
+    ASSERT_EQ(chunks[i]->GetVertices(), chunks_again[i]->GetVertices());
+    number_of_vertices += chunks[i]->GetVerticesNum();
+  }
+
+  carla::logging::log(
+      largest, ": GenerateMesh", mesh.GetVerticesNum(), "vertices in",
+      mesh_watch.GetElapsedTime(), "ms, GenerateChunkedMesh", chunks.size(),
+      "chunks and", number_of_vertices, "vertices in",
+      chunked_watch.GetElapsedTime(), "ms.");
+}
+
+// 按原来的顺序串行执行所有解析步骤，作为并行加载的对比基准
+static boost::optional<Map> LoadSerially(const std::string &opendrive) {
+  namespace parser = carla::opendrive::parser;
+  pugi::xml_document xml;
+  if (!xml.load_string(opendrive.c_str())) {
+    return {};
+  }
+  carla::road::MapBuilder map_builder;
+  parser::GeoReferenceParser::Parse(xml, map_builder);
+  parser::RoadParser::Parse(xml, map_builder);
+  parser::JunctionParser::Parse(xml, map_builder);
+  parser::GeometryParser::Parse(xml, map_builder);
+  parser::LaneParser::Parse(xml, map_builder);
+  parser::ProfilesParser::Parse(xml, map_builder);
+  parser::TrafficGroupParser::Parse(xml, map_builder);
+  parser::SignalParser::Parse(xml, map_builder);
+  parser::ObjectParser::Parse(xml, map_builder);
+  parser::ControllerParser::Parse(xml, map_builder);
+  return map_builder.Build();
+}
+
+TEST(road, benchmark_load) {
+  constexpr auto number_of_runs = 3u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const std::string opendrive = util::OpenDrive::Load(file);
+
+    carla::StopWatch serial_watch;
+    for (auto i = 1u; i < number_of_runs; ++i) {
+      LoadSerially(opendrive);
+    }
+    auto expected = LoadSerially(opendrive);
+    serial_watch.Stop();
+    ASSERT_TRUE(expected.has_value());
+
+    carla::StopWatch parallel_watch;
+    for (auto i = 1u; i < number_of_runs; ++i) {
+      OpenDriveParser::Load(opendrive);
+    }
+    auto result = OpenDriveParser::Load(opendrive);
+    parallel_watch.Stop();
+    ASSERT_TRUE(result.has_value());
+
+    // 并行解析的地图必须与串行解析的完全一致
+    const auto expected_waypoints = expected->GenerateWaypoints(2.0);
+    const auto waypoints = result->GenerateWaypoints(2.0);
+    ASSERT_EQ(waypoints.size(), expected_waypoints.size());
+    for (auto i = 0u; i < waypoints.size(); ++i) {
+      ASSERT_EQ(waypoints[i], expected_waypoints[i]);
+      ASSERT_EQ(
+          result->ComputeTransform(waypoints[i]),
+          expected->ComputeTransform(expected_waypoints[i]));
+    }
+
+    carla::logging::log(
+        file, ": load serial",
+        serial_watch.GetElapsedTime() / number_of_runs, "ms, parallel",
+        parallel_watch.GetElapsedTime() / number_of_runs, "ms.");
+  }
+}
+
+TEST(road, map_snapshot) {
+  using carla::road::MapSnapshot;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    const std::string opendrive = util::OpenDrive::Load(file);
+    const auto hash = MapSnapshot::ComputeHash(opendrive);
+
+    carla::StopWatch parse_watch;
+    auto expected = OpenDriveParser::Load(opendrive);
+    parse_watch.Stop();
+    ASSERT_TRUE(expected.has_value());
+
+    const auto snapshot = MapSnapshot::Serialize(*expected, hash);
+
+    carla::StopWatch load_watch;
+    auto result = MapSnapshot::Load(snapshot.data(), snapshot.size(), hash);
+    load_watch.Stop();
+    ASSERT_TRUE(result.has_value());
+
+    // 快照恢复的地图必须与解析得到的地图一致，道路的遍历顺序可能不同
+    const auto expected_waypoints = expected->GenerateWaypoints(2.0);
+    const auto waypoints = result->GenerateWaypoints(2.0);
+    ASSERT_EQ(waypoints.size(), expected_waypoints.size());
+    const std::unordered_set<carla::road::element::Waypoint> waypoint_set(
+        waypoints.begin(), waypoints.end());
+    for (const auto &waypoint : expected_waypoints) {
+      ASSERT_EQ(waypoint_set.count(waypoint), 1u);
+      const auto transform = expected->ComputeTransform(waypoint);
+      ASSERT_EQ(result->ComputeTransform(waypoint), transform);
+      ASSERT_EQ(result->GetLaneWidth(waypoint), expected->GetLaneWidth(waypoint));
+      ASSERT_EQ(result->GetNext(waypoint, 5.0).size(), expected->GetNext(waypoint, 5.0).size());
+      ASSERT_TRUE(
+          result->GetClosestWaypointOnRoad(transform.location) ==
+          expected->GetClosestWaypointOnRoad(transform.location));
+    }
+    ASSERT_EQ(result->GetSignals().size(), expected->GetSignals().size());
+    ASSERT_EQ(result->GetControllers().size(), expected->GetControllers().size());
+    ASSERT_EQ(result->GetJunctionsBoundingBoxes().size(), expected->GetJunctionsBoundingBoxes().size());
+
+    // 内容不同、版本不符或被截断的快照必须被拒绝
+    ASSERT_FALSE(MapSnapshot::Load(snapshot.data(), snapshot.size(), hash + 1u).has_value());
+    ASSERT_FALSE(MapSnapshot::Load(snapshot.data(), snapshot.size() / 2u, hash).has_value());
+    auto corrupted = snapshot;
+    corrupted[8u] ^= 0xFFu;
+    ASSERT_FALSE(MapSnapshot::Load(corrupted.data(), corrupted.size(), hash).has_value());
+
+    // 通过文件保存并映射加载，写入临时目录，结束时连同残留的临时文件一起删除
+    const auto folder =
+        boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+    const std::string filename = (folder / "test_map_snapshot.bin").string();
+    ASSERT_TRUE(MapSnapshot::Save(*expected, hash, filename));
+    ASSERT_TRUE(MapSnapshot::Load(filename, hash).has_value());
+    std::remove(filename.c_str());
+    ASSERT_FALSE(MapSnapshot::Load(filename, hash).has_value());
+
+    // 无法写入缓存时只返回false，不抛出异常
+    const std::string unwritable = (folder / "test_map_snapshot.bin" / "snapshot.bin").string();
+    ASSERT_TRUE(MapSnapshot::Save(*expected, hash, filename));
+    EXPECT_FALSE(MapSnapshot::Save(*expected, hash, unwritable));
+    boost::filesystem::remove_all(folder);
+
+    carla::logging::log(
+        file, ": parse", parse_watch.GetElapsedTime(), "ms, load snapshot",
+        load_watch.GetElapsedTime(), "ms (", snapshot.size(), "bytes).");
+  }
+}
+
+// 不经过类型索引，用访问者在全部信息中查找距离不大于s的最后一个T类型信息
+template <typename T>
+static const T *FindLastInfo(
+    const std::vector<std::unique_ptr<carla::road::element::RoadInfo>> &infos,
+    const double s) {
+  const T *result = nullptr;
+  for (auto it = carla::road::element::MakeRoadInfoIterator<T>(infos); !it.IsAtEnd(); ++it) {
+    if (it->GetDistance() <= s) {
+      result = &*it;
+    }
+  }
+  return result;
+}
+
+TEST(road, benchmark_compute_transform) {
+  using namespace carla::road::element;
+  constexpr auto number_of_runs = 10u;
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto waypoints = map->GenerateWaypoints(1.0);
+    ASSERT_FALSE(waypoints.empty());
+
+    // 按类型索引的查找结果必须与不经过索引的线性查找结果一致
+    for (const auto &waypoint : waypoints) {
+      const auto &lane = map->GetLane(waypoint);
+      ASSERT_EQ(
+          lane.GetInfo<RoadInfoLaneWidth>(waypoint.s),
+          FindLastInfo<RoadInfoLaneWidth>(lane.GetAllInfos(), waypoint.s));
+      const auto *road = lane.GetRoad();
+      ASSERT_EQ(
+          road->GetInfo<RoadInfoLaneOffset>(waypoint.s),
+          FindLastInfo<RoadInfoLaneOffset>(road->GetAllInfos(), waypoint.s));
+    }
+
+    carla::StopWatch watch;
+    float checksum = 0.0f;
+    for (auto i = 0u; i < number_of_runs; ++i) {
+      for (const auto &waypoint : waypoints) {
+        checksum += map->ComputeTransform(waypoint).location.x;
+      }
+    }
+    watch.Stop();
+    ASSERT_FALSE(std::isnan(checksum));
+
+    carla::logging::log(
+        file, ": ComputeTransform",
+        static_cast<double>(watch.GetElapsedTime<std::chrono::nanoseconds>()) /
+            static_cast<double>(number_of_runs * waypoints.size()),
+        "ns per waypoint over", waypoints.size(), "waypoints.");
+  }
+}
+
+// 原先 Map::GetNext/GetPrevious 的递归实现，用于验证邻接表与缓冲区版本
+static std::vector<Waypoint> ReferenceGetNext(
+    const Map &map,
+    const Waypoint waypoint,
+    const double distance,
+    const bool reverse) {
+  constexpr double epsilon = 10.0 * std::numeric_limits<double>::epsilon();
+  if (distance <= epsilon) {
+    return {waypoint};
+  }
+  const auto &lane = map.GetLane(waypoint);
+  const bool forward = reverse ? (waypoint.lane_id > 0) : (waypoint.lane_id <= 0);
+  const double relative_s = waypoint.s - lane.GetDistance();
+  const double remaining_lane_length = forward ? lane.GetLength() - relative_s : relative_s;
+  if (distance <= remaining_lane_length) {
+    Waypoint result = waypoint;
+    result.s += forward ? distance : -distance;
+    result.s += forward ? -epsilon : epsilon;
+    return {result};
+  }
+  std::vector<Waypoint> result;
+  const auto &lanes = reverse ? lane.GetPreviousLanes() : lane.GetNextLanes();
+  for (const auto *next_lane : lanes) {
+    // 相邻车道的入口（GetNext）或出口（GetPrevious）
+    const bool at_start = reverse ? (next_lane->GetId() > 0) : (next_lane->GetId() <= 0);
+    const double s = at_start ?
+        next_lane->GetDistance() + 10.0 * epsilon :
+        next_lane->GetDistance() + next_lane->GetLength() - 10.0 * epsilon;
+    auto next = ReferenceGetNext(
+        map,
+        Waypoint{next_lane->GetRoad()->GetId(), next_lane->GetLaneSection()->GetId(), next_lane->GetId(), s},
+        distance - remaining_lane_length,
+        reverse);
+    // 与原先的 ConcatVectors 相同，较长的向量在前
+    if (next.size() > result.size()) {
+      std::swap(next, result);
+    }
+    result.insert(result.end(), next.begin(), next.end());
+  }
+  return result;
+}
+
+TEST(road, get_next_with_buffer) {
+  constexpr double distances[] = {0.5, 5.0, 50.0, 250.0};
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    auto map = OpenDriveParser::Load(util::OpenDrive::Load(file));
+    ASSERT_TRUE(map.has_value());
+    const auto waypoints = map->GenerateWaypoints(5.0);
+    ASSERT_FALSE(waypoints.empty());
+
+    std::array<Waypoint, 4u> buffer;
+    for (const auto &waypoint : waypoints) {
+      for (const auto distance : distances) {
+        for (const bool reverse : {false, true}) {
+          const auto expected = ReferenceGetNext(*map, waypoint, distance, reverse);
+          const auto result = reverse ?
+              map->GetPrevious(waypoint, distance) :
+              map->GetNext(waypoint, distance);
+          ASSERT_EQ(result.size(), expected.size());
+          for (auto i = 0u; i < result.size(); ++i) {
+            ASSERT_EQ(result[i], expected[i]);
+          }
+          // 缓冲区不够大时只返回所需的数量
+          const size_t count = reverse ?
+              map->GetPrevious(waypoint, distance, buffer.data(), buffer.size()) :
+              map->GetNext(waypoint, distance, buffer.data(), buffer.size());
+          ASSERT_EQ(count, expected.size());
+          for (auto i = 0u; i < count && count <= buffer.size(); ++i) {
+            ASSERT_EQ(buffer[i], expected[i]);
+          }
+        }
+      }
+    }
+
+    carla::StopWatch watch;
+    size_t total = 0u;
+    for (const auto &waypoint : waypoints) {
+      total += map->GetNext(waypoint, 50.0, buffer.data(), buffer.size());
+    }
+    watch.Stop();
+    carla::logging::log(
+        file, ": GetNext",
+        static_cast<double>(watch.GetElapsedTime<std::chrono::nanoseconds>()) /
+            static_cast<double>(waypoints.size()),
+        "ns per waypoint,", total, "waypoints found.");
+  }
+}
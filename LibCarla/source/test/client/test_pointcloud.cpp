@@ -0,0 +1,205 @@
+// Copyright (c) 2017 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+
+#include <carla/pointcloud/PointCloudIO.h>
+#include <carla/sensor/data/LidarData.h>
+#include <carla/StopWatch.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using carla::pointcloud::PointCloudIO;
+using carla::sensor::data::LidarDetection;
+using carla::sensor::data::SemanticLidarDetection;
+
+// 模拟旋转激光雷达的扫描：按通道排列，相邻的点距离相近
+static std::vector<LidarDetection> MakeLidarScan(size_t channels, size_t points_per_channel) {
+  std::mt19937 engine(42u);
+  std::normal_distribution<float> noise(0.0f, 0.02f);
+  std::vector<LidarDetection> points;
+  points.reserve(channels * points_per_channel);
+  for (size_t c = 0u; c < channels; ++c) {
+    const float pitch = -0.4f + 0.6f * static_cast<float>(c) / static_cast<float>(channels);
+    for (size_t i = 0u; i < points_per_channel; ++i) {
+      const float yaw = 6.2831853f * static_cast<float>(i) / static_cast<float>(points_per_channel);
+      const float range = 20.0f + 5.0f * std::sin(3.0f * yaw) + noise(engine);
+      const float x = range * std::cos(pitch) * std::cos(yaw);
+      const float y = range * std::cos(pitch) * std::sin(yaw);
+      const float z = range * std::sin(pitch);
+      points.emplace_back(x, y, z, std::exp(-0.004f * range));
+    }
+  }
+  return points;
+}
+
+template <typename PointT>
+static void ExpectSameBytes(const std::vector<PointT> &lhs, const std::vector<PointT> &rhs) {
+  ASSERT_EQ(lhs.size(), rhs.size());
+  EXPECT_EQ(std::memcmp(lhs.data(), rhs.data(), lhs.size() * sizeof(PointT)), 0);
+}
+
+template <typename PointT>
+static std::vector<PointT> RoundTrip(const std::vector<PointT> &points) {
+  std::stringstream stream;
+  PointCloudIO::Dump(stream, points.begin(), points.end(), PointCloudIO::Format::Compressed);
+  return PointCloudIO::LoadCompressed<PointT>(stream);
+}
+
+TEST(pointcloud, binary_ply) {
+  const std::vector<SemanticLidarDetection> points = {
+    {1.0f, -2.0f, 3.5f, 0.25f, 7u, 14u},
+    {-0.5f, 4.0f, 0.0f, 1.0f, 8u, 1u}};
+  std::ostringstream out;
+  PointCloudIO::DumpBinary(out, points.data(), points.data() + points.size());
+  const std::string header =
+      "ply\n"
+      "format binary_little_endian 1.0\n"
+      "element vertex 2\n"
+      "property float32 x\n"
+      "property float32 y\n"
+      "property float32 z\n"
+      "property float32 CosAngle\n"
+      "property uint32 ObjIdx\n"
+      "property uint32 ObjTag\n"
+      "end_header\n";
+  const std::string result = out.str();
+  ASSERT_EQ(result.size(), header.size() + 2u * 24u);
+  ASSERT_EQ(result.substr(0u, header.size()), header);
+  const auto *body = reinterpret_cast<const uint8_t *>(result.data() + header.size());
+  // 第一个点的 ObjTag（偏移20）按小端写出
+  EXPECT_EQ(body[20u], 14u);
+  EXPECT_EQ(body[21u], 0u);
+  // 第二个点的 y = 4.0f = 0x40800000
+  EXPECT_EQ(body[24u + 4u], 0x00u);
+  EXPECT_EQ(body[24u + 6u], 0x80u);
+  EXPECT_EQ(body[24u + 7u], 0x40u);
+}
+
+TEST(pointcloud, compressed_round_trip) {
+  // 空点云与不满一个块的点云
+  ExpectSameBytes(RoundTrip(std::vector<LidarDetection>{}), {});
+  ExpectSameBytes(RoundTrip(MakeLidarScan(1u, 100u)), MakeLidarScan(1u, 100u));
+
+  // 多个块，包括不满的最后一块
+  const auto scan = MakeLidarScan(64u, 2000u);
+  ExpectSameBytes(RoundTrip(scan), scan);
+
+  // 随机数据，包括 NaN 与无穷大等特殊值
+  std::mt19937 engine(7u);
+  std::vector<SemanticLidarDetection> random(PointCloudIO::COMPRESSED_CHUNK_SIZE + 1u);
+  for (auto &point : random) {
+    uint32_t words[6u];
+    for (auto &word : words) {
+      word = engine();
+    }
+    std::memcpy(&point, words, sizeof(point));
+  }
+  ExpectSameBytes(RoundTrip(random), random);
+
+  // 语义标签大多相同，压缩效果明显
+  std::vector<SemanticLidarDetection> semantic;
+  for (const auto &point : scan) {
+    semantic.emplace_back(point.point, point.intensity, 100u, 7u);
+  }
+  std::stringstream stream;
+  PointCloudIO::Dump(stream, semantic.begin(), semantic.end(), PointCloudIO::Format::Compressed);
+  const size_t compressed_size = stream.str().size();
+  EXPECT_LT(compressed_size, semantic.size() * sizeof(SemanticLidarDetection) / 2u);
+  ExpectSameBytes(PointCloudIO::LoadCompressed<SemanticLidarDetection>(stream), semantic);
+}
+
+TEST(pointcloud, compressed_invalid_input) {
+  const auto scan = MakeLidarScan(4u, 1000u);
+  std::ostringstream out;
+  PointCloudIO::DumpCompressed(out, scan.data(), scan.data() + scan.size());
+  const std::string data = out.str();
+
+  // 截断的数据
+  std::istringstream truncated(data.substr(0u, data.size() - 10u));
+  EXPECT_THROW(PointCloudIO::LoadCompressed<LidarDetection>(truncated), std::runtime_error);
+
+  // 属性与点的类型不一致
+  std::istringstream mismatched(data);
+  EXPECT_THROW(PointCloudIO::LoadCompressed<SemanticLidarDetection>(mismatched), std::runtime_error);
+
+  // 不是压缩格式
+  std::ostringstream ply;
+  PointCloudIO::DumpBinary(ply, scan.data(), scan.data() + scan.size());
+  std::istringstream binary(ply.str());
+  EXPECT_THROW(PointCloudIO::LoadCompressed<LidarDetection>(binary), std::runtime_error);
+}
+
+TEST(pointcloud, compressed_untrusted_counts) {
+  const auto scan = MakeLidarScan(4u, 1000u);
+  std::ostringstream out;
+  PointCloudIO::DumpCompressed(out, scan.data(), scan.data() + scan.size());
+  const std::string data = out.str();
+  const std::string end_header = "end_header\n";
+  const size_t body = data.find(end_header) + end_header.size();
+
+  // 文件头中的点数远超剩余数据，应在分配内存前拒绝
+  for (const char *count : {"4000000000", "18446744073709551615"}) {
+    std::string header = data.substr(0u, body);
+    const std::string element = "element vertex ";
+    const size_t begin = header.find(element) + element.size();
+    header.replace(begin, header.find('\n', begin) - begin, count);
+    std::istringstream in(header + data.substr(body));
+    EXPECT_THROW(PointCloudIO::LoadCompressed<LidarDetection>(in), std::runtime_error);
+  }
+
+  // 块头中的点数超过 COMPRESSED_CHUNK_SIZE
+  std::string chunk = data;
+  for (size_t b = 0u; b < 4u; ++b) {
+    chunk[body + b] = '\xff';
+  }
+  std::istringstream in(chunk);
+  EXPECT_THROW(PointCloudIO::LoadCompressed<LidarDetection>(in), std::runtime_error);
+}
+
+TEST(pointcloud, save_to_disk_async) {
+  const auto scan = MakeLidarScan(32u, 1000u);
+  const auto folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  std::string path = (folder / "scan").string();
+  auto future = PointCloudIO::SaveToDiskAsync(
+      path,
+      scan.begin(),
+      scan.end(),
+      PointCloudIO::Format::Compressed);
+  // 路径在写入完成之前就已补全
+  EXPECT_EQ(boost::filesystem::path(path).extension().string(), ".cpc");
+  EXPECT_EQ(future.get(), path);
+  {
+    std::ifstream in(path, std::ios::binary);
+    ExpectSameBytes(PointCloudIO::LoadCompressed<LidarDetection>(in), scan);
+  }
+  boost::filesystem::remove_all(folder);
+}
+
+TEST(pointcloud, benchmark_formats) {
+  const auto scan = MakeLidarScan(64u, 16000u);
+  for (auto format : {
+      PointCloudIO::Format::Ascii,
+      PointCloudIO::Format::BinaryLittleEndian,
+      PointCloudIO::Format::Compressed}) {
+    std::ostringstream out;
+    carla::StopWatch stop_watch;
+    PointCloudIO::Dump(out, scan.begin(), scan.end(), format);
+    stop_watch.Stop();
+    carla::logging::log(
+        "format", static_cast<int>(format), ":",
+        out.str().size() / 1024u, "KiB in",
+        stop_watch.GetElapsedTime(), "ms");
+  }
+}
@@ -8,14 +8,23 @@
 //包含一个自定义的头文件"test.h"。
 // 通常在"test.h"里会有当前源文件所需的函数声明、结构体定义、宏定义等内容，方便在本文件中调用相关功能。
 #include <carla/MsgPackAdaptors.h>//包含来自名为"carla"的项目（可能是库等）下的头文件。
+#include <carla/StopWatch.h>
 #include <carla/ThreadGroup.h>//同样是从"carla"项目中引入头文件，此头文件大概率是关于线程组（ThreadGroup）的相关定义。
 // 例如可能包含创建、管理线程组的类，或者操作线程组的函数等，方便在代码中进行多线程相关的编程操作。
+#include <carla/client/detail/Client.h>
 #include <carla/rpc/Actor.h>//
 #include <carla/rpc/Client.h>
 #include <carla/rpc/Response.h>
 #include <carla/rpc/Server.h>
+#include <carla/rpc/VehicleLightState.h>
 
+#include <rpc/rpc_error.h>
+
+#include <atomic>
+#include <future>
+#include <numeric>
 #include <thread>
+#include <vector>
 
 using namespace carla::rpc;
 using namespace std::chrono_literals;
@@ -80,3 +89,148 @@ TEST(rpc, server_bind_sync_run_on_game_thread) {
   // 断言任务已完成
   ASSERT_TRUE(done);
 }
+
+// 比较三种查询1000个参与者的方式：逐个同步调用、流水线调用以及服务器端的批量调用。
+// 游戏线程每一帧只处理一小段时间的同步调用，与服务器的实际情况相同，因此逐个
+// 同步调用的每次往返都要等待下一帧。
+TEST(rpc, benchmark_pipelined_queries) {
+  constexpr uint32_t number_of_queries = 1000u;
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  Server server(port);
+  server.BindSync("get_value", [](uint32_t id) -> Response<uint32_t> {
+    return 2u * id;
+  });
+  server.BindSync("get_value_batch", [](const std::vector<uint32_t> &ids) {
+    std::vector<Response<uint32_t>> result;
+    result.reserve(ids.size());
+    for (auto id : ids) {
+      result.emplace_back(2u * id);
+    }
+    return result;
+  });
+  server.AsyncRun(2u);
+
+  std::vector<uint32_t> ids(number_of_queries);
+  std::iota(ids.begin(), ids.end(), 0u);
+
+  std::atomic_bool done{false};
+  carla::ThreadGroup threads;
+  threads.CreateThread([&]() {
+    Client client("localhost", port);
+    auto benchmark = [](const char *name, auto &&run) {
+      carla::StopWatch stop_watch;
+      run();
+      stop_watch.Stop();
+      const auto elapsed = std::max<size_t>(1u, stop_watch.GetElapsedTime<std::chrono::microseconds>());
+      std::cout << name << ": " << number_of_queries << " queries in " << elapsed / 1000.0
+                << " ms (" << 1e6 * number_of_queries / elapsed << " queries/s)\n";
+      return elapsed;
+    };
+
+    const auto sequential = benchmark("sequential", [&]() {
+      for (auto id : ids) {
+        auto response = client.call("get_value", id).as<Response<uint32_t>>();
+        EXPECT_EQ(response.Get(), 2u * id);
+      }
+    });
+
+    const auto pipelined = benchmark("pipelined ", [&]() {
+      std::vector<decltype(client.async_request("get_value", ids.front()))> futures;
+      futures.reserve(ids.size());
+      for (auto id : ids) {
+        futures.emplace_back(client.async_request("get_value", id));
+      }
+      for (auto i = 0u; i < futures.size(); ++i) {
+        auto response = futures[i].get().as<Response<uint32_t>>();
+        EXPECT_EQ(response.Get(), 2u * ids[i]);
+      }
+    });
+
+    const auto batch = benchmark("batch     ", [&]() {
+      auto responses = client.call("get_value_batch", ids).as<std::vector<Response<uint32_t>>>();
+      ASSERT_EQ(responses.size(), ids.size());
+      for (auto i = 0u; i < responses.size(); ++i) {
+        EXPECT_EQ(responses[i].Get(), 2u * ids[i]);
+      }
+    });
+
+    EXPECT_LT(pipelined, sequential);
+    EXPECT_LT(batch, sequential);
+    done = true;
+  });
+
+  // 模拟游戏线程：每一帧处理1毫秒的同步调用，其余时间用于其他工作
+  while (!done) {
+    server.SyncRunFor(1ms);
+    std::this_thread::sleep_for(1ms);
+  }
+}
+
+// 服务器没有批量接口时退回到流水线逐个调用，批量接口本身出错时不退回
+TEST(rpc, client_batch_call_fallback) {
+  using DetailClient = carla::client::detail::Client;
+  const uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 2017u);
+  std::atomic_size_t single_calls{0u};
+  std::atomic_size_t batch_calls{0u};
+  auto get_light_state = [&](ActorId id) -> Response<VehicleLightState> {
+    ++single_calls;
+    if (id == 0u) {
+      return ResponseError("not a vehicle");
+    }
+    return VehicleLightState(id);
+  };
+  auto check = [](const std::vector<boost::optional<VehicleLightState>> &result,
+                  const std::vector<ActorId> &ids) {
+    ASSERT_EQ(result.size(), ids.size());
+    for (auto i = 0u; i < ids.size(); ++i) {
+      if (ids[i] == 0u) {
+        EXPECT_FALSE(result[i]);
+      } else {
+        ASSERT_TRUE(result[i]);
+        EXPECT_EQ(result[i]->GetLightStateAsValue(), ids[i]);
+      }
+    }
+  };
+  const std::vector<ActorId> ids = {1u, 0u, 2u, 3u};
+
+  {
+    // 旧版本的服务器只有逐个查询的接口
+    Server server(port);
+    server.BindAsync("get_vehicle_light_state", get_light_state);
+    server.AsyncRun(1u);
+    DetailClient client("localhost", port, 1u);
+    check(client.GetVehicleLightStateBatch(ids), ids);
+    EXPECT_EQ(single_calls, ids.size());
+    check(client.GetVehicleLightStateBatch(ids), ids);
+    EXPECT_EQ(single_calls, 2u * ids.size());
+  }
+
+  single_calls = 0u;
+  {
+    Server server(port + 1u);
+    server.BindAsync("get_vehicle_light_state", get_light_state);
+    server.BindAsync("get_vehicle_light_state_batch", [&](const std::vector<ActorId> &batch) {
+      ++batch_calls;
+      if (batch.size() > ids.size()) {
+        throw std::runtime_error("too many vehicles");
+      }
+      std::vector<Response<VehicleLightState>> result;
+      for (auto id : batch) {
+        result.emplace_back(id == 0u ?
+            Response<VehicleLightState>(ResponseError("not a vehicle")) :
+            Response<VehicleLightState>(VehicleLightState(id)));
+      }
+      return result;
+    });
+    server.AsyncRun(1u);
+    DetailClient client("localhost", port + 1u, 1u);
+    check(client.GetVehicleLightStateBatch(ids), ids);
+    EXPECT_EQ(batch_calls, 1u);
+    // 批量接口内部的错误交给调用者，之后仍然使用批量接口
+    EXPECT_THROW(client.GetVehicleLightStateBatch(std::vector<ActorId>(ids.size() + 1u, 1u)), ::rpc::rpc_error);
+    EXPECT_EQ(batch_calls, 2u);
+    check(client.GetVehicleLightStateBatch(ids), ids);
+    EXPECT_EQ(batch_calls, 3u);
+    EXPECT_EQ(single_calls, 0u);
+  }
+}
@@ -0,0 +1,1368 @@
+// Copyright (c) 2020 Computer Vision Center (CVC) at the Universitat Autonoma
+// de Barcelona (UAB).
+//
+// This work is licensed under the terms of the MIT license.
+// For a copy, see <https://opensource.org/licenses/MIT>.
+
+#include "test.h"
+#include "OpenDrive.h"
+
+#include <carla/StopWatch.h>
+#include <carla/client/FileTransfer.h>
+#include <carla/client/Landmark.h>
+#include <carla/client/Map.h>
+#include <carla/client/Waypoint.h>
+#include <carla/rpc/ActorId.h>
+#include <carla/rpc/MapInfo.h>
+#include <carla/trafficmanager/CollisionStage.h>
+#include <carla/trafficmanager/Constants.h>
+#include <carla/trafficmanager/ControlFrameFilter.h>
+#include <carla/trafficmanager/FlatHashMap.h>
+#include <carla/trafficmanager/InMemoryMap.h>
+#include <carla/trafficmanager/InMemoryMapCache.h>
+#include <carla/trafficmanager/Parameters.h>
+#include <carla/trafficmanager/RandomGenerator.h>
+#include <carla/trafficmanager/SimulationState.h>
+#include <carla/trafficmanager/StageExecutor.h>
+#include <carla/trafficmanager/TrackTraffic.h>
+#include <carla/trafficmanager/TrafficManagerBase.h>
+#include <carla/trafficmanager/TrafficManagerClient.h>
+#include <carla/trafficmanager/TrafficManagerServer.h>
+#include <carla/trafficmanager/VehicleParameter.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using carla::rpc::ActorId;
+using carla::traffic_manager::Buffer;
+using carla::traffic_manager::FlatHashMap;
+using carla::traffic_manager::GeoGridId;
+using carla::traffic_manager::InMemoryMap;
+using carla::traffic_manager::Parameters;
+using carla::traffic_manager::ParametersSnapshot;
+using carla::traffic_manager::RandomGenerator;
+using carla::traffic_manager::SimpleWaypoint;
+using carla::traffic_manager::SimpleWaypointPtr;
+using carla::traffic_manager::StageExecutor;
+using carla::traffic_manager::TrackTraffic;
+
+// 模拟交通管理器阶段的合成负载：车辆在环形道路上行驶，
+// 每辆车读取前车在周期开始时的位置，用自己的随机数流决定加速度，
+// 新位置推迟到 CommitCycle 中写回。
+class SyntheticStage {
+public:
+
+  SyntheticStage(const std::vector<ActorId> &vehicle_id_list,
+                 RandomGenerator &random_device,
+                 const unsigned workload)
+    : _vehicle_id_list(vehicle_id_list),
+      _random_device(random_device),
+      _workload(workload),
+      _positions(vehicle_id_list.size()),
+      _next_positions(vehicle_id_list.size()) {
+    for (size_t i = 0u; i < _positions.size(); ++i) {
+      _positions[i] = static_cast<double>(i) * 10.0;
+    }
+  }
+
+  void PrepareCycle() {}
+
+  void Update(const unsigned long index) {
+    const ActorId actor_id = _vehicle_id_list.at(index);
+    const double position = _positions[index];
+    const double lead = _positions[(index + 1u) % _positions.size()];
+    double gap = std::fmod(lead - position + kRingLength, kRingLength);
+    // 模拟路径点搜索与几何计算的开销
+    for (unsigned i = 0u; i < _workload; ++i) {
+      gap += std::sin(gap + static_cast<double>(i)) * 1e-9;
+    }
+    const double acceleration = _random_device.next(actor_id) * 0.01;
+    _next_positions[index] = std::fmod(position + std::min(gap * 0.5, acceleration), kRingLength);
+  }
+
+  void CommitCycle() {
+    _positions.swap(_next_positions);
+  }
+
+  const std::vector<double> &GetPositions() const {
+    return _positions;
+  }
+
+private:
+
+  static constexpr double kRingLength = 1e5;
+
+  const std::vector<ActorId> &_vehicle_id_list;
+
+  RandomGenerator &_random_device;
+
+  const unsigned _workload;
+
+  std::vector<double> _positions;
+
+  std::vector<double> _next_positions;
+};
+
+static std::vector<ActorId> make_vehicle_ids(const size_t number_of_vehicles) {
+  std::vector<ActorId> ids;
+  for (size_t i = 0u; i < number_of_vehicles; ++i) {
+    ids.push_back(static_cast<ActorId>(100u + 3u * i));
+  }
+  return ids;
+}
+
+static std::vector<double> run_synthetic_stage(
+    const unsigned number_of_workers,
+    const size_t number_of_vehicles,
+    const unsigned workload,
+    const unsigned number_of_cycles,
+    size_t *elapsed_microseconds = nullptr) {
+  const std::vector<ActorId> vehicle_id_list = make_vehicle_ids(number_of_vehicles);
+  RandomGenerator random_device(2020u);
+  random_device.UpdateActors(vehicle_id_list);
+  SyntheticStage stage(vehicle_id_list, random_device, workload);
+  StageExecutor executor(number_of_workers);
+
+  carla::StopWatch stop_watch;
+  for (unsigned cycle = 0u; cycle < number_of_cycles; ++cycle) {
+    stage.PrepareCycle();
+    executor.ParallelFor(vehicle_id_list.size(), [&stage](const unsigned long index) {
+      stage.Update(index);
+    });
+    stage.CommitCycle();
+  }
+  stop_watch.Stop();
+  if (elapsed_microseconds != nullptr) {
+    *elapsed_microseconds = stop_watch.GetElapsedTime<std::chrono::microseconds>();
+  }
+  return stage.GetPositions();
+}
+
+TEST(traffic_manager, stage_executor_visits_every_index_once) {
+  constexpr size_t count = 10007u;
+  for (unsigned workers : {1u, 2u, 3u, 8u}) {
+    StageExecutor executor(workers);
+    ASSERT_EQ(executor.GetNumberOfWorkers(), workers);
+    std::vector<std::atomic<int>> visits(count);
+    for (int round = 0; round < 3; ++round) {
+      executor.ParallelFor(count, [&visits](const unsigned long index) {
+        visits[index].fetch_add(1);
+      });
+    }
+    for (size_t i = 0u; i < count; ++i) {
+      ASSERT_EQ(visits[i].load(), 3) << "index " << i << " with " << workers << " workers";
+    }
+  }
+}
+
+TEST(traffic_manager, stage_executor_rethrows_exceptions) {
+  StageExecutor executor(4u);
+  std::atomic<size_t> calls{0u};
+  ASSERT_THROW(executor.ParallelFor(1000u, [&calls](const unsigned long index) {
+    ++calls;
+    if (index == 500u) {
+      throw std::runtime_error("stage failure");
+    }
+  }), std::runtime_error);
+  // 异常不会中断其他 index 的执行，执行器也可以继续使用。
+  ASSERT_EQ(calls.load(), 1000u);
+  calls = 0u;
+  executor.ParallelFor(1000u, [&calls](const unsigned long) { ++calls; });
+  ASSERT_EQ(calls.load(), 1000u);
+}
+
+TEST(traffic_manager, stage_executor_changes_number_of_workers) {
+  StageExecutor executor;
+  ASSERT_EQ(executor.GetNumberOfWorkers(), 1u);
+  executor.SetNumberOfWorkers(0u);
+  ASSERT_EQ(executor.GetNumberOfWorkers(), std::max(1u, std::thread::hardware_concurrency()));
+  executor.SetNumberOfWorkers(3u);
+  std::atomic<size_t> calls{0u};
+  executor.ParallelFor(100u, [&calls](const unsigned long) { ++calls; });
+  ASSERT_EQ(calls.load(), 100u);
+}
+
+TEST(traffic_manager, random_generator_actor_streams) {
+  const std::vector<ActorId> forward = {1u, 2u, 3u};
+  const std::vector<ActorId> backward = {3u, 2u, 1u};
+  RandomGenerator a(42u);
+  RandomGenerator b(42u);
+  a.UpdateActors(forward);
+  b.UpdateActors(backward);
+  // 每辆车的随机数流只取决于种子和车辆ID，与处理顺序无关。
+  std::vector<double> from_a;
+  for (ActorId id : forward) {
+    from_a.push_back(a.next(id));
+  }
+  std::vector<double> from_b;
+  for (ActorId id : backward) {
+    from_b.push_back(b.next(id));
+  }
+  std::reverse(from_b.begin(), from_b.end());
+  ASSERT_EQ(from_a, from_b);
+  for (double value : from_a) {
+    ASSERT_GE(value, 0.0);
+    ASSERT_LT(value, 100.0);
+  }
+  // 删除车辆不会影响其他车辆的随机数流。
+  RandomGenerator c(42u);
+  c.UpdateActors(forward);
+  c.next(1u);
+  c.UpdateActors({1u, 3u});
+  ASSERT_THROW(c.next(2u), std::out_of_range);
+  RandomGenerator d(42u);
+  d.UpdateActors(forward);
+  d.next(1u);
+  ASSERT_EQ(c.next(1u), d.next(1u));
+  ASSERT_EQ(c.next(3u), d.next(3u));
+}
+
+TEST(traffic_manager, track_traffic_deferred_updates) {
+  const std::vector<ActorId> actors = {7u, 8u, 9u};
+  TrackTraffic direct;
+  TrackTraffic deferred;
+  auto apply = [&actors](TrackTraffic &track_traffic) {
+    for (size_t i = 0u; i < actors.size(); ++i) {
+      track_traffic.UpdatePassingVehicle(10u + i, actors[i]);
+      track_traffic.UpdatePassingVehicle(20u, actors[i]);
+    }
+    track_traffic.RemovePassingVehicle(20u, actors[1]);
+  };
+  direct.UpdatePassingVehicle(30u, actors[0]);
+  deferred.UpdatePassingVehicle(30u, actors[0]);
+
+  apply(direct);
+
+  deferred.BeginDeferredUpdates(actors);
+  apply(deferred);
+  // 推迟期间查询仍返回开始时的状态。
+  ASSERT_TRUE(deferred.GetPassingVehicles(20u).empty());
+  ASSERT_EQ(deferred.GetPassingVehicles(30u).size(), 1u);
+  deferred.CommitDeferredUpdates();
+
+  for (uint64_t waypoint_id : {10u, 11u, 12u, 20u, 30u}) {
+    ASSERT_EQ(direct.GetPassingVehicles(waypoint_id), deferred.GetPassingVehicles(waypoint_id));
+  }
+  ASSERT_EQ(deferred.GetPassingVehicles(20u).size(), 2u);
+
+  // 提交后恢复为立即修改。
+  deferred.RemovePassingVehicle(30u, actors[0]);
+  ASSERT_TRUE(deferred.GetPassingVehicles(30u).empty());
+}
+
+TEST(traffic_manager, parallel_stages_are_deterministic) {
+  const std::vector<double> reference = run_synthetic_stage(1u, 1000u, 50u, 20u);
+  for (unsigned workers : {2u, 3u, 4u, 7u}) {
+    ASSERT_EQ(run_synthetic_stage(workers, 1000u, 50u, 20u), reference) << workers << " workers";
+  }
+}
+
+TEST(traffic_manager, benchmark_stage_executor_scaling) {
+  constexpr size_t number_of_vehicles = 1000u;
+  constexpr unsigned workload = 2000u;
+  constexpr unsigned number_of_cycles = 20u;
+  const unsigned max_workers = std::max(1u, std::thread::hardware_concurrency());
+
+  size_t serial_time = 0u;
+  const std::vector<double> reference =
+      run_synthetic_stage(1u, number_of_vehicles, workload, number_of_cycles, &serial_time);
+  carla::log_info("stage executor: 1 worker,", serial_time / number_of_cycles, "us per cycle");
+
+  for (unsigned workers = 2u; workers <= max_workers; workers *= 2u) {
+    size_t elapsed = 0u;
+    ASSERT_EQ(run_synthetic_stage(workers, number_of_vehicles, workload, number_of_cycles, &elapsed), reference);
+    carla::log_info("stage executor:", workers, "workers,", elapsed / number_of_cycles, "us per cycle, speed-up",
+        static_cast<double>(serial_time) / static_cast<double>(std::max<size_t>(elapsed, 1u)));
+  }
+}
+
+TEST(traffic_manager, flat_hash_map) {
+  FlatHashMap<uint64_t, int> map;
+  std::unordered_map<uint64_t, int> reference;
+  std::mt19937 rng(42u);
+  // 键的范围较小，使插入与删除频繁交替并产生较长的探测链。
+  std::uniform_int_distribution<uint64_t> key_distribution(0u, 300u);
+  for (int i = 0; i < 20000; ++i) {
+    const uint64_t key = key_distribution(rng) * 1024u;
+    if (rng() % 3u == 0u) {
+      ASSERT_EQ(map.Erase(key), reference.erase(key) == 1u);
+    } else {
+      map[key] = i;
+      reference[key] = i;
+    }
+    ASSERT_EQ(map.Size(), reference.size());
+  }
+  for (uint64_t key = 0u; key <= 300u * 1024u; key += 1024u) {
+    auto it = reference.find(key);
+    const int *value = map.Find(key);
+    ASSERT_EQ(value != nullptr, it != reference.end());
+    if (value != nullptr) {
+      ASSERT_EQ(*value, it->second);
+    }
+  }
+  size_t count = 0u;
+  map.ForEach([&](uint64_t key, int value) {
+    ASSERT_EQ(reference.at(key), value);
+    ++count;
+  });
+  ASSERT_EQ(count, reference.size());
+  map.Clear();
+  ASSERT_TRUE(map.Empty());
+  ASSERT_EQ(map.Find(0u), nullptr);
+}
+
+static SimpleWaypointPtr make_waypoint(uint64_t id, GeoGridId grid_id) {
+  carla::traffic_manager::ResolvedWaypoint resolved;
+  resolved.id = id;
+  auto waypoint = std::make_shared<SimpleWaypoint>(nullptr, resolved);
+  waypoint->SetGeodesicGridId(grid_id);
+  return waypoint;
+}
+
+// 车辆沿一条由 number_of_grids 个网格组成的环形路线行驶，每个网格有 waypoints_per_grid 个航点。
+struct SyntheticRoute {
+  std::vector<SimpleWaypointPtr> waypoints;
+
+  SyntheticRoute(size_t number_of_grids, size_t waypoints_per_grid) {
+    for (size_t i = 0u; i < number_of_grids * waypoints_per_grid; ++i) {
+      waypoints.push_back(make_waypoint(i, static_cast<GeoGridId>(i / waypoints_per_grid)));
+    }
+  }
+
+  const SimpleWaypointPtr &at(size_t position) const {
+    return waypoints[position % waypoints.size()];
+  }
+};
+
+static void push_waypoint(TrackTraffic &track_traffic, ActorId actor_id, Buffer &buffer, const SimpleWaypointPtr &waypoint) {
+  buffer.push_back(waypoint);
+  track_traffic.AddBufferWaypoint(actor_id, waypoint->GetId(), waypoint->GetGeodesicGridId());
+}
+
+static void pop_waypoint(TrackTraffic &track_traffic, ActorId actor_id, Buffer &buffer) {
+  const SimpleWaypointPtr waypoint = buffer.front();
+  buffer.pop_front();
+  track_traffic.RemoveBufferWaypoint(actor_id, waypoint->GetId(), waypoint->GetGeodesicGridId());
+}
+
+TEST(traffic_manager, track_traffic_incremental_grids) {
+  const SyntheticRoute route(40u, 10u);
+  const std::vector<ActorId> actors = make_vehicle_ids(30u);
+  std::vector<Buffer> buffers(actors.size());
+  std::vector<size_t> positions(actors.size());
+  TrackTraffic track_traffic;
+  std::mt19937 rng(7u);
+  for (size_t i = 0u; i < actors.size(); ++i) {
+    positions[i] = rng() % route.waypoints.size();
+    for (size_t j = 0u; j < 25u; ++j) {
+      push_waypoint(track_traffic, actors[i], buffers[i], route.at(positions[i] + j));
+    }
+  }
+
+  for (int tick = 0; tick < 200; ++tick) {
+    for (size_t i = 0u; i < actors.size(); ++i) {
+      // 前端弹出若干航点，后端补充到不同的长度。
+      const size_t advance = rng() % 4u;
+      for (size_t j = 0u; j < advance && !buffers[i].empty(); ++j) {
+        pop_waypoint(track_traffic, actors[i], buffers[i]);
+        ++positions[i];
+      }
+      const size_t length = 15u + rng() % 20u;
+      while (buffers[i].size() < length) {
+        push_waypoint(track_traffic, actors[i], buffers[i], route.at(positions[i] + buffers[i].size()));
+      }
+      track_traffic.UpdateGridPosition(actors[i], buffers[i]);
+    }
+
+    // 按缓冲区从头重新计算的结果作为参照。
+    TrackTraffic rebuilt;
+    for (size_t i = 0u; i < actors.size(); ++i) {
+      for (const SimpleWaypointPtr &waypoint : buffers[i]) {
+        rebuilt.UpdatePassingVehicle(waypoint->GetId(), actors[i]);
+      }
+      rebuilt.UpdateGridPosition(actors[i], buffers[i]);
+    }
+    for (size_t i = 0u; i < actors.size(); ++i) {
+      const std::vector<ActorId> overlapping = track_traffic.GetOverlappingVehicles(actors[i]);
+      ASSERT_EQ(overlapping, rebuilt.GetOverlappingVehicles(actors[i]));
+      ASSERT_TRUE(std::is_sorted(overlapping.begin(), overlapping.end()));
+      ASSERT_NE(std::find(overlapping.begin(), overlapping.end(), actors[i]), overlapping.end());
+    }
+    for (const SimpleWaypointPtr &waypoint : route.waypoints) {
+      ASSERT_EQ(track_traffic.GetPassingVehicles(waypoint->GetId()), rebuilt.GetPassingVehicles(waypoint->GetId()));
+      ASSERT_EQ(track_traffic.IsGeoGridFree(waypoint->GetGeodesicGridId()),
+                rebuilt.IsGeoGridFree(waypoint->GetGeodesicGridId()));
+    }
+  }
+
+  for (size_t i = 0u; i < actors.size(); ++i) {
+    track_traffic.DeleteActor(actors[i]);
+  }
+  for (const SimpleWaypointPtr &waypoint : route.waypoints) {
+    ASSERT_FALSE(track_traffic.HasPassingVehicles(waypoint->GetId()));
+    ASSERT_TRUE(track_traffic.IsGeoGridFree(waypoint->GetGeodesicGridId()));
+  }
+}
+
+TEST(traffic_manager, benchmark_get_overlapping_vehicles) {
+  constexpr size_t number_of_vehicles = 1000u;
+  constexpr size_t buffer_length = 50u;
+  constexpr size_t number_of_cycles = 100u;
+  // 每个网格10个航点，平均每个网格约有5辆车。
+  const SyntheticRoute route(2000u, 10u);
+  const std::vector<ActorId> actors = make_vehicle_ids(number_of_vehicles);
+  std::vector<Buffer> buffers(number_of_vehicles);
+  std::vector<size_t> positions(number_of_vehicles);
+  TrackTraffic track_traffic;
+  for (size_t i = 0u; i < number_of_vehicles; ++i) {
+    positions[i] = i * route.waypoints.size() / number_of_vehicles;
+    for (size_t j = 0u; j < buffer_length; ++j) {
+      push_waypoint(track_traffic, actors[i], buffers[i], route.at(positions[i] + j));
+    }
+    track_traffic.UpdateGridPosition(actors[i], buffers[i]);
+  }
+
+  size_t total_overlapping = 0u;
+  size_t update_time = 0u;
+  size_t query_time = 0u;
+  for (size_t cycle = 0u; cycle < number_of_cycles; ++cycle) {
+    // 模拟定位阶段：每辆车前进一个航点。
+    carla::StopWatch update_watch;
+    for (size_t i = 0u; i < number_of_vehicles; ++i) {
+      pop_waypoint(track_traffic, actors[i], buffers[i]);
+      ++positions[i];
+      push_waypoint(track_traffic, actors[i], buffers[i], route.at(positions[i] + buffer_length - 1u));
+      track_traffic.UpdateGridPosition(actors[i], buffers[i]);
+    }
+    update_time += update_watch.GetElapsedTime<std::chrono::microseconds>();
+
+    // 模拟碰撞阶段：查询每辆车的重叠车辆。
+    carla::StopWatch query_watch;
+    for (size_t i = 0u; i < number_of_vehicles; ++i) {
+      total_overlapping += track_traffic.GetOverlappingVehicles(actors[i]).size();
+    }
+    query_time += query_watch.GetElapsedTime<std::chrono::microseconds>();
+  }
+  ASSERT_GT(total_overlapping, number_of_cycles * number_of_vehicles);
+
+  carla::log_info("track traffic:", number_of_vehicles, "vehicles,",
+      update_time / number_of_cycles, "us per cycle updating buffers,",
+      query_time / number_of_cycles, "us per cycle in GetOverlappingVehicles,",
+      static_cast<double>(total_overlapping) / static_cast<double>(number_of_cycles * number_of_vehicles),
+      "overlapping vehicles on average");
+}
+
+// 手工构造一个缓存：路径点位于给定的位置，按给定的后继连接，前驱由后继推出。
+static std::vector<uint8_t> build_map_cache(
+    const std::vector<carla::geom::Location> &locations,
+    const std::vector<std::vector<uint32_t>> &next_links,
+    const std::vector<carla::traffic_manager::cache::LandmarkRecord> &landmarks = {}) {
+  namespace cache = carla::traffic_manager::cache;
+  const uint32_t total = static_cast<uint32_t>(locations.size());
+  std::vector<std::vector<uint32_t>> previous_links(total);
+  for (uint32_t i = 0u; i < total; ++i) {
+    for (const uint32_t next : next_links[i]) {
+      previous_links[next].push_back(i);
+    }
+  }
+  auto to_csr = [](const std::vector<std::vector<uint32_t>> &links,
+                   std::vector<uint32_t> &offsets,
+                   std::vector<uint32_t> &indices) {
+    offsets.assign(1u, 0u);
+    for (const auto &row : links) {
+      indices.insert(indices.end(), row.begin(), row.end());
+      offsets.push_back(static_cast<uint32_t>(indices.size()));
+    }
+  };
+  std::vector<uint32_t> next_offsets, next_indices, previous_offsets, previous_indices;
+  to_csr(next_links, next_offsets, next_indices);
+  to_csr(previous_links, previous_offsets, previous_indices);
+
+  cache::Header header;
+  std::memcpy(header.magic, cache::MAGIC, sizeof(cache::MAGIC));
+  header.version = cache::VERSION;
+  header.header_size = sizeof(cache::Header);
+  header.waypoint_count = total;
+  header.next_link_count = static_cast<uint32_t>(next_indices.size());
+  header.previous_link_count = static_cast<uint32_t>(previous_indices.size());
+  header.spatial_tree_count = total;
+  header.landmark_count = static_cast<uint32_t>(landmarks.size());
+  header.reserved = 0u;
+  header.waypoints_offset = cache::Align(sizeof(cache::Header));
+  header.next_offsets_offset = cache::Align(header.waypoints_offset + total * sizeof(cache::WaypointRecord));
+  header.next_indices_offset = cache::Align(header.next_offsets_offset + next_offsets.size() * sizeof(uint32_t));
+  header.previous_offsets_offset = cache::Align(header.next_indices_offset + next_indices.size() * sizeof(uint32_t));
+  header.previous_indices_offset = cache::Align(header.previous_offsets_offset + previous_offsets.size() * sizeof(uint32_t));
+  header.spatial_tree_offset = cache::Align(header.previous_indices_offset + previous_indices.size() * sizeof(uint32_t));
+  header.landmarks_offset = cache::Align(header.spatial_tree_offset + total * sizeof(cache::SpatialTreeRecord));
+  header.file_size = header.landmarks_offset + landmarks.size() * sizeof(cache::LandmarkRecord);
+
+  std::vector<uint8_t> content(header.file_size, 0u);
+  std::memcpy(content.data(), &header, sizeof(header));
+  auto *records = reinterpret_cast<cache::WaypointRecord *>(content.data() + header.waypoints_offset);
+  auto *tree = reinterpret_cast<cache::SpatialTreeRecord *>(content.data() + header.spatial_tree_offset);
+  for (uint32_t i = 0u; i < total; ++i) {
+    cache::WaypointRecord &record = records[i];
+    record.waypoint_id = 1000u + i;
+    record.location[0] = locations[i].x;
+    record.location[1] = locations[i].y;
+    record.location[2] = locations[i].z;
+    record.road_id = 1u;
+    record.lane_id = -1;
+    record.s = record.location[0];
+    record.junction_id = -1;
+    record.geodesic_grid_id = 7;
+    record.left_index = cache::INVALID_INDEX;
+    record.right_index = cache::INVALID_INDEX;
+    record.flags = 0u;
+    record.road_option = 4u;
+    tree[i].location[0] = record.location[0];
+    tree[i].location[1] = record.location[1];
+    tree[i].location[2] = record.location[2];
+    tree[i].index = i;
+  }
+  auto copy = [&content](uint64_t offset, const std::vector<uint32_t> &values) {
+    std::memcpy(content.data() + offset, values.data(), values.size() * sizeof(uint32_t));
+  };
+  copy(header.next_offsets_offset, next_offsets);
+  copy(header.next_indices_offset, next_indices);
+  copy(header.previous_offsets_offset, previous_offsets);
+  copy(header.previous_indices_offset, previous_indices);
+  if (!landmarks.empty()) {
+    std::memcpy(content.data() + header.landmarks_offset, landmarks.data(), landmarks.size() * sizeof(cache::LandmarkRecord));
+  }
+  return content;
+}
+
+// 沿x轴的三个路径点 0 -> 1 -> 2，以及与 1 相邻的路径点 3。
+static std::vector<uint8_t> make_map_cache() {
+  namespace cache = carla::traffic_manager::cache;
+  using carla::geom::Location;
+  std::vector<uint8_t> content = build_map_cache(
+      {Location(0.0f, 0.0f, 0.0f), Location(10.0f, 0.0f, 0.0f), Location(20.0f, 0.0f, 0.0f), Location(10.0f, -3.5f, 0.0f)},
+      {{1u}, {2u}, {}, {}});
+  const auto &header = *reinterpret_cast<const cache::Header *>(content.data());
+  auto *records = reinterpret_cast<cache::WaypointRecord *>(content.data() + header.waypoints_offset);
+  records[3].lane_id = -2;
+  records[2].flags = cache::FLAG_JUNCTION;
+  // 路径点 3 位于路径点 1 的左侧（y 轴负方向为左）
+  records[1].left_index = 3u;
+  return content;
+}
+
+static carla::traffic_manager::cache::LandmarkRecord make_landmark_record(
+    const uint32_t waypoint_index,
+    const carla::traffic_manager::LandmarkType type,
+    const float distance,
+    const carla::geom::Location &location,
+    const float value = 0.0f) {
+  carla::traffic_manager::cache::LandmarkRecord record;
+  std::memset(&record, 0, sizeof(record));
+  record.location[0] = location.x;
+  record.location[1] = location.y;
+  record.location[2] = location.z;
+  record.waypoint_index = waypoint_index;
+  record.distance = distance;
+  record.value = value;
+  record.type = static_cast<uint8_t>(type);
+  return record;
+}
+
+TEST(traffic_manager, in_memory_map_cache_load) {
+  using namespace carla::traffic_manager;
+  InMemoryMap local_map(nullptr);
+  ASSERT_TRUE(local_map.Load(make_map_cache()));
+
+  const WaypointGraph &graph = local_map.GetWaypointGraph();
+  ASSERT_EQ(graph.Size(), 4u);
+  ASSERT_EQ(graph.GetNext(0u).size(), 1u);
+  ASSERT_EQ(graph.GetNext(0u).front(), 1u);
+  ASSERT_TRUE(graph.GetNext(2u).empty());
+  ASSERT_EQ(graph.GetPrevious(2u).front(), 1u);
+  ASSERT_EQ(graph.GetLeft(1u), 3u);
+  ASSERT_EQ(graph.GetRight(1u), INVALID_WAYPOINT_INDEX);
+  ASSERT_TRUE(graph.CheckJunction(2u));
+  ASSERT_FALSE(graph.CheckJunction(1u));
+  ASSERT_EQ(graph.GetId(2u), 1002u);
+
+  const SimpleWaypointPtr closest = local_map.GetWaypoint(carla::geom::Location(19.0f, 0.5f, 0.0f));
+  ASSERT_EQ(closest->GetId(), 1002u);
+  ASSERT_EQ(closest->GetIndex(), 2u);
+  ASSERT_EQ(closest->GetGeodesicGridId(), 7);
+  ASSERT_EQ(closest->GetRoadOption(), RoadOption::LaneFollow);
+  ASSERT_EQ(local_map.GetWaypointByIndex(1u)->GetLeftWaypoint(), local_map.GetWaypointByIndex(3u));
+  ASSERT_EQ(local_map.GetWaypointByIndex(0u)->GetNextWaypoint().front(), local_map.GetWaypointByIndex(1u));
+
+  // 重新序列化得到的缓存加载后保持一致
+  const std::vector<uint8_t> serialized = local_map.Serialize();
+  InMemoryMap reloaded(nullptr);
+  ASSERT_TRUE(reloaded.Load(serialized));
+  ASSERT_EQ(reloaded.Serialize(), serialized);
+}
+
+TEST(traffic_manager, in_memory_map_cache_rejects_invalid_content) {
+  namespace cache = carla::traffic_manager::cache;
+  const std::vector<uint8_t> content = make_map_cache();
+
+  std::vector<uint8_t> other_version = content;
+  reinterpret_cast<cache::Header *>(other_version.data())->version = cache::VERSION + 1u;
+  ASSERT_FALSE(InMemoryMap(nullptr).Load(other_version));
+
+  std::vector<uint8_t> truncated(content.begin(), content.end() - 1);
+  ASSERT_FALSE(InMemoryMap(nullptr).Load(truncated));
+
+  std::vector<uint8_t> bad_link = content;
+  const auto &header = *reinterpret_cast<const cache::Header *>(bad_link.data());
+  reinterpret_cast<uint32_t *>(bad_link.data() + header.next_indices_offset)[0] = 42u;
+  ASSERT_FALSE(InMemoryMap(nullptr).Load(bad_link));
+}
+
+TEST(traffic_manager, in_memory_map_cache_memory_mapped) {
+  const std::string filename = "test_in_memory_map_cache.bin";
+  const std::vector<uint8_t> content = make_map_cache();
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out.write(reinterpret_cast<const char *>(content.data()), static_cast<std::streamsize>(content.size()));
+  }
+  InMemoryMap local_map(nullptr);
+  ASSERT_TRUE(local_map.Load(filename));
+  ASSERT_EQ(local_map.GetWaypointGraph().Size(), 4u);
+  ASSERT_EQ(local_map.Serialize().size(), content.size());
+  std::remove(filename.c_str());
+
+  ASSERT_FALSE(InMemoryMap(nullptr).Load(std::string("does_not_exist.bin")));
+}
+
+TEST(traffic_manager, in_memory_map_cache_from_file_transfer) {
+  using carla::client::FileTransfer;
+  const std::string previous_folder = FileTransfer::GetFilesBaseFolder();
+  const auto folder = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+  ASSERT_TRUE(FileTransfer::SetFilesBaseFolder(folder.string()));
+
+  // 与服务器下发的缓存一样通过 FileTransfer 写入，再按 TrafficManagerLocal 的方式加载
+  const std::string file = "TM/test_map.bin";
+  ASSERT_FALSE(InMemoryMap(nullptr).LoadFromFileCache(file));
+  ASSERT_TRUE(FileTransfer::WriteFile(file, make_map_cache()));
+  InMemoryMap local_map(nullptr);
+  ASSERT_TRUE(local_map.LoadFromFileCache(file));
+  ASSERT_EQ(local_map.GetWaypointGraph().Size(), 4u);
+
+  FileTransfer::SetFilesBaseFolder(previous_folder);
+  boost::filesystem::remove_all(folder);
+}
+
+TEST(traffic_manager, waypoint_graph_matches_simple_waypoint_links) {
+  using namespace carla::traffic_manager;
+  using carla::geom::Location;
+  using carla::geom::Rotation;
+  using carla::geom::Transform;
+  constexpr uint64_t lane_length = 20u;
+
+  auto make_waypoint = [](uint64_t id, float x, float y) {
+    ResolvedWaypoint resolved;
+    resolved.transform = Transform(Location(x, y, 0.0f), Rotation());
+    resolved.id = id;
+    resolved.is_junction = (id % 7u) == 0u;
+    return std::make_shared<SimpleWaypoint>(nullptr, resolved);
+  };
+
+  // 沿x轴的两条平行车道，车道B位于车道A的左侧（y轴负方向为左）
+  NodeList lane_a, lane_b;
+  for (uint64_t i = 0u; i < lane_length; ++i) {
+    lane_a.push_back(make_waypoint(i, 2.0f * static_cast<float>(i), 0.0f));
+    lane_b.push_back(make_waypoint(100u + i, 2.0f * static_cast<float>(i), -3.5f));
+  }
+  for (uint64_t i = 0u; i + 1u < lane_length; ++i) {
+    lane_a[i]->SetNextWaypoint({lane_a[i + 1u]});
+    lane_a[i + 1u]->SetPreviousWaypoint({lane_a[i]});
+    lane_b[i]->SetNextWaypoint({lane_b[i + 1u]});
+    lane_b[i + 1u]->SetPreviousWaypoint({lane_b[i]});
+  }
+  for (uint64_t i = 0u; i < lane_length; ++i) {
+    lane_a[i]->SetLeftWaypoint(lane_b[i]);
+    lane_b[i]->SetRightWaypoint(lane_a[i]);
+  }
+  // 分叉：车道A的中间路径点同时连接到车道B
+  lane_a[9u]->SetNextWaypoint({lane_b[10u]});
+  lane_b[10u]->SetPreviousWaypoint({lane_a[9u]});
+  // 不属于拓扑的路径点不会出现在路径点图中
+  SimpleWaypointPtr outside = make_waypoint(999u, 100.0f, 0.0f);
+  lane_a.back()->SetNextWaypoint({outside});
+
+  // 打乱顺序，使索引与构造顺序无关，并留出一个空位
+  NodeList dense_topology;
+  dense_topology.insert(dense_topology.end(), lane_a.begin(), lane_a.end());
+  dense_topology.insert(dense_topology.end(), lane_b.begin(), lane_b.end());
+  std::shuffle(dense_topology.begin(), dense_topology.end(), std::mt19937(42u));
+  dense_topology.insert(dense_topology.begin() + 5, nullptr);
+
+  WaypointGraph graph;
+  graph.Build(dense_topology);
+  ASSERT_EQ(graph.Size(), dense_topology.size());
+
+  auto to_indices = [&dense_topology](const NodeList &links) {
+    std::vector<WaypointIndex> indices;
+    for (const auto &link : links) {
+      const auto it = std::find(dense_topology.begin(), dense_topology.end(), link);
+      if (link != nullptr && it != dense_topology.end()) {
+        indices.push_back(static_cast<WaypointIndex>(it - dense_topology.begin()));
+      }
+    }
+    return indices;
+  };
+  auto to_index = [&to_indices](const SimpleWaypointPtr &link) {
+    const auto indices = to_indices({link});
+    return indices.empty() ? INVALID_WAYPOINT_INDEX : indices.front();
+  };
+
+  for (WaypointIndex index = 0u; index < dense_topology.size(); ++index) {
+    const SimpleWaypointPtr &swp = dense_topology[index];
+    if (swp == nullptr) {
+      ASSERT_FALSE(graph.IsValid(index));
+      ASSERT_TRUE(graph.GetNext(index).empty());
+      ASSERT_TRUE(graph.GetPrevious(index).empty());
+      continue;
+    }
+    ASSERT_TRUE(graph.IsValid(index));
+    ASSERT_EQ(swp->GetIndex(), index);
+    ASSERT_EQ(graph.GetId(index), swp->GetId());
+    ASSERT_EQ(graph.CheckJunction(index), swp->CheckJunction());
+    ASSERT_FLOAT_EQ(graph.DistanceSquared(index, swp->GetLocation()), 0.0f);
+
+    const WaypointIndexRange next = graph.GetNext(index);
+    const WaypointIndexRange previous = graph.GetPrevious(index);
+    ASSERT_EQ(std::vector<WaypointIndex>(next.begin(), next.end()), to_indices(swp->GetNextWaypoint()));
+    ASSERT_EQ(std::vector<WaypointIndex>(previous.begin(), previous.end()), to_indices(swp->GetPreviousWaypoint()));
+    ASSERT_EQ(graph.GetLeft(index), to_index(swp->GetLeftWaypoint()));
+    ASSERT_EQ(graph.GetRight(index), to_index(swp->GetRightWaypoint()));
+  }
+
+  // 抽查：分叉有两个后继，车道A的最后一个路径点的后继不在拓扑中
+  ASSERT_EQ(graph.GetNext(lane_a[9u]->GetIndex()).size(), 2u);
+  ASSERT_TRUE(graph.GetNext(lane_a.back()->GetIndex()).empty());
+  ASSERT_EQ(graph.GetLeft(lane_a[3u]->GetIndex()), lane_b[3u]->GetIndex());
+  ASSERT_EQ(graph.GetRight(lane_b[3u]->GetIndex()), lane_a[3u]->GetIndex());
+  ASSERT_EQ(graph.GetLeft(lane_b[3u]->GetIndex()), INVALID_WAYPOINT_INDEX);
+}
+
+TEST(traffic_manager, landmark_index) {
+  using namespace carla::traffic_manager;
+  namespace cache = carla::traffic_manager::cache;
+  using carla::geom::Location;
+  // 0 -> 1 -> 2 -> 3 沿x轴每10米一个路径点，4 从侧面汇入 2
+  const std::vector<Location> locations = {
+      Location(0.0f, 0.0f, 0.0f), Location(10.0f, 0.0f, 0.0f), Location(20.0f, 0.0f, 0.0f),
+      Location(30.0f, 0.0f, 0.0f), Location(20.0f, 10.0f, 0.0f)};
+  const std::vector<std::vector<uint32_t>> next_links = {{1u}, {2u}, {3u}, {}, {2u}};
+  const std::vector<cache::LandmarkRecord> landmarks = {
+      make_landmark_record(2u, LandmarkType::TrafficLight, 5.0f, Location(25.0f, 0.0f, 0.0f)),
+      make_landmark_record(1u, LandmarkType::SpeedLimit, 2.0f, Location(12.0f, 0.0f, 0.0f), 30.0f),
+      // 超出视野长度的观察结果被忽略
+      make_landmark_record(3u, LandmarkType::Stop, 1000.0f, Location(1030.0f, 0.0f, 0.0f))};
+
+  InMemoryMap local_map(nullptr);
+  ASSERT_TRUE(local_map.Load(build_map_cache(locations, next_links, landmarks)));
+  const LandmarkIndex &index = local_map.GetLandmarkIndex();
+
+  const std::vector<float> expected_traffic_light = {25.0f, 15.0f, 5.0f, -1.0f, 15.0f};
+  for (WaypointIndex i = 0u; i < locations.size(); ++i) {
+    const UpcomingLandmark upcoming = index.GetUpcoming(i, LandmarkType::TrafficLight);
+    if (expected_traffic_light[i] < 0.0f) {
+      ASSERT_EQ(upcoming.landmark, nullptr);
+    } else {
+      ASSERT_NE(upcoming.landmark, nullptr);
+      ASSERT_NEAR(upcoming.distance, expected_traffic_light[i], 1e-4f);
+      ASSERT_EQ(upcoming.landmark->location, Location(25.0f, 0.0f, 0.0f));
+    }
+    ASSERT_EQ(index.GetUpcoming(i, LandmarkType::Stop).landmark, nullptr);
+    ASSERT_EQ(index.GetUpcoming(i, LandmarkType::Yield).landmark, nullptr);
+  }
+  const UpcomingLandmark speed_limit = index.GetUpcoming(0u, LandmarkType::SpeedLimit);
+  ASSERT_NE(speed_limit.landmark, nullptr);
+  ASSERT_NEAR(speed_limit.distance, 12.0f, 1e-4f);
+  ASSERT_EQ(speed_limit.landmark->value, 30.0f);
+  ASSERT_EQ(index.GetUpcoming(2u, LandmarkType::SpeedLimit).landmark, nullptr);
+  ASSERT_EQ(index.GetUpcoming(INVALID_WAYPOINT_INDEX, LandmarkType::TrafficLight).landmark, nullptr);
+
+  // 观察结果随缓存一起保存
+  const std::vector<uint8_t> serialized = local_map.Serialize();
+  InMemoryMap reloaded(nullptr);
+  ASSERT_TRUE(reloaded.Load(serialized));
+  ASSERT_NEAR(reloaded.GetLandmarkIndex().GetUpcoming(4u, LandmarkType::TrafficLight).distance, 15.0f, 1e-4f);
+  ASSERT_EQ(reloaded.Serialize(), serialized);
+
+  // 指向不存在的路径点或未知类型的地标使缓存无效
+  std::vector<cache::LandmarkRecord> invalid = landmarks;
+  invalid[0].waypoint_index = 5u;
+  ASSERT_FALSE(InMemoryMap(nullptr).Load(build_map_cache(locations, next_links, invalid)));
+  invalid = landmarks;
+  invalid[0].type = static_cast<uint8_t>(NUMBER_OF_LANDMARK_TYPES);
+  ASSERT_FALSE(InMemoryMap(nullptr).Load(build_map_cache(locations, next_links, invalid)));
+}
+
+TEST(traffic_manager, landmark_target_velocity) {
+  using namespace carla::traffic_manager;
+  using namespace carla::traffic_manager::constants::MotionPlan;
+  namespace cache = carla::traffic_manager::cache;
+  using carla::geom::Location;
+  // 沿x轴每10米一个路径点，共400米；x=305处有交通灯，x=12处有30km/h的限速标志
+  std::vector<Location> locations;
+  std::vector<std::vector<uint32_t>> next_links;
+  for (uint32_t i = 0u; i <= 40u; ++i) {
+    locations.emplace_back(10.0f * static_cast<float>(i), 0.0f, 0.0f);
+    next_links.push_back(i < 40u ? std::vector<uint32_t>{i + 1u} : std::vector<uint32_t>{});
+  }
+  const std::vector<cache::LandmarkRecord> landmarks = {
+      make_landmark_record(30u, LandmarkType::TrafficLight, 5.0f, Location(305.0f, 0.0f, 0.0f)),
+      make_landmark_record(1u, LandmarkType::SpeedLimit, 2.0f, Location(12.0f, 0.0f, 0.0f), 30.0f)};
+  InMemoryMap local_map(nullptr);
+  ASSERT_TRUE(local_map.Load(build_map_cache(locations, next_links, landmarks)));
+  const LandmarkIndex &index = local_map.GetLandmarkIndex();
+  const VehicleParameters vehicle_parameters;
+
+  // 检测距离之外的地标不影响速度
+  const float urban_velocity = 50.0f / 3.6f;
+  ASSERT_EQ(index.GetTargetVelocity(20u, locations[20u], vehicle_parameters, urban_velocity),
+            std::numeric_limits<float>::max());
+
+  // 车速很高时检测距离被截断为视野长度，视野内的地标仍然使车辆减速
+  const float high_velocity = 300.0f / 3.6f;
+  ASSERT_GT(LANDMARK_DETECTION_TIME * high_velocity, LANDMARK_INDEX_HORIZON);
+  const float distance = 105.0f;
+  const float expected = (high_velocity - TL_TARGET_VELOCITY) / LANDMARK_INDEX_HORIZON * distance + TL_TARGET_VELOCITY;
+  ASSERT_NEAR(index.GetTargetVelocity(20u, locations[20u], vehicle_parameters, high_velocity), expected, 1e-3f);
+  ASSERT_EQ(index.GetTargetVelocity(14u, locations[14u], vehicle_parameters, high_velocity),
+            std::numeric_limits<float>::max());
+
+  // 限速标志的速度按车辆参数换算
+  VehicleParameters slow_vehicle;
+  slow_vehicle.percentage_speed_difference = 50.0f;
+  ASSERT_NEAR(index.GetTargetVelocity(0u, Location(12.0f, 0.0f, 0.0f), slow_vehicle, urban_velocity),
+              30.0f / 3.6f * 0.5f, 1e-4f);
+  ASSERT_NEAR(index.GetTargetVelocity(0u, Location(12.0f, 0.0f, 0.0f), vehicle_parameters, urban_velocity),
+              30.0f / 3.6f, 1e-4f);
+}
+
+// 两条相连的弯曲道路，地标位于道路中间、两条道路的连接处以及没有后继的车道末端。
+static const char *LANDMARK_TEST_MAP = R"(<?xml version="1.0" standalone="yes"?>
+<OpenDRIVE>
+<header revMajor="1" revMinor="4" name="landmarks"/>
+<road name="r0" length="70" id="0" junction="-1">
+<link><successor elementType="road" elementId="1" contactPoint="start"/></link>
+<planView>
+<geometry s="0" x="0" y="0" hdg="0" length="30"><line/></geometry>
+<geometry s="30" x="30" y="0" hdg="0" length="40"><arc curvature="0.02"/></geometry>
+</planView>
+<lanes><laneSection s="0">
+<left><lane id="1" type="driving" level="false"><link><successor id="1"/></link><width sOffset="0" a="3.5" b="0" c="0" d="0"/></lane></left>
+<center><lane id="0" type="none" level="false"/></center>
+<right><lane id="-1" type="driving" level="false"><link><successor id="-1"/></link><width sOffset="0" a="3.5" b="0" c="0" d="0"/></lane></right>
+</laneSection></lanes>
+<signals>
+<signal s="20" t="-5" id="1" name="s1" dynamic="yes" orientation="+" zOffset="0" country="OpenDRIVE" type="1000001" subtype="-1" value="-1" height="1" width="1"><validity fromLane="-1" toLane="-1"/></signal>
+<signal s="69.8" t="-5" id="2" name="s2" dynamic="no" orientation="+" zOffset="0" country="OpenDRIVE" type="274" subtype="-1" value="30" unit="km/h" height="1" width="1"><validity fromLane="-1" toLane="-1"/></signal>
+<signal s="0.4" t="5" id="3" name="s3" dynamic="no" orientation="-" zOffset="0" country="OpenDRIVE" type="205" subtype="-1" value="-1" height="1" width="1"><validity fromLane="1" toLane="1"/></signal>
+<signal s="45" t="5" id="4" name="s4" dynamic="no" orientation="-" zOffset="0" country="OpenDRIVE" type="101" subtype="-1" value="-1" height="1" width="1"><validity fromLane="1" toLane="1"/></signal>
+</signals>
+</road>
+<road name="r1" length="50" id="1" junction="-1">
+<link><predecessor elementType="road" elementId="0" contactPoint="end"/></link>
+<planView>
+<geometry s="0" x="65.8678" y="15.1647" hdg="0.8" length="50"><arc curvature="-0.02"/></geometry>
+</planView>
+<lanes><laneSection s="0">
+<left><lane id="1" type="driving" level="false"><link><predecessor id="1"/></link><width sOffset="0" a="3.5" b="0" c="0" d="0"/></lane></left>
+<center><lane id="0" type="none" level="false"/></center>
+<right><lane id="-1" type="driving" level="false"><link><predecessor id="-1"/></link><width sOffset="0" a="3.5" b="0" c="0" d="0"/></lane></right>
+</laneSection></lanes>
+<signals>
+<signal s="49.7" t="-5" id="5" name="s5" dynamic="no" orientation="+" zOffset="0" country="OpenDRIVE" type="206" subtype="-1" value="-1" height="1" width="1"><validity fromLane="-1" toLane="-1"/></signal>
+<signal s="10" t="5" id="6" name="s6" dynamic="yes" orientation="-" zOffset="0" country="OpenDRIVE" type="1000001" subtype="-1" value="-1" height="1" width="1"><validity fromLane="1" toLane="1"/></signal>
+<signal s="0.2" t="5" id="7" name="s7" dynamic="no" orientation="-" zOffset="0" country="OpenDRIVE" type="274" subtype="-1" value="60" unit="km/h" height="1" width="1"><validity fromLane="1" toLane="1"/></signal>
+</signals>
+</road>
+</OpenDRIVE>)";
+
+// 在OpenDrive地图上，索引给出的每类最近地标应与沿车道直接搜索的结果一致，
+// 包括弯道上的路径点与没有后继的路径点。
+TEST(traffic_manager, landmark_index_matches_opendrive) {
+  using namespace carla::traffic_manager;
+  using namespace carla::traffic_manager::constants::MotionPlan;
+  const float max_distance = LANDMARK_DETECTION_TIME * 50.0f / 3.6f;
+  // 直接搜索的距离沿道路参考线计算，路径点图中的距离是车道中心上路径点之间的
+  // 直线距离，两者在弯道上不同
+  auto tolerance = [](const float distance) { return 1.0f + 0.1f * distance; };
+  size_t number_of_landmarks = 0u;
+  auto check = [&](const std::string &name, std::string xodr) {
+    const auto world_map = carla::MakeShared<carla::client::Map>(carla::rpc::MapInfo{}, std::move(xodr));
+    InMemoryMap local_map(world_map);
+    local_map.SetUp();
+    const LandmarkIndex &index = local_map.GetLandmarkIndex();
+    for (const SimpleWaypointPtr &swp : local_map.GetDenseTopology()) {
+      std::array<float, NUMBER_OF_LANDMARK_TYPES> expected;
+      expected.fill(std::numeric_limits<float>::max());
+      for (const auto &landmark : swp->GetWaypoint()->GetAllLandmarksInDistance(max_distance, false)) {
+        LandmarkType type;
+        if (ToLandmarkType(landmark->GetType(), type)) {
+          float &distance = expected[static_cast<size_t>(type)];
+          distance = std::min(distance, static_cast<float>(landmark->GetDistance()));
+        }
+      }
+      for (size_t t = 0u; t < NUMBER_OF_LANDMARK_TYPES; ++t) {
+        const UpcomingLandmark upcoming = index.GetUpcoming(swp->GetIndex(), static_cast<LandmarkType>(t));
+        if (expected[t] <= max_distance) {
+          ++number_of_landmarks;
+          ASSERT_NE(upcoming.landmark, nullptr) << name << ": landmark at " << expected[t] << "m is not indexed";
+          ASSERT_NEAR(upcoming.distance, expected[t], tolerance(expected[t])) << name;
+        } else if (upcoming.landmark != nullptr) {
+          ASSERT_GT(upcoming.distance, max_distance - tolerance(max_distance)) << name;
+        }
+      }
+    }
+  };
+
+  check("landmark test map", LANDMARK_TEST_MAP);
+  ASSERT_GT(number_of_landmarks, 0u);
+  for (const auto &file : util::OpenDrive::GetAvailableFiles()) {
+    carla::logging::log("checking landmarks of", file);
+    check(file, util::OpenDrive::Load(file));
+  }
+  carla::logging::log("compared", number_of_landmarks, "landmarks with the landmark index");
+}
+
+TEST(traffic_manager, benchmark_landmark_target_velocity) {
+  using namespace carla::traffic_manager;
+  namespace cache = carla::traffic_manager::cache;
+  using carla::geom::Location;
+  constexpr size_t number_of_vehicles = 500u;
+  constexpr size_t number_of_cycles = 1000u;
+  constexpr uint32_t number_of_waypoints = 10000u;
+  constexpr float spacing = 2.0f;
+
+  // 周长20公里的环形道路，每200米交替放置交通灯、停车、让行与限速标志
+  const float radius = spacing * number_of_waypoints / (2.0f * 3.1415927f);
+  std::vector<Location> locations;
+  std::vector<std::vector<uint32_t>> next_links;
+  std::vector<cache::LandmarkRecord> landmarks;
+  for (uint32_t i = 0u; i < number_of_waypoints; ++i) {
+    const float angle = 2.0f * 3.1415927f * static_cast<float>(i) / static_cast<float>(number_of_waypoints);
+    locations.emplace_back(radius * std::cos(angle), radius * std::sin(angle), 0.0f);
+    next_links.push_back({(i + 1u) % number_of_waypoints});
+  }
+  for (uint32_t i = 50u; i < number_of_waypoints; i += 100u) {
+    const auto type = static_cast<LandmarkType>((i / 100u) % NUMBER_OF_LANDMARK_TYPES);
+    landmarks.push_back(make_landmark_record(i, type, 1.0f, locations[i], 30.0f));
+  }
+
+  carla::StopWatch build_watch;
+  InMemoryMap local_map(nullptr);
+  ASSERT_TRUE(local_map.Load(build_map_cache(locations, next_links, landmarks)));
+  build_watch.Stop();
+  const LandmarkIndex &index = local_map.GetLandmarkIndex();
+
+  std::mt19937 engine(2020u);
+  std::uniform_int_distribution<uint32_t> random_waypoint(0u, number_of_waypoints - 1u);
+  std::vector<WaypointIndex> vehicles(number_of_vehicles);
+  for (auto &vehicle : vehicles) {
+    vehicle = random_waypoint(engine);
+  }
+
+  // 模拟运动规划阶段：每辆车每个周期查询一次地标目标速度并前进一个路径点
+  const VehicleParameters vehicle_parameters;
+  size_t slowed_down = 0u;
+  carla::StopWatch stop_watch;
+  for (size_t cycle = 0u; cycle < number_of_cycles; ++cycle) {
+    for (auto &vehicle : vehicles) {
+      const Location vehicle_location = locations[vehicle];
+      const float velocity = index.GetTargetVelocity(vehicle, vehicle_location, vehicle_parameters, 50.0f / 3.6f);
+      if (velocity < 50.0f / 3.6f) {
+        ++slowed_down;
+      }
+      vehicle = (vehicle + 1u) % number_of_waypoints;
+    }
+  }
+  stop_watch.Stop();
+  ASSERT_GT(slowed_down, 0u);
+  ASSERT_LT(slowed_down, number_of_vehicles * number_of_cycles);
+
+  carla::log_info("landmark index:", number_of_waypoints, "waypoints built in",
+      build_watch.GetElapsedTime<std::chrono::microseconds>(), "us,",
+      index.GetMemoryUsage() / 1024u, "KiB;",
+      number_of_vehicles, "vehicles,",
+      stop_watch.GetElapsedTime<std::chrono::microseconds>() / number_of_cycles,
+      "us per cycle in GetLandmarkTargetVelocity");
+}
+
+TEST(traffic_manager, parameters_snapshot) {
+  Parameters parameters;
+  std::vector<ActorId> vehicle_id_list = {3u, 1u, 2u};
+  parameters.UpdateSnapshot(vehicle_id_list);
+  const ParametersSnapshot &snapshot = parameters.GetSnapshot();
+  ASSERT_EQ(snapshot.Size(), 3u);
+  EXPECT_FLOAT_EQ(snapshot.GetVehicle(0u).GetVehicleTargetVelocity(50.0f), 50.0f);
+  EXPECT_FLOAT_EQ(snapshot.GetVehicle(0u).distance_to_leading_vehicle, 2.0f);
+  EXPECT_TRUE(snapshot.GetVehicle(0u).auto_lane_change);
+  EXPECT_FLOAT_EQ(snapshot.GetVehicle(0u).perc_keep_right, -1.0f);
+  EXPECT_TRUE(snapshot.GetCollisionDetection(snapshot.GetVehicle(1u), 3u));
+  EXPECT_EQ(snapshot.FindVehicle(2u), &snapshot.GetVehicle(2u));
+  EXPECT_EQ(snapshot.FindVehicle(42u), nullptr);
+
+  // 修改只在下一次更新快照时生效
+  const uint64_t version = snapshot.GetVersion();
+  parameters.SetGlobalPercentageSpeedDifference(20.0f);
+  parameters.SetGlobalLaneOffset(0.5f);
+  parameters.SetGlobalDistanceToLeadingVehicle(5.0f);
+  EXPECT_FLOAT_EQ(snapshot.GetVehicle(0u).distance_to_leading_vehicle, 2.0f);
+  parameters.UpdateSnapshot(vehicle_id_list);
+  EXPECT_GT(snapshot.GetVersion(), version);
+  for (unsigned long index = 0u; index < snapshot.Size(); ++index) {
+    const auto &vehicle = snapshot.GetVehicle(index);
+    EXPECT_FLOAT_EQ(vehicle.GetVehicleTargetVelocity(50.0f), 40.0f);
+    EXPECT_FLOAT_EQ(vehicle.lane_offset, 0.5f);
+    EXPECT_FLOAT_EQ(vehicle.distance_to_leading_vehicle, 5.0f);
+    EXPECT_FLOAT_EQ(vehicle.distance_to_leading_vehicle, parameters.GetDistanceToLeadingVehicle(vehicle_id_list[index]));
+  }
+
+  // 车辆列表变化时重新生成
+  vehicle_id_list.pop_back();
+  parameters.UpdateSnapshot(vehicle_id_list);
+  ASSERT_EQ(snapshot.Size(), 2u);
+  EXPECT_EQ(snapshot.FindVehicle(2u), nullptr);
+  EXPECT_NE(snapshot.FindVehicle(1u), nullptr);
+}
+
+TEST(traffic_manager, collision_broad_phase_matches_exhaustive_check) {
+  using namespace carla::traffic_manager;
+  using carla::geom::Location;
+  using carla::geom::Rotation;
+  using carla::geom::Transform;
+  using carla::geom::Vector3D;
+  using constants::Collision::OVERLAP_THRESHOLD;
+  constexpr size_t number_of_vehicles = 60u;
+  constexpr size_t number_of_walkers = 30u;
+  constexpr size_t path_length = 40u;
+
+  std::mt19937 rng(7u);
+  std::uniform_real_distribution<float> position(0.0f, 150.0f);
+  std::uniform_real_distribution<float> yaw(-180.0f, 180.0f);
+  std::uniform_real_distribution<float> turn(-6.0f, 6.0f);
+  std::uniform_real_distribution<float> speed(0.0f, 15.0f);
+
+  SimulationState simulation_state;
+  BufferMap buffer_map;
+  std::vector<ActorId> vehicle_id_list;
+  std::vector<ActorId> actor_id_list;
+  uint64_t waypoint_id = 0u;
+  for (size_t i = 0u; i < number_of_vehicles; ++i) {
+    const ActorId actor_id = static_cast<ActorId>(1u + i);
+    const Location location(position(rng), position(rng), 0.0f);
+    const Rotation rotation(0.0f, yaw(rng), 0.0f);
+    const Vector3D velocity = rotation.GetForwardVector() * speed(rng);
+    simulation_state.AddActor(actor_id,
+                              KinematicState{location, rotation, velocity, 30.0f, true, false, location},
+                              StaticAttributes{ActorType::Vehicle, 2.4f, 1.0f, 0.8f},
+                              TrafficLightState{TLS::Green, false});
+    // 从车辆位置出发、逐渐转弯的路径
+    Buffer &buffer = buffer_map[actor_id];
+    Location point = location;
+    float heading = rotation.yaw;
+    for (size_t j = 0u; j < path_length; ++j) {
+      ResolvedWaypoint resolved;
+      resolved.transform = Transform(point, Rotation(0.0f, heading, 0.0f));
+      resolved.id = waypoint_id++;
+      buffer.push_back(std::make_shared<SimpleWaypoint>(nullptr, resolved));
+      heading += turn(rng);
+      point += Location(Rotation(0.0f, heading, 0.0f).GetForwardVector() * 2.0f);
+    }
+    vehicle_id_list.push_back(actor_id);
+    actor_id_list.push_back(actor_id);
+  }
+  // 行人没有路径缓存，边界框沿速度方向延伸
+  for (size_t i = 0u; i < number_of_walkers; ++i) {
+    const ActorId actor_id = static_cast<ActorId>(1000u + i);
+    const Location location(position(rng), position(rng), 0.0f);
+    const Rotation rotation(0.0f, yaw(rng), 0.0f);
+    const Vector3D velocity = rotation.GetForwardVector() * 1.5f;
+    simulation_state.AddActor(actor_id,
+                              KinematicState{location, rotation, velocity, 0.0f, true, false, location},
+                              StaticAttributes{ActorType::Pedestrian, 0.3f, 0.3f, 0.9f},
+                              TrafficLightState{TLS::Off, false});
+    actor_id_list.push_back(actor_id);
+  }
+
+  Parameters parameters;
+  parameters.SetGlobalDistanceToLeadingVehicle(4.0f);
+  parameters.UpdateSnapshot(vehicle_id_list);
+  TrackTraffic track_traffic;
+  CollisionFrame collision_frame(vehicle_id_list.size());
+  RandomGenerator random_device(2020u);
+  CollisionStage stage(vehicle_id_list, simulation_state, buffer_map, track_traffic,
+                       parameters, collision_frame, random_device);
+  stage.PrepareCycle();
+
+  // 粗检测跳过的车辆对中不可能存在路径边界接触，
+  // 因此保留下来的车辆对中接触的集合与完整检测的结果相同
+  size_t pruned_pairs = 0u;
+  size_t touching_pairs = 0u;
+  std::vector<std::pair<ActorId, ActorId>> pairs;
+  std::vector<GeometryComparison> exhaustive;
+  for (const ActorId reference : vehicle_id_list) {
+    for (const ActorId other : actor_id_list) {
+      if (reference == other) {
+        continue;
+      }
+      const GeometryComparison comparison = stage.GetGeometryBetweenActors(reference, other);
+      const bool touching = comparison.inter_geodesic_distance < OVERLAP_THRESHOLD;
+      if (!stage.MayOverlap(reference, other)) {
+        ++pruned_pairs;
+        EXPECT_FALSE(touching) << reference << " " << other;
+        EXPECT_GE(comparison.reference_vehicle_to_other_geodesic, OVERLAP_THRESHOLD);
+        EXPECT_GE(comparison.other_vehicle_to_reference_geodesic, OVERLAP_THRESHOLD);
+        EXPECT_GE(comparison.inter_bbox_distance, OVERLAP_THRESHOLD);
+      }
+      touching_pairs += touching ? 1u : 0u;
+      pairs.emplace_back(reference, other);
+      exhaustive.push_back(comparison);
+    }
+  }
+  // 场景中两种情况都要出现，否则测试没有意义
+  EXPECT_GT(pruned_pairs, pairs.size() / 2u);
+  EXPECT_GT(touching_pairs, 0u);
+
+  // 缓存的边界与几何比较结果与重新计算的结果相同，交换参考车辆时交换两个方向的距离
+  stage.ClearCycleCache();
+  for (size_t i = 0u; i < pairs.size(); ++i) {
+    const ActorId reference = pairs[i].first;
+    const ActorId other = pairs[i].second;
+    const GeometryComparison recomputed = stage.GetGeometryBetweenActors(reference, other);
+    EXPECT_DOUBLE_EQ(recomputed.reference_vehicle_to_other_geodesic, exhaustive[i].reference_vehicle_to_other_geodesic);
+    EXPECT_DOUBLE_EQ(recomputed.other_vehicle_to_reference_geodesic, exhaustive[i].other_vehicle_to_reference_geodesic);
+    EXPECT_DOUBLE_EQ(recomputed.inter_geodesic_distance, exhaustive[i].inter_geodesic_distance);
+    EXPECT_DOUBLE_EQ(recomputed.inter_bbox_distance, exhaustive[i].inter_bbox_distance);
+    if (simulation_state.GetType(other) == ActorType::Vehicle) {
+      const GeometryComparison swapped = stage.GetGeometryBetweenActors(other, reference);
+      EXPECT_DOUBLE_EQ(swapped.reference_vehicle_to_other_geodesic, recomputed.other_vehicle_to_reference_geodesic);
+      EXPECT_DOUBLE_EQ(swapped.other_vehicle_to_reference_geodesic, recomputed.reference_vehicle_to_other_geodesic);
+      EXPECT_DOUBLE_EQ(swapped.inter_geodesic_distance, recomputed.inter_geodesic_distance);
+    }
+  }
+}
+
+TEST(traffic_manager, control_frame_filter) {
+  using carla::rpc::Command;
+  using carla::traffic_manager::ControlFrame;
+  using carla::traffic_manager::ControlFrameFilter;
+  constexpr float tolerance = 0.01f;
+
+  auto make_control = [](ActorId actor_id, float throttle) {
+    carla::rpc::VehicleControl control;
+    control.throttle = throttle;
+    return Command{Command::ApplyVehicleControl(actor_id, control)};
+  };
+  auto ids_of = [](const ControlFrame &batch) {
+    std::vector<ActorId> ids;
+    for (const auto &command : batch) {
+      const auto *control = boost::variant2::get_if<Command::ApplyVehicleControl>(&command.command);
+      ids.push_back(control != nullptr ? control->actor : 0u);
+    }
+    return ids;
+  };
+
+  StageExecutor executor(4u);
+  ControlFrameFilter filter;
+  ControlFrame batch;
+
+  // 第一帧全部发送，车灯命令总是发送
+  ControlFrame frame = {make_control(1u, 0.5f), make_control(2u, 0.5f), make_control(3u, 0.5f)};
+  frame.push_back(Command{Command::SetVehicleLightState(1u, 0u)});
+  filter.Filter(frame, 3u, tolerance, executor, batch);
+  EXPECT_EQ(ids_of(batch), (std::vector<ActorId>{1u, 2u, 3u, 0u}));
+
+  // 只发送变化超过容差的命令，比较的基准是上一次发送的命令
+  frame = {make_control(1u, 0.505f), make_control(2u, 0.7f), make_control(3u, 0.5f)};
+  batch.clear();
+  filter.Filter(frame, 3u, tolerance, executor, batch);
+  EXPECT_EQ(ids_of(batch), (std::vector<ActorId>{2u}));
+  frame = {make_control(1u, 0.515f), make_control(2u, 0.7f), make_control(3u, 0.5f)};
+  batch.clear();
+  filter.Filter(frame, 3u, tolerance, executor, batch);
+  EXPECT_EQ(ids_of(batch), (std::vector<ActorId>{1u}));
+
+  // 混合物理模式下的传送总是发送，即使每一步的位移小于容差，否则车辆会停在原地
+  auto make_teleport = [](ActorId actor_id, float x) {
+    return Command{Command::ApplyTransform(actor_id, carla::geom::Transform(carla::geom::Location(x, 2.0f, 0.0f)))};
+  };
+  for (int step = 0; step < 3; ++step) {
+    frame[2u] = make_teleport(3u, 1.0f + 0.5f * tolerance * static_cast<float>(step));
+    batch.clear();
+    filter.Filter(frame, 3u, tolerance, executor, batch);
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_TRUE(boost::variant2::get_if<Command::ApplyTransform>(&batch[0u].command) != nullptr);
+  }
+  EXPECT_FALSE(ControlFrameFilter::IsNearlyEqual(frame[2u], frame[2u], 1.0f));
+
+  // 恢复物理模拟后的第一条控制命令总是发送，即使与传送前的控制相同
+  frame[2u] = make_control(3u, 0.5f);
+  batch.clear();
+  filter.Filter(frame, 3u, tolerance, executor, batch);
+  EXPECT_EQ(ids_of(batch), (std::vector<ActorId>{3u}));
+
+  // 注销后重新注册的车辆会重新发送
+  filter.Retain({1u, 3u});
+  batch.clear();
+  filter.Filter(frame, 3u, tolerance, executor, batch);
+  EXPECT_EQ(ids_of(batch), (std::vector<ActorId>{2u}));
+  filter.Reset();
+  batch.clear();
+  filter.Filter(frame, 3u, tolerance, executor, batch);
+  EXPECT_EQ(batch.size(), 3u);
+
+  // 离散的值必须完全相同
+  auto reversed = make_control(1u, 0.515f);
+  boost::variant2::get<Command::ApplyVehicleControl>(reversed.command).control.reverse = true;
+  EXPECT_FALSE(ControlFrameFilter::IsNearlyEqual(frame[0u], reversed, 1.0f));
+  EXPECT_TRUE(ControlFrameFilter::IsNearlyEqual(frame[0u], make_control(1u, 0.52f), tolerance));
+  EXPECT_FALSE(ControlFrameFilter::IsNearlyEqual(frame[0u], make_control(2u, 0.515f), tolerance));
+}
+
+// 只保存参数的交通管理器，用于通过 TrafficManagerServer 测试远程设置
+class ParametersOnlyTrafficManager : public carla::traffic_manager::TrafficManagerBase {
+public:
+
+  using ActorPtr = carla::traffic_manager::ActorPtr;
+  using Path = carla::traffic_manager::Path;
+  using Route = carla::traffic_manager::Route;
+  using Action = carla::traffic_manager::Action;
+  using ActionBuffer = carla::traffic_manager::ActionBuffer;
+  using VehicleParameter = carla::traffic_manager::VehicleParameter;
+  using VehicleParameterList = carla::traffic_manager::VehicleParameterList;
+
+  Parameters parameters;
+
+  void SetVehicleParameters(const VehicleParameter parameter, const VehicleParameterList &values) override {
+    parameters.SetVehicleParameters(parameter, values);
+  }
+
+  void Start() override {}
+  void Stop() override {}
+  void Release() override {}
+  void Reset() override {}
+  void RegisterVehicles(const std::vector<ActorPtr> &) override {}
+  void UnregisterVehicles(const std::vector<ActorPtr> &) override {}
+  void SetPercentageSpeedDifference(const ActorPtr &, const float) override {}
+  void SetLaneOffset(const ActorPtr &, const float) override {}
+  void SetDesiredSpeed(const ActorPtr &, const float) override {}
+  void SetGlobalPercentageSpeedDifference(float const) override {}
+  void SetGlobalLaneOffset(float const) override {}
+  void SetUpdateVehicleLights(const ActorPtr &, const bool) override {}
+  void SetCollisionDetection(const ActorPtr &, const ActorPtr &, const bool) override {}
+  void SetForceLaneChange(const ActorPtr &, const bool) override {}
+  void SetAutoLaneChange(const ActorPtr &, const bool) override {}
+  void SetDistanceToLeadingVehicle(const ActorPtr &, const float) override {}
+  void SetPercentageIgnoreWalkers(const ActorPtr &, const float) override {}
+  void SetPercentageIgnoreVehicles(const ActorPtr &, const float) override {}
+  void SetPercentageRunningLight(const ActorPtr &, const float) override {}
+  void SetPercentageRunningSign(const ActorPtr &, const float) override {}
+  void SetSynchronousMode(bool) override {}
+  void SetSynchronousModeTimeOutInMiliSecond(double) override {}
+  bool SynchronousTick() override { return true; }
+  carla::client::detail::EpisodeProxy &GetEpisodeProxy() override { return episode_proxy; }
+  void SetGlobalDistanceToLeadingVehicle(const float) override {}
+  void SetKeepRightPercentage(const ActorPtr &, const float) override {}
+  void SetRandomLeftLaneChangePercentage(const ActorPtr &, const float) override {}
+  void SetRandomRightLaneChangePercentage(const ActorPtr &, const float) override {}
+  void SetHybridPhysicsMode(const bool) override {}
+  void SetHybridPhysicsRadius(const float) override {}
+  void SetWorkerThreadCount(const unsigned) override {}
+  void SetControlFrameDiffing(const bool, const float) override {}
+  void SetAsynchronousParameterUpdates(const bool) override {}
+  void SetRandomDeviceSeed(const uint64_t) override {}
+  void SetOSMMode(const bool) override {}
+  void SetCustomPath(const ActorPtr &, const Path, const bool) override {}
+  void RemoveUploadPath(const ActorId &, const bool) override {}
+  void UpdateUploadPath(const ActorId &, const Path) override {}
+  void SetImportedRoute(const ActorPtr &, const Route, const bool) override {}
+  void RemoveImportedRoute(const ActorId &, const bool) override {}
+  void UpdateImportedRoute(const ActorId &, const Route) override {}
+  void SetRespawnDormantVehicles(const bool) override {}
+  void SetBoundariesRespawnDormantVehicles(const float, const float) override {}
+  void SetMaxBoundaries(const float, const float) override {}
+  Action GetNextAction(const ActorId &) override { return Action(); }
+  ActionBuffer GetActionBuffer(const ActorId &) override { return ActionBuffer(); }
+  void ShutDown() override {}
+
+private:
+
+  carla::client::detail::EpisodeProxy episode_proxy;
+};
+
+TEST(traffic_manager, remote_vehicle_parameters) {
+  using carla::traffic_manager::TrafficManagerClient;
+  using carla::traffic_manager::TrafficManagerServer;
+  using carla::traffic_manager::VehicleParameter;
+  using carla::traffic_manager::VehicleParameterList;
+  constexpr ActorId number_of_vehicles = 1000u;
+
+  ParametersOnlyTrafficManager tm;
+  uint16_t port = (TESTING_PORT != 0u ? TESTING_PORT : 8010u);
+  TrafficManagerServer server(port, &tm);
+  TrafficManagerClient client("localhost", port);
+
+  VehicleParameterList speed_difference;
+  VehicleParameterList desired_speed;
+  VehicleParameterList running_light;
+  VehicleParameterList auto_lane_change;
+  for (ActorId actor_id = 1u; actor_id <= number_of_vehicles; ++actor_id) {
+    speed_difference.emplace_back(actor_id, 30.0f);
+    if (actor_id % 2u == 0u) {
+      desired_speed.emplace_back(actor_id, static_cast<float>(actor_id));
+    }
+    running_light.emplace_back(actor_id, static_cast<float>(actor_id % 150u));
+    auto_lane_change.emplace_back(actor_id, actor_id % 3u == 0u ? 0.0f : 1.0f);
+  }
+
+  // 同步调用返回时参数已经生效
+  client.SetVehicleParameters(VehicleParameter::PercentageSpeedDifference, speed_difference, false);
+  EXPECT_FLOAT_EQ(tm.parameters.GetVehicleTargetVelocity(number_of_vehicles, 50.0f), 35.0f);
+
+  // 异步发送的参数按顺序应用，之后的同步调用返回时都已经生效
+  client.SetVehicleParameters(VehicleParameter::DesiredSpeed, desired_speed, true);
+  client.SetVehicleParameters(VehicleParameter::PercentageRunningLight, running_light, true);
+  client.SetVehicleParameters(VehicleParameter::AutoLaneChange, auto_lane_change, true);
+  client.HealthCheckRemoteTM();
+
+  for (ActorId actor_id = 1u; actor_id <= number_of_vehicles; ++actor_id) {
+    const float expected_velocity = actor_id % 2u == 0u ? static_cast<float>(actor_id) : 35.0f;
+    ASSERT_FLOAT_EQ(tm.parameters.GetVehicleTargetVelocity(actor_id, 50.0f), expected_velocity);
+    ASSERT_FLOAT_EQ(tm.parameters.GetPercentageRunningLight(actor_id), std::min(static_cast<float>(actor_id % 150u), 100.0f));
+    ASSERT_EQ(tm.parameters.GetAutoLaneChange(actor_id), actor_id % 3u != 0u);
+  }
+
+  // 无效的参数类型被服务器忽略，服务器继续工作且已有的参数不变
+  VehicleParameterList zero_speed;
+  for (ActorId actor_id = 1u; actor_id <= number_of_vehicles; ++actor_id) {
+    zero_speed.emplace_back(actor_id, 0.0f);
+  }
+  client.SetVehicleParameters(VehicleParameter::SIZE, zero_speed, false);
+  client.SetVehicleParameters(VehicleParameter::SIZE, zero_speed, true);
+  client.HealthCheckRemoteTM();
+  client.SetVehicleParameters(VehicleParameter::DesiredSpeed, {{1u, 20.0f}}, false);
+  EXPECT_FLOAT_EQ(tm.parameters.GetVehicleTargetVelocity(1u, 50.0f), 20.0f);
+  for (ActorId actor_id = 2u; actor_id <= number_of_vehicles; ++actor_id) {
+    const float expected_velocity = actor_id % 2u == 0u ? static_cast<float>(actor_id) : 35.0f;
+    ASSERT_FLOAT_EQ(tm.parameters.GetVehicleTargetVelocity(actor_id, 50.0f), expected_velocity);
+  }
+}
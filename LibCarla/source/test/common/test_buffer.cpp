@@ -176,3 +176,70 @@ TEST(buffer, buffer_pool) {
   // 现在清空缓存池来测试缓存里面的弱引用
   pool.reset();
 }
+
+// 测试缓冲区池的大小级别
+// 指定大小弹出时应得到容量足够的缓冲区，小缓冲区不会被分给大消息
+TEST(buffer, buffer_pool_size_classes) {
+  ASSERT_EQ(carla::BufferPool::SizeClassForCapacity(1u), 0u);
+  ASSERT_EQ(carla::BufferPool::SizeClassForCapacity(1023u), 9u);
+  ASSERT_EQ(carla::BufferPool::SizeClassForCapacity(1024u), 10u);
+  ASSERT_EQ(carla::BufferPool::SizeClassForRequest(1024u), 10u);
+  ASSERT_EQ(carla::BufferPool::SizeClassForRequest(1025u), 11u);
+
+  auto pool = std::make_shared<carla::BufferPool>();
+  {
+    auto small = pool->Pop(100u);
+    small.reset(100u);
+    auto large = pool->Pop(1u << 20u);
+    large.reset(1u << 20u);
+  }
+  auto statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.misses, 2u);
+  ASSERT_EQ(statistics.buffers_retained, 2u);
+  ASSERT_EQ(statistics.bytes_retained, 100u + (1u << 20u));
+
+  // 大消息只能拿到大缓冲区
+  auto large = pool->Pop(1000000u);
+  ASSERT_GE(large.capacity(), 1000000u);
+  // 没有合适的小缓冲区时不会占用过大的缓冲区
+  auto medium = pool->Pop(4096u);
+  ASSERT_EQ(medium.capacity(), 0u);
+  auto small = pool->Pop(64u);
+  ASSERT_EQ(small.capacity(), 100u);
+
+  statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.hits, 2u);
+  ASSERT_EQ(statistics.misses, 3u);
+  ASSERT_EQ(statistics.buffers_retained, 0u);
+  ASSERT_EQ(statistics.bytes_retained, 0u);
+}
+
+// 测试缓冲区池的上限与释放
+TEST(buffer, buffer_pool_limits) {
+  auto pool = std::make_shared<carla::BufferPool>(2u, 10000u);
+  {
+    std::vector<carla::Buffer> buffers;
+    for (auto i = 0u; i < 4u; ++i) {
+      buffers.emplace_back(pool->Pop(1000u));
+      buffers.back().reset(1000u);
+    }
+    buffers.emplace_back(pool->Pop(20000u));
+    buffers.back().reset(20000u);
+  }
+  // 每个级别最多保留两个，超出总字节数的缓冲区直接释放
+  auto statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.pushes, 2u);
+  ASSERT_EQ(statistics.discarded, 3u);
+  ASSERT_EQ(statistics.buffers_retained, 2u);
+  ASSERT_EQ(statistics.bytes_retained, 2000u);
+
+  pool->Trim(1000u);
+  statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.buffers_retained, 1u);
+  ASSERT_EQ(statistics.bytes_retained, 1000u);
+
+  pool->Trim();
+  statistics = pool->GetStatistics();
+  ASSERT_EQ(statistics.buffers_retained, 0u);
+  ASSERT_EQ(statistics.bytes_retained, 0u);
+}
@@ -8,9 +8,13 @@
 
 #include <carla/geom/Vector3D.h>
 #include <carla/geom/Math.h>
+#include <carla/geom/Mesh.h>
 #include <carla/geom/BoundingBox.h>
 #include <carla/geom/Transform.h>
+#include <cstring>
 #include <limits>
+#include <random>
+#include <sstream>
 // 定义一个名为carla的命名空间，用于组织相关的代码和类型
 namespace carla {
 // 在carla命名空间内部，再定义一个名为geom的子命名空间
@@ -349,3 +353,129 @@ TEST(geom, nearest_point_arc) {
       1.0f,  // 预期的距离值
       0.01f);  // 容忍的误差范围
 }
+
+TEST(geom, mesh_append) {
+  // 构造几个带材质的小网格
+  std::vector<std::unique_ptr<Mesh>> meshes;
+  for (int i = 0; i < 3; ++i) {
+    auto mesh = std::make_unique<Mesh>();
+    mesh->AddMaterial("material_" + std::to_string(i));
+    for (int j = 0; j <= i + 2; ++j) {
+      mesh->AddVertex(Vector3D(static_cast<float>(i), static_cast<float>(j), 0.0f));
+      mesh->AddNormal(Vector3D(0.0f, 0.0f, 1.0f));
+      mesh->AddUV(Vector2D(static_cast<float>(j), 0.0f));
+    }
+    mesh->AddIndex(1u);
+    mesh->AddIndex(2u);
+    mesh->AddIndex(3u);
+    mesh->EndMaterial();
+    meshes.emplace_back(std::move(mesh));
+  }
+  meshes.emplace_back(nullptr);
+
+  // Append 的结果必须与依次调用 operator+= 完全一致
+  Mesh expected;
+  for (auto &mesh : meshes) {
+    if (mesh != nullptr) {
+      expected += *mesh;
+    }
+  }
+  Mesh result;
+  result.Append(meshes);
+
+  ASSERT_EQ(result.GetVertices(), expected.GetVertices());
+  ASSERT_EQ(result.GetNormals(), expected.GetNormals());
+  ASSERT_EQ(result.GetIndexes(), expected.GetIndexes());
+  ASSERT_EQ(result.GetUVs(), expected.GetUVs());
+  ASSERT_EQ(result.GetMaterials().size(), expected.GetMaterials().size());
+  for (size_t i = 0u; i < result.GetMaterials().size(); ++i) {
+    ASSERT_EQ(result.GetMaterials()[i].name, expected.GetMaterials()[i].name);
+    ASSERT_EQ(result.GetMaterials()[i].index_start, expected.GetMaterials()[i].index_start);
+    ASSERT_EQ(result.GetMaterials()[i].index_end, expected.GetMaterials()[i].index_end);
+  }
+}
+
+// 构造一个带随机坐标的网格，用于测试导出
+static Mesh MakeRandomMesh(size_t number_of_vertices) {
+  std::mt19937 engine(42u);
+  std::uniform_real_distribution<float> distribution(-5000.0f, 5000.0f);
+  Mesh mesh;
+  mesh.AddMaterial("road");
+  for (size_t i = 0u; i < number_of_vertices; ++i) {
+    mesh.AddVertex(Vector3D(distribution(engine), distribution(engine), distribution(engine) * 1e-4f));
+    mesh.AddNormal(Vector3D(0.0f, -0.0f, 1.0f));
+    mesh.AddUV(Vector2D(distribution(engine) * 1e-3f, 0.0078125f));
+  }
+  for (size_t i = 1u; i + 2u <= number_of_vertices; ++i) {
+    mesh.AddIndex(i);
+    mesh.AddIndex(i + 1u);
+    mesh.AddIndex(i + 2u);
+  }
+  mesh.EndMaterial();
+  return mesh;
+}
+
+TEST(geom, mesh_write_obj) {
+  const auto mesh = MakeRandomMesh(1000u);
+
+  // 按照原来基于 std::stringstream 的格式生成参考输出
+  std::stringstream expected;
+  expected << std::fixed;
+  expected << "# List of geometric vertices, with (x, y, z) coordinates." << std::endl;
+  for (auto &v : mesh.GetVertices()) {
+    expected << "v " << v.x << " " << v.y << " " << v.z << std::endl;
+  }
+  expected << std::endl << "# List of texture coordinates, in (u, v) coordinates, these will vary between 0 and 1." << std::endl;
+  for (auto &vt : mesh.GetUVs()) {
+    expected << "vt " << vt.x << " " << vt.y << std::endl;
+  }
+  expected << std::endl << "# List of vertex normals in (x, y, z) form; normals might not be unit vectors." << std::endl;
+  for (auto &vn : mesh.GetNormals()) {
+    expected << "vn " << vn.x << " " << vn.y << " " << vn.z << std::endl;
+  }
+  expected << std::endl << "# Polygonal face element." << std::endl;
+  expected << "\nusemtl road" << std::endl;
+  const auto &indexes = mesh.GetIndexes();
+  for (size_t i = 0u; i < indexes.size(); i += 3u) {
+    expected << "f " << indexes[i] << " " << indexes[i + 1u] << " " << indexes[i + 2u] << std::endl;
+  }
+
+  std::stringstream result;
+  ASSERT_TRUE(mesh.WriteOBJ(result));
+  ASSERT_EQ(result.str(), expected.str());
+  ASSERT_EQ(mesh.GenerateOBJ(), expected.str());
+
+  std::stringstream invalid;
+  ASSERT_FALSE(Mesh().WriteOBJ(invalid));
+  ASSERT_TRUE(invalid.str().empty());
+}
+
+TEST(geom, mesh_write_ply) {
+  const auto mesh = MakeRandomMesh(100u);
+  std::stringstream out;
+  ASSERT_TRUE(mesh.WritePLY(out));
+  const std::string ply = out.str();
+
+  const std::string end_header = "end_header\n";
+  const auto header_size = ply.find(end_header);
+  ASSERT_NE(header_size, std::string::npos);
+  const std::string header = ply.substr(0u, header_size);
+  ASSERT_EQ(header.find("ply\nformat binary_"), 0u);
+  ASSERT_NE(header.find("element vertex 100\n"), std::string::npos);
+  ASSERT_NE(header.find("element face 98\n"), std::string::npos);
+
+  // 每个顶点 8 个 float（位置、法线、UV），每个面 1 个字节加 3 个 uint32
+  const size_t vertex_size = 8u * sizeof(float);
+  const size_t face_size = 1u + 3u * sizeof(uint32_t);
+  const char *body = ply.data() + header_size + end_header.size();
+  ASSERT_EQ(ply.size() - header_size - end_header.size(), 100u * vertex_size + 98u * face_size);
+
+  float x;
+  std::memcpy(&x, body + 5u * vertex_size, sizeof(float));
+  ASSERT_EQ(x, mesh.GetVertices()[5u].x);
+  const char *face = body + 100u * vertex_size + 7u * face_size;
+  ASSERT_EQ(static_cast<uint8_t>(face[0u]), 3u);
+  uint32_t index;
+  std::memcpy(&index, face + 1u, sizeof(uint32_t));
+  ASSERT_EQ(index + 1u, mesh.GetIndexes()[21u]);
+}
@@ -13,6 +13,8 @@
 #include <carla/streaming/Server.h>
 // 包含Carla流媒体细节相关的调度器头文件，可能涉及到对流媒体数据分发、处理等底层逻辑的实现
 #include <carla/streaming/detail/Dispatcher.h>
+// 包含共享内存环形缓冲区的头文件
+#include <carla/streaming/detail/shm/RingBuffer.h>
 // 包含Carla流媒体基于TCP协议客户端相关的详细实现头文件，提供了具体的TCP客户端功能实现细节
 #include <carla/streaming/detail/tcp/Client.h>
 // 包含Carla流媒体基于TCP协议服务器相关的详细实现头文件，提供了具体的TCP服务器功能实现细节
@@ -22,7 +24,11 @@
 // 包含Carla流媒体底层服务器相关的头文件，涉及更底层的服务器功能实现，同样可能侧重于基础的协议处理等方面
 #include <carla/streaming/low_level/Server.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <cstring>
+#include <vector>
 // 使用 std::chrono_literals 命名空间，这样可以方便地使用时间字面量
 using namespace std::chrono_literals;
 
@@ -197,7 +203,7 @@ TEST(streaming, low_level_tcp_small_message) {
   tcp::Server::endpoint ep(boost::asio::ip::tcp::v4(), TESTING_PORT);
 
   tcp::Server srv(io_context, ep);
-    / 设置服务器超时时间
+    // 设置服务器超时时间
   srv.SetTimeout(1s);
     // 初始化一个原子布尔变量，表示任务是否完成
   std::atomic_bool done{false};
@@ -253,6 +259,148 @@ TEST(streaming, low_level_tcp_small_message) {
   c->Stop();
 }
 
+// 同步模式下连续写入大量消息，发送队列会合并发送，但消息不能丢失或乱序
+TEST(streaming, low_level_tcp_synchronous_write_queue) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  constexpr uint32_t number_of_messages = 5000u;
+
+  boost::asio::io_context io_context;
+  tcp::Server::endpoint ep(boost::asio::ip::tcp::v4(), TESTING_PORT);
+
+  tcp::Server srv(io_context, ep);
+  srv.SetTimeout(1s);
+  srv.SetSynchronousMode(true);
+  std::atomic_size_t message_count{0u};
+  std::atomic_bool out_of_order{false};
+  std::atomic_bool sent{false};
+
+  srv.Listen([&](std::shared_ptr<tcp::ServerSession> session) {
+    // 只在第一个会话中写入，客户端重新连接时不再重复发送
+    if (sent.exchange(true)) {
+      return;
+    }
+    for (uint32_t i = 0u; i < number_of_messages; ++i) {
+      carla::Buffer buffer(boost::asio::buffer(&i, sizeof(i)));
+      session->Write(carla::BufferView::CreateFrom(std::move(buffer)));
+    }
+  }, [](std::shared_ptr<tcp::ServerSession>) {});
+
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
+  auto stream = dispatcher.MakeStream();
+  auto c = std::make_shared<tcp::Client>(io_context, stream.token(), [&](carla::Buffer message) {
+    ASSERT_EQ(message.size(), sizeof(uint32_t));
+    uint32_t value = 0u;
+    std::memcpy(&value, message.data(), sizeof(value));
+    if (value != message_count) {
+      out_of_order = true;
+    }
+    ++message_count;
+  });
+  c->Connect();
+
+  // 同步模式下写入者会等待发送队列，需要至少两个线程
+  carla::ThreadGroup threads;
+  threads.CreateThreads(
+      std::max(2u, std::thread::hardware_concurrency()),
+      [&]() { io_context.run(); });
+
+  for (auto i = 0u; i < 500u && message_count < number_of_messages; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  io_context.stop();
+  ASSERT_EQ(message_count, number_of_messages);
+  ASSERT_FALSE(out_of_order);
+  c->Stop();
+}
+
+TEST(streaming, shared_memory_ring_buffer) {
+  using namespace carla::streaming::detail;
+  auto producer = shm::RingBuffer::Create(shm::RingBuffer::MakeUniqueName(1u), 1000u);
+  auto consumer = shm::RingBuffer::Open(producer->GetName());
+  ASSERT_EQ(consumer->GetCapacity(), 1000u);
+
+  std::vector<unsigned char> data(400u);
+  std::vector<unsigned char> result(400u);
+  std::array<boost::asio::const_buffer, 1u> sequence{{boost::asio::buffer(data)}};
+  uint64_t position = 0u;
+  for (auto i = 0u; i < 10u; ++i) {
+    std::fill(data.begin(), data.end(), static_cast<unsigned char>(i));
+    ASSERT_TRUE(producer->TryWrite(sequence.begin(), sequence.end(), data.size(), position));
+    // 末尾剩余空间不足时消息从环的开头开始
+    ASSERT_LE(position % 1000u + data.size(), 1000u);
+    ASSERT_TRUE(consumer->Read(position, result.size(), result.data()));
+    ASSERT_EQ(result, data);
+    // 已经读取过的位置不能再读
+    ASSERT_FALSE(consumer->Read(position, result.size(), result.data()));
+  }
+
+  // 未读取的消息占满环时写入失败
+  ASSERT_TRUE(producer->TryWrite(sequence.begin(), sequence.end(), data.size(), position));
+  ASSERT_TRUE(producer->TryWrite(sequence.begin(), sequence.end(), data.size(), position));
+  ASSERT_FALSE(producer->TryWrite(sequence.begin(), sequence.end(), data.size(), position));
+  ASSERT_FALSE(producer->TryWrite(sequence.begin(), sequence.end(), 2000u, position));
+}
+
+TEST(streaming, low_level_tcp_shared_memory) {
+  using namespace carla::streaming;
+  using namespace carla::streaming::detail;
+  constexpr uint32_t number_of_messages = 200u;
+  constexpr size_t large_message_size = 256u * 1024u;
+
+  boost::asio::io_context io_context;
+  tcp::Server::endpoint ep(boost::asio::ip::tcp::v4(), TESTING_PORT);
+
+  tcp::Server srv(io_context, ep);
+  srv.SetTimeout(1s);
+  srv.SetSynchronousMode(true);
+  std::atomic_size_t message_count{0u};
+  std::atomic_bool corrupted{false};
+  std::atomic_bool sent{false};
+
+  // 大消息通过共享内存发送，小消息与环形缓冲区已满时的消息直接通过TCP发送
+  auto make_message = [](uint32_t i) {
+    std::vector<uint32_t> data((i % 2u == 0u ? large_message_size : sizeof(uint32_t)) / sizeof(uint32_t), i);
+    return carla::BufferView::CreateFrom(carla::Buffer(data));
+  };
+
+  srv.Listen([&](std::shared_ptr<tcp::ServerSession> session) {
+    if (sent.exchange(true)) {
+      return;
+    }
+    for (uint32_t i = 0u; i < number_of_messages; ++i) {
+      session->Write(make_message(i));
+    }
+  }, [](std::shared_ptr<tcp::ServerSession>) {});
+
+  Dispatcher dispatcher{make_endpoint<tcp::Client::protocol_type>(srv.GetLocalEndpoint())};
+  auto stream = dispatcher.MakeStream();
+  auto c = std::make_shared<tcp::Client>(io_context, stream.token(), [&](carla::Buffer message) {
+    const uint32_t i = static_cast<uint32_t>(message_count);
+    const auto expected = make_message(i);
+    if ((message.size() != expected->size()) ||
+        (std::memcmp(message.data(), expected->data(), message.size()) != 0)) {
+      corrupted = true;
+    }
+    ++message_count;
+  });
+  c->EnableSharedMemory(1024u * 1024u);
+  c->Connect();
+
+  carla::ThreadGroup threads;
+  threads.CreateThreads(
+      std::max(2u, std::thread::hardware_concurrency()),
+      [&]() { io_context.run(); });
+
+  for (auto i = 0u; i < 500u && message_count < number_of_messages; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  io_context.stop();
+  ASSERT_EQ(message_count, number_of_messages);
+  ASSERT_FALSE(corrupted);
+  c->Stop();
+}
+
 struct DoneGuard {
   ~DoneGuard() { done = true; };
   std::atomic_bool &done;
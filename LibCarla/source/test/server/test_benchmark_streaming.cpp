@@ -7,13 +7,17 @@
 #include "test.h"
 //包含名为test.h的自定义头文件，可能包含项目特定的定义、函数声明等。
 #include <carla/Buffer.h>
+#include <carla/BufferPool.h>
 #include <carla/BufferView.h>
+#include <carla/StopWatch.h>
 #include <carla/streaming/Client.h>
 #include <carla/streaming/Server.h>
 //包含名为test.h的自定义头文件，可能包含项目特定的定义、函数声明等。
 #include <boost/asio/post.hpp>
 //是包含boost库中的asio模块的post.hpp头文件，boost::asio常用于异步输入/输出操作，这里的post可能与将任务提交到执行队列相关。
 #include <algorithm>
+#include <deque>
+#include <random>
 //包含了许多通用算法，如排序、查找等算法的模板函数声明。
 using namespace carla::streaming;//前者使得可以直接使用carla::streaming命名空间下的类型和函数而无需每次都写完整的命名空间前缀
 using namespace std::chrono_literals;//使得可以直接使用std::chrono库中的字面值（例如1s表示1秒的时间字面值等）。
@@ -179,3 +183,137 @@ TEST(benchmark_streaming, image_800x600_mt) {
 TEST(benchmark_streaming, image_1920x1080_mt) {
   benchmark_image(1920u * 1080u, get_max_concurrency(), 0.9);
 }
+
+// 在同步模式下尽快发送4K图像，返回全部接收所用的时间（毫秒）。
+// 同步模式下服务器不会丢弃消息，因此耗时反映了传输本身的吞吐量。
+static size_t benchmark_4k_transport(bool shared_memory) {
+  constexpr auto number_of_messages = 60u;
+  constexpr size_t message_size = 4u * 3840u * 2160u;
+
+  Server server(TESTING_PORT);
+  server.SetSynchronousMode(true);
+  server.AsyncRun(2u);
+
+  Client client;
+  if (shared_memory) {
+    client.EnableSharedMemory();
+  }
+  client.AsyncRun(2u);
+
+  const auto message = make_special_message(message_size);
+  std::atomic_size_t number_of_messages_received{0u};
+  auto stream = server.MakeStream();
+  client.Subscribe(stream.token(), [&](carla::Buffer msg) {
+    DEBUG_ASSERT_EQ(msg.size(), message_size);
+    ++number_of_messages_received;
+  });
+  std::this_thread::sleep_for(1s); // 等待客户端准备好
+
+  carla::StopWatch stop_watch;
+  for (auto i = 0u; i < number_of_messages; ++i) {
+    stream.Write(message);
+  }
+  for (auto i = 0u; i < 2000u && number_of_messages_received < number_of_messages; ++i) {
+    std::this_thread::sleep_for(10ms);
+  }
+  stop_watch.Stop();
+
+  const auto elapsed = stop_watch.GetElapsedTime();
+  const auto megabytes = static_cast<double>(number_of_messages * message_size) / (1024.0 * 1024.0);
+  carla::logging::log(
+      shared_memory ? "shared memory:" : "tcp:",
+      number_of_messages_received, "of", number_of_messages, "4K images in", elapsed, "ms,",
+      megabytes / (static_cast<double>(std::max<size_t>(elapsed, 1u)) / 1000.0), "MB/s");
+  EXPECT_EQ(number_of_messages_received, number_of_messages);
+  return elapsed;
+}
+
+TEST(benchmark_streaming, image_3840x2160_tcp_vs_shared_memory) {
+  const auto tcp = benchmark_4k_transport(false);
+  const auto shared_memory = benchmark_4k_transport(true);
+  carla::logging::log("Shared memory speed-up over tcp:", static_cast<double>(tcp) / static_cast<double>(std::max<size_t>(shared_memory, 1u)));
+}
+
+struct AllocationCount {
+  size_t allocations = 0u;
+  size_t bytes = 0u;
+};
+
+// 模拟相机与激光雷达混合的流量，统计取得缓冲区后仍需重新分配内存的次数与字节数。
+// pop(size) 返回一个缓冲区，release(buffers) 在帧结束时归还这一帧的所有缓冲区。
+template <typename PopFunctor, typename ReleaseFunctor>
+static AllocationCount count_buffer_allocations(PopFunctor &&pop, ReleaseFunctor &&release) {
+  constexpr auto number_of_frames = 200u;
+  constexpr auto number_of_lidars = 4u;
+  constexpr size_t camera_size = 4u * 1920u * 1080u;
+
+  std::mt19937 rng(42u);
+  std::uniform_int_distribution<size_t> lidar_size(100000u, 400000u);
+
+  AllocationCount count;
+  for (auto frame = 0u; frame < number_of_frames; ++frame) {
+    // 同一帧的传感器数据以随机顺序到达，并且同时在处理中
+    std::vector<size_t> sizes(number_of_lidars + 1u, camera_size);
+    for (auto i = 0u; i < number_of_lidars; ++i) {
+      sizes[i] = lidar_size(rng);
+    }
+    std::shuffle(sizes.begin(), sizes.end(), rng);
+
+    std::vector<carla::Buffer> in_flight;
+    for (auto size : sizes) {
+      carla::Buffer buffer = pop(size);
+      if (buffer.capacity() < size) {
+        ++count.allocations;
+        count.bytes += size;
+      }
+      buffer.reset(size);
+      in_flight.emplace_back(std::move(buffer));
+    }
+    release(in_flight);
+  }
+  return count;
+}
+
+TEST(benchmark_streaming, buffer_pool_mixed_camera_lidar) {
+  // 旧的缓冲池：一个不区分大小的先进先出队列
+  std::deque<carla::Buffer> queue;
+  const auto fifo_allocations = count_buffer_allocations(
+      [&](size_t) {
+        carla::Buffer buffer;
+        if (!queue.empty()) {
+          buffer = std::move(queue.front());
+          queue.pop_front();
+        }
+        return buffer;
+      },
+      [&](std::vector<carla::Buffer> &buffers) {
+        for (auto &buffer : buffers) {
+          queue.emplace_back(std::move(buffer));
+        }
+      });
+
+  // 按大小级别划分的缓冲池，缓冲区销毁时自动归还
+  auto pool = std::make_shared<carla::BufferPool>();
+  const auto pool_allocations = count_buffer_allocations(
+      [&](size_t size) { return pool->Pop(size); },
+      [](std::vector<carla::Buffer> &buffers) { buffers.clear(); });
+
+  size_t fifo_bytes_retained = 0u;
+  for (auto &buffer : queue) {
+    fifo_bytes_retained += buffer.capacity();
+  }
+  const auto statistics = pool->GetStatistics();
+  carla::logging::log(
+      "FIFO queue allocations:", fifo_allocations.allocations,
+      "bytes allocated:", fifo_allocations.bytes,
+      "bytes retained:", fifo_bytes_retained);
+  carla::logging::log(
+      "Size-class pool allocations:", pool_allocations.allocations,
+      "bytes allocated:", pool_allocations.bytes,
+      "bytes retained:", statistics.bytes_retained,
+      "hits:", statistics.hits,
+      "misses:", statistics.misses);
+  // 不区分大小时小缓冲区会被分给相机图像，每个缓冲区最终都会增长到图像的大小
+  ASSERT_LT(pool_allocations.bytes, fifo_allocations.bytes);
+  ASSERT_LT(statistics.bytes_retained, fifo_bytes_retained);
+}
@@ -69,7 +69,7 @@ def get_libcarla_extensions():
                 os.path.join(pwd, 'dependencies/lib/libDetourCrowd.a'),
                 os.path.join(pwd, 'dependencies/lib/libosm2odr.a'),
                 os.path.join(pwd, 'dependencies/lib/libxerces-c.a')]
-            extra_link_args += ['-lz']#编译参数列表
+            extra_link_args += ['-lz', '-lrt']#编译参数列表，librt 提供流式传输使用的共享内存
             extra_compile_args = [
                 '-isystem', os.path.join(pwd, 'dependencies/include/system'), '-fPIC', '-std=c++14',#指定额外的系统文件搜索路径
                 '-Werror',#将警告当作错误处理
@@ -196,6 +196,55 @@ static auto ApplyBatchCommandsSync(
 
   return result;
 }
+
+static std::vector<carla::ActorId> ToActorIds(const boost::python::object &actor_ids) {
+  return {
+    boost::python::stl_input_iterator<carla::ActorId>(actor_ids),
+    boost::python::stl_input_iterator<carla::ActorId>()};
+}
+
+// 一次往返获取多辆车的物理控制参数，出错的参与者对应 None
+static auto GetPhysicsControlBatch(
+    const carla::client::Client &self,
+    const boost::python::object &actor_ids) {
+  auto ids = ToActorIds(actor_ids);
+  std::vector<boost::optional<carla::rpc::VehiclePhysicsControl>> controls;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    controls = self.GetVehiclePhysicsControlBatch(ids);
+  }
+  boost::python::list result;
+  for (auto &control : controls) {
+    if (control.has_value()) {
+      result.append(std::move(*control));
+    } else {
+      result.append(boost::python::object());
+    }
+  }
+  return result;
+}
+
+// 一次往返获取多辆车的灯光状态，出错的参与者对应 None
+static auto GetVehicleLightStateBatch(
+    const carla::client::Client &self,
+    const boost::python::object &actor_ids) {
+  auto ids = ToActorIds(actor_ids);
+  std::vector<boost::optional<carla::rpc::VehicleLightState>> states;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    states = self.GetVehicleLightStateBatch(ids);
+  }
+  boost::python::list result;
+  for (auto &state : states) {
+    if (state.has_value()) {
+      result.append(state->GetLightStateEnum());
+    } else {
+      result.append(boost::python::object());
+    }
+  }
+  return result;
+}
+
 /*此函数与ApplyBatchCommands类似，但它是同步执行批量命令并进行一些额外的处理。
 首先同样将boost::python::object类型的commands对象转换为CommandType类型的向量cmds，然后调用客户端的ApplyBatchSync方法获取命令执行的响应结果，并将这些结果逐个添加到boost::python::list类型的result对象中。
 接下来，主要进行了与自动驾驶相关命令的处理：
@@ -250,6 +299,8 @@ void export_client() {
     .def("set_replayer_ignore_spectator", &cc::Client::SetReplayerIgnoreSpectator, (arg("ignore_spectator")))
     .def("apply_batch", &ApplyBatchCommands, (arg("commands"), arg("do_tick")=false))
     .def("apply_batch_sync", &ApplyBatchCommandsSync, (arg("commands"), arg("do_tick")=false))
+    .def("get_physics_control_batch", &GetPhysicsControlBatch, (arg("actor_ids")))
+    .def("get_vehicle_light_state_batch", &GetVehicleLightStateBatch, (arg("actor_ids")))
     .def("get_trafficmanager", CONST_CALL_WITHOUT_GIL_1(cc::Client, GetInstanceTM, uint16_t), (arg("port")=ctm::TM_DEFAULT_PORT))
   ;
 }
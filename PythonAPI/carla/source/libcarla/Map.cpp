@@ -16,6 +16,7 @@
 #include <carla/client/Landmark.h>
 #include <carla/road/SignalType.h>
 
+#include <cstring>
 #include <ostream>
 #include <fstream>
 
@@ -101,6 +102,123 @@ static auto GetLaneValidities(const carla::client::Landmark &self){
   return result;
 }
  
+// 通过 PyObject_GetBuffer 获取的缓冲区，离开作用域时释放，抛出异常时也不会泄漏
+class ScopedBufferView : private carla::NonCopyable {
+public:
+
+  ScopedBufferView() = default;
+
+  ~ScopedBufferView() {
+    if (_acquired) {
+      PyBuffer_Release(&_view);
+    }
+  }
+
+  void Acquire(PyObject *object, int flags) {
+    if (PyObject_GetBuffer(object, &_view, flags) != 0) {
+      boost::python::throw_error_already_set();
+    }
+    _acquired = true;
+  }
+
+  const Py_buffer &Get() const {
+    return _view;
+  }
+
+private:
+
+  Py_buffer _view;
+
+  bool _acquired = false;
+};
+
+// 通过缓冲区协议读取位置数组，支持形状为 (N, 3) 的 float32/float64 numpy 数组，
+// 以及任意 carla.Location 的可迭代对象
+static std::vector<carla::geom::Location> ToLocationArray(boost::python::object locations) {
+  namespace py = boost::python;
+  std::vector<carla::geom::Location> result;
+  if (!PyObject_CheckBuffer(locations.ptr())) {
+    for (py::stl_input_iterator<carla::geom::Location> it(locations), end; it != end; ++it) {
+      result.emplace_back(*it);
+    }
+    return result;
+  }
+  ScopedBufferView buffer;
+  buffer.Acquire(locations.ptr(), PyBUF_C_CONTIGUOUS | PyBUF_FORMAT);
+  const Py_buffer &view = buffer.Get();
+  const std::string format = view.format != nullptr ? view.format : "B";
+  const bool is_float = (format == "f") || (format == "<f") || (format == "=f");
+  const bool is_double = (format == "d") || (format == "<d") || (format == "=d");
+  const bool is_nx3 = (view.ndim == 1) || (view.ndim == 2 && view.shape[1] == 3);
+  if ((!is_float && !is_double) || !is_nx3 || (view.len / view.itemsize) % 3 != 0) {
+    PyErr_SetString(PyExc_TypeError, "locations must be a contiguous (N, 3) array of float32 or float64");
+    py::throw_error_already_set();
+  }
+  const size_t count = static_cast<size_t>(view.len / view.itemsize) / 3u;
+  result.reserve(count);
+  if (is_float) {
+    const auto *data = static_cast<const float *>(view.buf);
+    for (size_t i = 0u; i < count; ++i) {
+      result.emplace_back(data[3u * i], data[3u * i + 1u], data[3u * i + 2u]);
+    }
+  } else {
+    const auto *data = static_cast<const double *>(view.buf);
+    for (size_t i = 0u; i < count; ++i) {
+      result.emplace_back(
+          static_cast<float>(data[3u * i]),
+          static_cast<float>(data[3u * i + 1u]),
+          static_cast<float>(data[3u * i + 2u]));
+    }
+  }
+  return result;
+}
+
+// 创建一个指定类型的一维 numpy 数组并获取其可写缓冲区，numpy 只在运行时导入
+static boost::python::object MakeNumpyArray(size_t size, const char *dtype, ScopedBufferView &buffer) {
+  namespace py = boost::python;
+  py::object array = py::import("numpy").attr("empty")(size, dtype);
+  buffer.Acquire(array.ptr(), PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS);
+  return array;
+}
+
+// 批量获取路点，返回 (road_id, lane_id, s, found) 四个等长的 numpy 数组。
+// 查询期间释放GIL，并在多个线程中并行查询R树
+static boost::python::tuple GetWaypointBatch(
+    const carla::client::Map &self,
+    boost::python::object locations,
+    bool project_to_road,
+    carla::road::Lane::LaneType lane_type) {
+  namespace py = boost::python;
+  const auto points = ToLocationArray(locations);
+  std::vector<boost::optional<carla::road::element::Waypoint>> waypoints;
+  {
+    carla::PythonUtil::ReleaseGIL unlock;
+    waypoints = self.GetMap().GetWaypointBatch(
+        points.data(),
+        points.size(),
+        project_to_road,
+        static_cast<int32_t>(lane_type));
+  }
+
+  ScopedBufferView road_view, lane_view, s_view, found_view;
+  py::object road_ids = MakeNumpyArray(waypoints.size(), "uint32", road_view);
+  py::object lane_ids = MakeNumpyArray(waypoints.size(), "int32", lane_view);
+  py::object s = MakeNumpyArray(waypoints.size(), "float64", s_view);
+  py::object found = MakeNumpyArray(waypoints.size(), "bool", found_view);
+  auto *road_data = static_cast<uint32_t *>(road_view.Get().buf);
+  auto *lane_data = static_cast<int32_t *>(lane_view.Get().buf);
+  auto *s_data = static_cast<double *>(s_view.Get().buf);
+  auto *found_data = static_cast<bool *>(found_view.Get().buf);
+  for (size_t i = 0u; i < waypoints.size(); ++i) {
+    const auto &waypoint = waypoints[i];
+    found_data[i] = waypoint.has_value();
+    road_data[i] = waypoint.has_value() ? waypoint->road_id : 0u;
+    lane_data[i] = waypoint.has_value() ? waypoint->lane_id : 0;
+    s_data[i] = waypoint.has_value() ? waypoint->s : 0.0;
+  }
+  return py::make_tuple(road_ids, lane_ids, s, found);
+}
+
 // 定义一个静态函数，用于将位置转换为地理坐标
 static carla::geom::GeoLocation ToGeolocation(
     const carla::client::Map &self,
@@ -209,6 +327,8 @@ class_<cc::Map, boost::noncopyable, boost::shared_ptr<cc::Map>>("Map", no_init)
    .def("get_spawn_points", CALL_RETURNING_LIST(cc::Map, GetRecommendedSpawnPoints))
     // 根据位置获取路点，可指定是否投影到道路以及车道类型（默认是驾驶车道）
    .def("get_waypoint", &cc::Map::GetWaypoint, (arg("location"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
+    // 批量获取路点，接受 (N, 3) 的 numpy 数组，返回 road_id/lane_id/s/found 的扁平数组
+   .def("get_waypoint_batch", &GetWaypointBatch, (arg("locations"), arg("project_to_road")=true, arg("lane_type")=cr::Lane::LaneType::Driving))
     // 根据道路ID、车道ID和距离获取路点（基于OpenDRIVE格式相关参数）
    .def("get_waypoint_xodr", &cc::Map::GetWaypointXODR, (arg("road_id"), arg("lane_id"), arg("s")))
     // 获取地图拓扑结构的相关方法（这里具体函数未给出完整定义，可能在别处实现）
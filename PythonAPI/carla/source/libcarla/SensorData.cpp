@@ -4,10 +4,12 @@
 // This work is licensed under the terms of the MIT license.
 // For a copy, see <https://opensource.org/licenses/MIT>.
 
+#include <carla/Logging.h>
 #include <carla/PythonUtil.h>
 #include <carla/image/ImageConverter.h>
 #include <carla/image/ImageIO.h>
 #include <carla/image/ImageView.h>
+#include <carla/image/SimdColorConverter.h>
 #include <carla/pointcloud/PointCloudIO.h>
 #include <carla/sensor/SensorData.h>
 #include <carla/sensor/data/CollisionEvent.h>
@@ -33,6 +35,9 @@
 #include <cmath>
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <future>
+#include <mutex>
 #include <thread>
 
 namespace carla {
@@ -304,9 +309,6 @@ static FakeImage ColorCodedFlow(
     // 使用命名空间别名简化代码  
     namespace bp = boost::python;  
     namespace csd = carla::sensor::data;  
-    // 定义常量π和弧度转角度的系数  
-    constexpr float pi = 3.1415f;  
-    constexpr float rad2ang = 360.f/(2.f*pi);  
     // 创建FakeImage对象，用于存储转换后的图像数据  
     FakeImage result;  
     // 设置图像的宽度、高度和视野角度  
@@ -316,89 +318,12 @@ static FakeImage ColorCodedFlow(
     // 调整result的大小，以适应RGB图像的数据量（每个像素4个字节）  
     result.resize(image.GetHeight()*image.GetWidth()* 4);
 
-  // Lambda函数，用于批量处理像素（计算光流数据并映射为颜色）
+  // Lambda函数，用于批量处理像素（计算光流数据并映射为颜色），使用向量化的实现
   auto command = [&] (size_t min_index, size_t max_index) {
-    // 遍历图像像素的索引，从 min_index 到 max_index
-    for (size_t index = min_index; index < max_index; index++) {
-      const csd::OpticalFlowPixel& pixel = image[index];
-      // 提取光流的 x 和 y 分量，表示在 x 和 y 方向上的流动
-      float vx = pixel.x;
-      float vy = pixel.y;
-
-       // 计算光流向量的角度，角度范围为 [0, 360] 度
-      float angle = 180.f + std::atan2(vy, vx)*rad2ang;
-      if (angle < 0) angle = 360.f + angle;
-      angle = std::fmod(angle, 360.f);
-
-      // 计算光流向量的模（即流动的大小）
-      float norm = std::sqrt(vx*vx + vy*vy);
-      const float shift = 0.999f;
-      const float a = 1.f/std::log(0.1f + shift);
-      float intensity = carla::geom::Math::Clamp(a*std::log(norm + shift), 0.f, 1.f);
-
-      // 将角度（Hue）赋值给 H，饱和度（S）设为 1，亮度（V）使用计算得到的强度值
-      float& H = angle;
-      float  S = 1.f;
-      float V = intensity;
-      float H_60 = H*(1.f/60.f);
-
-      // 计算 HSV 转换到 RGB 的中间值
-      float C = V * S;
-      float X = C*(1.f - std::abs(std::fmod(H_60, 2.f) - 1.f));
-      float m = V - C;
-
-      // 初始化 RGB 分量
-      float r = 0,g = 0,b = 0;
-      // 根据 H 值的范围确定 RGB 分量的值
-      unsigned int angle_case = static_cast<unsigned int>(H_60);
-      switch (angle_case) {
-      case 0:
-        r = C;
-        g = X;
-        b = 0;
-        break;
-      case 1:
-        r = X;
-        g = C;
-        b = 0;
-        break;
-      case 2:
-        r = 0;
-        g = C;
-        b = X;
-        break;
-      case 3:
-        r = 0;
-        g = X;
-        b = C;
-        break;
-      case 4:
-        r = X;
-        g = 0;
-        b = C;
-        break;
-      case 5:
-        r = C;
-        g = 0;
-        b = X;
-        break;
-      default:
-        r = 1;
-        g = 1;
-        b = 1;
-        break;
-      }
-
-      // 将 RGB 分量调整并映射到 [0, 255] 范围，并保存到结果数组中（假设使用 RGBA 格式，A 为 0）
-      uint8_t R = static_cast<uint8_t>((r+m)*255.f);
-      uint8_t G = static_cast<uint8_t>((g+m)*255.f);
-      uint8_t B = static_cast<uint8_t>((b+m)*255.f);
-      // 将计算得到的 RGB 值存储到结果数组中（以 RGBA 格式存储）
-      result[4*index] = B;
-      result[4*index + 1] = G;
-      result[4*index + 2] = R;
-      result[4*index + 3] = 0;
-    }
+    carla::image::SimdColorConverter::ColorCodedFlow(
+        image.data() + min_index,
+        max_index - min_index,
+        reinterpret_cast<csd::Color *>(result.data()) + min_index);
   };
   // 计算可用线程数，至少为 8 个线程，或者根据硬件的核心数决定
   size_t num_threads = std::max(8u, std::thread::hardware_concurrency());
@@ -453,11 +378,39 @@ static std::string SaveImageToDisk(T &self, std::string path, EColorConverter cc
   }
 }
 
+using PointCloudFormat = carla::pointcloud::PointCloudIO::Format;
+
+// 保留异步保存点云的任务，输出已完成任务的错误；程序退出时等待未完成的写入
+static void KeepPendingPointCloudSave(std::future<std::string> future) {
+  static std::mutex mutex;
+  static std::vector<std::future<std::string>> pending;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto finished = std::remove_if(pending.begin(), pending.end(), [](std::future<std::string> &task) {
+    if (task.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      return false;
+    }
+    try {
+      task.get();
+    } catch (const std::exception &e) {
+      carla::log_error("failed to save point cloud:", e.what());
+    }
+    return true;
+  });
+  pending.erase(finished, pending.end());
+  pending.emplace_back(std::move(future));
+}
+
 template <typename T>
 // 定义一个静态函数 SavePointCloudToDisk，用于将点云数据保存到磁盘
-static std::string SavePointCloudToDisk(T &self, std::string path) {
+static std::string SavePointCloudToDisk(T &self, std::string path, PointCloudFormat format, bool asynchronous) {
+  using carla::pointcloud::PointCloudIO;
   carla::PythonUtil::ReleaseGIL unlock;
-  return carla::pointcloud::PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end());
+  if (!asynchronous) {
+    return PointCloudIO::SaveToDisk(std::move(path), self.begin(), self.end(), format);
+  }
+  // 复制点云后在后台线程写入，立即返回补全扩展名后的路径
+  KeepPendingPointCloudSave(PointCloudIO::SaveToDiskAsync(path, self.begin(), self.end(), format));
+  return path;
 }
 
 static boost::python::dict GetCAMData(const carla::sensor::data::CAMData message)
@@ -524,6 +477,12 @@ void export_sensor_data() {
     .value("CityScapesPalette", EColorConverter::CityScapesPalette)
   ;
 
+  enum_<PointCloudFormat>("PointCloudFormat")
+    .value("Ascii", PointCloudFormat::Ascii)
+    .value("BinaryLittleEndian", PointCloudFormat::BinaryLittleEndian)
+    .value("Compressed", PointCloudFormat::Compressed)
+  ;
+
   // The values here should match the ones in the enum EGBufferTextureID,
   // from the CARLA fork of Unreal Engine (Renderer/Public/GBufferView.h).
   enum_<int>("GBufferTextureID")
@@ -582,7 +541,7 @@ void export_sensor_data() {
     .add_property("channels", &csd::LidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::LidarMeasurement>)
     .def("get_point_count", &csd::LidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::LidarMeasurement>, (arg("path"), arg("format")=PointCloudFormat::Ascii, arg("asynchronous")=false))
     .def("__len__", &csd::LidarMeasurement::size)
     .def("__iter__", iterator<csd::LidarMeasurement>())
     .def("__getitem__", +[](const csd::LidarMeasurement &self, size_t pos) -> csd::LidarDetection {
@@ -599,7 +558,7 @@ void export_sensor_data() {
     .add_property("channels", &csd::SemanticLidarMeasurement::GetChannelCount)
     .add_property("raw_data", &GetRawDataAsBuffer<csd::SemanticLidarMeasurement>)
     .def("get_point_count", &csd::SemanticLidarMeasurement::GetPointCount, (arg("channel")))
-    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path")))
+    .def("save_to_disk", &SavePointCloudToDisk<csd::SemanticLidarMeasurement>, (arg("path"), arg("format")=PointCloudFormat::Ascii, arg("asynchronous")=false))
     .def("__len__", &csd::SemanticLidarMeasurement::size)
     .def("__iter__", iterator<csd::SemanticLidarMeasurement>())
     .def("__getitem__", +[](const csd::SemanticLidarMeasurement &self, size_t pos) -> csd::SemanticLidarDetection {
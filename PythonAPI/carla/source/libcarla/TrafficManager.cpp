@@ -65,6 +65,18 @@ void InterSetImportedRoute(carla::traffic_manager::TrafficManager& self, const A
   self.SetImportedRoute(actor, RoadOptionToUint(input), empty_buffer); // 调用TrafficManager的SetImportedRoute方法，将Python列表转换为uint8_t的vector作为输入
 }
  
+// 批量设置参数，将Python列表中的 (actor, value) 元组转换为车辆与参数值的vector
+void InterSetVehicleParameters(carla::traffic_manager::TrafficManager& self, carla::traffic_manager::VehicleParameter parameter, boost::python::list input) {
+  std::vector<std::pair<ActorPtr, float>> values;
+  values.reserve(len(input));
+  for (int i = 0; i < len(input); ++i) {
+    values.emplace_back(
+        boost::python::extract<ActorPtr>(input[i][0]),
+        boost::python::extract<float>(input[i][1]));
+  }
+  self.SetVehicleParameters(parameter, values);
+}
+
 // 获取下一个动作
 boost::python::list InterGetNextAction(carla::traffic_manager::TrafficManager& self, const ActorPtr &actor_ptr) {
   boost::python::list l; // 用于存储返回结果的Python列表
@@ -94,6 +106,22 @@ void export_trafficmanager() {
   namespace ctm = carla::traffic_manager; // 定义别名简化命名空间引用
   using namespace boost::python; // 使用Boost.Python命名空间，方便后续代码调用Boost.Python的功能
 
+  enum_<ctm::VehicleParameter>("VehicleParameter")
+    .value("PercentageSpeedDifference", ctm::VehicleParameter::PercentageSpeedDifference)
+    .value("LaneOffset", ctm::VehicleParameter::LaneOffset)
+    .value("DesiredSpeed", ctm::VehicleParameter::DesiredSpeed)
+    .value("DistanceToLeadingVehicle", ctm::VehicleParameter::DistanceToLeadingVehicle)
+    .value("PercentageRunningLight", ctm::VehicleParameter::PercentageRunningLight)
+    .value("PercentageRunningSign", ctm::VehicleParameter::PercentageRunningSign)
+    .value("PercentageIgnoreWalkers", ctm::VehicleParameter::PercentageIgnoreWalkers)
+    .value("PercentageIgnoreVehicles", ctm::VehicleParameter::PercentageIgnoreVehicles)
+    .value("KeepRightPercentage", ctm::VehicleParameter::KeepRightPercentage)
+    .value("RandomLeftLaneChangePercentage", ctm::VehicleParameter::RandomLeftLaneChangePercentage)
+    .value("RandomRightLaneChangePercentage", ctm::VehicleParameter::RandomRightLaneChangePercentage)
+    .value("AutoLaneChange", ctm::VehicleParameter::AutoLaneChange)
+    .value("UpdateVehicleLights", ctm::VehicleParameter::UpdateVehicleLights)
+  ;
+
   class_<ctm::TrafficManager>("TrafficManager", no_init)
     .def("get_port", &ctm::TrafficManager::Port)
     .def("vehicle_percentage_speed_difference", &ctm::TrafficManager::SetPercentageSpeedDifference, (arg("actor"), arg("percentage")))
@@ -117,6 +145,10 @@ void export_trafficmanager() {
     .def("set_synchronous_mode", &ctm::TrafficManager::SetSynchronousMode, (arg("mode_switch")))
     .def("set_hybrid_physics_mode", &ctm::TrafficManager::SetHybridPhysicsMode, (arg("enabled")))
     .def("set_hybrid_physics_radius", &ctm::TrafficManager::SetHybridPhysicsRadius, (arg("r")))
+    .def("set_worker_thread_count", &ctm::TrafficManager::SetWorkerThreadCount, (arg("count")))
+    .def("set_control_frame_diffing", &ctm::TrafficManager::SetControlFrameDiffing, (arg("mode_switch"), arg("tolerance")=0.01f))
+    .def("set_vehicle_parameters", &InterSetVehicleParameters, (arg("parameter"), arg("values")))
+    .def("set_asynchronous_parameter_updates", &ctm::TrafficManager::SetAsynchronousParameterUpdates, (arg("mode_switch")))
     .def("set_random_device_seed", &ctm::TrafficManager::SetRandomDeviceSeed, (arg("value")))
     .def("set_osm_mode", &carla::traffic_manager::TrafficManager::SetOSMMode, (arg("mode_switch")))
     .def("set_path", &InterSetCustomPath, (arg("actor"), arg("path"), arg("empty_buffer")=true))
@@ -101,6 +101,7 @@ void FCarlaEngine::NotifyInitGame(const UCarlaSettings &Settings)
     Server.AsyncRun(FCarlaEngine_GetNumberOfThreadsForRPCServer());
 
     WorldObserver.SetStream(BroadcastStream);
+    WorldObserver.SetKeyframeInterval(Settings.EpisodeKeyframeInterval);
 
     OnPreTickHandle = FWorldDelegates::OnWorldTickStart.AddRaw(
         this,
@@ -31,6 +31,8 @@
 #include "Misc/FileHelper.h" // 包含文件帮助函数的头文件，提供文件操作功能
 #include "Misc/Paths.h" // 包含路径管理的头文件，提供路径相关功能
 
+#include <fstream> // 以流的方式写入导航网格文件
+
 // 静态函数，根据交通标志状态返回对应的标识符
 static FString UCarlaEpisode_GetTrafficSignId(ETrafficSignState State)
 {
@@ -179,20 +181,23 @@ bool UCarlaEpisode::LoadNewOpendriveEpisode(
     return false;
   }
 
-  // 生成 OBJ（作为字符串）
-  const auto RoadMesh = CarlaMap->GenerateMesh(Params.vertex_distance);
-  const auto CrosswalksMesh = CarlaMap->GetAllCrosswalkMesh();
-  const auto RecastOBJ = (RoadMesh + CrosswalksMesh).GenerateOBJForRecast();
+  // 生成道路网格并合并人行横道网格
+  auto RoadMesh = CarlaMap->GenerateMesh(Params.vertex_distance);
+  RoadMesh += CarlaMap->GetAllCrosswalkMesh();
 
   const FString AbsoluteOBJPath = FPaths::ConvertRelativePathToFull(
       FPaths::ProjectContentDir() + "Carla/Maps/Nav/OpenDriveMap.obj");
 
-  // 将 OBJ 字符串存储到文件中，以便 RecastBuilder 可以加载它
-  FFileHelper::SaveStringToFile(
-      carla::rpc::ToLongFString(RecastOBJ),
-      *AbsoluteOBJPath,
-      FFileHelper::EEncodingOptions::ForceUTF8,
-      &IFileManager::Get());
+  // 将 OBJ 分块直接写入文件，以便 RecastBuilder 可以加载它，
+  // 大地图不需要先在内存中生成完整的字符串
+  IFileManager::Get().MakeDirectory(*FPaths::GetPath(AbsoluteOBJPath), true);
+  {
+    std::ofstream OBJFile(TCHAR_TO_UTF8(*AbsoluteOBJPath), std::ios::binary);
+    if (!RoadMesh.WriteOBJForRecast(OBJFile))
+    {
+      UE_LOG(LogCarla, Error, TEXT("Failed to write the navigation mesh OBJ to %s"), *AbsoluteOBJPath);
+    }
+  }
 
   const FString AbsoluteXODRPath = FPaths::ConvertRelativePathToFull(
       FPaths::ProjectContentDir() + "Carla/Maps/OpenDrive/OpenDriveMap.xodr");
@@ -265,7 +265,51 @@ static carla::geom::Vector3D FWorldObserver_GetAcceleration(
   return {Acceleration.X, Acceleration.Y, Acceleration.Z};
 }
 
-static carla::Buffer FWorldObserver_Serialize(
+static carla::sensor::data::ActorDynamicState FWorldObserver_GetActorDynamicState(
+    const FCarlaActor &View,
+    const FActorRegistry &Registry,
+    float DeltaSeconds)
+{
+  constexpr float TO_METERS = 1e-2;
+
+  FTransform ActorTransform;
+  FVector Velocity(0.0f);
+  carla::geom::Vector3D AngularVelocity(0.0f, 0.0f, 0.0f);
+  carla::geom::Vector3D Acceleration(0.0f, 0.0f, 0.0f);
+  carla::sensor::data::ActorDynamicState::TypeDependentState State{};
+
+  if(View.IsDormant())
+  {
+    const FActorData* ActorData = View.GetActorData();
+    Velocity = TO_METERS * ActorData->Velocity;
+    AngularVelocity = carla::geom::Vector3D
+                      {ActorData->AngularVelocity.X,
+                       ActorData->AngularVelocity.Y,
+                       ActorData->AngularVelocity.Z};
+    Acceleration = FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds);
+    State = FWorldObserver_GetDormantActorState(View, Registry);
+  }
+  else
+  {
+    Velocity = TO_METERS * View.GetActor()->GetVelocity();
+    AngularVelocity = FWorldObserver_GetAngularVelocity(*View.GetActor());
+    Acceleration = FWorldObserver_GetAcceleration(View, Velocity, DeltaSeconds);
+    State = FWorldObserver_GetActorState(View, Registry);
+  }
+  ActorTransform = View.GetActorGlobalTransform();
+
+  return {
+    View.GetActorId(),
+    View.GetActorState(),
+    carla::geom::Transform(ActorTransform),
+    carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
+    AngularVelocity,
+    Acceleration,
+    State,
+  };
+}
+
+carla::Buffer FWorldObserver::Serialize(
     carla::Buffer &&buffer,
     const UCarlaEpisode &Episode,
     float DeltaSeconds,
@@ -275,24 +319,79 @@ static carla::Buffer FWorldObserver_Serialize(
   TRACE_CPUPROFILER_EVENT_SCOPE_STR(__FUNCTION__);
   using Serializer = carla::sensor::s11n::EpisodeStateSerializer;
   using SimulationState = carla::sensor::s11n::EpisodeStateSerializer::SimulationState;
-  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
-
 
   const FActorRegistry &Registry = Episode.GetActorRegistry();
+  const uint64 Frame = FCarlaEngine::GetFrameCounter();
 
-  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Registry.Num();
+  // Gather the state of every actor.
+  CurrentActors.clear();
+  CurrentActors.reserve(Registry.Num());
+  for (auto& It : Registry)
+  {
+    const FCarlaActor* View = It.Value.Get();
+    check(View);
+    CurrentActors.emplace_back(FWorldObserver_GetActorDynamicState(*View, Registry, DeltaSeconds));
+  }
+
+  // Compare against the last keyframe, actors within the tolerance of the
+  // serializer are not sent again.
+  bool bIsKeyframe =
+      (KeyframeInterval == 0u) ||
+      !bHasKeyframe ||
+      MapChange ||
+      (KeyframeEpisodeId != Episode.GetId()) ||
+      (TicksSinceKeyframe >= KeyframeInterval);
+  if (!bIsKeyframe)
+  {
+    ChangedActors.clear();
+    RemovedActors.clear();
+    for (const ActorDynamicState &Actor : CurrentActors)
+    {
+      const carla::ActorId ActorId = Actor.id;
+      auto Found = KeyframeActors.find(ActorId);
+      if (Found == KeyframeActors.end())
+      {
+        ChangedActors.emplace_back(Actor);
+        continue;
+      }
+      Found->second.LastSeenFrame = Frame;
+      if (!Serializer::IsNearlyEqual(Actor, Found->second.State))
+      {
+        ChangedActors.emplace_back(Actor);
+      }
+    }
+    for (const auto &Item : KeyframeActors)
+    {
+      if (Item.second.LastSeenFrame != Frame)
+      {
+        RemovedActors.emplace_back(Item.first);
+      }
+    }
+    // Once most of the actors changed a keyframe is cheaper and resets the
+    // base for the following ticks.
+    const auto DeltaSize =
+        sizeof(Serializer::DeltaHeader) +
+        sizeof(carla::ActorId) * RemovedActors.size() +
+        sizeof(ActorDynamicState) * ChangedActors.size();
+    bIsKeyframe = (DeltaSize >= sizeof(ActorDynamicState) * CurrentActors.size());
+  }
+
+  const std::vector<ActorDynamicState> &Actors = bIsKeyframe ? CurrentActors : ChangedActors;
+  auto total_size = sizeof(Serializer::Header) + sizeof(ActorDynamicState) * Actors.size();
+  if (!bIsKeyframe)
+  {
+    total_size += sizeof(Serializer::DeltaHeader) + sizeof(carla::ActorId) * RemovedActors.size();
+  }
   auto current_size = 0;
   // Set up buffer for writing.
   buffer.reset(total_size);
-  auto write_data = [&current_size, &buffer](const auto &data)
+  auto write_data = [&current_size, &buffer](const void *data, size_t size)
   {
     auto begin = buffer.begin() + current_size;
-    std::memcpy(begin, &data, sizeof(data));
-    current_size += sizeof(data);
+    std::memcpy(begin, data, size);
+    current_size += size;
   };
 
-  constexpr float TO_METERS = 1e-2;
-
   // Write header.
   Serializer::Header header;
   header.episode_id = Episode.GetId();
@@ -304,60 +403,42 @@ static carla::Buffer FWorldObserver_Serialize(
 
   uint8_t simulation_state = (SimulationState::MapChange * MapChange);
   simulation_state |= (SimulationState::PendingLightUpdate * PendingLightUpdates);
+  simulation_state |= (SimulationState::Delta * !bIsKeyframe);
 
   header.simulation_state = static_cast<SimulationState>(simulation_state);
 
-  write_data(header);
+  write_data(&header, sizeof(header));
 
-  // Write every actor.
-  for (auto& It : Registry)
+  if (bIsKeyframe)
   {
-    const FCarlaActor* View = It.Value.Get();
-    const FActorInfo* ActorInfo = View->GetActorInfo();
-
-    FTransform ActorTransform;
-    FVector Velocity(0.0f);
-    carla::geom::Vector3D AngularVelocity(0.0f, 0.0f, 0.0f);
-    carla::geom::Vector3D Acceleration(0.0f, 0.0f, 0.0f);
-    carla::sensor::data::ActorDynamicState::TypeDependentState State{};
-
-
-    check(View);
-
-    if(View->IsDormant())
+    if (KeyframeInterval > 0u)
     {
-      const FActorData* ActorData = View->GetActorData();
-      Velocity = TO_METERS * ActorData->Velocity;
-      AngularVelocity = carla::geom::Vector3D
-                        {ActorData->AngularVelocity.X,
-                         ActorData->AngularVelocity.Y,
-                         ActorData->AngularVelocity.Z};
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetDormantActorState(*View, Registry);
-    }
-    else
-    {
-      Velocity = TO_METERS * View->GetActor()->GetVelocity();
-      AngularVelocity = FWorldObserver_GetAngularVelocity(*View->GetActor());
-      Acceleration = FWorldObserver_GetAcceleration(*View, Velocity, DeltaSeconds);
-      State = FWorldObserver_GetActorState(*View, Registry);
+      bHasKeyframe = true;
+      KeyframeFrame = Frame;
+      KeyframeEpisodeId = Episode.GetId();
+      TicksSinceKeyframe = 0u;
+      KeyframeActors.clear();
+      KeyframeActors.reserve(CurrentActors.size());
+      for (const ActorDynamicState &Actor : CurrentActors)
+      {
+        const carla::ActorId ActorId = Actor.id;
+        KeyframeActors.emplace(ActorId, FKeyframeActor{Actor, Frame});
+      }
     }
-    ActorTransform = View->GetActorGlobalTransform();
-
-    ActorDynamicState info = {
-      View->GetActorId(),
-      View->GetActorState(),
-      carla::geom::Transform(ActorTransform),
-      carla::geom::Vector3D(Velocity.X, Velocity.Y, Velocity.Z),
-      AngularVelocity,
-      Acceleration,
-      State,
-    };
-    write_data(info);
+  }
+  else
+  {
+    ++TicksSinceKeyframe;
+    Serializer::DeltaHeader delta_header;
+    delta_header.keyframe = KeyframeFrame;
+    delta_header.actor_count = static_cast<uint32_t>(CurrentActors.size());
+    delta_header.removed_count = static_cast<uint32_t>(RemovedActors.size());
+    write_data(&delta_header, sizeof(delta_header));
+    write_data(RemovedActors.data(), sizeof(carla::ActorId) * RemovedActors.size());
   }
 
-  // Shrink buffer
-  buffer.resize(current_size);
+  // Write the actors.
+  write_data(Actors.data(), sizeof(ActorDynamicState) * Actors.size());
 
   check(buffer.size() == current_size);
 
@@ -377,7 +458,7 @@ void FWorldObserver::BroadcastTick(
 
   auto AsyncStream = Stream.MakeAsyncDataStream(*this, Episode.GetElapsedGameTime());
 
-  carla::Buffer buffer = FWorldObserver_Serialize(
+  carla::Buffer buffer = Serialize(
       AsyncStream.PopBufferFromPool(),
       Episode,
       DeltaSecond,
@@ -8,6 +8,13 @@
 
 #include "Carla/Sensor/DataStream.h"
 
+#include <compiler/disable-ue4-macros.h>
+#include <carla/sensor/data/ActorDynamicState.h>
+#include <compiler/enable-ue4-macros.h>
+
+#include <unordered_map>
+#include <vector>
+
 class UCarlaEpisode;
 
 /// Serializes and sends all the actors in the current UCarlaEpisode.
@@ -30,6 +37,16 @@ public:
     return Stream.GetToken();
   }
 
+  /// Enable the delta encoding of the episode stream. A full keyframe is sent
+  /// every @a KeyframeInterval ticks, the ticks in between only carry the
+  /// actors that changed since the last keyframe. Zero disables it and every
+  /// tick sends the full state.
+  void SetKeyframeInterval(uint32 InKeyframeInterval)
+  {
+    KeyframeInterval = InKeyframeInterval;
+    bHasKeyframe = false;
+  }
+
   /// Send a message to every connected client with the info about the given @a
   /// Episode.
   void BroadcastTick(
@@ -46,5 +63,41 @@ public:
 
 private:
 
+  using ActorDynamicState = carla::sensor::data::ActorDynamicState;
+
+  struct FKeyframeActor
+  {
+    ActorDynamicState State;
+
+    uint64 LastSeenFrame = 0u;
+  };
+
+  carla::Buffer Serialize(
+    carla::Buffer &&Buffer,
+    const UCarlaEpisode &Episode,
+    float DeltaSeconds,
+    bool MapChange,
+    bool PendingLightUpdate);
+
   FDataMultiStream Stream;
+
+  uint32 KeyframeInterval = 0u;
+
+  bool bHasKeyframe = false;
+
+  uint64 KeyframeFrame = 0u;
+
+  uint64 KeyframeEpisodeId = 0u;
+
+  uint32 TicksSinceKeyframe = 0u;
+
+  /// State of every actor at the last keyframe, as seen by the clients.
+  std::unordered_map<carla::ActorId, FKeyframeActor> KeyframeActors;
+
+  /// Scratch buffers reused between ticks.
+  std::vector<ActorDynamicState> CurrentActors;
+
+  std::vector<ActorDynamicState> ChangedActors;
+
+  std::vector<carla::ActorId> RemovedActors;
 };
@@ -3003,6 +3003,35 @@ BIND_SYNC(is_sensor_enabled_for_ros) << [this](carla::streaming::detail::stream_
     return result;
   };
 
+  // ~~ Query actors in batch ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+  // 与 apply_batch 一样在一次调用中处理多个参与者，每个参与者的结果
+  // 单独返回，某个参与者出错不会影响其他参与者。
+
+  BIND_SYNC(get_physics_control_batch) << [=](
+      const std::vector<cr::ActorId> &actor_ids)
+  {
+    std::vector<R<cr::VehiclePhysicsControl>> result;
+    result.reserve(actor_ids.size());
+    for (auto actor_id : actor_ids)
+    {
+      result.emplace_back(get_physics_control(actor_id));
+    }
+    return result;
+  };
+
+  BIND_SYNC(get_vehicle_light_state_batch) << [=](
+      const std::vector<cr::ActorId> &actor_ids)
+  {
+    std::vector<R<cr::VehicleLightState>> result;
+    result.reserve(actor_ids.size());
+    for (auto actor_id : actor_ids)
+    {
+      result.emplace_back(get_vehicle_light_state(actor_id));
+    }
+    return result;
+  };
+
   // ~~ Light Subsystem ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
   BIND_SYNC(query_lights_state) << [this](std::string client) -> R<std::vector<cr::LightState>>
@@ -90,6 +90,7 @@ static void LoadSettingsFromConfig(
     ConfigFile.GetString(S_CARLA_SERVER, TEXT("PrimaryIP"), Tmp);
     Settings.PrimaryIP = TCHAR_TO_UTF8(*Tmp);
     ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("PrimaryPort"), Settings.PrimaryPort);
+    ConfigFile.GetInt(S_CARLA_SERVER,    TEXT("EpisodeKeyframeInterval"), Settings.EpisodeKeyframeInterval);
   }
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("SynchronousMode"), Settings.bSynchronousMode);
   ConfigFile.GetBool(S_CARLA_SERVER, TEXT("DisableRendering"), Settings.bDisableRendering);
@@ -159,6 +160,10 @@ void UCarlaSettings::LoadSettings()
     {
       PrimaryPort = Value;
     }
+    if (FParse::Value(FCommandLine::Get(), TEXT("-episode-keyframe-interval="), Value))
+    {
+      EpisodeKeyframeInterval = Value;
+    }
     FString StringQualityLevel;
     if (FParse::Value(FCommandLine::Get(), TEXT("-quality-level="), StringQualityLevel))
     {
@@ -203,6 +208,7 @@ void UCarlaSettings::LogSettings() const
   UE_LOG(LogCarla, Log, TEXT("RPC Port = %d"), RPCPort);
   UE_LOG(LogCarla, Log, TEXT("Streaming Port = %d"), StreamingPort);
   UE_LOG(LogCarla, Log, TEXT("Secondary Port = %d"), SecondaryPort);
+  UE_LOG(LogCarla, Log, TEXT("Episode Keyframe Interval = %d"), EpisodeKeyframeInterval);
   UE_LOG(LogCarla, Log, TEXT("Synchronous Mode = %s"), EnabledDisabled(bSynchronousMode));
   UE_LOG(LogCarla, Log, TEXT("Rendering = %s"), EnabledDisabled(!bDisableRendering));
   UE_LOG(LogCarla, Log, TEXT("[%s]"), S_CARLA_QUALITYSETTINGS);
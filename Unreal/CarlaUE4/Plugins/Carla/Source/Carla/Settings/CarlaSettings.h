@@ -85,6 +85,10 @@ public:
   std::string PrimaryIP = "";
   uint32      PrimaryPort = 2002u;
 
+  /// 剧集状态流的关键帧间隔（帧数）。大于0时两个关键帧之间只发送发生
+  /// 变化的参与者，为0时每一帧都发送所有参与者的状态。
+  uint32 EpisodeKeyframeInterval = 0u;
+
   /// 在同步模式下，CARLA 会等待每个节拍信号，直到收到来自客户端的控制。
   UPROPERTY(Category = "CARLA Server", VisibleAnywhere, meta = (EditCondition = bUseNetworking))
   bool bSynchronousMode = false;